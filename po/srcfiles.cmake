@@ -78,6 +78,8 @@ SET(WEECHAT_SOURCES
 ./src/core/wee-secure-buffer.h
 ./src/core/wee-secure-config.c
 ./src/core/wee-secure-config.h
+./src/core/wee-slab.c
+./src/core/wee-slab.h
 ./src/core/wee-string.c
 ./src/core/wee-string.h
 ./src/core/wee-upgrade.c
@@ -269,6 +271,8 @@ SET(WEECHAT_SOURCES
 ./src/plugins/logger/logger-command.h
 ./src/plugins/logger/logger-config.c
 ./src/plugins/logger/logger-config.h
+./src/plugins/logger/logger-index.c
+./src/plugins/logger/logger-index.h
 ./src/plugins/logger/logger.h
 ./src/plugins/logger/logger-info.c
 ./src/plugins/logger/logger-info.h
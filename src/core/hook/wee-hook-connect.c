@@ -39,7 +39,10 @@
 
 
 /*
- * Hooks a connection to a peer (using fork).
+ * Hooks a connection to a peer.
+ *
+ * Name is resolved in a thread and connection is made in WeeChat process,
+ * without fork (a fork is still used to connect with a proxy).
  *
  * Returns pointer to new hook, NULL if error.
  */
@@ -99,6 +102,17 @@ hook_connect (struct t_weechat_plugin *plugin, const char *proxy,
     new_hook_connect->handshake_hook_timer = NULL;
     new_hook_connect->handshake_fd_flags = 0;
     new_hook_connect->handshake_ip_address = NULL;
+    new_hook_connect->resolve = NULL;
+    new_hook_connect->res_remote = NULL;
+    new_hook_connect->res_local = NULL;
+    new_hook_connect->addresses = NULL;
+    new_hook_connect->num_addresses = 0;
+    new_hook_connect->next_address = 0;
+    new_hook_connect->attempt_sock = NULL;
+    new_hook_connect->attempt_hook_fd = NULL;
+    new_hook_connect->attempt_hook_timer = NULL;
+    new_hook_connect->attempt_status = WEECHAT_HOOK_CONNECT_IP_ADDRESS_NOT_FOUND;
+    new_hook_connect->attempt_errno = 0;
     if (!hook_socketpair_ok)
     {
         for (i = 0; i < HOOK_CONNECT_MAX_SOCKETS; i++)
@@ -110,7 +124,7 @@ hook_connect (struct t_weechat_plugin *plugin, const char *proxy,
 
     hook_add_to_list (new_hook);
 
-    network_connect_with_fork (new_hook);
+    network_connect_start (new_hook);
 
     return new_hook;
 }
@@ -246,6 +260,12 @@ hook_connect_free_data (struct t_hook *hook)
         free (HOOK_CONNECT(hook, handshake_ip_address));
         HOOK_CONNECT(hook, handshake_ip_address) = NULL;
     }
+    if (HOOK_CONNECT(hook, resolve))
+    {
+        network_resolve_cancel (HOOK_CONNECT(hook, resolve));
+        HOOK_CONNECT(hook, resolve) = NULL;
+    }
+    network_connect_free_attempts (hook);
     if (HOOK_CONNECT(hook, child_pid) > 0)
     {
         kill (HOOK_CONNECT(hook, child_pid), SIGKILL);
@@ -350,6 +370,18 @@ hook_connect_add_to_infolist (struct t_infolist_item *item,
         return 0;
     if (!infolist_new_var_string (item, "handshake_ip_address", HOOK_CONNECT(hook, handshake_ip_address)))
         return 0;
+    if (!infolist_new_var_pointer (item, "resolve", HOOK_CONNECT(hook, resolve)))
+        return 0;
+    if (!infolist_new_var_integer (item, "num_addresses", HOOK_CONNECT(hook, num_addresses)))
+        return 0;
+    if (!infolist_new_var_integer (item, "next_address", HOOK_CONNECT(hook, next_address)))
+        return 0;
+    if (!infolist_new_var_pointer (item, "attempt_hook_timer", HOOK_CONNECT(hook, attempt_hook_timer)))
+        return 0;
+    if (!infolist_new_var_integer (item, "attempt_status", HOOK_CONNECT(hook, attempt_status)))
+        return 0;
+    if (!infolist_new_var_integer (item, "attempt_errno", HOOK_CONNECT(hook, attempt_errno)))
+        return 0;
 
     return 1;
 }
@@ -390,6 +422,25 @@ hook_connect_print_log (struct t_hook *hook)
     log_printf ("    handshake_hook_timer. : 0x%lx", HOOK_CONNECT(hook, handshake_hook_timer));
     log_printf ("    handshake_fd_flags. . : %d", HOOK_CONNECT(hook, handshake_fd_flags));
     log_printf ("    handshake_ip_address. : '%s'", HOOK_CONNECT(hook, handshake_ip_address));
+    log_printf ("    resolve . . . . . . . : 0x%lx", HOOK_CONNECT(hook, resolve));
+    log_printf ("    res_remote. . . . . . : 0x%lx", HOOK_CONNECT(hook, res_remote));
+    log_printf ("    res_local . . . . . . : 0x%lx", HOOK_CONNECT(hook, res_local));
+    log_printf ("    addresses . . . . . . : 0x%lx", HOOK_CONNECT(hook, addresses));
+    log_printf ("    num_addresses . . . . : %d", HOOK_CONNECT(hook, num_addresses));
+    log_printf ("    next_address. . . . . : %d", HOOK_CONNECT(hook, next_address));
+    if (HOOK_CONNECT(hook, attempt_sock))
+    {
+        for (i = 0; i < HOOK_CONNECT(hook, num_addresses); i++)
+        {
+            log_printf ("    attempt[%03d]. . . . . : sock: %d, hook_fd: 0x%lx",
+                        i,
+                        HOOK_CONNECT(hook, attempt_sock)[i],
+                        HOOK_CONNECT(hook, attempt_hook_fd)[i]);
+        }
+    }
+    log_printf ("    attempt_hook_timer. . : 0x%lx", HOOK_CONNECT(hook, attempt_hook_timer));
+    log_printf ("    attempt_status. . . . : %d", HOOK_CONNECT(hook, attempt_status));
+    log_printf ("    attempt_errno . . . . : %d", HOOK_CONNECT(hook, attempt_errno));
     if (!hook_socketpair_ok)
     {
         for (i = 0; i < HOOK_CONNECT_MAX_SOCKETS; i++)
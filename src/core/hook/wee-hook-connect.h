@@ -25,6 +25,8 @@
 
 struct t_weechat_plugin;
 struct t_infolist_item;
+struct t_network_resolve;
+struct addrinfo;
 
 #define HOOK_CONNECT(hook, var) (((struct t_hook_connect *)hook->hook_data)->var)
 
@@ -67,12 +69,24 @@ struct t_hook_connect
     int child_recv;                    /* to read data from child socket    */
     int child_send;                    /* to write data to child socket     */
     pid_t child_pid;                   /* pid of child process (connecting) */
-    struct t_hook *hook_child_timer;   /* timer for child process timeout   */
+    struct t_hook *hook_child_timer;   /* timer for connection timeout      */
     struct t_hook *hook_fd;            /* pointer to fd hook                */
     struct t_hook *handshake_hook_fd;  /* fd hook for handshake             */
     struct t_hook *handshake_hook_timer; /* timer for handshake timeout     */
     int handshake_fd_flags;            /* socket flags saved for handshake  */
     char *handshake_ip_address;        /* ip address (used for handshake)   */
+    /* used if connecting without fork (name resolved in a thread) */
+    struct t_network_resolve *resolve; /* pending name resolution           */
+    struct addrinfo *res_remote;       /* addresses of peer                 */
+    struct addrinfo *res_local;        /* addresses of local hostname       */
+    struct addrinfo **addresses;       /* sorted addresses to try           */
+    int num_addresses;                 /* number of addresses to try        */
+    int next_address;                  /* index of next address to try      */
+    int *attempt_sock;                 /* socket of each connect attempt    */
+    struct t_hook **attempt_hook_fd;   /* fd hook of each connect attempt   */
+    struct t_hook *attempt_hook_timer; /* timer to start next attempt       */
+    int attempt_status;                /* status of last failed attempt     */
+    int attempt_errno;                 /* errno of last failed attempt      */
     /* sockets used if socketpair() is NOT available */
     int sock_v4[HOOK_CONNECT_MAX_SOCKETS];  /* IPv4 sockets for connecting  */
     int sock_v6[HOOK_CONNECT_MAX_SOCKETS];  /* IPv6 sockets for connecting  */
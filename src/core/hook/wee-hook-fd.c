@@ -24,9 +24,15 @@
 #endif
 
 #include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
 #include <poll.h>
 #include <fcntl.h>
 #include <errno.h>
+#ifdef HAVE_SYS_EPOLL_H
+#include <sys/epoll.h>
+#endif
 
 #include "../weechat.h"
 #include "../wee-hook.h"
@@ -37,8 +43,23 @@
 
 
 struct pollfd *hook_fd_pollfd = NULL;  /* file descriptors for poll()       */
+struct t_hook **hook_fd_pollfd_hook = NULL; /* hook for each pollfd         */
 int hook_fd_pollfd_count = 0;          /* number of file descriptors        */
 
+struct t_hook **hook_fd_table = NULL;  /* fd hooks, indexed by fd           */
+int hook_fd_table_size = 0;            /* size of hook_fd_table             */
+unsigned int hook_fd_serial = 0;       /* serial for next fd hook           */
+int hook_fd_always_ready_count = 0;    /* number of hooks always ready      */
+
+#ifdef HAVE_SYS_EPOLL_H
+int hook_fd_epoll = -1;                /* epoll instance (-1 = poll() used) */
+int hook_fd_epoll_failed = 0;          /* 1 if epoll can not be used        */
+struct epoll_event *hook_fd_epoll_events = NULL; /* events for epoll_wait() */
+int hook_fd_epoll_events_size = 0;     /* size of hook_fd_epoll_events      */
+int hook_fd_epoll_removed = 0;         /* 1 if a hook was removed from the  */
+                                       /* interest set during exec          */
+#endif /* HAVE_SYS_EPOLL_H */
+
 
 /*
  * Searches for a fd hook in list.
@@ -48,20 +69,247 @@ int hook_fd_pollfd_count = 0;          /* number of file descriptors        */
 
 struct t_hook *
 hook_fd_search (int fd)
+{
+    if ((fd < 0) || (fd >= hook_fd_table_size))
+        return NULL;
+
+    return hook_fd_table[fd];
+}
+
+/*
+ * Sets the hook for a fd in table of fd hooks (hook can be NULL to remove
+ * the fd from table).
+ *
+ * Returns:
+ *   1: OK
+ *   0: error (not enough memory)
+ */
+
+int
+hook_fd_table_set (int fd, struct t_hook *hook)
+{
+    struct t_hook **new_table;
+    int i, new_size;
+
+    if (fd < 0)
+        return 0;
+
+    if (fd >= hook_fd_table_size)
+    {
+        if (!hook)
+            return 1;
+        new_size = (hook_fd_table_size > 0) ? hook_fd_table_size : 64;
+        while (new_size <= fd)
+        {
+            new_size *= 2;
+        }
+        new_table = realloc (hook_fd_table, new_size * sizeof (*new_table));
+        if (!new_table)
+            return 0;
+        for (i = hook_fd_table_size; i < new_size; i++)
+        {
+            new_table[i] = NULL;
+        }
+        hook_fd_table = new_table;
+        hook_fd_table_size = new_size;
+    }
+
+    hook_fd_table[fd] = hook;
+
+    return 1;
+}
+
+/*
+ * Sets error on a fd hook and displays an error if fd is invalid
+ * (only for the first error).
+ */
+
+void
+hook_fd_set_error (struct t_hook *hook, int error)
+{
+    if (HOOK_FD(hook, error) != 0)
+        return;
+
+    HOOK_FD(hook, error) = error;
+    if (error == EBADF)
+    {
+        gui_chat_printf (NULL,
+                         _("%sError: bad file descriptor (%d) "
+                           "used in hook_fd"),
+                         gui_chat_prefix[GUI_CHAT_PREFIX_ERROR],
+                         HOOK_FD(hook, fd));
+    }
+}
+
+/*
+ * Checks if the file descriptor of a fd hook is valid, and sets error on
+ * hook if the fd is invalid.
+ *
+ * Returns:
+ *   1: fd is valid
+ *   0: fd is invalid
+ */
+
+int
+hook_fd_check_valid (struct t_hook *hook)
+{
+    if ((fcntl (HOOK_FD(hook, fd), F_GETFD) == -1) && (errno == EBADF))
+    {
+        hook_fd_set_error (hook, EBADF);
+        return 0;
+    }
+    return 1;
+}
+
+#ifdef HAVE_SYS_EPOLL_H
+
+/*
+ * Closes the epoll instance.
+ *
+ * If failed == 1, epoll will not be used any more (fallback to poll()).
+ */
+
+void
+hook_fd_epoll_end (int failed)
 {
     struct t_hook *ptr_hook;
 
+    if (failed)
+        hook_fd_epoll_failed = 1;
+
+    if (hook_fd_epoll < 0)
+        return;
+
+    close (hook_fd_epoll);
+    hook_fd_epoll = -1;
+
     for (ptr_hook = weechat_hooks[HOOK_TYPE_FD]; ptr_hook;
          ptr_hook = ptr_hook->next_hook)
     {
-        if (!ptr_hook->deleted && (HOOK_FD(ptr_hook, fd) == fd))
-            return ptr_hook;
+        if (!ptr_hook->deleted)
+            HOOK_FD(ptr_hook, always_ready) = 0;
+    }
+    hook_fd_always_ready_count = 0;
+
+    if (hook_fd_epoll_events)
+    {
+        free (hook_fd_epoll_events);
+        hook_fd_epoll_events = NULL;
+    }
+    hook_fd_epoll_events_size = 0;
+}
+
+/*
+ * Adds a fd hook in the epoll interest set.
+ *
+ * The data of epoll event contains the fd and the serial of hook, so that
+ * an event received for an old hook (with a reused fd) is detected.
+ */
+
+void
+hook_fd_epoll_add (struct t_hook *hook)
+{
+    struct epoll_event event;
+    int rc;
+
+    HOOK_FD(hook, always_ready) = 0;
+
+    memset (&event, 0, sizeof (event));
+    if (HOOK_FD(hook, flags) & HOOK_FD_FLAG_READ)
+        event.events |= EPOLLIN;
+    if (HOOK_FD(hook, flags) & HOOK_FD_FLAG_WRITE)
+        event.events |= EPOLLOUT;
+    event.data.u64 = ((uint64_t)HOOK_FD(hook, serial) << 32)
+        | (uint32_t)HOOK_FD(hook, fd);
+
+    rc = epoll_ctl (hook_fd_epoll, EPOLL_CTL_ADD, HOOK_FD(hook, fd), &event);
+    if ((rc < 0) && (errno == EEXIST))
+        rc = epoll_ctl (hook_fd_epoll, EPOLL_CTL_MOD, HOOK_FD(hook, fd), &event);
+    if (rc == 0)
+        return;
+
+    switch (errno)
+    {
+        case EPERM:
+            /*
+             * fd not supported by epoll (regular file): poll() would
+             * always return it as ready, so we do the same
+             */
+            HOOK_FD(hook, always_ready) = 1;
+            hook_fd_always_ready_count++;
+            break;
+        case EBADF:
+            hook_fd_set_error (hook, EBADF);
+            break;
+        default:
+            /* unexpected error (for example limit of watches reached) */
+            hook_fd_epoll_end (1);
+            break;
+    }
+}
+
+/*
+ * Removes a fd hook from the epoll interest set.
+ */
+
+void
+hook_fd_epoll_remove (struct t_hook *hook)
+{
+    if (HOOK_FD(hook, always_ready))
+    {
+        HOOK_FD(hook, always_ready) = 0;
+        hook_fd_always_ready_count--;
+        return;
     }
 
-    /* fd hook not found */
-    return NULL;
+    /* errors are ignored: fd may have been closed before unhook */
+    (void) epoll_ctl (hook_fd_epoll, EPOLL_CTL_DEL, HOOK_FD(hook, fd), NULL);
+    hook_fd_epoll_removed = 1;
 }
 
+/*
+ * Creates the epoll instance and adds all fd hooks in the interest set.
+ *
+ * Returns:
+ *   1: OK, epoll is used
+ *   0: epoll can not be used (poll() will be used instead)
+ */
+
+int
+hook_fd_epoll_init ()
+{
+    struct t_hook *ptr_hook;
+
+    if (hook_fd_epoll >= 0)
+        return 1;
+
+    if (hook_fd_epoll_failed)
+        return 0;
+
+    hook_fd_epoll = epoll_create1 (EPOLL_CLOEXEC);
+    if (hook_fd_epoll < 0)
+    {
+        hook_fd_epoll_failed = 1;
+        return 0;
+    }
+
+    hook_fd_always_ready_count = 0;
+    for (ptr_hook = weechat_hooks[HOOK_TYPE_FD]; ptr_hook;
+         ptr_hook = ptr_hook->next_hook)
+    {
+        if (!ptr_hook->deleted)
+        {
+            hook_fd_epoll_add (ptr_hook);
+            if (hook_fd_epoll < 0)
+                return 0;
+        }
+    }
+
+    return 1;
+}
+
+#endif /* HAVE_SYS_EPOLL_H */
+
 /*
  * Reallocates the "struct pollfd" array for poll().
  */
@@ -70,6 +318,7 @@ void
 hook_fd_realloc_pollfd ()
 {
     struct pollfd *ptr_pollfd;
+    struct t_hook **ptr_pollfd_hook;
     int count;
 
     if (hooks_count[HOOK_TYPE_FD] == hook_fd_pollfd_count)
@@ -84,6 +333,11 @@ hook_fd_realloc_pollfd ()
             free (hook_fd_pollfd);
             hook_fd_pollfd = NULL;
         }
+        if (hook_fd_pollfd_hook)
+        {
+            free (hook_fd_pollfd_hook);
+            hook_fd_pollfd_hook = NULL;
+        }
     }
     else
     {
@@ -92,6 +346,11 @@ hook_fd_realloc_pollfd ()
         if (!ptr_pollfd)
             return;
         hook_fd_pollfd = ptr_pollfd;
+        ptr_pollfd_hook = realloc (hook_fd_pollfd_hook,
+                                   count * sizeof (struct t_hook *));
+        if (!ptr_pollfd_hook)
+            return;
+        hook_fd_pollfd_hook = ptr_pollfd_hook;
     }
 
     hook_fd_pollfd_count = count;
@@ -104,14 +363,25 @@ hook_fd_realloc_pollfd ()
 void
 hook_fd_add_cb (struct t_hook *hook)
 {
+    hook_fd_realloc_pollfd ();
+
+#ifdef HAVE_SYS_EPOLL_H
+    /* epoll_init adds all hooks, including this one */
+    if (hook_fd_epoll >= 0)
+        hook_fd_epoll_add (hook);
+    else
+        (void) hook_fd_epoll_init ();
+#else
     /* make C compiler happy */
     (void) hook;
-
-    hook_fd_realloc_pollfd ();
+#endif /* HAVE_SYS_EPOLL_H */
 }
 
 /*
  * Callback called when a fd hook is removed from the list of hooks.
+ *
+ * Note: the fd has already been removed from the epoll interest set by
+ * function hook_fd_free_data.
  */
 
 void
@@ -121,6 +391,19 @@ hook_fd_remove_cb (struct t_hook *hook)
     (void) hook;
 
     hook_fd_realloc_pollfd ();
+
+    if (hooks_count[HOOK_TYPE_FD] == 0)
+    {
+#ifdef HAVE_SYS_EPOLL_H
+        hook_fd_epoll_end (0);
+#endif /* HAVE_SYS_EPOLL_H */
+        if (hook_fd_table)
+        {
+            free (hook_fd_table);
+            hook_fd_table = NULL;
+        }
+        hook_fd_table_size = 0;
+    }
 }
 
 /*
@@ -152,6 +435,13 @@ hook_fd (struct t_weechat_plugin *plugin, int fd, int flag_read,
         return NULL;
     }
 
+    if (!hook_fd_table_set (fd, new_hook))
+    {
+        free (new_hook_fd);
+        free (new_hook);
+        return NULL;
+    }
+
     hook_init_data (new_hook, plugin, HOOK_TYPE_FD, HOOK_PRIORITY_DEFAULT,
                     callback_pointer, callback_data);
 
@@ -160,6 +450,8 @@ hook_fd (struct t_weechat_plugin *plugin, int fd, int flag_read,
     new_hook_fd->fd = fd;
     new_hook_fd->flags = 0;
     new_hook_fd->error = 0;
+    new_hook_fd->serial = hook_fd_serial++;
+    new_hook_fd->always_ready = 0;
     if (flag_read)
         new_hook_fd->flags |= HOOK_FD_FLAG_READ;
     if (flag_write)
@@ -173,19 +465,44 @@ hook_fd (struct t_weechat_plugin *plugin, int fd, int flag_read,
 }
 
 /*
- * Executes fd hooks:
- * - poll() on fie descriptors
- * - call of hook fd callbacks if needed.
+ * Returns timeout to wait for events on file descriptors (in milliseconds).
+ */
+
+int
+hook_fd_get_timeout ()
+{
+    if (hook_process_pending)
+        return 0;
+
+    return hook_timer_get_time_to_next ();
+}
+
+/*
+ * Calls the callback of a fd hook.
  */
 
 void
-hook_fd_exec ()
+hook_fd_run_callback (struct t_hook *hook)
 {
-    int i, num_fd, timeout, ready, found;
-    struct t_hook *ptr_hook, *next_hook;
+    hook->running = 1;
+    (void) (HOOK_FD(hook, callback)) (
+        hook->callback_pointer,
+        hook->callback_data,
+        HOOK_FD(hook, fd));
+    hook->running = 0;
+}
 
-    if (!weechat_hooks[HOOK_TYPE_FD])
-        return;
+/*
+ * Executes fd hooks with poll():
+ * - poll() on file descriptors
+ * - call of hook fd callbacks if needed.
+ */
+
+void
+hook_fd_exec_poll ()
+{
+    int i, num_fd, ready;
+    struct t_hook *ptr_hook;
 
     /* build an array of "struct pollfd" for poll() */
     num_fd = 0;
@@ -195,22 +512,9 @@ hook_fd_exec ()
         if (!ptr_hook->deleted)
         {
             /* skip invalid file descriptors */
-            if ((fcntl (HOOK_FD(ptr_hook,fd), F_GETFD) == -1)
-                && (errno == EBADF))
-            {
-                if (HOOK_FD(ptr_hook, error) == 0)
-                {
-                    HOOK_FD(ptr_hook, error) = errno;
-                    gui_chat_printf (NULL,
-                                     _("%sError: bad file descriptor (%d) "
-                                       "used in hook_fd"),
-                                     gui_chat_prefix[GUI_CHAT_PREFIX_ERROR],
-                                     HOOK_FD(ptr_hook, fd));
-                }
-            }
-            else
+            if (hook_fd_check_valid (ptr_hook))
             {
-                if (num_fd > hook_fd_pollfd_count)
+                if (num_fd >= hook_fd_pollfd_count)
                     break;
 
                 hook_fd_pollfd[num_fd].fd = HOOK_FD(ptr_hook, fd);
@@ -220,6 +524,7 @@ hook_fd_exec ()
                     hook_fd_pollfd[num_fd].events |= POLLIN;
                 if (HOOK_FD(ptr_hook, flags) & HOOK_FD_FLAG_WRITE)
                     hook_fd_pollfd[num_fd].events |= POLLOUT;
+                hook_fd_pollfd_hook[num_fd] = ptr_hook;
 
                 num_fd++;
             }
@@ -227,49 +532,147 @@ hook_fd_exec ()
     }
 
     /* perform the poll() */
-    timeout = hook_timer_get_time_to_next ();
-    if (hook_process_pending)
-        timeout = 0;
-    ready = poll (hook_fd_pollfd, num_fd, timeout);
+    ready = poll (hook_fd_pollfd, num_fd, hook_fd_get_timeout ());
     if (ready <= 0)
         return;
 
     /* execute callbacks for file descriptors with activity */
     hook_exec_start ();
 
-    ptr_hook = weechat_hooks[HOOK_TYPE_FD];
-    while (ptr_hook)
+    for (i = 0; i < num_fd; i++)
     {
-        next_hook = ptr_hook->next_hook;
-
-        if (!ptr_hook->deleted
+        /* hook is not freed before hook_exec_end, only marked as deleted */
+        ptr_hook = hook_fd_pollfd_hook[i];
+        if (hook_fd_pollfd[i].revents
+            && !ptr_hook->deleted
             && !ptr_hook->running)
         {
-            found = 0;
-            for (i = 0; i < num_fd; i++)
-            {
-                if (hook_fd_pollfd[i].fd == HOOK_FD(ptr_hook, fd)
-                    && hook_fd_pollfd[i].revents)
-                {
-                    found = 1;
-                    break;
-                }
-            }
-            if (found)
+            hook_fd_run_callback (ptr_hook);
+        }
+    }
+
+    hook_exec_end ();
+}
+
+#ifdef HAVE_SYS_EPOLL_H
+
+/*
+ * Executes fd hooks with epoll:
+ * - epoll_wait() on the interest set (kept up to date when fd hooks are
+ *   added/removed)
+ * - call of hook fd callbacks for file descriptors with activity.
+ */
+
+void
+hook_fd_exec_epoll ()
+{
+    int i, ready, timeout, fd, stale;
+    unsigned int serial;
+    struct epoll_event *ptr_events;
+    struct t_hook *ptr_hook, *next_hook;
+
+    if (hook_fd_epoll_events_size != hooks_count[HOOK_TYPE_FD])
+    {
+        ptr_events = realloc (hook_fd_epoll_events,
+                              hooks_count[HOOK_TYPE_FD] *
+                              sizeof (hook_fd_epoll_events[0]));
+        if (!ptr_events)
+            return;
+        hook_fd_epoll_events = ptr_events;
+        hook_fd_epoll_events_size = hooks_count[HOOK_TYPE_FD];
+    }
+
+    timeout = (hook_fd_always_ready_count > 0) ? 0 : hook_fd_get_timeout ();
+    ready = epoll_wait (hook_fd_epoll, hook_fd_epoll_events,
+                        hook_fd_epoll_events_size, timeout);
+    if (ready < 0)
+        ready = 0;
+    if ((ready == 0) && (hook_fd_always_ready_count == 0))
+        return;
+
+    /* execute callbacks for file descriptors with activity */
+    hook_exec_start ();
+
+    hook_fd_epoll_removed = 0;
+    stale = 0;
+
+    for (i = 0; i < ready; i++)
+    {
+        fd = (int)(hook_fd_epoll_events[i].data.u64 & 0xFFFFFFFF);
+        serial = (unsigned int)(hook_fd_epoll_events[i].data.u64 >> 32);
+        ptr_hook = hook_fd_search (fd);
+        if (!ptr_hook || (HOOK_FD(ptr_hook, serial) != serial))
+        {
+            /*
+             * no hook for this event: if no hook was removed by a callback
+             * in this loop, this is an old registration that can not be
+             * removed any more (fd closed before unhook, while a child
+             * process still has it open)
+             */
+            if (!hook_fd_epoll_removed)
+                stale = 1;
+            continue;
+        }
+        if ((hook_fd_epoll_events[i].events & EPOLLERR)
+            && !hook_fd_check_valid (ptr_hook))
+        {
+            stale = 1;
+            continue;
+        }
+        if (!ptr_hook->running)
+            hook_fd_run_callback (ptr_hook);
+    }
+
+    if (hook_fd_always_ready_count > 0)
+    {
+        ptr_hook = weechat_hooks[HOOK_TYPE_FD];
+        while (ptr_hook)
+        {
+            next_hook = ptr_hook->next_hook;
+            if (!ptr_hook->deleted
+                && !ptr_hook->running
+                && HOOK_FD(ptr_hook, always_ready))
             {
-                ptr_hook->running = 1;
-                (void) (HOOK_FD(ptr_hook, callback)) (
-                    ptr_hook->callback_pointer,
-                    ptr_hook->callback_data,
-                    HOOK_FD(ptr_hook, fd));
-                ptr_hook->running = 0;
+                hook_fd_run_callback (ptr_hook);
             }
+            ptr_hook = next_hook;
         }
-
-        ptr_hook = next_hook;
     }
 
     hook_exec_end ();
+
+    /* rebuild the interest set from scratch to drop old registrations */
+    if (stale)
+    {
+        hook_fd_epoll_end (0);
+        (void) hook_fd_epoll_init ();
+    }
+}
+
+#endif /* HAVE_SYS_EPOLL_H */
+
+/*
+ * Executes fd hooks:
+ * - wait for events on file descriptors (with epoll if available,
+ *   otherwise poll())
+ * - call of hook fd callbacks if needed.
+ */
+
+void
+hook_fd_exec ()
+{
+    if (!weechat_hooks[HOOK_TYPE_FD])
+        return;
+
+#ifdef HAVE_SYS_EPOLL_H
+    if ((hook_fd_epoll >= 0) || hook_fd_epoll_init ())
+    {
+        hook_fd_exec_epoll ();
+        return;
+    }
+#endif /* HAVE_SYS_EPOLL_H */
+
+    hook_fd_exec_poll ();
 }
 
 /*
@@ -282,6 +685,14 @@ hook_fd_free_data (struct t_hook *hook)
     if (!hook || !hook->hook_data)
         return;
 
+    if (hook_fd_search (HOOK_FD(hook, fd)) == hook)
+        (void) hook_fd_table_set (HOOK_FD(hook, fd), NULL);
+
+#ifdef HAVE_SYS_EPOLL_H
+    if (hook_fd_epoll >= 0)
+        hook_fd_epoll_remove (hook);
+#endif /* HAVE_SYS_EPOLL_H */
+
     free (hook->hook_data);
     hook->hook_data = NULL;
 }
@@ -328,4 +739,6 @@ hook_fd_print_log (struct t_hook *hook)
     log_printf ("    fd. . . . . . . . . . : %d", HOOK_FD(hook, fd));
     log_printf ("    flags . . . . . . . . : %d", HOOK_FD(hook, flags));
     log_printf ("    error . . . . . . . . : %d", HOOK_FD(hook, error));
+    log_printf ("    serial. . . . . . . . : %u", HOOK_FD(hook, serial));
+    log_printf ("    always_ready. . . . . : %d", HOOK_FD(hook, always_ready));
 }
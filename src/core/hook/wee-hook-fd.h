@@ -39,6 +39,10 @@ struct t_hook_fd
     int flags;                         /* fd flags (read,write,..)          */
     int error;                         /* contains errno if error occurred  */
                                        /* with fd                           */
+    unsigned int serial;               /* unique id, to detect fd reuse     */
+    int always_ready;                  /* 1 if fd can not be watched by     */
+                                       /* epoll (regular file): it is then  */
+                                       /* considered as always ready        */
 };
 
 extern void hook_fd_add_cb (struct t_hook *hook);
@@ -34,6 +34,52 @@
 #include "../../plugins/plugin.h"
 
 
+struct t_hook_index *hook_hsignal_index = NULL; /* hsignal hooks by name    */
+
+
+/*
+ * Returns the signal of a hsignal hook (used by the index of hooks).
+ */
+
+const char *
+hook_hsignal_get_name_cb (struct t_hook *hook)
+{
+    return HOOK_HSIGNAL(hook, signal);
+}
+
+/*
+ * Callback called when a hsignal hook is added in the list of hooks.
+ */
+
+void
+hook_hsignal_add_cb (struct t_hook *hook)
+{
+    if (!hook_hsignal_index)
+        hook_hsignal_index = hook_index_new (&hook_hsignal_get_name_cb);
+
+    hook_index_add (hook_hsignal_index, hook);
+}
+
+/*
+ * Callback called when a hsignal hook is removed from the list of hooks.
+ *
+ * Note: the hook has already been removed from the index by function
+ * hook_hsignal_free_data.
+ */
+
+void
+hook_hsignal_remove_cb (struct t_hook *hook)
+{
+    /* make C compiler happy */
+    (void) hook;
+
+    if ((hooks_count[HOOK_TYPE_HSIGNAL] == 0) && hook_hsignal_index)
+    {
+        hook_index_free (hook_hsignal_index);
+        hook_hsignal_index = NULL;
+    }
+}
+
 /*
  * Hooks a hsignal (signal with hashtable).
  *
@@ -84,21 +130,30 @@ hook_hsignal (struct t_weechat_plugin *plugin, const char *signal,
 int
 hook_hsignal_send (const char *signal, struct t_hashtable *hashtable)
 {
-    struct t_hook *ptr_hook, *next_hook;
-    int rc;
+    struct t_hook *hooks_static[32], **hooks, *ptr_hook;
+    int rc, i, num_hooks;
 
     rc = WEECHAT_RC_OK;
 
+    if (!signal || !hook_hsignal_index)
+        return rc;
+
+    /* get hooks matching the signal (exact name or mask) */
+    hooks = hook_index_match (hook_hsignal_index, signal,
+                              hooks_static,
+                              sizeof (hooks_static) / sizeof (hooks_static[0]),
+                              &num_hooks);
+    if (!hooks || (num_hooks == 0))
+        return rc;
+
     hook_exec_start ();
 
-    ptr_hook = weechat_hooks[HOOK_TYPE_HSIGNAL];
-    while (ptr_hook)
+    for (i = 0; i < num_hooks; i++)
     {
-        next_hook = ptr_hook->next_hook;
+        /* hook is not freed before hook_exec_end, only marked as deleted */
+        ptr_hook = hooks[i];
 
-        if (!ptr_hook->deleted
-            && !ptr_hook->running
-            && (string_match (signal, HOOK_HSIGNAL(ptr_hook, signal), 0)))
+        if (!ptr_hook->deleted && !ptr_hook->running)
         {
             ptr_hook->running = 1;
             rc = (HOOK_HSIGNAL(ptr_hook, callback))
@@ -111,10 +166,11 @@ hook_hsignal_send (const char *signal, struct t_hashtable *hashtable)
             if (rc == WEECHAT_RC_OK_EAT)
                 break;
         }
-
-        ptr_hook = next_hook;
     }
 
+    if (hooks != hooks_static)
+        free (hooks);
+
     hook_exec_end ();
 
     return rc;
@@ -130,6 +186,8 @@ hook_hsignal_free_data (struct t_hook *hook)
     if (!hook || !hook->hook_data)
         return;
 
+    hook_index_remove (hook_hsignal_index, hook);
+
     if (HOOK_HSIGNAL(hook, signal))
     {
         free (HOOK_HSIGNAL(hook, signal));
@@ -36,6 +36,8 @@ struct t_hook_hsignal
                                        /* with "*", "*" == any signal)      */
 };
 
+extern void hook_hsignal_add_cb (struct t_hook *hook);
+extern void hook_hsignal_remove_cb (struct t_hook *hook);
 extern struct t_hook *hook_hsignal (struct t_weechat_plugin *plugin,
                                     const char *signal,
                                     t_hook_callback_hsignal *callback,
@@ -28,11 +28,320 @@
 
 #include "../weechat.h"
 #include "../wee-hook.h"
+#include "../wee-arraylist.h"
+#include "../wee-hashtable.h"
 #include "../wee-infolist.h"
 #include "../wee-log.h"
 #include "../wee-string.h"
 #include "../../gui/gui-color.h"
 #include "../../gui/gui-line.h"
+#include "../../plugins/plugin.h"
+
+
+struct t_hook_print_list *hook_print_all_buffers = NULL; /* hooks for all   */
+                                                         /* buffers         */
+struct t_hashtable *hook_print_buffers = NULL; /* buffer -> hooks (list)    */
+
+
+/*
+ * Frees a list of print hooks.
+ */
+
+void
+hook_print_list_free (struct t_hook_print_list *list)
+{
+    if (!list)
+        return;
+
+    if (list->hooks)
+        arraylist_free (list->hooks);
+    if (list->tags)
+        hashtable_free (list->tags);
+
+    free (list);
+}
+
+/*
+ * Frees a list of print hooks in hashtable hook_print_buffers.
+ */
+
+void
+hook_print_buffers_free_value_cb (struct t_hashtable *hashtable,
+                                  const void *key, void *value)
+{
+    /* make C compiler happy */
+    (void) hashtable;
+    (void) key;
+
+    hook_print_list_free ((struct t_hook_print_list *)value);
+}
+
+/*
+ * Creates a new list of print hooks.
+ *
+ * Returns pointer to new list, NULL if error.
+ */
+
+struct t_hook_print_list *
+hook_print_list_new ()
+{
+    struct t_hook_print_list *new_list;
+
+    new_list = malloc (sizeof (*new_list));
+    if (!new_list)
+        return NULL;
+
+    new_list->hooks = arraylist_new (8, 1, 0,
+                                     &hook_index_cmp_cb, NULL, NULL, NULL);
+    new_list->tags = hashtable_new (32,
+                                    WEECHAT_HASHTABLE_STRING,
+                                    WEECHAT_HASHTABLE_POINTER,
+                                    &hook_index_hash_key_cb,
+                                    &hook_index_keycmp_cb);
+    if (!new_list->hooks || !new_list->tags)
+    {
+        hook_print_list_free (new_list);
+        return NULL;
+    }
+    new_list->tags->callback_free_value = &hook_index_free_value_cb;
+
+    return new_list;
+}
+
+/*
+ * Returns the tag used to index a group of tags (tags that must all be in
+ * the line): the first tag which is not negated and without wildcard.
+ *
+ * Returns NULL if there is no such tag in the group (the hook can then not
+ * be indexed by tag).
+ */
+
+const char *
+hook_print_get_index_tag (char **tags)
+{
+    int i;
+
+    for (i = 0; tags[i]; i++)
+    {
+        if (tags[i][0] && (tags[i][0] != '!')
+            && !hook_index_name_is_mask (tags[i]))
+        {
+            return tags[i];
+        }
+    }
+
+    return NULL;
+}
+
+/*
+ * Checks if a print hook can be indexed by tags: each group of tags must
+ * have a tag which is not negated and without wildcard.
+ *
+ * Returns:
+ *   1: hook can be indexed by tags
+ *   0: hook must be checked for all lines
+ */
+
+int
+hook_print_has_index_tags (struct t_hook *hook)
+{
+    int i;
+
+    if (!HOOK_PRINT(hook, tags_array))
+        return 0;
+
+    for (i = 0; i < HOOK_PRINT(hook, tags_count); i++)
+    {
+        if (!hook_print_get_index_tag (HOOK_PRINT(hook, tags_array)[i]))
+            return 0;
+    }
+
+    return 1;
+}
+
+/*
+ * Adds a print hook in a list.
+ */
+
+void
+hook_print_list_add (struct t_hook_print_list *list, struct t_hook *hook)
+{
+    struct t_arraylist *ptr_hooks;
+    const char *ptr_tag;
+    int i;
+
+    if (!hook_print_has_index_tags (hook))
+    {
+        arraylist_add (list->hooks, hook);
+        return;
+    }
+
+    for (i = 0; i < HOOK_PRINT(hook, tags_count); i++)
+    {
+        ptr_tag = hook_print_get_index_tag (HOOK_PRINT(hook, tags_array)[i]);
+        ptr_hooks = hashtable_get (list->tags, ptr_tag);
+        if (!ptr_hooks)
+        {
+            ptr_hooks = arraylist_new (4, 1, 0,
+                                       &hook_index_cmp_cb, NULL, NULL, NULL);
+            if (!ptr_hooks)
+                continue;
+            if (!hashtable_set (list->tags, ptr_tag, ptr_hooks))
+            {
+                arraylist_free (ptr_hooks);
+                continue;
+            }
+        }
+        /* no duplicates: hook is added only once for a tag */
+        arraylist_add (ptr_hooks, hook);
+    }
+}
+
+/*
+ * Removes a print hook from a list.
+ */
+
+void
+hook_print_list_remove (struct t_hook_print_list *list, struct t_hook *hook)
+{
+    struct t_arraylist *ptr_hooks;
+    const char *ptr_tag;
+    int i, index;
+
+    if (!hook_print_has_index_tags (hook))
+    {
+        if (arraylist_search (list->hooks, hook, &index, NULL))
+            arraylist_remove (list->hooks, index);
+        return;
+    }
+
+    for (i = 0; i < HOOK_PRINT(hook, tags_count); i++)
+    {
+        ptr_tag = hook_print_get_index_tag (HOOK_PRINT(hook, tags_array)[i]);
+        ptr_hooks = hashtable_get (list->tags, ptr_tag);
+        if (!ptr_hooks)
+            continue;
+        if (arraylist_search (ptr_hooks, hook, &index, NULL))
+            arraylist_remove (ptr_hooks, index);
+        if (arraylist_size (ptr_hooks) == 0)
+            hashtable_remove (list->tags, ptr_tag);
+    }
+}
+
+/*
+ * Checks if a list of print hooks is empty.
+ *
+ * Returns:
+ *   1: list is empty
+ *   0: list has hooks
+ */
+
+int
+hook_print_list_is_empty (struct t_hook_print_list *list)
+{
+    return ((arraylist_size (list->hooks) == 0)
+            && (list->tags->items_count == 0)) ? 1 : 0;
+}
+
+/*
+ * Callback called when a print hook is added in the list of hooks.
+ */
+
+void
+hook_print_add_cb (struct t_hook *hook)
+{
+    struct t_hook_print_list *ptr_list;
+
+    if (!HOOK_PRINT(hook, buffer))
+    {
+        if (!hook_print_all_buffers)
+            hook_print_all_buffers = hook_print_list_new ();
+        if (hook_print_all_buffers)
+            hook_print_list_add (hook_print_all_buffers, hook);
+        return;
+    }
+
+    if (!hook_print_buffers)
+    {
+        hook_print_buffers = hashtable_new (32,
+                                            WEECHAT_HASHTABLE_POINTER,
+                                            WEECHAT_HASHTABLE_POINTER,
+                                            NULL, NULL);
+        if (!hook_print_buffers)
+            return;
+        hook_print_buffers->callback_free_value = &hook_print_buffers_free_value_cb;
+    }
+
+    ptr_list = hashtable_get (hook_print_buffers, HOOK_PRINT(hook, buffer));
+    if (!ptr_list)
+    {
+        ptr_list = hook_print_list_new ();
+        if (!ptr_list)
+            return;
+        if (!hashtable_set (hook_print_buffers, HOOK_PRINT(hook, buffer),
+                            ptr_list))
+        {
+            hook_print_list_free (ptr_list);
+            return;
+        }
+    }
+    hook_print_list_add (ptr_list, hook);
+}
+
+/*
+ * Removes a print hook from index (called when hook is unhooked).
+ */
+
+void
+hook_print_index_remove (struct t_hook *hook)
+{
+    struct t_hook_print_list *ptr_list;
+
+    if (!HOOK_PRINT(hook, buffer))
+    {
+        if (hook_print_all_buffers)
+            hook_print_list_remove (hook_print_all_buffers, hook);
+        return;
+    }
+
+    if (!hook_print_buffers)
+        return;
+
+    ptr_list = hashtable_get (hook_print_buffers, HOOK_PRINT(hook, buffer));
+    if (!ptr_list)
+        return;
+    hook_print_list_remove (ptr_list, hook);
+    if (hook_print_list_is_empty (ptr_list))
+        hashtable_remove (hook_print_buffers, HOOK_PRINT(hook, buffer));
+}
+
+/*
+ * Callback called when a print hook is removed from the list of hooks.
+ *
+ * Note: the hook has already been removed from index by function
+ * hook_print_free_data.
+ */
+
+void
+hook_print_remove_cb (struct t_hook *hook)
+{
+    /* make C compiler happy */
+    (void) hook;
+
+    if (hooks_count[HOOK_TYPE_PRINT] == 0)
+    {
+        if (hook_print_all_buffers)
+        {
+            hook_print_list_free (hook_print_all_buffers);
+            hook_print_all_buffers = NULL;
+        }
+        if (hook_print_buffers)
+        {
+            hashtable_free (hook_print_buffers);
+            hook_print_buffers = NULL;
+        }
+    }
+}
 
 
 /*
@@ -80,15 +389,117 @@ hook_print (struct t_weechat_plugin *plugin, struct t_gui_buffer *buffer,
     return new_hook;
 }
 
+/*
+ * Adds hooks of a list (sorted) in array of hooks to check for a line.
+ *
+ * Returns pointer to array of hooks (can be reallocated), NULL if error.
+ */
+
+struct t_hook **
+hook_print_add_candidates (struct t_hook **hooks, struct t_hook **hooks_static,
+                           int *size, int *num_hooks,
+                           struct t_arraylist *list)
+{
+    struct t_hook **new_hooks;
+    int i, count;
+
+    count = arraylist_size (list);
+    if (count == 0)
+        return hooks;
+
+    if (*num_hooks + count > *size)
+    {
+        while (*num_hooks + count > *size)
+        {
+            *size *= 2;
+        }
+        new_hooks = (hooks == hooks_static) ?
+            malloc (*size * sizeof (*new_hooks)) :
+            realloc (hooks, *size * sizeof (*new_hooks));
+        if (!new_hooks)
+        {
+            if (hooks != hooks_static)
+                free (hooks);
+            return NULL;
+        }
+        if (hooks == hooks_static)
+            memcpy (new_hooks, hooks_static, *num_hooks * sizeof (*new_hooks));
+        hooks = new_hooks;
+    }
+
+    for (i = 0; i < count; i++)
+    {
+        hooks[(*num_hooks)++] = (struct t_hook *)arraylist_get (list, i);
+    }
+
+    return hooks;
+}
+
+/*
+ * Adds hooks of a list of print hooks that may match a line: hooks without
+ * index tags and hooks indexed by one of the line tags.
+ *
+ * Returns pointer to array of hooks (can be reallocated), NULL if error.
+ */
+
+struct t_hook **
+hook_print_add_candidates_list (struct t_hook **hooks,
+                                struct t_hook **hooks_static,
+                                int *size, int *num_hooks,
+                                struct t_hook_print_list *list,
+                                struct t_gui_line *line)
+{
+    struct t_arraylist *ptr_hooks;
+    int i;
+
+    if (!list || !hooks)
+        return hooks;
+
+    hooks = hook_print_add_candidates (hooks, hooks_static, size, num_hooks,
+                                       list->hooks);
+
+    if (list->tags->items_count == 0)
+        return hooks;
+
+    for (i = 0; hooks && (i < line->data->tags_count); i++)
+    {
+        ptr_hooks = hashtable_get (list->tags, line->data->tags_array[i]);
+        if (ptr_hooks)
+        {
+            hooks = hook_print_add_candidates (hooks, hooks_static, size,
+                                               num_hooks, ptr_hooks);
+        }
+    }
+
+    return hooks;
+}
+
+/*
+ * Compares two print hooks (for qsort): same order as the list of hooks.
+ */
+
+int
+hook_print_cmp_hooks_cb (const void *hook1, const void *hook2)
+{
+    return hook_index_cmp_cb (NULL, NULL,
+                              *((struct t_hook **)hook1),
+                              *((struct t_hook **)hook2));
+}
+
 /*
  * Executes a print hook.
+ *
+ * Only hooks that may match the line are checked (hooks for all buffers
+ * and for this buffer, filtered by tags using the index), and colors are
+ * decoded only if a hook needs it (to strip colors or to search a message).
  */
 
 void
 hook_print_exec (struct t_gui_buffer *buffer, struct t_gui_line *line)
 {
-    struct t_hook *ptr_hook, *next_hook;
+    struct t_hook *hooks_static[32], **hooks, *ptr_hook;
     char *prefix_no_color, *message_no_color;
+    int i, size, num_hooks, colors_decoded;
 
     if (!weechat_hooks[HOOK_TYPE_PRINT])
         return;
@@ -96,53 +507,96 @@ hook_print_exec (struct t_gui_buffer *buffer, struct t_gui_line *line)
     if (!line->data->message || !line->data->message[0])
         return;
 
-    prefix_no_color = (line->data->prefix) ?
-        gui_color_decode (line->data->prefix, NULL) : NULL;
-
-    message_no_color = gui_color_decode (line->data->message, NULL);
-    if (!message_no_color)
+    /* get hooks that may match the line */
+    hooks = hooks_static;
+    size = sizeof (hooks_static) / sizeof (hooks_static[0]);
+    num_hooks = 0;
+    hooks = hook_print_add_candidates_list (hooks, hooks_static,
+                                            &size, &num_hooks,
+                                            hook_print_all_buffers, line);
+    if (hooks && hook_print_buffers)
     {
-        if (prefix_no_color)
-            free (prefix_no_color);
+        hooks = hook_print_add_candidates_list (
+            hooks, hooks_static, &size, &num_hooks,
+            hashtable_get (hook_print_buffers, buffer),
+            line);
+    }
+    if (!hooks)
         return;
+    if (num_hooks == 0)
+        goto end;
+
+    /* sort hooks like in list and remove duplicates (hooks with many tags) */
+    if (num_hooks > 1)
+    {
+        qsort (hooks, num_hooks, sizeof (hooks[0]), &hook_print_cmp_hooks_cb);
+        size = 1;
+        for (i = 1; i < num_hooks; i++)
+        {
+            if (hooks[i] != hooks[size - 1])
+                hooks[size++] = hooks[i];
+        }
+        num_hooks = size;
     }
 
+    prefix_no_color = NULL;
+    message_no_color = NULL;
+    colors_decoded = 0;
+
     hook_exec_start ();
 
-    ptr_hook = weechat_hooks[HOOK_TYPE_PRINT];
-    while (ptr_hook)
-    {
-        next_hook = ptr_hook->next_hook;
-
-        if (!ptr_hook->deleted
-            && !ptr_hook->running
-            && (!HOOK_PRINT(ptr_hook, buffer)
-                || (buffer == HOOK_PRINT(ptr_hook, buffer)))
-            && (!HOOK_PRINT(ptr_hook, message)
-                || !HOOK_PRINT(ptr_hook, message)[0]
-                || string_strcasestr (prefix_no_color, HOOK_PRINT(ptr_hook, message))
-                || string_strcasestr (message_no_color, HOOK_PRINT(ptr_hook, message)))
-            && (!HOOK_PRINT(ptr_hook, tags_array)
-                || gui_line_match_tags (line->data,
-                                        HOOK_PRINT(ptr_hook, tags_count),
-                                        HOOK_PRINT(ptr_hook, tags_array))))
+    for (i = 0; i < num_hooks; i++)
+    {
+        /* hook is not freed before hook_exec_end, only marked as deleted */
+        ptr_hook = hooks[i];
+
+        if (ptr_hook->deleted
+            || ptr_hook->running
+            || (HOOK_PRINT(ptr_hook, tags_array)
+                && !gui_line_match_tags (line->data,
+                                         HOOK_PRINT(ptr_hook, tags_count),
+                                         HOOK_PRINT(ptr_hook, tags_array))))
         {
-            /* run callback */
-            ptr_hook->running = 1;
-            (void) (HOOK_PRINT(ptr_hook, callback))
-                (ptr_hook->callback_pointer,
-                 ptr_hook->callback_data,
-                 buffer,
-                 line->data->date,
-                 line->data->tags_count,
-                 (const char **)line->data->tags_array,
-                 (int)line->data->displayed, (int)line->data->highlight,
-                 (HOOK_PRINT(ptr_hook, strip_colors)) ? prefix_no_color : line->data->prefix,
-                 (HOOK_PRINT(ptr_hook, strip_colors)) ? message_no_color : line->data->message);
-            ptr_hook->running = 0;
+            continue;
         }
 
-        ptr_hook = next_hook;
+        /* decode colors (only once, and only if needed by hook) */
+        if (!colors_decoded
+            && (HOOK_PRINT(ptr_hook, strip_colors)
+                || (HOOK_PRINT(ptr_hook, message)
+                    && HOOK_PRINT(ptr_hook, message)[0])))
+        {
+            prefix_no_color = (line->data->prefix) ?
+                gui_color_decode (line->data->prefix, NULL) : NULL;
+            message_no_color = gui_color_decode (line->data->message, NULL);
+            if (!message_no_color)
+                break;
+            colors_decoded = 1;
+        }
+
+        if (HOOK_PRINT(ptr_hook, message)
+            && HOOK_PRINT(ptr_hook, message)[0]
+            && !string_strcasestr (prefix_no_color,
+                                   HOOK_PRINT(ptr_hook, message))
+            && !string_strcasestr (message_no_color,
+                                   HOOK_PRINT(ptr_hook, message)))
+        {
+            continue;
+        }
+
+        /* run callback */
+        ptr_hook->running = 1;
+        (void) (HOOK_PRINT(ptr_hook, callback))
+            (ptr_hook->callback_pointer,
+             ptr_hook->callback_data,
+             buffer,
+             line->data->date,
+             line->data->tags_count,
+             (const char **)line->data->tags_array,
+             (int)line->data->displayed, (int)line->data->highlight,
+             (HOOK_PRINT(ptr_hook, strip_colors)) ? prefix_no_color : line->data->prefix,
+             (HOOK_PRINT(ptr_hook, strip_colors)) ? message_no_color : line->data->message);
+        ptr_hook->running = 0;
     }
 
     if (prefix_no_color)
@@ -151,6 +605,10 @@ hook_print_exec (struct t_gui_buffer *buffer, struct t_gui_line *line)
         free (message_no_color);
 
     hook_exec_end ();
+
+end:
+    if (hooks != hooks_static)
+        free (hooks);
 }
 
 /*
@@ -163,6 +621,8 @@ hook_print_free_data (struct t_hook *hook)
     if (!hook || !hook->hook_data)
         return;
 
+    hook_print_index_remove (hook);
+
     if (HOOK_PRINT(hook, tags_array))
     {
         string_free_split_tags (HOOK_PRINT(hook, tags_array));
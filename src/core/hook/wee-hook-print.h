@@ -24,6 +24,8 @@
 
 struct t_weechat_plugin;
 struct t_infolist_item;
+struct t_arraylist;
+struct t_hashtable;
 struct t_gui_buffer;
 struct t_gui_line;
 
@@ -46,6 +48,20 @@ struct t_hook_print
     int strip_colors;                  /* strip colors in msg for callback? */
 };
 
+/*
+ * print hooks of a buffer (or all buffers): hooks with tags are indexed by
+ * one tag of each group of tags (a line can match only if it has one of
+ * these tags), other hooks are checked for all lines
+ */
+
+struct t_hook_print_list
+{
+    struct t_arraylist *hooks;         /* hooks checked for all lines       */
+    struct t_hashtable *tags;          /* tag -> hooks (arraylist)          */
+};
+
+extern void hook_print_add_cb (struct t_hook *hook);
+extern void hook_print_remove_cb (struct t_hook *hook);
 extern struct t_hook *hook_print (struct t_weechat_plugin *plugin,
                                   struct t_gui_buffer *buffer,
                                   const char *tags, const char *message,
@@ -122,6 +122,7 @@ hook_process_hashtable (struct t_weechat_plugin *plugin,
     new_hook_process->buffer_size[HOOK_PROCESS_STDOUT] = 0;
     new_hook_process->buffer_size[HOOK_PROCESS_STDERR] = 0;
     new_hook_process->buffer_flush = HOOK_PROCESS_BUFFER_SIZE;
+    new_hook_process->url_transfer = NULL;
     if (options)
     {
         ptr_value = hashtable_get (options, "buffer_flush");
@@ -383,6 +384,10 @@ hook_process_send_buffers (struct t_hook *hook_process, int callback_rc)
          (HOOK_PROCESS(hook_process, buffer_size[HOOK_PROCESS_STDERR]) > 0) ?
          HOOK_PROCESS(hook_process, buffer[HOOK_PROCESS_STDERR]) : NULL);
 
+    /* hook removed by the callback? */
+    if (hook_process->deleted)
+        return;
+
     /* reset size for stdout and stderr */
     HOOK_PROCESS(hook_process, buffer_size[HOOK_PROCESS_STDOUT]) = 0;
     HOOK_PROCESS(hook_process, buffer_size[HOOK_PROCESS_STDERR]) = 0;
@@ -397,7 +402,11 @@ hook_process_add_to_buffer (struct t_hook *hook_process, int index_buffer,
                             const char *buffer, int size)
 {
     if (HOOK_PROCESS(hook_process, buffer_size[index_buffer]) + size > HOOK_PROCESS_BUFFER_SIZE)
+    {
         hook_process_send_buffers (hook_process, WEECHAT_HOOK_PROCESS_RUNNING);
+        if (hook_process->deleted)
+            return;
+    }
 
     memcpy (HOOK_PROCESS(hook_process, buffer[index_buffer]) +
             HOOK_PROCESS(hook_process, buffer_size[index_buffer]),
@@ -581,8 +590,11 @@ hook_process_timer_cb (const void *pointer, void *data, int remaining_calls)
                              HOOK_PROCESS(hook_process, command),
                              ((float)HOOK_PROCESS(hook_process, timeout)) / 1000);
         }
-        kill (HOOK_PROCESS(hook_process, child_pid), SIGKILL);
-        usleep (1000);
+        if (HOOK_PROCESS(hook_process, child_pid) > 0)
+        {
+            kill (HOOK_PROCESS(hook_process, child_pid), SIGKILL);
+            usleep (1000);
+        }
         unhook (hook_process);
     }
     else
@@ -612,6 +624,113 @@ hook_process_timer_cb (const void *pointer, void *data, int remaining_calls)
     return WEECHAT_RC_OK;
 }
 
+/*
+ * Adds data received for an URL (callback called by the URL transfer).
+ */
+
+void
+hook_process_url_write_cb (void *pointer, const char *data, int size)
+{
+    struct t_hook *hook_process;
+    int size_chunk;
+
+    hook_process = (struct t_hook *)pointer;
+
+    if (hook_process->deleted || HOOK_PROCESS(hook_process, detached))
+        return;
+
+    /* add data by chunks, like data read from a child process */
+    while (size > 0)
+    {
+        size_chunk = (size > HOOK_PROCESS_BUFFER_SIZE / 8) ?
+            HOOK_PROCESS_BUFFER_SIZE / 8 : size;
+        hook_process_add_to_buffer (hook_process, HOOK_PROCESS_STDOUT,
+                                    data, size_chunk);
+        if (hook_process->deleted)
+            return;
+        if (HOOK_PROCESS(hook_process, buffer_size[HOOK_PROCESS_STDOUT]) >=
+            HOOK_PROCESS(hook_process, buffer_flush))
+        {
+            hook_process_send_buffers (hook_process,
+                                       WEECHAT_HOOK_PROCESS_RUNNING);
+            if (hook_process->deleted)
+                return;
+        }
+        data += size_chunk;
+        size -= size_chunk;
+    }
+}
+
+/*
+ * Ends download of an URL (callback called by the URL transfer).
+ */
+
+void
+hook_process_url_end_cb (void *pointer, int return_code, const char *error)
+{
+    struct t_hook *hook_process;
+
+    hook_process = (struct t_hook *)pointer;
+
+    if (hook_process->deleted)
+        return;
+
+    if (error && error[0] && !HOOK_PROCESS(hook_process, detached))
+    {
+        hook_process_add_to_buffer (hook_process, HOOK_PROCESS_STDERR,
+                                    error, strlen (error));
+    }
+    hook_process_send_buffers (hook_process, return_code);
+    unhook (hook_process);
+}
+
+/*
+ * Downloads an URL in WeeChat process (without fork), with data sent to the
+ * callback when it is received.
+ */
+
+void
+hook_process_run_url (struct t_hook *hook_process)
+{
+    const char *ptr_url;
+    int rc;
+
+    ptr_url = HOOK_PROCESS(hook_process, command) + 4;
+    while (ptr_url[0] == ' ')
+    {
+        ptr_url++;
+    }
+
+    HOOK_PROCESS(hook_process, url_transfer) = weeurl_transfer_start (
+        ptr_url,
+        HOOK_PROCESS(hook_process, options),
+        &hook_process_url_write_cb,
+        &hook_process_url_end_cb,
+        hook_process,
+        &rc);
+    if (!HOOK_PROCESS(hook_process, url_transfer))
+    {
+        (void) (HOOK_PROCESS(hook_process, callback))
+            (hook_process->callback_pointer,
+             hook_process->callback_data,
+             HOOK_PROCESS(hook_process, command),
+             rc,
+             NULL, NULL);
+        unhook (hook_process);
+        return;
+    }
+
+    if (HOOK_PROCESS(hook_process, timeout) > 0)
+    {
+        HOOK_PROCESS(hook_process, hook_timer) = hook_timer (
+            hook_process->plugin,
+            HOOK_PROCESS(hook_process, timeout), 0, 1,
+            &hook_process_timer_cb,
+            hook_process,
+            NULL);
+    }
+}
+
 /*
  * Executes process command in child, and read data in current process,
  * with fd hook.
@@ -625,6 +744,14 @@ hook_process_run (struct t_hook *hook_process)
     long interval;
     pid_t pid;
 
+    /* download of URL is made in WeeChat process if possible (no fork) */
+    if ((strncmp (HOOK_PROCESS(hook_process, command), "url:", 4) == 0)
+        && weeurl_transfer_available ())
+    {
+        hook_process_run_url (hook_process);
+        return;
+    }
+
     for (i = 0; i < 3; i++)
     {
         pipes[i][0] = -1;
@@ -783,7 +910,8 @@ hook_process_exec ()
 
         if (!ptr_hook->deleted
             && !ptr_hook->running
-            && (HOOK_PROCESS(ptr_hook, child_pid) == 0))
+            && (HOOK_PROCESS(ptr_hook, child_pid) == 0)
+            && !HOOK_PROCESS(ptr_hook, url_transfer))
         {
             ptr_hook->running = 1;
             hook_process_run (ptr_hook);
@@ -808,6 +936,11 @@ hook_process_free_data (struct t_hook *hook)
     if (!hook || !hook->hook_data)
         return;
 
+    if (HOOK_PROCESS(hook, url_transfer))
+    {
+        weeurl_transfer_free (HOOK_PROCESS(hook, url_transfer));
+        HOOK_PROCESS(hook, url_transfer) = NULL;
+    }
     if (HOOK_PROCESS(hook, command))
     {
         free (HOOK_PROCESS(hook, command));
@@ -941,6 +1074,8 @@ hook_process_add_to_infolist (struct t_infolist_item *item,
         return 0;
     if (!infolist_new_var_pointer (item, "hook_timer", HOOK_PROCESS(hook, hook_timer)))
         return 0;
+    if (!infolist_new_var_pointer (item, "url_transfer", HOOK_PROCESS(hook, url_transfer)))
+        return 0;
 
     return 1;
 }
@@ -975,4 +1110,5 @@ hook_process_print_log (struct t_hook *hook)
     log_printf ("    hook_fd[stdout] . . . : 0x%lx", HOOK_PROCESS(hook, hook_fd[HOOK_PROCESS_STDOUT]));
     log_printf ("    hook_fd[stderr] . . . : 0x%lx", HOOK_PROCESS(hook, hook_fd[HOOK_PROCESS_STDERR]));
     log_printf ("    hook_timer. . . . . . : 0x%lx", HOOK_PROCESS(hook, hook_timer));
+    log_printf ("    url_transfer. . . . . : 0x%lx", HOOK_PROCESS(hook, url_transfer));
 }
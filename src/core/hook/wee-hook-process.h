@@ -23,6 +23,7 @@
 struct t_weechat_plugin;
 struct t_infolist_item;
 struct t_hashtable;
+struct t_url_transfer;
 
 #define HOOK_PROCESS(hook, var) (((struct t_hook_process *)hook->hook_data)->var)
 
@@ -52,6 +53,8 @@ struct t_hook_process
     char *buffer[3];                   /* buffers for child stdin/out/err   */
     int buffer_size[3];                /* size of child stdin/out/err       */
     int buffer_flush;                  /* bytes to flush output buffers     */
+    struct t_url_transfer *url_transfer; /* download of URL in WeeChat      */
+                                       /* process (instead of child)        */
 };
 
 extern int hook_process_pending;
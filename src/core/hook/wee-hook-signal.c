@@ -34,6 +34,52 @@
 #include "../../plugins/plugin.h"
 
 
+struct t_hook_index *hook_signal_index = NULL; /* signal hooks by name      */
+
+
+/*
+ * Returns the signal of a signal hook (used by the index of hooks).
+ */
+
+const char *
+hook_signal_get_name_cb (struct t_hook *hook)
+{
+    return HOOK_SIGNAL(hook, signal);
+}
+
+/*
+ * Callback called when a signal hook is added in the list of hooks.
+ */
+
+void
+hook_signal_add_cb (struct t_hook *hook)
+{
+    if (!hook_signal_index)
+        hook_signal_index = hook_index_new (&hook_signal_get_name_cb);
+
+    hook_index_add (hook_signal_index, hook);
+}
+
+/*
+ * Callback called when a signal hook is removed from the list of hooks.
+ *
+ * Note: the hook has already been removed from the index by function
+ * hook_signal_free_data.
+ */
+
+void
+hook_signal_remove_cb (struct t_hook *hook)
+{
+    /* make C compiler happy */
+    (void) hook;
+
+    if ((hooks_count[HOOK_TYPE_SIGNAL] == 0) && hook_signal_index)
+    {
+        hook_index_free (hook_signal_index);
+        hook_signal_index = NULL;
+    }
+}
+
 /*
  * Hooks a signal.
  *
@@ -84,21 +130,30 @@ hook_signal (struct t_weechat_plugin *plugin, const char *signal,
 int
 hook_signal_send (const char *signal, const char *type_data, void *signal_data)
 {
-    struct t_hook *ptr_hook, *next_hook;
-    int rc;
+    struct t_hook *hooks_static[32], **hooks, *ptr_hook;
+    int rc, i, num_hooks;
 
     rc = WEECHAT_RC_OK;
 
+    if (!signal || !hook_signal_index)
+        return rc;
+
+    /* get hooks matching the signal (exact name or mask) */
+    hooks = hook_index_match (hook_signal_index, signal,
+                              hooks_static,
+                              sizeof (hooks_static) / sizeof (hooks_static[0]),
+                              &num_hooks);
+    if (!hooks || (num_hooks == 0))
+        return rc;
+
     hook_exec_start ();
 
-    ptr_hook = weechat_hooks[HOOK_TYPE_SIGNAL];
-    while (ptr_hook)
+    for (i = 0; i < num_hooks; i++)
     {
-        next_hook = ptr_hook->next_hook;
+        /* hook is not freed before hook_exec_end, only marked as deleted */
+        ptr_hook = hooks[i];
 
-        if (!ptr_hook->deleted
-            && !ptr_hook->running
-            && (string_match (signal, HOOK_SIGNAL(ptr_hook, signal), 0)))
+        if (!ptr_hook->deleted && !ptr_hook->running)
         {
             ptr_hook->running = 1;
             rc = (HOOK_SIGNAL(ptr_hook, callback))
@@ -112,10 +167,11 @@ hook_signal_send (const char *signal, const char *type_data, void *signal_data)
             if (rc == WEECHAT_RC_OK_EAT)
                 break;
         }
-
-        ptr_hook = next_hook;
     }
 
+    if (hooks != hooks_static)
+        free (hooks);
+
     hook_exec_end ();
 
     return rc;
@@ -131,6 +187,8 @@ hook_signal_free_data (struct t_hook *hook)
     if (!hook || !hook->hook_data)
         return;
 
+    hook_index_remove (hook_signal_index, hook);
+
     if (HOOK_SIGNAL(hook, signal))
     {
         free (HOOK_SIGNAL(hook, signal));
@@ -36,6 +36,8 @@ struct t_hook_signal
                                        /* with "*", "*" == any signal)      */
 };
 
+extern void hook_signal_add_cb (struct t_hook *hook);
+extern void hook_signal_remove_cb (struct t_hook *hook);
 extern struct t_hook *hook_signal (struct t_weechat_plugin *plugin,
                                    const char *signal,
                                    t_hook_callback_signal *callback,
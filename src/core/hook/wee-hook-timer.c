@@ -36,6 +36,223 @@
 
 time_t hook_last_system_time = 0;      /* used to detect system clock skew  */
 
+struct t_hook **hook_timer_heap = NULL; /* timers sorted by next execution  */
+                                       /* (binary min-heap)                 */
+int hook_timer_heap_count = 0;         /* number of timers in heap          */
+int hook_timer_heap_size = 0;          /* allocated size of heap            */
+struct t_hook **hook_timer_due = NULL; /* timers to run in hook_timer_exec  */
+unsigned long long hook_timer_order = 0; /* order for next timer created    */
+
+
+/*
+ * Compares two timers in heap: first on date of next execution, then on
+ * creation order.
+ *
+ * Returns:
+ *   < 0: timer1 must run before timer2
+ *     0: same timer
+ *   > 0: timer1 must run after timer2
+ */
+
+int
+hook_timer_heap_cmp (struct t_hook *timer1, struct t_hook *timer2)
+{
+    int rc;
+
+    rc = util_timeval_cmp (&HOOK_TIMER(timer1, next_exec),
+                           &HOOK_TIMER(timer2, next_exec));
+    if (rc != 0)
+        return rc;
+
+    if (HOOK_TIMER(timer1, order) < HOOK_TIMER(timer2, order))
+        return -1;
+    return (HOOK_TIMER(timer1, order) > HOOK_TIMER(timer2, order)) ? 1 : 0;
+}
+
+/*
+ * Sets a timer at an index in heap.
+ */
+
+void
+hook_timer_heap_set (int index, struct t_hook *hook)
+{
+    hook_timer_heap[index] = hook;
+    HOOK_TIMER(hook, heap_index) = index;
+}
+
+/*
+ * Moves a timer up in heap, until its parent runs before it.
+ */
+
+void
+hook_timer_heap_sift_up (int index)
+{
+    struct t_hook *ptr_hook;
+    int parent;
+
+    ptr_hook = hook_timer_heap[index];
+    while (index > 0)
+    {
+        parent = (index - 1) / 2;
+        if (hook_timer_heap_cmp (hook_timer_heap[parent], ptr_hook) <= 0)
+            break;
+        hook_timer_heap_set (index, hook_timer_heap[parent]);
+        index = parent;
+    }
+    hook_timer_heap_set (index, ptr_hook);
+}
+
+/*
+ * Moves a timer down in heap, until its children run after it.
+ */
+
+void
+hook_timer_heap_sift_down (int index)
+{
+    struct t_hook *ptr_hook;
+    int child;
+
+    ptr_hook = hook_timer_heap[index];
+    while (1)
+    {
+        child = (2 * index) + 1;
+        if (child >= hook_timer_heap_count)
+            break;
+        if ((child + 1 < hook_timer_heap_count)
+            && (hook_timer_heap_cmp (hook_timer_heap[child + 1],
+                                     hook_timer_heap[child]) < 0))
+        {
+            child++;
+        }
+        if (hook_timer_heap_cmp (ptr_hook, hook_timer_heap[child]) <= 0)
+            break;
+        hook_timer_heap_set (index, hook_timer_heap[child]);
+        index = child;
+    }
+    hook_timer_heap_set (index, ptr_hook);
+}
+
+/*
+ * Reserves room in heap for one more timer.
+ *
+ * Returns:
+ *   1: OK
+ *   0: error (not enough memory)
+ */
+
+int
+hook_timer_heap_grow ()
+{
+    struct t_hook **new_heap, **new_due;
+    int new_size;
+
+    if (hooks_count[HOOK_TYPE_TIMER] < hook_timer_heap_size)
+        return 1;
+
+    new_size = (hook_timer_heap_size > 0) ? hook_timer_heap_size * 2 : 64;
+
+    new_heap = realloc (hook_timer_heap, new_size * sizeof (*new_heap));
+    if (!new_heap)
+        return 0;
+    hook_timer_heap = new_heap;
+
+    new_due = realloc (hook_timer_due, new_size * sizeof (*new_due));
+    if (!new_due)
+        return 0;
+    hook_timer_due = new_due;
+
+    hook_timer_heap_size = new_size;
+
+    return 1;
+}
+
+/*
+ * Adds a timer in heap.
+ *
+ * Room in heap must have been reserved with hook_timer_heap_grow.
+ */
+
+void
+hook_timer_heap_add (struct t_hook *hook)
+{
+    hook_timer_heap_set (hook_timer_heap_count, hook);
+    hook_timer_heap_count++;
+    hook_timer_heap_sift_up (hook_timer_heap_count - 1);
+}
+
+/*
+ * Removes a timer from heap.
+ */
+
+void
+hook_timer_heap_remove (struct t_hook *hook)
+{
+    struct t_hook *ptr_last;
+    int index;
+
+    index = HOOK_TIMER(hook, heap_index);
+    if ((index < 0) || (index >= hook_timer_heap_count))
+        return;
+
+    HOOK_TIMER(hook, heap_index) = -1;
+    hook_timer_heap_count--;
+    if (index == hook_timer_heap_count)
+        return;
+
+    /* move last timer to the free slot, then restore heap order */
+    ptr_last = hook_timer_heap[hook_timer_heap_count];
+    hook_timer_heap_set (index, ptr_last);
+    hook_timer_heap_sift_up (index);
+    if (HOOK_TIMER(ptr_last, heap_index) == index)
+        hook_timer_heap_sift_down (index);
+}
+
+/*
+ * Removes and returns the first timer of heap (next timer to run).
+ */
+
+struct t_hook *
+hook_timer_heap_pop ()
+{
+    struct t_hook *ptr_hook;
+
+    if (hook_timer_heap_count == 0)
+        return NULL;
+
+    ptr_hook = hook_timer_heap[0];
+    hook_timer_heap_remove (ptr_hook);
+
+    return ptr_hook;
+}
+
+/*
+ * Rebuilds the heap with all timers (used when date of next execution of
+ * all timers has changed).
+ */
+
+void
+hook_timer_heap_build ()
+{
+    struct t_hook *ptr_hook;
+    int i;
+
+    hook_timer_heap_count = 0;
+    for (ptr_hook = weechat_hooks[HOOK_TYPE_TIMER]; ptr_hook;
+         ptr_hook = ptr_hook->next_hook)
+    {
+        if (!ptr_hook->deleted && (HOOK_TIMER(ptr_hook, heap_index) >= 0))
+        {
+            hook_timer_heap_set (hook_timer_heap_count, ptr_hook);
+            hook_timer_heap_count++;
+        }
+    }
+
+    for (i = (hook_timer_heap_count / 2) - 1; i >= 0; i--)
+    {
+        hook_timer_heap_sift_down (i);
+    }
+}
+
 
 /*
  * Initializes a timer hook.
@@ -93,6 +310,46 @@ hook_timer_init (struct t_hook *hook)
                       ((long long)HOOK_TIMER(hook, interval)) * 1000);
 }
 
+/*
+ * Callback called when a timer hook is added in the list of hooks.
+ */
+
+void
+hook_timer_add_cb (struct t_hook *hook)
+{
+    hook_timer_heap_add (hook);
+}
+
+/*
+ * Callback called when a timer hook is removed from the list of hooks.
+ *
+ * Note: the timer has already been removed from heap by function
+ * hook_timer_free_data.
+ */
+
+void
+hook_timer_remove_cb (struct t_hook *hook)
+{
+    /* make C compiler happy */
+    (void) hook;
+
+    if (hooks_count[HOOK_TYPE_TIMER] == 0)
+    {
+        if (hook_timer_heap)
+        {
+            free (hook_timer_heap);
+            hook_timer_heap = NULL;
+        }
+        if (hook_timer_due)
+        {
+            free (hook_timer_due);
+            hook_timer_due = NULL;
+        }
+        hook_timer_heap_count = 0;
+        hook_timer_heap_size = 0;
+    }
+}
+
 /*
  * Hooks a timer.
  *
@@ -121,6 +378,13 @@ hook_timer (struct t_weechat_plugin *plugin, long interval, int align_second,
         return NULL;
     }
 
+    if (!hook_timer_heap_grow ())
+    {
+        free (new_hook_timer);
+        free (new_hook);
+        return NULL;
+    }
+
     hook_init_data (new_hook, plugin, HOOK_TYPE_TIMER, HOOK_PRIORITY_DEFAULT,
                     callback_pointer, callback_data);
 
@@ -129,6 +393,8 @@ hook_timer (struct t_weechat_plugin *plugin, long interval, int align_second,
     new_hook_timer->interval = interval;
     new_hook_timer->align_second = align_second;
     new_hook_timer->remaining_calls = max_calls;
+    new_hook_timer->order = hook_timer_order++;
+    new_hook_timer->heap_index = -1;
 
     hook_timer_init (new_hook);
 
@@ -174,6 +440,7 @@ hook_timer_check_system_clock ()
             if (!ptr_hook->deleted)
                 hook_timer_init (ptr_hook);
         }
+        hook_timer_heap_build ();
     }
 
     hook_last_system_time = now;
@@ -186,7 +453,6 @@ hook_timer_check_system_clock ()
 int
 hook_timer_get_time_to_next ()
 {
-    struct t_hook *ptr_hook;
     int found, timeout;
     struct timeval tv_now, tv_timeout;
     long diff_usec;
@@ -197,18 +463,12 @@ hook_timer_get_time_to_next ()
     tv_timeout.tv_sec = 0;
     tv_timeout.tv_usec = 0;
 
-    for (ptr_hook = weechat_hooks[HOOK_TYPE_TIMER]; ptr_hook;
-         ptr_hook = ptr_hook->next_hook)
+    /* first timer in heap is the next one to run */
+    if (hook_timer_heap_count > 0)
     {
-        if (!ptr_hook->deleted
-            && (!found
-                || (util_timeval_cmp (&HOOK_TIMER(ptr_hook, next_exec),
-                                      &tv_timeout) < 0)))
-        {
-            found = 1;
-            tv_timeout.tv_sec = HOOK_TIMER(ptr_hook, next_exec).tv_sec;
-            tv_timeout.tv_usec = HOOK_TIMER(ptr_hook, next_exec).tv_usec;
-        }
+        found = 1;
+        tv_timeout.tv_sec = HOOK_TIMER(hook_timer_heap[0], next_exec).tv_sec;
+        tv_timeout.tv_usec = HOOK_TIMER(hook_timer_heap[0], next_exec).tv_usec;
     }
 
     /* no timeout found, return 2 seconds by default */
@@ -257,15 +517,36 @@ end:
     return (timeout < 1) ? 1 : timeout;
 }
 
+/*
+ * Compares two timers by creation order (used to sort timers to run).
+ */
+
+int
+hook_timer_cmp_order_cb (const void *timer1, const void *timer2)
+{
+    unsigned long long order1, order2;
+
+    order1 = HOOK_TIMER((*((struct t_hook **)timer1)), order);
+    order2 = HOOK_TIMER((*((struct t_hook **)timer2)), order);
+
+    if (order1 < order2)
+        return -1;
+    return (order1 > order2) ? 1 : 0;
+}
+
 /*
  * Executes timer hooks.
+ *
+ * Timers to run are taken from the heap, then run in the order of the list
+ * of hooks (creation order), and each timer is run at most once.
  */
 
 void
 hook_timer_exec ()
 {
     struct timeval tv_time;
-    struct t_hook *ptr_hook, *next_hook;
+    struct t_hook *ptr_hook;
+    int i, num_due;
 
     if (!weechat_hooks[HOOK_TYPE_TIMER])
         return;
@@ -274,17 +555,35 @@ hook_timer_exec ()
 
     gettimeofday (&tv_time, NULL);
 
+    /* remove from heap all timers to run now */
+    num_due = 0;
+    while ((hook_timer_heap_count > 0)
+           && (util_timeval_cmp (&HOOK_TIMER(hook_timer_heap[0], next_exec),
+                                 &tv_time) <= 0))
+    {
+        hook_timer_due[num_due++] = hook_timer_heap_pop ();
+    }
+
+    if (num_due == 0)
+        return;
+
+    if (num_due > 1)
+    {
+        qsort (hook_timer_due, num_due, sizeof (hook_timer_due[0]),
+               &hook_timer_cmp_order_cb);
+    }
+
     hook_exec_start ();
 
-    ptr_hook = weechat_hooks[HOOK_TYPE_TIMER];
-    while (ptr_hook)
+    for (i = 0; i < num_due; i++)
     {
-        next_hook = ptr_hook->next_hook;
+        /* hook is not freed before hook_exec_end, only marked as deleted */
+        ptr_hook = hook_timer_due[i];
+
+        if (ptr_hook->deleted)
+            continue;
 
-        if (!ptr_hook->deleted
-            && !ptr_hook->running
-            && (util_timeval_cmp (&HOOK_TIMER(ptr_hook, next_exec),
-                                  &tv_time) <= 0))
+        if (!ptr_hook->running)
         {
             ptr_hook->running = 1;
             (void) (HOOK_TIMER(ptr_hook, callback))
@@ -293,25 +592,30 @@ hook_timer_exec ()
                  (HOOK_TIMER(ptr_hook, remaining_calls) > 0) ?
                   HOOK_TIMER(ptr_hook, remaining_calls) - 1 : -1);
             ptr_hook->running = 0;
-            if (!ptr_hook->deleted)
-            {
-                HOOK_TIMER(ptr_hook, last_exec).tv_sec = tv_time.tv_sec;
-                HOOK_TIMER(ptr_hook, last_exec).tv_usec = tv_time.tv_usec;
+            if (ptr_hook->deleted)
+                continue;
+
+            HOOK_TIMER(ptr_hook, last_exec).tv_sec = tv_time.tv_sec;
+            HOOK_TIMER(ptr_hook, last_exec).tv_usec = tv_time.tv_usec;
 
-                util_timeval_add (
-                    &HOOK_TIMER(ptr_hook, next_exec),
-                    ((long long)HOOK_TIMER(ptr_hook, interval)) * 1000);
+            util_timeval_add (
+                &HOOK_TIMER(ptr_hook, next_exec),
+                ((long long)HOOK_TIMER(ptr_hook, interval)) * 1000);
 
-                if (HOOK_TIMER(ptr_hook, remaining_calls) > 0)
+            if (HOOK_TIMER(ptr_hook, remaining_calls) > 0)
+            {
+                HOOK_TIMER(ptr_hook, remaining_calls)--;
+                if (HOOK_TIMER(ptr_hook, remaining_calls) == 0)
                 {
-                    HOOK_TIMER(ptr_hook, remaining_calls)--;
-                    if (HOOK_TIMER(ptr_hook, remaining_calls) == 0)
-                        unhook (ptr_hook);
+                    unhook (ptr_hook);
+                    continue;
                 }
             }
         }
 
-        ptr_hook = next_hook;
+        /* put timer back in heap, with its new date of next execution */
+        if (HOOK_TIMER(ptr_hook, heap_index) < 0)
+            hook_timer_heap_add (ptr_hook);
     }
 
     hook_exec_end ();
@@ -327,6 +631,8 @@ hook_timer_free_data (struct t_hook *hook)
     if (!hook || !hook->hook_data)
         return;
 
+    hook_timer_heap_remove (hook);
+
     free (hook->hook_data);
     hook->hook_data = NULL;
 }
@@ -1889,6 +1889,7 @@ COMMAND_CALLBACK(debug)
     if (string_strcasecmp (argv[1], "tags") == 0)
     {
         gui_chat_display_tags ^= 1;
+        gui_line_height_invalidate_all ();
         gui_window_ask_refresh (2);
         return WEECHAT_RC_OK;
     }
@@ -36,6 +36,7 @@
 #include "weechat.h"
 #include "wee-config-file.h"
 #include "wee-config.h"
+#include "wee-hashtable.h"
 #include "wee-hdata.h"
 #include "wee-hook.h"
 #include "wee-infolist.h"
@@ -59,6 +60,66 @@ char *config_boolean_false[] = { "off", "no", "n", "false", "f", "0", NULL };
 void config_file_option_free_data (struct t_config_option *option);
 
 
+/*
+ * Hashes a name of section or option (case is ignored for chars "A-Z", like
+ * function string_strcasecmp).
+ *
+ * Keys are names of sections/options (pointers to strings, which are not
+ * duplicated in the hashtable).
+ */
+
+unsigned long long
+config_file_hash_key_name_cb (struct t_hashtable *hashtable, const void *key)
+{
+    const unsigned char *ptr_key;
+    unsigned long long hash;
+    unsigned char c;
+
+    /* make C compiler happy */
+    (void) hashtable;
+
+    hash = 5381;
+    for (ptr_key = (const unsigned char *)key; ptr_key[0]; ptr_key++)
+    {
+        c = ptr_key[0];
+        if ((c >= 'A') && (c <= 'Z'))
+            c += ('a' - 'A');
+        hash ^= (hash << 5) + (hash >> 2) + c;
+    }
+
+    return hash;
+}
+
+/*
+ * Compares two names of sections or options (case is ignored).
+ */
+
+int
+config_file_keycmp_name_cb (struct t_hashtable *hashtable,
+                            const void *key1, const void *key2)
+{
+    /* make C compiler happy */
+    (void) hashtable;
+
+    return string_strcasecmp ((const char *)key1, (const char *)key2);
+}
+
+/*
+ * Creates a hashtable to index sections or options by name.
+ *
+ * Returns pointer to new hashtable, NULL if error.
+ */
+
+struct t_hashtable *
+config_file_hashtable_names_new ()
+{
+    return hashtable_new (32,
+                          WEECHAT_HASHTABLE_POINTER,
+                          WEECHAT_HASHTABLE_POINTER,
+                          &config_file_hash_key_name_cb,
+                          &config_file_keycmp_name_cb);
+}
+
 /*
  * Searches for a configuration file.
  */
@@ -163,6 +224,14 @@ config_file_new (struct t_weechat_plugin *plugin, const char *name,
         new_config_file->callback_reload_data = callback_reload_data;
         new_config_file->sections = NULL;
         new_config_file->last_section = NULL;
+        new_config_file->sections_hashtable = config_file_hashtable_names_new ();
+        if (!new_config_file->sections_hashtable)
+        {
+            free (new_config_file->filename);
+            free (new_config_file->name);
+            free (new_config_file);
+            return NULL;
+        }
 
         new_config_file->prev_config = last_config_file;
         new_config_file->next_config = NULL;
@@ -283,6 +352,13 @@ config_file_new_section (struct t_config_file *config_file, const char *name,
         new_section->callback_delete_option_data = callback_delete_option_data;
         new_section->options = NULL;
         new_section->last_option = NULL;
+        new_section->options_hashtable = config_file_hashtable_names_new ();
+        if (!new_section->options_hashtable)
+        {
+            free (new_section->name);
+            free (new_section);
+            return NULL;
+        }
 
         new_section->prev_section = config_file->last_section;
         new_section->next_section = NULL;
@@ -291,6 +367,9 @@ config_file_new_section (struct t_config_file *config_file, const char *name,
         else
             config_file->sections = new_section;
         config_file->last_section = new_section;
+
+        hashtable_set (config_file->sections_hashtable,
+                       new_section->name, new_section);
     }
 
     return new_section;
@@ -306,20 +385,10 @@ struct t_config_section *
 config_file_search_section (struct t_config_file *config_file,
                             const char *section_name)
 {
-    struct t_config_section *ptr_section;
-
     if (!config_file || !section_name)
         return NULL;
 
-    for (ptr_section = config_file->sections; ptr_section;
-         ptr_section = ptr_section->next_section)
-    {
-        if (string_strcasecmp (ptr_section->name, section_name) == 0)
-            return ptr_section;
-    }
-
-    /* section not found */
-    return NULL;
+    return hashtable_get (config_file->sections_hashtable, section_name);
 }
 
 /*
@@ -430,7 +499,8 @@ config_file_option_find_pos (struct t_config_section *section, const char *name)
 }
 
 /*
- * Inserts an option in section (keeping options sorted by name).
+ * Inserts an option in section (keeping options sorted by name) and indexes
+ * it by name in hashtable of section.
  */
 
 void
@@ -473,6 +543,8 @@ config_file_option_insert_in_section (struct t_config_option *option)
         (option->section)->options = option;
         (option->section)->last_option = option;
     }
+
+    hashtable_set ((option->section)->options_hashtable, option->name, option);
 }
 
 /*
@@ -572,7 +644,7 @@ config_file_new_option (struct t_config_file *config_file,
         option_name = strdup (name);
     }
 
-    if (config_file && section
+    if (section
         && config_file_search_option (config_file, section, option_name))
     {
         goto error;
@@ -833,34 +905,22 @@ config_file_search_option (struct t_config_file *config_file,
 {
     struct t_config_section *ptr_section;
     struct t_config_option *ptr_option;
-    int rc;
+
+    if (!option_name)
+        return NULL;
 
     if (section)
-    {
-        for (ptr_option = section->last_option; ptr_option;
-             ptr_option = ptr_option->prev_option)
-        {
-            rc = string_strcasecmp (ptr_option->name, option_name);
-            if (rc == 0)
-                return ptr_option;
-            else if (rc < 0)
-                return NULL;
-        }
-    }
-    else if (config_file)
+        return hashtable_get (section->options_hashtable, option_name);
+
+    if (config_file)
     {
         for (ptr_section = config_file->sections; ptr_section;
              ptr_section = ptr_section->next_section)
         {
-            for (ptr_option = ptr_section->last_option; ptr_option;
-                 ptr_option = ptr_option->prev_option)
-            {
-                rc = string_strcasecmp (ptr_option->name, option_name);
-                if (rc == 0)
-                    return ptr_option;
-                else if (rc < 0)
-                    return NULL;
-            }
+            ptr_option = hashtable_get (ptr_section->options_hashtable,
+                                        option_name);
+            if (ptr_option)
+                return ptr_option;
         }
     }
 
@@ -884,25 +944,20 @@ config_file_search_section_option (struct t_config_file *config_file,
 {
     struct t_config_section *ptr_section;
     struct t_config_option *ptr_option;
-    int rc;
 
     *section_found = NULL;
     *option_found = NULL;
 
+    if (!option_name)
+        return;
+
     if (section)
     {
-        for (ptr_option = section->last_option; ptr_option;
-             ptr_option = ptr_option->prev_option)
+        ptr_option = hashtable_get (section->options_hashtable, option_name);
+        if (ptr_option)
         {
-            rc = string_strcasecmp (ptr_option->name, option_name);
-            if (rc == 0)
-            {
-                *section_found = section;
-                *option_found = ptr_option;
-                return;
-            }
-            else if (rc < 0)
-                return;
+            *section_found = section;
+            *option_found = ptr_option;
         }
     }
     else if (config_file)
@@ -910,18 +965,13 @@ config_file_search_section_option (struct t_config_file *config_file,
         for (ptr_section = config_file->sections; ptr_section;
              ptr_section = ptr_section->next_section)
         {
-            for (ptr_option = ptr_section->last_option; ptr_option;
-                 ptr_option = ptr_option->prev_option)
+            ptr_option = hashtable_get (ptr_section->options_hashtable,
+                                        option_name);
+            if (ptr_option)
             {
-                rc = string_strcasecmp (ptr_option->name, option_name);
-                if (rc == 0)
-                {
-                    *section_found = ptr_section;
-                    *option_found = ptr_option;
-                    return;
-                }
-                else if (rc < 0)
-                    return;
+                *section_found = ptr_section;
+                *option_found = ptr_option;
+                return;
             }
         }
     }
@@ -1665,6 +1715,8 @@ config_file_option_rename (struct t_config_option *option,
         /* remove option from list */
         if (option->section)
         {
+            hashtable_remove ((option->section)->options_hashtable,
+                              option->name);
             if (option->prev_option)
                 (option->prev_option)->next_option = option->next_option;
             if (option->next_option)
@@ -2917,6 +2969,10 @@ config_file_option_free (struct t_config_option *option, int run_callback)
 
     ptr_section = option->section;
 
+    /* remove option from hashtable of section (before name is freed) */
+    if (ptr_section)
+        hashtable_remove (ptr_section->options_hashtable, option->name);
+
     /* free data */
     config_file_option_free_data (option);
 
@@ -2979,6 +3035,8 @@ config_file_section_free (struct t_config_section *section)
 
     /* free data */
     config_file_section_free_options (section);
+    hashtable_free (section->options_hashtable);
+    hashtable_remove (ptr_config->sections_hashtable, section->name);
     if (section->name)
         free (section->name);
     if (section->callback_read_data)
@@ -3028,6 +3086,7 @@ config_file_free (struct t_config_file *config_file)
     {
         config_file_section_free (config_file->sections);
     }
+    hashtable_free (config_file->sections_hashtable);
     if (config_file->name)
         free (config_file->name);
     if (config_file->filename)
@@ -3117,6 +3176,7 @@ config_file_hdata_config_file_cb (const void *pointer, void *data,
         HDATA_VAR(struct t_config_file, callback_reload_data, POINTER, 0, NULL, NULL);
         HDATA_VAR(struct t_config_file, sections, POINTER, 0, NULL, "config_section");
         HDATA_VAR(struct t_config_file, last_section, POINTER, 0, NULL, "config_section");
+        HDATA_VAR(struct t_config_file, sections_hashtable, HASHTABLE, 0, NULL, NULL);
         HDATA_VAR(struct t_config_file, prev_config, POINTER, 0, NULL, hdata_name);
         HDATA_VAR(struct t_config_file, next_config, POINTER, 0, NULL, hdata_name);
         HDATA_LIST(config_files, WEECHAT_HDATA_LIST_CHECK_POINTERS);
@@ -3164,6 +3224,7 @@ config_file_hdata_config_section_cb (const void *pointer, void *data,
         HDATA_VAR(struct t_config_section, callback_delete_option_data, POINTER, 0, NULL, NULL);
         HDATA_VAR(struct t_config_section, options, POINTER, 0, NULL, "config_option");
         HDATA_VAR(struct t_config_section, last_option, POINTER, 0, NULL, "config_option");
+        HDATA_VAR(struct t_config_section, options_hashtable, HASHTABLE, 0, NULL, NULL);
         HDATA_VAR(struct t_config_section, prev_section, POINTER, 0, NULL, hdata_name);
         HDATA_VAR(struct t_config_section, next_section, POINTER, 0, NULL, hdata_name);
     }
@@ -3430,6 +3491,7 @@ config_file_print_log ()
         log_printf ("  callback_reload_data . : 0x%lx", ptr_config_file->callback_reload_data);
         log_printf ("  sections . . . . . . . : 0x%lx", ptr_config_file->sections);
         log_printf ("  last_section . . . . . : 0x%lx", ptr_config_file->last_section);
+        log_printf ("  sections_hashtable . . : 0x%lx", ptr_config_file->sections_hashtable);
         log_printf ("  prev_config. . . . . . : 0x%lx", ptr_config_file->prev_config);
         log_printf ("  next_config. . . . . . : 0x%lx", ptr_config_file->next_config);
 
@@ -3457,6 +3519,7 @@ config_file_print_log ()
             log_printf ("      callback_delete_option_data . : 0x%lx", ptr_section->callback_delete_option_data);
             log_printf ("      options . . . . . . . . . . . : 0x%lx", ptr_section->options);
             log_printf ("      last_option . . . . . . . . . : 0x%lx", ptr_section->last_option);
+            log_printf ("      options_hashtable . . . . . . : 0x%lx", ptr_section->options_hashtable);
             log_printf ("      prev_section. . . . . . . . . : 0x%lx", ptr_section->prev_section);
             log_printf ("      next_section. . . . . . . . . : 0x%lx", ptr_section->next_section);
 
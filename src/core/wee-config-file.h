@@ -40,6 +40,7 @@
 
 struct t_weelist;
 struct t_infolist;
+struct t_hashtable;
 
 struct t_config_option;
 
@@ -58,6 +59,7 @@ struct t_config_file
     void *callback_reload_data;            /* data sent to callback         */
     struct t_config_section *sections;     /* config sections               */
     struct t_config_section *last_section; /* last config section           */
+    struct t_hashtable *sections_hashtable; /* sections by name (no case)  */
     struct t_config_file *prev_config;     /* link to previous config file  */
     struct t_config_file *next_config;     /* link to next config file      */
 };
@@ -110,6 +112,7 @@ struct t_config_section
     void *callback_delete_option_data;     /* data sent to delete callback  */
     struct t_config_option *options;       /* options in section            */
     struct t_config_option *last_option;   /* last option in section        */
+    struct t_hashtable *options_hashtable; /* options by name (no case)     */
     struct t_config_section *prev_section; /* link to previous section      */
     struct t_config_section *next_section; /* link to next section          */
 };
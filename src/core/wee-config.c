@@ -47,6 +47,7 @@
 #include "wee-list.h"
 #include "wee-proxy.h"
 #include "wee-string.h"
+#include "wee-url.h"
 #include "wee-version.h"
 #include "../gui/gui-bar.h"
 #include "../gui/gui-bar-item.h"
@@ -283,6 +284,7 @@ struct t_config_option *config_completion_partial_completion_templates;
 struct t_config_option *config_history_display_default;
 struct t_config_option *config_history_max_buffer_lines_minutes;
 struct t_config_option *config_history_max_buffer_lines_number;
+struct t_config_option *config_history_max_buffer_lines_uncompressed;
 struct t_config_option *config_history_max_commands;
 struct t_config_option *config_history_max_visited_buffers;
 
@@ -292,6 +294,7 @@ struct t_config_option *config_network_connection_timeout;
 struct t_config_option *config_network_gnutls_ca_file;
 struct t_config_option *config_network_gnutls_handshake_timeout;
 struct t_config_option *config_network_proxy_curl;
+struct t_config_option *config_network_url_max_connections;
 
 /* config, plugin section */
 
@@ -1309,6 +1312,23 @@ config_check_proxy_curl (const void *pointer, void *data,
     return 1;
 }
 
+/*
+ * Callback for changes on option "weechat.network.url_max_connections".
+ */
+
+void
+config_change_network_url_max_connections (const void *pointer, void *data,
+                                           struct t_config_option *option)
+{
+    /* make C compiler happy */
+    (void) pointer;
+    (void) data;
+    (void) option;
+
+    weeurl_set_max_connections (
+        CONFIG_INTEGER(config_network_url_max_connections));
+}
+
 /*
  * Callback for changes on option "weechat.plugin.extension".
  */
@@ -4418,6 +4438,18 @@ config_weechat_init_options ()
            "weechat.history.max_buffer_lines_minutes is NOT set to 0"),
         NULL, 0, INT_MAX, "4096", NULL, 0,
         NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+    config_history_max_buffer_lines_uncompressed = config_file_new_option (
+        weechat_config_file, ptr_section,
+        "max_buffer_lines_uncompressed", "integer",
+        N_("maximum number of lines kept uncompressed in memory per buffer "
+           "with formatted content (0 = never compress lines); older lines "
+           "are compressed by blocks and uncompressed when they are needed "
+           "(scroll, search, merge of buffers, upgrade, ...); lines not "
+           "displayed in any window are compressed, so this number should be "
+           "greater than the size of windows and the backlog sent to relay "
+           "clients"),
+        NULL, 0, INT_MAX, "0", NULL, 0,
+        NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
     config_history_max_commands = config_file_new_option (
         weechat_config_file, ptr_section,
         "max_commands", "integer",
@@ -4497,6 +4529,17 @@ config_weechat_init_options ()
         &config_check_proxy_curl, NULL, NULL,
         NULL, NULL, NULL,
         NULL, NULL, NULL);
+    config_network_url_max_connections = config_file_new_option (
+        weechat_config_file, ptr_section,
+        "url_max_connections", "integer",
+        N_("max number of simultaneous connections for download of URLs in "
+           "WeeChat process (function hook_process with \"url:\"); other "
+           "downloads are queued until a connection is available "
+           "(0 = no limit)"),
+        NULL, 0, 1000, "16", NULL, 0,
+        NULL, NULL, NULL,
+        &config_change_network_url_max_connections, NULL, NULL,
+        NULL, NULL, NULL);
 
     /* plugin */
     ptr_section = config_file_new_section (weechat_config_file, "plugin",
@@ -330,6 +330,7 @@ extern struct t_config_option *config_completion_partial_completion_templates;
 extern struct t_config_option *config_history_display_default;
 extern struct t_config_option *config_history_max_buffer_lines_minutes;
 extern struct t_config_option *config_history_max_buffer_lines_number;
+extern struct t_config_option *config_history_max_buffer_lines_uncompressed;
 extern struct t_config_option *config_history_max_commands;
 extern struct t_config_option *config_history_max_visited_buffers;
 
@@ -337,6 +338,7 @@ extern struct t_config_option *config_network_connection_timeout;
 extern struct t_config_option *config_network_gnutls_ca_file;
 extern struct t_config_option *config_network_gnutls_handshake_timeout;
 extern struct t_config_option *config_network_proxy_curl;
+extern struct t_config_option *config_network_url_max_connections;
 
 extern struct t_config_option *config_plugin_autoload;
 extern struct t_config_option *config_plugin_debug;
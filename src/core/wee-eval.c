@@ -61,6 +61,12 @@ char *comparisons[EVAL_NUM_COMPARISONS] =
   "<=", "<", ">=", ">",      /* less than, greater than */
 };
 
+/* cache of compiled conditions (most recently used first) */
+struct t_hashtable *eval_cache = NULL;
+struct t_eval_compiled *eval_cache_first = NULL;
+struct t_eval_compiled *eval_cache_last = NULL;
+int eval_cache_count = 0;
+
 
 char *eval_replace_vars (const char *expr,
                          struct t_eval_context *eval_context);
@@ -1504,6 +1510,610 @@ end:
     return value;
 }
 
+/*
+ * Checks if a text is constant: it has no variables to replace (and no
+ * escaped prefix).
+ *
+ * Returns:
+ *   1: text is constant
+ *   0: text has variables
+ */
+
+int
+eval_text_is_constant (const char *text, struct t_eval_context *eval_context)
+{
+    const char *ptr_text;
+
+    if (strstr (text, eval_context->prefix))
+        return 0;
+
+    for (ptr_text = strchr (text, '\\'); ptr_text;
+         ptr_text = strchr (ptr_text + 1, '\\'))
+    {
+        if (ptr_text[1] == eval_context->prefix[0])
+            return 0;
+    }
+
+    return 1;
+}
+
+/*
+ * Creates a new node for a compiled expression.
+ *
+ * Returns pointer to new node, NULL if error.
+ */
+
+struct t_eval_node *
+eval_node_new (enum t_eval_node_type type, int op, const char *text,
+               struct t_eval_context *eval_context)
+{
+    struct t_eval_node *new_node;
+
+    new_node = malloc (sizeof (*new_node));
+    if (!new_node)
+        return NULL;
+
+    new_node->type = type;
+    new_node->op = op;
+    new_node->text = NULL;
+    new_node->constant = 0;
+    new_node->regex = NULL;
+    new_node->regex_error = 0;
+    new_node->left = NULL;
+    new_node->right = NULL;
+
+    if (text)
+    {
+        new_node->text = strdup (text);
+        if (!new_node->text)
+        {
+            free (new_node);
+            return NULL;
+        }
+        new_node->constant = eval_text_is_constant (text, eval_context);
+    }
+
+    return new_node;
+}
+
+/*
+ * Frees a node of a compiled expression (and its sub-nodes).
+ */
+
+void
+eval_node_free (struct t_eval_node *node)
+{
+    if (!node)
+        return;
+
+    if (node->text)
+        free (node->text);
+    if (node->regex)
+    {
+        regfree (node->regex);
+        free (node->regex);
+    }
+    eval_node_free (node->left);
+    eval_node_free (node->right);
+
+    free (node);
+}
+
+/*
+ * Compiles a condition: the expression is split once for all on logical
+ * operators and comparisons, exactly like function eval_expression_condition
+ * does on each evaluation.
+ *
+ * Returns pointer to root node, NULL if error.
+ */
+
+struct t_eval_node *
+eval_compile_condition (const char *expr, struct t_eval_context *eval_context)
+{
+    int logic, comp, level;
+    const char *pos, *pos_end;
+    char *expr2, *sub_expr;
+    struct t_eval_node *node;
+
+    if (!expr)
+        return eval_node_new (EVAL_NODE_NONE, 0, NULL, eval_context);
+
+    /* skip spaces at beginning of string */
+    while (expr[0] == ' ')
+    {
+        expr++;
+    }
+    if (!expr[0])
+    {
+        node = eval_node_new (EVAL_NODE_VARS, 0, expr, eval_context);
+        if (node)
+            node->constant = 1;
+        return node;
+    }
+
+    /* skip spaces at end of string */
+    pos_end = expr + strlen (expr) - 1;
+    while ((pos_end > expr) && (pos_end[0] == ' '))
+    {
+        pos_end--;
+    }
+
+    expr2 = string_strndup (expr, pos_end + 1 - expr);
+    if (!expr2)
+        return NULL;
+
+    node = NULL;
+
+    /* search for a logical operator */
+    for (logic = 0; logic < EVAL_NUM_LOGICAL_OPS; logic++)
+    {
+        pos = eval_strstr_level (expr2, logical_ops[logic], eval_context,
+                                 "(", ")", 0);
+        if (pos > expr2)
+        {
+            node = eval_node_new (EVAL_NODE_LOGICAL, logic, NULL,
+                                  eval_context);
+            if (!node)
+                goto end;
+            pos_end = pos - 1;
+            while ((pos_end > expr2) && (pos_end[0] == ' '))
+            {
+                pos_end--;
+            }
+            sub_expr = string_strndup (expr2, pos_end + 1 - expr2);
+            if (sub_expr)
+            {
+                node->left = eval_compile_condition (sub_expr, eval_context);
+                free (sub_expr);
+            }
+            pos += strlen (logical_ops[logic]);
+            while (pos[0] == ' ')
+            {
+                pos++;
+            }
+            node->right = eval_compile_condition (pos, eval_context);
+            goto end;
+        }
+    }
+
+    /* search for a comparison */
+    for (comp = 0; comp < EVAL_NUM_COMPARISONS; comp++)
+    {
+        pos = eval_strstr_level (expr2, comparisons[comp], eval_context,
+                                 "(", ")", 0);
+        if (pos >= expr2)
+        {
+            node = eval_node_new (EVAL_NODE_COMPARE, comp, NULL,
+                                  eval_context);
+            if (!node)
+                goto end;
+            if (pos > expr2)
+            {
+                pos_end = pos - 1;
+                while ((pos_end > expr2) && (pos_end[0] == ' '))
+                {
+                    pos_end--;
+                }
+                sub_expr = string_strndup (expr2, pos_end + 1 - expr2);
+            }
+            else
+            {
+                sub_expr = strdup ("");
+            }
+            if (!sub_expr)
+                goto end;
+            pos += strlen (comparisons[comp]);
+            while (pos[0] == ' ')
+            {
+                pos++;
+            }
+            if ((comp == EVAL_COMPARE_REGEX_MATCHING)
+                || (comp == EVAL_COMPARE_REGEX_NOT_MATCHING))
+            {
+                /* for regex: just replace vars in both expressions */
+                node->left = eval_node_new (EVAL_NODE_VARS, 0, sub_expr,
+                                            eval_context);
+                node->right = eval_node_new (EVAL_NODE_VARS, 0, pos,
+                                             eval_context);
+                /* compile regex now if it has no variables */
+                if (node->right && node->right->constant)
+                {
+                    node->regex = malloc (sizeof (*node->regex));
+                    if (node->regex
+                        && (string_regcomp (node->regex, pos,
+                                            REG_EXTENDED | REG_ICASE
+                                            | REG_NOSUB) != 0))
+                    {
+                        free (node->regex);
+                        node->regex = NULL;
+                        node->regex_error = 1;
+                    }
+                }
+            }
+            else
+            {
+                /* other comparison: fully evaluate both expressions */
+                node->left = eval_compile_condition (sub_expr, eval_context);
+                node->right = eval_compile_condition (pos, eval_context);
+            }
+            free (sub_expr);
+            goto end;
+        }
+    }
+
+    /* sub-expression between parentheses */
+    if (expr2[0] == '(')
+    {
+        level = 0;
+        pos = expr2 + 1;
+        while (pos[0])
+        {
+            if (pos[0] == '(')
+                level++;
+            else if (pos[0] == ')')
+            {
+                if (level == 0)
+                    break;
+                level--;
+            }
+            pos++;
+        }
+        if (pos[0] != ')')
+        {
+            /* closing parenthesis not found */
+            node = eval_node_new (EVAL_NODE_NONE, 0, NULL, eval_context);
+        }
+        else if (!pos[1])
+        {
+            /* nothing around parentheses */
+            node = eval_node_new (EVAL_NODE_PARENTHESES, 0, NULL,
+                                  eval_context);
+            if (node)
+            {
+                sub_expr = string_strndup (expr2 + 1, pos - expr2 - 1);
+                if (sub_expr)
+                {
+                    node->left = eval_compile_condition (sub_expr,
+                                                         eval_context);
+                    free (sub_expr);
+                }
+            }
+        }
+        else
+        {
+            /*
+             * text after parentheses: the value of sub-expression is
+             * concatenated with this text on each evaluation, so it can not
+             * be compiled
+             */
+            node = eval_node_new (EVAL_NODE_CONDITION, 0, expr2,
+                                  eval_context);
+        }
+        goto end;
+    }
+
+    /* no logical operator neither comparison: just replace variables */
+    node = eval_node_new (EVAL_NODE_VARS, 0, expr2, eval_context);
+
+end:
+    free (expr2);
+
+    /* check that all sub-nodes were created */
+    if (node
+        && (((node->type == EVAL_NODE_LOGICAL)
+             || (node->type == EVAL_NODE_COMPARE))
+            && (!node->left || !node->right)))
+    {
+        eval_node_free (node);
+        node = NULL;
+    }
+    if (node && (node->type == EVAL_NODE_PARENTHESES) && !node->left)
+    {
+        eval_node_free (node);
+        node = NULL;
+    }
+
+    return node;
+}
+
+/*
+ * Evaluates a node of a compiled expression.
+ *
+ * Note: result must be freed after use (if not NULL).
+ */
+
+char *
+eval_node_exec (struct t_eval_node *node, struct t_eval_context *eval_context)
+{
+    char *value, *value2, *result;
+    int rc;
+
+    switch (node->type)
+    {
+        case EVAL_NODE_VARS:
+            if (node->constant)
+                return strdup (node->text);
+            return eval_replace_vars (node->text, eval_context);
+        case EVAL_NODE_LOGICAL:
+            value = eval_node_exec (node->left, eval_context);
+            rc = eval_is_true (value);
+            if (value)
+                free (value);
+            /*
+             * if rc == 0 with "&&" or rc == 1 with "||", no need to
+             * evaluate second sub-expression
+             */
+            if ((rc && (node->op == EVAL_LOGICAL_OP_AND))
+                || (!rc && (node->op == EVAL_LOGICAL_OP_OR)))
+            {
+                value = eval_node_exec (node->right, eval_context);
+                rc = eval_is_true (value);
+                if (value)
+                    free (value);
+            }
+            return strdup ((rc) ? EVAL_STR_TRUE : EVAL_STR_FALSE);
+        case EVAL_NODE_COMPARE:
+            value = eval_node_exec (node->left, eval_context);
+            if (node->regex || node->regex_error)
+            {
+                rc = (value && node->regex) ?
+                    ((regexec (node->regex, value, 0, NULL, 0) == 0) ? 1 : 0) :
+                    0;
+                if (value && node->regex
+                    && (node->op == EVAL_COMPARE_REGEX_NOT_MATCHING))
+                {
+                    rc ^= 1;
+                }
+                if (value)
+                    free (value);
+                return strdup ((rc) ? EVAL_STR_TRUE : EVAL_STR_FALSE);
+            }
+            value2 = eval_node_exec (node->right, eval_context);
+            result = eval_compare (value, node->op, value2, eval_context);
+            if (value)
+                free (value);
+            if (value2)
+                free (value2);
+            return result;
+        case EVAL_NODE_PARENTHESES:
+            return eval_node_exec (node->left, eval_context);
+        case EVAL_NODE_CONDITION:
+            return eval_expression_condition (node->text, eval_context);
+        case EVAL_NODE_NONE:
+        case EVAL_NUM_NODE_TYPES:
+            break;
+    }
+
+    return NULL;
+}
+
+/*
+ * Compiles an expression, using prefix/suffix given in evaluation context.
+ *
+ * Returns pointer to compiled expression, NULL if error.
+ */
+
+struct t_eval_compiled *
+eval_compile_with_context (const char *expr, int condition,
+                           struct t_eval_context *eval_context)
+{
+    struct t_eval_compiled *new_compiled;
+
+    new_compiled = malloc (sizeof (*new_compiled));
+    if (!new_compiled)
+        return NULL;
+
+    new_compiled->expr = strdup (expr);
+    new_compiled->prefix = strdup (eval_context->prefix);
+    new_compiled->suffix = strdup (eval_context->suffix);
+    new_compiled->condition = condition;
+    new_compiled->root = NULL;
+    new_compiled->running = 0;
+    new_compiled->prev_compiled = NULL;
+    new_compiled->next_compiled = NULL;
+
+    if (new_compiled->expr && new_compiled->prefix && new_compiled->suffix)
+    {
+        new_compiled->root = (condition) ?
+            eval_compile_condition (expr, eval_context) :
+            eval_node_new (EVAL_NODE_VARS, 0, expr, eval_context);
+    }
+
+    if (!new_compiled->root)
+    {
+        eval_compiled_free (new_compiled);
+        return NULL;
+    }
+
+    return new_compiled;
+}
+
+/*
+ * Removes a compiled expression from the cache (the compiled expression is
+ * not freed).
+ */
+
+void
+eval_cache_unlink (struct t_eval_compiled *compiled)
+{
+    if (compiled->prev_compiled)
+        (compiled->prev_compiled)->next_compiled = compiled->next_compiled;
+    if (compiled->next_compiled)
+        (compiled->next_compiled)->prev_compiled = compiled->prev_compiled;
+    if (eval_cache_first == compiled)
+        eval_cache_first = compiled->next_compiled;
+    if (eval_cache_last == compiled)
+        eval_cache_last = compiled->prev_compiled;
+    compiled->prev_compiled = NULL;
+    compiled->next_compiled = NULL;
+}
+
+/*
+ * Adds a compiled expression at beginning of cache (most recently used).
+ */
+
+void
+eval_cache_link_first (struct t_eval_compiled *compiled)
+{
+    compiled->prev_compiled = NULL;
+    compiled->next_compiled = eval_cache_first;
+    if (eval_cache_first)
+        eval_cache_first->prev_compiled = compiled;
+    else
+        eval_cache_last = compiled;
+    eval_cache_first = compiled;
+}
+
+/*
+ * Gets a compiled condition from the cache; if not found, the condition is
+ * compiled and added in cache (the least recently used conditions are
+ * removed if the cache is full).
+ *
+ * Returns pointer to compiled condition, NULL if error.
+ */
+
+struct t_eval_compiled *
+eval_cache_get (const char *expr, struct t_eval_context *eval_context)
+{
+    struct t_eval_compiled *ptr_compiled, *ptr_prev;
+
+    if (!eval_cache)
+    {
+        eval_cache = hashtable_new (256,
+                                    WEECHAT_HASHTABLE_STRING,
+                                    WEECHAT_HASHTABLE_POINTER,
+                                    NULL, NULL);
+        if (!eval_cache)
+            return NULL;
+    }
+
+    ptr_compiled = hashtable_get (eval_cache, expr);
+    if (ptr_compiled
+        && (strcmp (ptr_compiled->prefix, eval_context->prefix) == 0)
+        && (strcmp (ptr_compiled->suffix, eval_context->suffix) == 0))
+    {
+        /* move compiled condition at beginning of cache */
+        if (ptr_compiled != eval_cache_first)
+        {
+            eval_cache_unlink (ptr_compiled);
+            eval_cache_link_first (ptr_compiled);
+        }
+        return ptr_compiled;
+    }
+
+    /* compiled with another prefix/suffix: compile it again if not used */
+    if (ptr_compiled)
+    {
+        if (ptr_compiled->running > 0)
+            return NULL;
+        hashtable_remove (eval_cache, expr);
+        eval_cache_unlink (ptr_compiled);
+        eval_compiled_free (ptr_compiled);
+        eval_cache_count--;
+    }
+
+    /* remove least recently used conditions (if not currently evaluated) */
+    ptr_compiled = eval_cache_last;
+    while (ptr_compiled && (eval_cache_count >= EVAL_CACHE_MAX_SIZE))
+    {
+        ptr_prev = ptr_compiled->prev_compiled;
+        if (ptr_compiled->running == 0)
+        {
+            hashtable_remove (eval_cache, ptr_compiled->expr);
+            eval_cache_unlink (ptr_compiled);
+            eval_compiled_free (ptr_compiled);
+            eval_cache_count--;
+        }
+        ptr_compiled = ptr_prev;
+    }
+
+    ptr_compiled = eval_compile_with_context (expr, 1, eval_context);
+    if (!ptr_compiled)
+        return NULL;
+
+    hashtable_set (eval_cache, expr, ptr_compiled);
+    eval_cache_link_first (ptr_compiled);
+    eval_cache_count++;
+
+    return ptr_compiled;
+}
+
+/*
+ * Frees all compiled conditions in cache.
+ */
+
+void
+eval_cache_free_all ()
+{
+    struct t_eval_compiled *ptr_next;
+
+    while (eval_cache_first)
+    {
+        ptr_next = eval_cache_first->next_compiled;
+        eval_compiled_free (eval_cache_first);
+        eval_cache_first = ptr_next;
+    }
+    eval_cache_last = NULL;
+    eval_cache_count = 0;
+
+    if (eval_cache)
+    {
+        hashtable_free (eval_cache);
+        eval_cache = NULL;
+    }
+}
+
+/*
+ * Compiles an expression, so that it can be evaluated many times with
+ * function eval_compiled_exec, without parsing it again.
+ *
+ * Options used for compilation are "type", "prefix" and "suffix" (see
+ * function eval_expression); other options are given on each evaluation.
+ *
+ * Returns pointer to compiled expression, NULL if error.
+ *
+ * Note: result must be freed after use with function eval_compiled_free.
+ */
+
+struct t_eval_compiled *
+eval_compile (const char *expr, struct t_hashtable *options)
+{
+    struct t_eval_context context, *eval_context;
+    const char *ptr_value;
+    int condition;
+
+    if (!expr)
+        return NULL;
+
+    eval_context = &context;
+
+    eval_context->pointers = NULL;
+    eval_context->extra_vars = NULL;
+    eval_context->extra_vars_eval = 0;
+    eval_context->prefix = EVAL_DEFAULT_PREFIX;
+    eval_context->suffix = EVAL_DEFAULT_SUFFIX;
+    eval_context->regex = NULL;
+    eval_context->recursion_count = 0;
+    eval_context->debug = NULL;
+
+    condition = 0;
+
+    if (options)
+    {
+        ptr_value = hashtable_get (options, "type");
+        if (ptr_value && (strcmp (ptr_value, "condition") == 0))
+            condition = 1;
+        ptr_value = hashtable_get (options, "prefix");
+        if (ptr_value && ptr_value[0])
+            eval_context->prefix = ptr_value;
+        ptr_value = hashtable_get (options, "suffix");
+        if (ptr_value && ptr_value[0])
+            eval_context->suffix = ptr_value;
+    }
+
+    return eval_compile_with_context (expr, condition, eval_context);
+}
+
 /*
  * Replaces text in a string using a regular expression and replacement text.
  *
@@ -1638,7 +2248,12 @@ eval_replace_regex (const char *string, regex_t *regex, const char *replace,
 }
 
 /*
- * Evaluates an expression.
+ * Evaluates an expression, or a compiled expression if "compiled" is not NULL
+ * (in this case "expr" is ignored).
+ *
+ * Conditions which are not compiled are compiled and kept in a cache (with
+ * a maximum of EVAL_CACHE_MAX_SIZE conditions, the least recently used are
+ * removed first).
  *
  * The hashtable "pointers" must have string for keys, pointer for values.
  * The hashtable "extra_vars" must have string for keys and values.
@@ -1679,10 +2294,14 @@ eval_replace_regex (const char *string, regex_t *regex, const char *replace,
  */
 
 char *
-eval_expression (const char *expr, struct t_hashtable *pointers,
-                 struct t_hashtable *extra_vars, struct t_hashtable *options)
+eval_expression_internal (const char *expr,
+                          struct t_eval_compiled *compiled,
+                          struct t_hashtable *pointers,
+                          struct t_hashtable *extra_vars,
+                          struct t_hashtable *options)
 {
     struct t_eval_context context, *eval_context;
+    struct t_eval_compiled *ptr_compiled;
     int condition, rc, pointers_allocated, regex_allocated;
     int ptr_window_added, ptr_buffer_added;
     char *value;
@@ -1692,6 +2311,9 @@ eval_expression (const char *expr, struct t_hashtable *pointers,
     struct t_gui_window *window;
     regex_t *regex;
 
+    if (compiled)
+        expr = compiled->expr;
+
     if (!expr)
         return NULL;
 
@@ -1805,13 +2427,39 @@ eval_expression (const char *expr, struct t_hashtable *pointers,
             eval_context->debug = string_dyn_alloc (256);
     }
 
+    /* type, prefix and suffix of a compiled expression can not be changed */
+    if (compiled)
+    {
+        condition = compiled->condition;
+        eval_context->prefix = compiled->prefix;
+        eval_context->suffix = compiled->suffix;
+    }
+
     EVAL_DEBUG("eval_expression(\"%s\")", expr);
 
     /* evaluate expression */
     if (condition)
     {
-        /* evaluate as condition (return a boolean: "0" or "1") */
-        value = eval_expression_condition (expr, eval_context);
+        /*
+         * evaluate as condition (return a boolean: "0" or "1"), using the
+         * compiled condition (from cache if not given), except in debug mode
+         */
+        ptr_compiled = NULL;
+        if (!eval_context->debug)
+        {
+            ptr_compiled = (compiled) ?
+                compiled : eval_cache_get (expr, eval_context);
+        }
+        if (ptr_compiled)
+        {
+            ptr_compiled->running++;
+            value = eval_node_exec (ptr_compiled->root, eval_context);
+            ptr_compiled->running--;
+        }
+        else
+        {
+            value = eval_expression_condition (expr, eval_context);
+        }
         rc = eval_is_true (value);
         if (value)
             free (value);
@@ -1825,6 +2473,11 @@ eval_expression (const char *expr, struct t_hashtable *pointers,
             value = eval_replace_regex (expr, regex, regex_replace,
                                         eval_context);
         }
+        else if (compiled && !eval_context->debug)
+        {
+            /* only replace variables in expression (if any) */
+            value = eval_node_exec (compiled->root, eval_context);
+        }
         else
         {
             /* only replace variables in expression */
@@ -1856,3 +2509,74 @@ eval_expression (const char *expr, struct t_hashtable *pointers,
 
     return value;
 }
+
+/*
+ * Evaluates an expression.
+ *
+ * See function eval_expression_internal for the description of arguments
+ * and examples.
+ *
+ * Note: result must be freed after use (if not NULL).
+ */
+
+char *
+eval_expression (const char *expr, struct t_hashtable *pointers,
+                 struct t_hashtable *extra_vars, struct t_hashtable *options)
+{
+    return eval_expression_internal (expr, NULL, pointers, extra_vars,
+                                     options);
+}
+
+/*
+ * Evaluates an expression compiled with function eval_compile.
+ *
+ * Arguments are the same as function eval_expression, except that options
+ * "type", "prefix" and "suffix" are ignored (the ones given when compiling
+ * the expression are used).
+ *
+ * Note: result must be freed after use (if not NULL).
+ */
+
+char *
+eval_compiled_exec (struct t_eval_compiled *compiled,
+                    struct t_hashtable *pointers,
+                    struct t_hashtable *extra_vars,
+                    struct t_hashtable *options)
+{
+    if (!compiled)
+        return NULL;
+
+    return eval_expression_internal (NULL, compiled, pointers, extra_vars,
+                                     options);
+}
+
+/*
+ * Frees a compiled expression.
+ */
+
+void
+eval_compiled_free (struct t_eval_compiled *compiled)
+{
+    if (!compiled)
+        return;
+
+    if (compiled->expr)
+        free (compiled->expr);
+    if (compiled->prefix)
+        free (compiled->prefix);
+    if (compiled->suffix)
+        free (compiled->suffix);
+    eval_node_free (compiled->root);
+
+    free (compiled);
+}
+
+/*
+ * Frees all allocated data.
+ */
+
+void
+eval_end ()
+{
+    eval_cache_free_all ();
+}
@@ -30,6 +30,8 @@
 
 #define EVAL_RECURSION_MAX  32
 
+#define EVAL_CACHE_MAX_SIZE 256
+
 struct t_hashtable;
 
 enum t_eval_logical_op
@@ -62,6 +64,42 @@ enum t_eval_comparison
     EVAL_NUM_COMPARISONS,
 };
 
+enum t_eval_node_type
+{
+    EVAL_NODE_NONE = 0,                /* no value (NULL)                   */
+    EVAL_NODE_VARS,                    /* replace variables in text         */
+    EVAL_NODE_LOGICAL,                 /* logical operator                  */
+    EVAL_NODE_COMPARE,                 /* comparison                        */
+    EVAL_NODE_PARENTHESES,             /* sub-expression in parentheses     */
+    EVAL_NODE_CONDITION,               /* condition evaluated from text     */
+    /* number of node types */
+    EVAL_NUM_NODE_TYPES,
+};
+
+struct t_eval_node
+{
+    enum t_eval_node_type type;        /* type of node                      */
+    int op;                            /* logical operator or comparison    */
+    char *text;                        /* text (vars/condition)             */
+    int constant;                      /* 1 if text has no variables        */
+    regex_t *regex;                    /* compiled regex (constant regex)   */
+    int regex_error;                   /* 1 if constant regex is invalid    */
+    struct t_eval_node *left;          /* left sub-expression               */
+    struct t_eval_node *right;         /* right sub-expression              */
+};
+
+struct t_eval_compiled
+{
+    char *expr;                        /* expression                        */
+    char *prefix;                      /* prefix for variables              */
+    char *suffix;                      /* suffix for variables              */
+    int condition;                     /* 1 if evaluated as condition       */
+    struct t_eval_node *root;          /* compiled expression               */
+    int running;                       /* > 0 if currently evaluated        */
+    struct t_eval_compiled *prev_compiled; /* link to previous (cache)      */
+    struct t_eval_compiled *next_compiled; /* link to next (cache)          */
+};
+
 struct t_eval_regex
 {
     const char *result;
@@ -81,10 +119,20 @@ struct t_eval_context
     char **debug;
 };
 
+extern int eval_cache_count;
+
 extern int eval_is_true (const char *value);
 extern char *eval_expression (const char *expr,
                               struct t_hashtable *pointers,
                               struct t_hashtable *extra_vars,
                               struct t_hashtable *options);
+extern struct t_eval_compiled *eval_compile (const char *expr,
+                                             struct t_hashtable *options);
+extern char *eval_compiled_exec (struct t_eval_compiled *compiled,
+                                 struct t_hashtable *pointers,
+                                 struct t_hashtable *extra_vars,
+                                 struct t_hashtable *options);
+extern void eval_compiled_free (struct t_eval_compiled *compiled);
+extern void eval_end ();
 
 #endif /* WEECHAT_EVAL_H */
@@ -24,6 +24,7 @@
 #endif
 
 #include <stdlib.h>
+#include <limits.h>
 #include <stdint.h>
 #include <string.h>
 #include <time.h>
@@ -88,6 +89,179 @@ hashtable_hash_key_djb2 (const char *string)
     return hash;
 }
 
+/*
+ * Reads a 64-bit / 32-bit little-endian integer (for xxh64).
+ */
+
+#define HASHTABLE_XXH64_READ64(__ptr)                                    \
+    (((uint64_t)(__ptr)[0])                                              \
+     | ((uint64_t)(__ptr)[1] << 8)                                       \
+     | ((uint64_t)(__ptr)[2] << 16)                                      \
+     | ((uint64_t)(__ptr)[3] << 24)                                      \
+     | ((uint64_t)(__ptr)[4] << 32)                                      \
+     | ((uint64_t)(__ptr)[5] << 40)                                      \
+     | ((uint64_t)(__ptr)[6] << 48)                                      \
+     | ((uint64_t)(__ptr)[7] << 56))
+#define HASHTABLE_XXH64_READ32(__ptr)                                    \
+    (((uint64_t)(__ptr)[0])                                              \
+     | ((uint64_t)(__ptr)[1] << 8)                                       \
+     | ((uint64_t)(__ptr)[2] << 16)                                      \
+     | ((uint64_t)(__ptr)[3] << 24))
+#define HASHTABLE_XXH64_ROTL(__value, __bits)                            \
+    (((__value) << (__bits)) | ((__value) >> (64 - (__bits))))
+
+#define HASHTABLE_XXH64_PRIME1 0x9E3779B185EBCA87ULL
+#define HASHTABLE_XXH64_PRIME2 0xC2B2AE3D27D4EB4FULL
+#define HASHTABLE_XXH64_PRIME3 0x165667B19E3779F9ULL
+#define HASHTABLE_XXH64_PRIME4 0x85EBCA77C2B2AE63ULL
+#define HASHTABLE_XXH64_PRIME5 0x27D4EB2F165667C5ULL
+
+/*
+ * Mixes one 64-bit lane of input into an accumulator (for xxh64).
+ */
+
+uint64_t
+hashtable_xxh64_round (uint64_t acc, uint64_t input)
+{
+    acc += input * HASHTABLE_XXH64_PRIME2;
+    acc = HASHTABLE_XXH64_ROTL(acc, 31);
+    return acc * HASHTABLE_XXH64_PRIME1;
+}
+
+/*
+ * Merges an accumulator into the hash (for xxh64).
+ */
+
+uint64_t
+hashtable_xxh64_merge_round (uint64_t hash, uint64_t acc)
+{
+    hash ^= hashtable_xxh64_round (0, acc);
+    return (hash * HASHTABLE_XXH64_PRIME1) + HASHTABLE_XXH64_PRIME4;
+}
+
+/*
+ * Hashes data using xxh64 (seed 0).
+ *
+ * This hash reads 8 bytes at a time and has a much better distribution than
+ * djb2, so it can be used for long keys or keys with common prefixes
+ * (see function hashtable_hash_key_fast_cb).
+ *
+ * Returns the hash of data.
+ */
+
+unsigned long long
+hashtable_hash_key_xxh64 (const void *data, int length)
+{
+    const unsigned char *ptr_data, *ptr_end, *ptr_limit;
+    uint64_t hash, v1, v2, v3, v4;
+
+    if (!data || (length < 0))
+        length = 0;
+
+    ptr_data = (const unsigned char *)data;
+    ptr_end = ptr_data + length;
+
+    if (length >= 32)
+    {
+        ptr_limit = ptr_end - 32;
+        v1 = HASHTABLE_XXH64_PRIME1 + HASHTABLE_XXH64_PRIME2;
+        v2 = HASHTABLE_XXH64_PRIME2;
+        v3 = 0;
+        v4 = -HASHTABLE_XXH64_PRIME1;
+        do
+        {
+            v1 = hashtable_xxh64_round (v1, HASHTABLE_XXH64_READ64(ptr_data));
+            v2 = hashtable_xxh64_round (v2, HASHTABLE_XXH64_READ64(ptr_data + 8));
+            v3 = hashtable_xxh64_round (v3, HASHTABLE_XXH64_READ64(ptr_data + 16));
+            v4 = hashtable_xxh64_round (v4, HASHTABLE_XXH64_READ64(ptr_data + 24));
+            ptr_data += 32;
+        } while (ptr_data <= ptr_limit);
+        hash = HASHTABLE_XXH64_ROTL(v1, 1) + HASHTABLE_XXH64_ROTL(v2, 7)
+            + HASHTABLE_XXH64_ROTL(v3, 12) + HASHTABLE_XXH64_ROTL(v4, 18);
+        hash = hashtable_xxh64_merge_round (hash, v1);
+        hash = hashtable_xxh64_merge_round (hash, v2);
+        hash = hashtable_xxh64_merge_round (hash, v3);
+        hash = hashtable_xxh64_merge_round (hash, v4);
+    }
+    else
+    {
+        hash = HASHTABLE_XXH64_PRIME5;
+    }
+
+    hash += (uint64_t)length;
+
+    while (ptr_data + 8 <= ptr_end)
+    {
+        hash ^= hashtable_xxh64_round (0, HASHTABLE_XXH64_READ64(ptr_data));
+        hash = (HASHTABLE_XXH64_ROTL(hash, 27) * HASHTABLE_XXH64_PRIME1)
+            + HASHTABLE_XXH64_PRIME4;
+        ptr_data += 8;
+    }
+    if (ptr_data + 4 <= ptr_end)
+    {
+        hash ^= HASHTABLE_XXH64_READ32(ptr_data) * HASHTABLE_XXH64_PRIME1;
+        hash = (HASHTABLE_XXH64_ROTL(hash, 23) * HASHTABLE_XXH64_PRIME2)
+            + HASHTABLE_XXH64_PRIME3;
+        ptr_data += 4;
+    }
+    while (ptr_data < ptr_end)
+    {
+        hash ^= ((uint64_t)ptr_data[0]) * HASHTABLE_XXH64_PRIME5;
+        hash = HASHTABLE_XXH64_ROTL(hash, 11) * HASHTABLE_XXH64_PRIME1;
+        ptr_data++;
+    }
+
+    /* final avalanche */
+    hash ^= hash >> 33;
+    hash *= HASHTABLE_XXH64_PRIME2;
+    hash ^= hash >> 29;
+    hash *= HASHTABLE_XXH64_PRIME3;
+    hash ^= hash >> 32;
+
+    return hash;
+}
+
+/*
+ * Hashes a key with xxh64 (callback that can be given to hashtable_new
+ * instead of the default one).
+ *
+ * Unlike the default callback, integers, pointers and times are mixed, so
+ * that aligned pointers or sequential integers are spread over all buckets.
+ *
+ * Returns the hash of the key, depending on the type (0 for type "buffer":
+ * a specific callback is required for this type).
+ */
+
+unsigned long long
+hashtable_hash_key_fast_cb (struct t_hashtable *hashtable, const void *key)
+{
+    unsigned long long hash;
+
+    hash = 0;
+
+    switch (hashtable->type_keys)
+    {
+        case HASHTABLE_INTEGER:
+            hash = hashtable_hash_key_xxh64 (key, sizeof (int));
+            break;
+        case HASHTABLE_STRING:
+            hash = hashtable_hash_key_xxh64 (key, strlen ((const char *)key));
+            break;
+        case HASHTABLE_POINTER:
+            hash = hashtable_hash_key_xxh64 (&key, sizeof (key));
+            break;
+        case HASHTABLE_BUFFER:
+            break;
+        case HASHTABLE_TIME:
+            hash = hashtable_hash_key_xxh64 (key, sizeof (time_t));
+            break;
+        case HASHTABLE_NUM_TYPES:
+            break;
+    }
+
+    return hash;
+}
+
 /*
  * Hashes a key (default callback).
  *
@@ -229,6 +403,11 @@ hashtable_new (int size,
         }
         new_hashtable->items_count = 0;
 
+        new_hashtable->htable_old = NULL;
+        new_hashtable->size_old = 0;
+        new_hashtable->rehash_index = 0;
+        new_hashtable->map_running = 0;
+
         new_hashtable->callback_hash_key = (callback_hash_key) ?
             callback_hash_key : &hashtable_hash_key_default_cb;
         new_hashtable->callback_keycmp = (callback_keycmp) ?
@@ -362,6 +541,167 @@ hashtable_free_value (struct t_hashtable *hashtable,
     }
 }
 
+/*
+ * Searches for a key in a linked list of htable (sorted by key).
+ *
+ * Argument "pos_item" is set with the last item which is before the key in
+ * the list (NULL if the key is before first item).
+ *
+ * Returns pointer to item found, NULL if key is not in the list.
+ */
+
+struct t_hashtable_item *
+hashtable_search_list (struct t_hashtable *hashtable,
+                       struct t_hashtable_item *list,
+                       const void *key,
+                       struct t_hashtable_item **pos_item)
+{
+    struct t_hashtable_item *ptr_item;
+    int rc;
+
+    if (pos_item)
+        *pos_item = NULL;
+
+    for (ptr_item = list; ptr_item; ptr_item = ptr_item->next_item)
+    {
+        rc = (hashtable->callback_keycmp) (hashtable, key, ptr_item->key);
+        if (rc == 0)
+            return ptr_item;
+        if (rc < 0)
+            break;
+        if (pos_item)
+            *pos_item = ptr_item;
+    }
+
+    return NULL;
+}
+
+/*
+ * Links an item in a linked list of htable, after the item "pos_item"
+ * (or at beginning of list if "pos_item" is NULL).
+ */
+
+void
+hashtable_link_item (struct t_hashtable_item **list,
+                     struct t_hashtable_item *pos_item,
+                     struct t_hashtable_item *item)
+{
+    if (pos_item)
+    {
+        /* insert item after position found */
+        item->prev_item = pos_item;
+        item->next_item = pos_item->next_item;
+        if (pos_item->next_item)
+            (pos_item->next_item)->prev_item = item;
+        pos_item->next_item = item;
+    }
+    else
+    {
+        /* insert item at beginning of list */
+        item->prev_item = NULL;
+        item->next_item = *list;
+        if (*list)
+            (*list)->prev_item = item;
+        *list = item;
+    }
+}
+
+/*
+ * Moves some buckets of the old htable to the new one (incremental rehash).
+ *
+ * At most "buckets" non-empty buckets are moved (and at most 10 times this
+ * number of empty buckets are skipped). If "buckets" is negative, all the
+ * remaining buckets are moved (the rehash is then completed).
+ *
+ * Nothing is done if the hashtable is being mapped, because items must not
+ * move during the map.
+ */
+
+void
+hashtable_rehash_step (struct t_hashtable *hashtable, int buckets)
+{
+    struct t_hashtable_item *ptr_item, *ptr_next_item, **ptr_list, *pos_item;
+    int empty_visits;
+
+    if (!hashtable->htable_old || (hashtable->map_running > 0))
+        return;
+
+    empty_visits = buckets * 10;
+
+    while ((buckets != 0)
+           && (hashtable->rehash_index < hashtable->size_old))
+    {
+        ptr_item = hashtable->htable_old[hashtable->rehash_index];
+        if (!ptr_item)
+        {
+            hashtable->rehash_index++;
+            if (--empty_visits == 0)
+                break;
+            continue;
+        }
+        while (ptr_item)
+        {
+            ptr_next_item = ptr_item->next_item;
+            ptr_list = &hashtable->htable[
+                hashtable->callback_hash_key (hashtable, ptr_item->key)
+                % hashtable->size];
+            hashtable_search_list (hashtable, *ptr_list, ptr_item->key,
+                                   &pos_item);
+            hashtable_link_item (ptr_list, pos_item, ptr_item);
+            ptr_item = ptr_next_item;
+        }
+        hashtable->htable_old[hashtable->rehash_index] = NULL;
+        hashtable->rehash_index++;
+        buckets--;
+    }
+
+    if (hashtable->rehash_index >= hashtable->size_old)
+    {
+        free (hashtable->htable_old);
+        hashtable->htable_old = NULL;
+        hashtable->size_old = 0;
+        hashtable->rehash_index = 0;
+    }
+}
+
+/*
+ * Grows the hashtable if the number of items is too high for its size:
+ * a new htable with double size is allocated and the items will be moved
+ * incrementally from the current htable (see function hashtable_rehash_step).
+ */
+
+void
+hashtable_grow (struct t_hashtable *hashtable)
+{
+    struct t_hashtable_item **new_htable;
+    int i, new_size;
+
+    if ((hashtable->map_running > 0)
+        || (hashtable->items_count <= hashtable->size * HASHTABLE_MAX_LOAD_FACTOR)
+        || (hashtable->size > INT_MAX / (2 * HASHTABLE_MAX_LOAD_FACTOR)))
+    {
+        return;
+    }
+
+    /* a previous rehash must be completed before starting a new one */
+    hashtable_rehash_step (hashtable, -1);
+
+    new_size = hashtable->size * 2;
+    new_htable = malloc (new_size * sizeof (*new_htable));
+    if (!new_htable)
+        return;
+    for (i = 0; i < new_size; i++)
+    {
+        new_htable[i] = NULL;
+    }
+
+    hashtable->htable_old = hashtable->htable;
+    hashtable->size_old = hashtable->size;
+    hashtable->rehash_index = 0;
+    hashtable->htable = new_htable;
+    hashtable->size = new_size;
+}
+
 /*
  * Sets value for a key in hashtable.
  *
@@ -385,19 +725,28 @@ hashtable_set_with_size (struct t_hashtable *hashtable,
         return NULL;
     }
 
-    /* search position for item in hashtable */
-    hash = hashtable->callback_hash_key (hashtable, key) % hashtable->size;
     pos_item = NULL;
-    for (ptr_item = hashtable->htable[hash];
-         ptr_item
-             && ((int)(hashtable->callback_keycmp) (hashtable, key, ptr_item->key) > 0);
-         ptr_item = ptr_item->next_item)
+
+    hashtable_rehash_step (hashtable, HASHTABLE_REHASH_BUCKETS);
+
+    hash = hashtable->callback_hash_key (hashtable, key);
+
+    /* during a rehash, the key may still be in the old htable */
+    ptr_item = (hashtable->htable_old) ?
+        hashtable_search_list (hashtable,
+                               hashtable->htable_old[hash % hashtable->size_old],
+                               key, NULL) : NULL;
+
+    /* search position for item in hashtable */
+    hash %= hashtable->size;
+    if (!ptr_item)
     {
-        pos_item = ptr_item;
+        ptr_item = hashtable_search_list (hashtable, hashtable->htable[hash],
+                                          key, &pos_item);
     }
 
     /* replace value if item is already in hashtable */
-    if (ptr_item && (hashtable->callback_keycmp (hashtable, key, ptr_item->key) == 0))
+    if (ptr_item)
     {
         hashtable_free_value (hashtable, ptr_item);
         hashtable_alloc_type (hashtable->type_values,
@@ -420,27 +769,12 @@ hashtable_set_with_size (struct t_hashtable *hashtable,
                           &new_item->value, &new_item->value_size);
 
     /* add item */
-    if (pos_item)
-    {
-        /* insert item after position found */
-        new_item->prev_item = pos_item;
-        new_item->next_item = pos_item->next_item;
-        if (pos_item->next_item)
-            (pos_item->next_item)->prev_item = new_item;
-        pos_item->next_item = new_item;
-    }
-    else
-    {
-        /* insert item at beginning of list */
-        new_item->prev_item = NULL;
-        new_item->next_item = hashtable->htable[hash];
-        if (hashtable->htable[hash])
-            (hashtable->htable[hash])->prev_item = new_item;
-        hashtable->htable[hash] = new_item;
-    }
+    hashtable_link_item (&hashtable->htable[hash], pos_item, new_item);
 
     hashtable->items_count++;
 
+    hashtable_grow (hashtable);
+
     return new_item;
 }
 
@@ -464,7 +798,8 @@ hashtable_set (struct t_hashtable *hashtable,
  * Searches for an item in hashtable.
  *
  * If hash is non NULL, then it is set with hash value of key (even if key is
- * not found).
+ * not found): this is the index in htable, or in htable_old if a rehash is
+ * in progress and that the item is still in the old htable.
  */
 
 struct t_hashtable_item *
@@ -477,22 +812,31 @@ hashtable_get_item (struct t_hashtable *hashtable, const void *key,
     if (!hashtable || !key)
         return NULL;
 
-    key_hash = hashtable->callback_hash_key (hashtable, key) % hashtable->size;
-    if (hash)
-        *hash = key_hash;
-    for (ptr_item = hashtable->htable[key_hash];
-         ptr_item && hashtable->callback_keycmp (hashtable, key, ptr_item->key) > 0;
-         ptr_item = ptr_item->next_item)
-    {
-    }
+    hashtable_rehash_step (hashtable, HASHTABLE_REHASH_BUCKETS);
 
-    if (ptr_item
-        && (hashtable->callback_keycmp (hashtable, key, ptr_item->key) == 0))
+    key_hash = hashtable->callback_hash_key (hashtable, key);
+
+    /* during a rehash, the key may still be in the old htable */
+    if (hashtable->htable_old)
     {
-        return ptr_item;
+        ptr_item = hashtable_search_list (
+            hashtable,
+            hashtable->htable_old[key_hash % hashtable->size_old],
+            key, NULL);
+        if (ptr_item)
+        {
+            if (hash)
+                *hash = key_hash % hashtable->size_old;
+            return ptr_item;
+        }
     }
 
-    return NULL;
+    key_hash %= hashtable->size;
+    if (hash)
+        *hash = key_hash;
+
+    return hashtable_search_list (hashtable, hashtable->htable[key_hash],
+                                  key, NULL);
 }
 
 /*
@@ -580,6 +924,10 @@ hashtable_map (struct t_hashtable *hashtable,
     if (!hashtable)
         return;
 
+    /* items must not move during the map */
+    hashtable_rehash_step (hashtable, -1);
+    hashtable->map_running++;
+
     for (i = 0; i < hashtable->size; i++)
     {
         ptr_item = hashtable->htable[i];
@@ -595,6 +943,8 @@ hashtable_map (struct t_hashtable *hashtable,
             ptr_item = ptr_next_item;
         }
     }
+
+    hashtable->map_running--;
 }
 
 /*
@@ -614,6 +964,10 @@ hashtable_map_string (struct t_hashtable *hashtable,
     if (!hashtable)
         return;
 
+    /* items must not move during the map */
+    hashtable_rehash_step (hashtable, -1);
+    hashtable->map_running++;
+
     for (i = 0; i < hashtable->size; i++)
     {
         ptr_item = hashtable->htable[i];
@@ -642,6 +996,8 @@ hashtable_map_string (struct t_hashtable *hashtable,
             ptr_item = ptr_next_item;
         }
     }
+
+    hashtable->map_running--;
 }
 
 /*
@@ -1051,6 +1407,8 @@ hashtable_add_to_infolist (struct t_hashtable *hashtable,
     if (!hashtable || !infolist_item || !prefix)
         return 0;
 
+    hashtable_rehash_step (hashtable, -1);
+
     item_number = 0;
     for (i = 0; i < hashtable->size; i++)
     {
@@ -1208,8 +1566,17 @@ hashtable_remove_item (struct t_hashtable *hashtable,
         (item->prev_item)->next_item = item->next_item;
     if (item->next_item)
         (item->next_item)->prev_item = item->prev_item;
-    if (hashtable->htable[hash] == item)
+    if ((hash < (unsigned long long)hashtable->size)
+        && (hashtable->htable[hash] == item))
+    {
         hashtable->htable[hash] = item->next_item;
+    }
+    else if (hashtable->htable_old
+             && (hash < (unsigned long long)hashtable->size_old)
+             && (hashtable->htable_old[hash] == item))
+    {
+        hashtable->htable_old[hash] = item->next_item;
+    }
 
     free (item);
 
@@ -1246,6 +1613,21 @@ hashtable_remove_all (struct t_hashtable *hashtable)
     if (!hashtable)
         return;
 
+    if (hashtable->htable_old)
+    {
+        for (i = 0; i < hashtable->size_old; i++)
+        {
+            while (hashtable->htable_old[i])
+            {
+                hashtable_remove_item (hashtable, hashtable->htable_old[i], i);
+            }
+        }
+        free (hashtable->htable_old);
+        hashtable->htable_old = NULL;
+        hashtable->size_old = 0;
+        hashtable->rehash_index = 0;
+    }
+
     for (i = 0; i < hashtable->size; i++)
     {
         while (hashtable->htable[i])
@@ -1267,45 +1649,31 @@ hashtable_free (struct t_hashtable *hashtable)
 
     hashtable_remove_all (hashtable);
     free (hashtable->htable);
+    if (hashtable->htable_old)
+        free (hashtable->htable_old);
     if (hashtable->keys_values)
         free (hashtable->keys_values);
     free (hashtable);
 }
 
 /*
- * Prints hashtable in WeeChat log file (usually for crash dump).
+ * Prints items of a htable (array of linked lists) in WeeChat log file.
  */
 
 void
-hashtable_print_log (struct t_hashtable *hashtable, const char *name)
+hashtable_print_log_htable (struct t_hashtable *hashtable,
+                            struct t_hashtable_item **htable, int size,
+                            const char *name)
 {
     struct t_hashtable_item *ptr_item;
     int i;
 
-    log_printf ("");
-    log_printf ("[hashtable %s (addr:0x%lx)]", name, hashtable);
-    log_printf ("  size . . . . . . . . . : %d",    hashtable->size);
-    log_printf ("  htable . . . . . . . . : 0x%lx", hashtable->htable);
-    log_printf ("  items_count. . . . . . : %d",    hashtable->items_count);
-    log_printf ("  type_keys. . . . . . . : %d (%s)",
-                hashtable->type_keys,
-                hashtable_type_string[hashtable->type_keys]);
-    log_printf ("  type_values. . . . . . : %d (%s)",
-                hashtable->type_values,
-                hashtable_type_string[hashtable->type_values]);
-    log_printf ("  callback_hash_key. . . : 0x%lx", hashtable->callback_hash_key);
-    log_printf ("  callback_keycmp. . . . : 0x%lx", hashtable->callback_keycmp);
-    log_printf ("  callback_free_key. . . : 0x%lx", hashtable->callback_free_key);
-    log_printf ("  callback_free_value. . : 0x%lx", hashtable->callback_free_value);
-    log_printf ("  keys_values. . . . . . : '%s'",  hashtable->keys_values);
-
-    for (i = 0; i < hashtable->size; i++)
+    for (i = 0; i < size; i++)
     {
-        log_printf ("  htable[%06d] . . . . : 0x%lx", i, hashtable->htable[i]);
-        for (ptr_item = hashtable->htable[i]; ptr_item;
-             ptr_item = ptr_item->next_item)
+        log_printf ("  %s[%06d] . . . . : 0x%lx", name, i, htable[i]);
+        for (ptr_item = htable[i]; ptr_item; ptr_item = ptr_item->next_item)
         {
-            log_printf ("    [item 0x%lx]", hashtable->htable);
+            log_printf ("    [item 0x%lx]", ptr_item);
             switch (hashtable->type_keys)
             {
                 case HASHTABLE_INTEGER:
@@ -1353,3 +1721,47 @@ hashtable_print_log (struct t_hashtable *hashtable, const char *name)
         }
     }
 }
+
+/*
+ * Prints hashtable in WeeChat log file (usually for crash dump).
+ */
+
+void
+hashtable_print_log (struct t_hashtable *hashtable, const char *name)
+{
+    log_printf ("");
+    log_printf ("[hashtable %s (addr:0x%lx)]", name, hashtable);
+    log_printf ("  size . . . . . . . . . : %d",    hashtable->size);
+    log_printf ("  htable . . . . . . . . : 0x%lx", hashtable->htable);
+    log_printf ("  items_count. . . . . . : %d",    hashtable->items_count);
+    log_printf ("  htable_old . . . . . . : 0x%lx", hashtable->htable_old);
+    log_printf ("  size_old . . . . . . . : %d",    hashtable->size_old);
+    log_printf ("  rehash_index . . . . . : %d",    hashtable->rehash_index);
+    log_printf ("  map_running. . . . . . : %d",    hashtable->map_running);
+    log_printf ("  type_keys. . . . . . . : %d (%s)",
+                hashtable->type_keys,
+                hashtable_type_string[hashtable->type_keys]);
+    log_printf ("  type_values. . . . . . : %d (%s)",
+                hashtable->type_values,
+                hashtable_type_string[hashtable->type_values]);
+    log_printf ("  callback_hash_key. . . : 0x%lx", hashtable->callback_hash_key);
+    log_printf ("  callback_keycmp. . . . : 0x%lx", hashtable->callback_keycmp);
+    log_printf ("  callback_free_key. . . : 0x%lx", hashtable->callback_free_key);
+    log_printf ("  callback_free_value. . : 0x%lx", hashtable->callback_free_value);
+    log_printf ("  keys_values. . . . . . : '%s'",  hashtable->keys_values);
+
+    hashtable_print_log_htable (hashtable, hashtable->htable,
+                                hashtable->size, "htable");
+
+    /*
+     * during an incremental rehash, items not yet moved are in old htable
+     * (buckets before rehash_index are already moved)
+     */
+    if (hashtable->htable_old)
+    {
+        log_printf ("  rehash in progress . . : %d/%d buckets moved",
+                    hashtable->rehash_index, hashtable->size_old);
+        hashtable_print_log_htable (hashtable, hashtable->htable_old,
+                                    hashtable->size_old, "htable_old");
+    }
+}
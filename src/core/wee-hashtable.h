@@ -24,6 +24,15 @@ struct t_hashtable;
 struct t_infolist;
 struct t_infolist_item;
 
+/*
+ * The hashtable grows (size is doubled) when the number of items exceeds
+ * HASHTABLE_MAX_LOAD_FACTOR * size; the items are then moved incrementally
+ * to the new table: HASHTABLE_REHASH_BUCKETS buckets of the old table are
+ * moved on each set/get/remove, so there is no latency spike on big tables.
+ */
+#define HASHTABLE_MAX_LOAD_FACTOR 2
+#define HASHTABLE_REHASH_BUCKETS  4
+
 /*
  * Macros to set various values as string value in the hashtable;
  * variable hashtable must be defined and str_value must be a static
@@ -96,6 +105,11 @@ typedef void (t_hashtable_map_string)(void *data,
  * +-----+
  * |   7 | --> "weechat"
  * +-----+
+ *
+ * When the number of items becomes too high (see HASHTABLE_MAX_LOAD_FACTOR),
+ * a new htable with double size is allocated, the current one is kept in
+ * "htable_old" and its linked lists are moved step by step to the new htable.
+ * During this rehash, a key can be in any of the two tables.
  */
 
 enum t_hashtable_type
@@ -126,6 +140,15 @@ struct t_hashtable
                                        /* lists                             */
     int items_count;                   /* number of items in hashtable      */
 
+    /* incremental rehash (when hashtable is growing) */
+    struct t_hashtable_item **htable_old; /* previous htable, items are     */
+                                       /* moved to htable (NULL if no       */
+                                       /* rehash in progress)               */
+    int size_old;                      /* size of htable_old                */
+    int rehash_index;                  /* next bucket of htable_old to move */
+    int map_running;                   /* > 0 if hashtable_map is running   */
+                                       /* (no rehash during map)            */
+
     /* type for keys and values */
     enum t_hashtable_type type_keys;   /* type for keys: int/str/pointer    */
     enum t_hashtable_type type_values; /* type for values: int/str/pointer  */
@@ -142,6 +165,10 @@ struct t_hashtable
 };
 
 extern unsigned long long hashtable_hash_key_djb2 (const char *string);
+extern unsigned long long hashtable_hash_key_xxh64 (const void *data,
+                                                   int length);
+extern unsigned long long hashtable_hash_key_fast_cb (struct t_hashtable *hashtable,
+                                                      const void *key);
 extern struct t_hashtable *hashtable_new (int size,
                                           const char *type_keys,
                                           const char *type_values,
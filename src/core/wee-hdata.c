@@ -42,6 +42,20 @@ struct t_hashtable *hdata_search_pointers = NULL;
 struct t_hashtable *hdata_search_extra_vars = NULL;
 struct t_hashtable *hdata_search_options = NULL;
 
+/*
+ * pointers in lists, to check pointers without walking lists
+ * (key: address of list variable, value: hashtable with pointers as keys)
+ */
+struct t_hashtable *hdata_list_pointers = NULL;
+
+/*
+ * lists with an index of pointers built on demand (key: address of list
+ * variable, value: struct t_hdata_list_index), and first element of these
+ * lists (key: first element, value: address of list variable)
+ */
+struct t_hashtable *hdata_list_indexes = NULL;
+struct t_hashtable *hdata_list_first = NULL;
+
 char *hdata_type_string[9] =
 { "other", "char", "integer", "long", "string", "pointer", "time",
   "hashtable", "shared_string" };
@@ -436,6 +450,386 @@ hdata_get_list (struct t_hdata *hdata, const char *name)
     return NULL;
 }
 
+/*
+ * Hashes a pointer (objects are aligned in memory, so the low bits of
+ * address are mixed with higher bits).
+ */
+
+unsigned long long
+hdata_hash_key_pointer_cb (struct t_hashtable *hashtable, const void *key)
+{
+    unsigned long long hash;
+
+    /* make C compiler happy */
+    (void) hashtable;
+
+    hash = (unsigned long long)((unsigned long)key);
+
+    return hash ^ (hash >> 4) ^ (hash >> 16);
+}
+
+/*
+ * Frees pointers of a list (callback called when a list is removed from
+ * hashtable "hdata_list_pointers").
+ */
+
+void
+hdata_free_list_pointers (struct t_hashtable *hashtable,
+                          const void *key, void *value)
+{
+    /* make C compiler happy */
+    (void) hashtable;
+    (void) key;
+
+    hashtable_free ((struct t_hashtable *)value);
+}
+
+/*
+ * Frees an index of pointers built on demand (callback called when a list is
+ * removed from hashtable "hdata_list_indexes").
+ */
+
+void
+hdata_free_list_index (struct t_hashtable *hashtable,
+                       const void *key, void *value)
+{
+    struct t_hdata_list_index *ptr_index;
+
+    /* make C compiler happy */
+    (void) hashtable;
+    (void) key;
+
+    ptr_index = (struct t_hdata_list_index *)value;
+    if (!ptr_index)
+        return;
+
+    if (ptr_index->pointers)
+        hashtable_free (ptr_index->pointers);
+    free (ptr_index);
+}
+
+/*
+ * Updates first element of a list indexed on demand (in hashtable
+ * "hdata_list_first"), if it has changed.
+ */
+
+void
+hdata_list_index_set_first (void *list, struct t_hdata_list_index *index)
+{
+    void *first;
+
+    first = *((void **)list);
+    if (first == index->first)
+        return;
+
+    if (index->first
+        && (hashtable_get (hdata_list_first, index->first) == list))
+    {
+        hashtable_remove (hdata_list_first, index->first);
+    }
+    index->first = first;
+    if (first)
+        hashtable_set (hdata_list_first, first, list);
+}
+
+/*
+ * Declares a list with an index of pointers built on demand ("list" is the
+ * address of variable with the first element of list).
+ *
+ * The index is built by hdata_check_pointer on first check of a pointer with
+ * this list (the first element of list is given as "list" argument), then it
+ * is kept up to date by hdata_list_add_pointer and hdata_list_remove_pointer,
+ * which must be called for all elements added/removed in the list (with the
+ * list already updated). If many elements are changed at once, the function
+ * hdata_list_index_reset can be called instead.
+ *
+ * Function hdata_list_index_free must be called before the list variable is
+ * freed.
+ */
+
+void
+hdata_list_index_new (void *list)
+{
+    struct t_hdata_list_index *new_index;
+
+    if (!list)
+        return;
+
+    if (!hdata_list_indexes)
+    {
+        hdata_list_indexes = hashtable_new (32,
+                                            WEECHAT_HASHTABLE_POINTER,
+                                            WEECHAT_HASHTABLE_POINTER,
+                                            &hdata_hash_key_pointer_cb,
+                                            NULL);
+        if (!hdata_list_indexes)
+            return;
+        hdata_list_indexes->callback_free_value = &hdata_free_list_index;
+    }
+    if (!hdata_list_first)
+    {
+        hdata_list_first = hashtable_new (32,
+                                          WEECHAT_HASHTABLE_POINTER,
+                                          WEECHAT_HASHTABLE_POINTER,
+                                          &hdata_hash_key_pointer_cb,
+                                          NULL);
+        if (!hdata_list_first)
+            return;
+    }
+
+    new_index = malloc (sizeof (*new_index));
+    if (!new_index)
+        return;
+    new_index->hdata = NULL;
+    new_index->pointers = NULL;
+    new_index->first = NULL;
+
+    if (!hashtable_set (hdata_list_indexes, list, new_index))
+    {
+        free (new_index);
+        return;
+    }
+
+    hdata_list_index_set_first (list, new_index);
+}
+
+/*
+ * Resets index of pointers of a list indexed on demand: it will be built
+ * again on next check of a pointer.
+ */
+
+void
+hdata_list_index_reset (void *list)
+{
+    struct t_hdata_list_index *ptr_index;
+
+    if (!hdata_list_indexes || !list)
+        return;
+
+    ptr_index = hashtable_get (hdata_list_indexes, list);
+    if (!ptr_index)
+        return;
+
+    if (ptr_index->pointers)
+    {
+        hashtable_free (ptr_index->pointers);
+        ptr_index->pointers = NULL;
+    }
+    ptr_index->hdata = NULL;
+    hdata_list_index_set_first (list, ptr_index);
+}
+
+/*
+ * Frees index of pointers of a list indexed on demand.
+ */
+
+void
+hdata_list_index_free (void *list)
+{
+    struct t_hdata_list_index *ptr_index;
+
+    if (!hdata_list_indexes || !list)
+        return;
+
+    ptr_index = hashtable_get (hdata_list_indexes, list);
+    if (!ptr_index)
+        return;
+
+    if (ptr_index->first
+        && (hashtable_get (hdata_list_first, ptr_index->first) == list))
+    {
+        hashtable_remove (hdata_list_first, ptr_index->first);
+    }
+    hashtable_remove (hdata_list_indexes, list);
+}
+
+/*
+ * Adds a pointer in index of pointers of a list ("list" is the address of
+ * variable with the first element of list, as given to hdata_new_list).
+ *
+ * This function must be called for all elements added in the list, starting
+ * with the first one, and hdata_list_remove_pointer must be called for all
+ * elements removed from the list; then hdata_check_pointer does not walk the
+ * list any more to check a pointer.
+ *
+ * If memory is missing, the index is disabled for this list (pointers are
+ * then checked by walking the list).
+ */
+
+void
+hdata_list_add_pointer (void *list, void *pointer)
+{
+    struct t_hashtable *ptr_pointers;
+    struct t_hdata_list_index *ptr_index;
+
+    if (!list || !pointer)
+        return;
+
+    ptr_index = (hdata_list_indexes) ?
+        hashtable_get (hdata_list_indexes, list) : NULL;
+    if (ptr_index)
+    {
+        if (ptr_index->pointers
+            && !hashtable_set (ptr_index->pointers, pointer, NULL))
+        {
+            hdata_list_index_reset (list);
+        }
+        hdata_list_index_set_first (list, ptr_index);
+        return;
+    }
+
+    if (!hdata_list_pointers)
+    {
+        hdata_list_pointers = hashtable_new (32,
+                                             WEECHAT_HASHTABLE_POINTER,
+                                             WEECHAT_HASHTABLE_POINTER,
+                                             NULL,
+                                             NULL);
+        if (!hdata_list_pointers)
+            return;
+        hdata_list_pointers->callback_free_value = &hdata_free_list_pointers;
+    }
+
+    ptr_pointers = hashtable_get (hdata_list_pointers, list);
+    if (!ptr_pointers)
+    {
+        /* index disabled for this list? */
+        if (hashtable_has_key (hdata_list_pointers, list))
+            return;
+        ptr_pointers = hashtable_new (32,
+                                      WEECHAT_HASHTABLE_POINTER,
+                                      WEECHAT_HASHTABLE_POINTER,
+                                      &hdata_hash_key_pointer_cb,
+                                      NULL);
+        if (!ptr_pointers)
+        {
+            hashtable_set (hdata_list_pointers, list, NULL);
+            return;
+        }
+        hashtable_set (hdata_list_pointers, list, ptr_pointers);
+    }
+
+    if (!hashtable_set (ptr_pointers, pointer, NULL))
+    {
+        /* index is incomplete: disable it for this list */
+        hashtable_set (hdata_list_pointers, list, NULL);
+    }
+}
+
+/*
+ * Removes a pointer from index of pointers of a list.
+ */
+
+void
+hdata_list_remove_pointer (void *list, void *pointer)
+{
+    struct t_hashtable *ptr_pointers;
+    struct t_hdata_list_index *ptr_index;
+
+    if (!list || !pointer)
+        return;
+
+    ptr_index = (hdata_list_indexes) ?
+        hashtable_get (hdata_list_indexes, list) : NULL;
+    if (ptr_index)
+    {
+        if (ptr_index->pointers)
+            hashtable_remove (ptr_index->pointers, pointer);
+        hdata_list_index_set_first (list, ptr_index);
+        return;
+    }
+
+    if (!hdata_list_pointers)
+        return;
+
+    ptr_pointers = hashtable_get (hdata_list_pointers, list);
+    if (ptr_pointers)
+        hashtable_remove (ptr_pointers, pointer);
+}
+
+/*
+ * Searches a pointer in index of pointers of a list.
+ *
+ * Returns:
+ *    1: pointer is in list
+ *    0: pointer is not in list
+ *   -1: no index of pointers for this list (the list must be walked)
+ */
+
+int
+hdata_list_search_pointer (void *list, void *pointer)
+{
+    struct t_hashtable *ptr_pointers;
+
+    if (!hdata_list_pointers || !list)
+        return -1;
+
+    ptr_pointers = hashtable_get (hdata_list_pointers, list);
+    if (!ptr_pointers)
+        return -1;
+
+    return (pointer && hashtable_has_key (ptr_pointers, pointer)) ? 1 : 0;
+}
+
+/*
+ * Searches a pointer in index of pointers of a list indexed on demand, with
+ * the first element of list ("first"); the index is built if needed.
+ *
+ * Returns:
+ *    1: pointer is in list
+ *    0: pointer is not in list
+ *   -1: no index of pointers for this list (the list must be walked)
+ */
+
+int
+hdata_list_index_search (struct t_hdata *hdata, void *first, void *pointer)
+{
+    struct t_hdata_list_index *ptr_index;
+    struct t_hashtable *pointers;
+    void *list, *ptr_current;
+
+    if (!hdata_list_first || !first)
+        return -1;
+
+    list = hashtable_get (hdata_list_first, first);
+    if (!list || (*((void **)list) != first))
+        return -1;
+
+    ptr_index = hashtable_get (hdata_list_indexes, list);
+    if (!ptr_index)
+        return -1;
+
+    if (!ptr_index->pointers)
+    {
+        pointers = hashtable_new (32,
+                                  WEECHAT_HASHTABLE_POINTER,
+                                  WEECHAT_HASHTABLE_POINTER,
+                                  &hdata_hash_key_pointer_cb,
+                                  NULL);
+        if (!pointers)
+            return -1;
+        for (ptr_current = first; ptr_current;
+             ptr_current = hdata_move (hdata, ptr_current, 1))
+        {
+            if (!hashtable_set (pointers, ptr_current, NULL))
+            {
+                hashtable_free (pointers);
+                return -1;
+            }
+        }
+        ptr_index->hdata = hdata;
+        ptr_index->pointers = pointers;
+    }
+    else if (ptr_index->hdata != hdata)
+    {
+        /* index was built with another hdata: walk the list */
+        return -1;
+    }
+
+    return (pointer && hashtable_has_key (ptr_index->pointers, pointer)) ?
+        1 : 0;
+}
+
 /*
  * Checks if a pointer is in the list.
  *
@@ -466,6 +860,32 @@ hdata_check_pointer_in_list (struct t_hdata *hdata, void *list, void *pointer)
     return 0;
 }
 
+/*
+ * Searches index of pointers for a list of hdata with this first element.
+ */
+
+void
+hdata_search_list_pointers_map_cb (void *data, struct t_hashtable *hashtable,
+                                   const void *key, const void *value)
+{
+    void **pointers;
+    struct t_hdata_list *ptr_list;
+
+    /* make C compiler happy */
+    (void) hashtable;
+    (void) key;
+
+    pointers = (void **)data;
+
+    /* index already found for another list? just exit */
+    if (pointers[1])
+        return;
+
+    ptr_list = (struct t_hdata_list *)value;
+    if (ptr_list && (*((void **)(ptr_list->pointer)) == pointers[0]))
+        pointers[1] = hashtable_get (hdata_list_pointers, ptr_list->pointer);
+}
+
 /*
  * Checks if a pointer is in a list with flag "check_pointers".
  */
@@ -477,6 +897,7 @@ hdata_check_pointer_map_cb (void *data, struct t_hashtable *hashtable,
     void **pointers, *pointer, **num_lists, **found;
     struct t_hdata *ptr_hdata;
     struct t_hdata_list *ptr_list;
+    int rc;
 
     /* make C compiler happy */
     (void) hashtable;
@@ -496,10 +917,14 @@ hdata_check_pointer_map_cb (void *data, struct t_hashtable *hashtable,
     if (!ptr_list || !(ptr_list->flags & WEECHAT_HDATA_LIST_CHECK_POINTERS))
         return;
 
-    *found = (void *)((unsigned long)hdata_check_pointer_in_list (
-                          ptr_hdata,
-                          *((void **)(ptr_list->pointer)),
-                          pointer));
+    rc = hdata_list_search_pointer (ptr_list->pointer, pointer);
+    if (rc < 0)
+    {
+        rc = hdata_check_pointer_in_list (ptr_hdata,
+                                          *((void **)(ptr_list->pointer)),
+                                          pointer);
+    }
+    *found = (void *)((unsigned long)rc);
     (*num_lists)++;
 }
 
@@ -511,6 +936,9 @@ hdata_check_pointer_map_cb (void *data, struct t_hashtable *hashtable,
  * the pointer is considered valid (so this function returns 1); if the
  * pointer is not found in any list, this function returns 0.
  *
+ * Lists with an index of pointers (see functions hdata_list_add_pointer and
+ * hdata_list_index_new) are not walked: the pointer is searched in the index.
+ *
  * Returns:
  *   1: pointer exists in the given list (or a list with check_pointers flag)
  *   0: pointer does not exist
@@ -520,12 +948,36 @@ int
 hdata_check_pointer (struct t_hdata *hdata, void *list, void *pointer)
 {
     void *pointers[4];
+    int rc;
 
     if (!hdata || !pointer)
         return 0;
 
     if (list)
     {
+        if (pointer == list)
+            return 1;
+
+        /* use index of pointers if list is the start of a list of hdata */
+        if (hdata_list_pointers)
+        {
+            pointers[0] = list;
+            pointers[1] = NULL;  /* index of pointers found for list */
+            hashtable_map (hdata->hash_list,
+                           &hdata_search_list_pointers_map_cb,
+                           pointers);
+            if (pointers[1])
+            {
+                return hashtable_has_key ((struct t_hashtable *)pointers[1],
+                                          pointer);
+            }
+        }
+
+        /* use index of pointers if list is indexed on demand */
+        rc = hdata_list_index_search (hdata, list, pointer);
+        if (rc >= 0)
+            return rc;
+
         /* search pointer in the given list */
         return hdata_check_pointer_in_list (hdata, list, pointer);
     }
@@ -1349,4 +1801,19 @@ hdata_end ()
         hashtable_free (hdata_search_options);
         hdata_search_options = NULL;
     }
+    if (hdata_list_pointers)
+    {
+        hashtable_free (hdata_list_pointers);
+        hdata_list_pointers = NULL;
+    }
+    if (hdata_list_indexes)
+    {
+        hashtable_free (hdata_list_indexes);
+        hdata_list_indexes = NULL;
+    }
+    if (hdata_list_first)
+    {
+        hashtable_free (hdata_list_first);
+        hdata_list_first = NULL;
+    }
 }
@@ -45,6 +45,14 @@ struct t_hdata_list
     int flags;                         /* flags for list                    */
 };
 
+struct t_hdata_list_index
+{
+    struct t_hdata *hdata;             /* hdata used to build the index     */
+    struct t_hashtable *pointers;      /* pointers in list (NULL if index   */
+                                       /* is not built)                     */
+    void *first;                       /* first element of list             */
+};
+
 struct t_hdata
 {
     char *name;                        /* name of hdata                     */
@@ -105,6 +113,12 @@ extern void *hdata_get_var (struct t_hdata *hdata, void *pointer,
 extern void *hdata_get_var_at_offset (struct t_hdata *hdata, void *pointer,
                                       int offset);
 extern void *hdata_get_list (struct t_hdata *hdata, const char *name);
+extern void hdata_list_add_pointer (void *list, void *pointer);
+extern void hdata_list_remove_pointer (void *list, void *pointer);
+extern int hdata_list_search_pointer (void *list, void *pointer);
+extern void hdata_list_index_new (void *list);
+extern void hdata_list_index_reset (void *list);
+extern void hdata_list_index_free (void *list);
 extern int hdata_check_pointer (struct t_hdata *hdata, void *list,
                                 void *pointer);
 extern void *hdata_move (struct t_hdata *hdata, void *pointer, int count);
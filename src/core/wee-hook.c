@@ -32,6 +32,7 @@
 
 #include "weechat.h"
 #include "wee-hook.h"
+#include "wee-arraylist.h"
 #include "wee-hashtable.h"
 #include "wee-infolist.h"
 #include "wee-log.h"
@@ -54,12 +55,16 @@ int real_delete_pending = 0;           /* 1 if some hooks must be deleted   */
 
 int hook_socketpair_ok = 0;            /* 1 if socketpair() is OK           */
 
+unsigned long long hook_order = 0;     /* creation order for next hook      */
+
 /* hook callbacks */
 t_callback_hook *hook_callback_add[HOOK_NUM_TYPES] =
-{ NULL, NULL, NULL, &hook_fd_add_cb, NULL, NULL, NULL, NULL, NULL, NULL,
-  NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL };
+{ NULL, NULL, &hook_timer_add_cb, &hook_fd_add_cb, NULL, NULL, NULL,
+  &hook_print_add_cb, &hook_signal_add_cb, &hook_hsignal_add_cb, NULL, NULL,
+  NULL, NULL, NULL, NULL, NULL, NULL };
 t_callback_hook *hook_callback_remove[HOOK_NUM_TYPES] =
-{ NULL, NULL, NULL, &hook_fd_remove_cb, NULL, NULL, NULL, NULL, NULL, NULL,
+{ NULL, NULL, &hook_timer_remove_cb, &hook_fd_remove_cb, NULL, NULL, NULL,
+  &hook_print_remove_cb, &hook_signal_remove_cb, &hook_hsignal_remove_cb,
   NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL };
 t_callback_hook *hook_callback_free_data[HOOK_NUM_TYPES] =
 { &hook_command_free_data, &hook_command_run_free_data,
@@ -387,6 +392,7 @@ hook_init_data (struct t_hook *hook, struct t_weechat_plugin *plugin,
     hook->deleted = 0;
     hook->running = 0;
     hook->priority = priority;
+    hook->order = hook_order++;
     hook->callback_pointer = callback_pointer;
     hook->callback_data = callback_data;
     hook->hook_data = NULL;
@@ -403,6 +409,317 @@ hook_init_data (struct t_hook *hook, struct t_weechat_plugin *plugin,
     }
 }
 
+/*
+ * Compares two hooks in an index: same order as the list of hooks (by
+ * priority, then creation order).
+ */
+
+int
+hook_index_cmp_cb (void *data, struct t_arraylist *arraylist,
+                   void *pointer1, void *pointer2)
+{
+    struct t_hook *hook1, *hook2;
+
+    /* make C compiler happy */
+    (void) data;
+    (void) arraylist;
+
+    hook1 = (struct t_hook *)pointer1;
+    hook2 = (struct t_hook *)pointer2;
+
+    if (hook1->priority != hook2->priority)
+        return (hook1->priority > hook2->priority) ? -1 : 1;
+    if (hook1->order != hook2->order)
+        return (hook1->order < hook2->order) ? -1 : 1;
+    return 0;
+}
+
+/*
+ * Hashes a name in an index (case insensitive, only for ASCII chars).
+ */
+
+unsigned long long
+hook_index_hash_key_cb (struct t_hashtable *hashtable, const void *key)
+{
+    const char *ptr_key;
+    unsigned long long hash;
+    int c;
+
+    /* make C compiler happy */
+    (void) hashtable;
+
+    /* variant of djb2 hash, with lower case chars */
+    hash = 5381;
+    for (ptr_key = (const char *)key; ptr_key[0]; ptr_key++)
+    {
+        c = (unsigned char)ptr_key[0];
+        if ((c >= 'A') && (c <= 'Z'))
+            c += ('a' - 'A');
+        hash ^= (hash << 5) + (hash >> 2) + c;
+    }
+
+    return hash;
+}
+
+/*
+ * Compares two names in an index (case insensitive).
+ */
+
+int
+hook_index_keycmp_cb (struct t_hashtable *hashtable,
+                      const void *key1, const void *key2)
+{
+    /* make C compiler happy */
+    (void) hashtable;
+
+    return string_strcasecmp ((const char *)key1, (const char *)key2);
+}
+
+/*
+ * Frees a list of hooks in the hashtable of an index.
+ */
+
+void
+hook_index_free_value_cb (struct t_hashtable *hashtable,
+                          const void *key, void *value)
+{
+    /* make C compiler happy */
+    (void) hashtable;
+    (void) key;
+
+    arraylist_free ((struct t_arraylist *)value);
+}
+
+/*
+ * Creates a new index of hooks by name.
+ *
+ * Returns pointer to new index, NULL if error.
+ */
+
+struct t_hook_index *
+hook_index_new (t_callback_hook_index_name *callback_name)
+{
+    struct t_hook_index *new_index;
+
+    if (!callback_name)
+        return NULL;
+
+    new_index = malloc (sizeof (*new_index));
+    if (!new_index)
+        return NULL;
+
+    new_index->names = hashtable_new (64,
+                                      WEECHAT_HASHTABLE_STRING,
+                                      WEECHAT_HASHTABLE_POINTER,
+                                      &hook_index_hash_key_cb,
+                                      &hook_index_keycmp_cb);
+    new_index->masks = arraylist_new (8, 1, 0,
+                                      &hook_index_cmp_cb, NULL, NULL, NULL);
+    if (!new_index->names || !new_index->masks)
+    {
+        hook_index_free (new_index);
+        return NULL;
+    }
+    new_index->names->callback_free_value = &hook_index_free_value_cb;
+    new_index->callback_name = callback_name;
+
+    return new_index;
+}
+
+/*
+ * Checks if a hook name is a mask in an index: names with a wildcard or
+ * non-ASCII chars are compared with string_match (non-ASCII chars can not
+ * be hashed the case insensitive way).
+ *
+ * Returns:
+ *   1: name is a mask
+ *   0: name is an exact name
+ */
+
+int
+hook_index_name_is_mask (const char *name)
+{
+    const char *ptr_name;
+
+    for (ptr_name = name; ptr_name[0]; ptr_name++)
+    {
+        if ((ptr_name[0] == '*') || ((unsigned char)ptr_name[0] >= 128))
+            return 1;
+    }
+    return 0;
+}
+
+/*
+ * Adds a hook in an index.
+ *
+ * Returns:
+ *   1: OK
+ *   0: error
+ */
+
+int
+hook_index_add (struct t_hook_index *index, struct t_hook *hook)
+{
+    struct t_arraylist *ptr_hooks;
+    const char *name;
+
+    if (!index || !hook)
+        return 0;
+
+    name = (index->callback_name) (hook);
+    if (!name)
+        return 0;
+
+    if (hook_index_name_is_mask (name))
+        return (arraylist_add (index->masks, hook) >= 0) ? 1 : 0;
+
+    ptr_hooks = hashtable_get (index->names, name);
+    if (!ptr_hooks)
+    {
+        ptr_hooks = arraylist_new (4, 1, 0,
+                                   &hook_index_cmp_cb, NULL, NULL, NULL);
+        if (!ptr_hooks)
+            return 0;
+        if (!hashtable_set (index->names, name, ptr_hooks))
+        {
+            arraylist_free (ptr_hooks);
+            return 0;
+        }
+    }
+
+    return (arraylist_add (ptr_hooks, hook) >= 0) ? 1 : 0;
+}
+
+/*
+ * Removes a hook from an index.
+ */
+
+void
+hook_index_remove (struct t_hook_index *index, struct t_hook *hook)
+{
+    struct t_arraylist *ptr_hooks;
+    const char *name;
+    int index_hook;
+
+    if (!index || !hook)
+        return;
+
+    name = (index->callback_name) (hook);
+    if (!name)
+        return;
+
+    if (hook_index_name_is_mask (name))
+    {
+        if (arraylist_search (index->masks, hook, &index_hook, NULL))
+            arraylist_remove (index->masks, index_hook);
+        return;
+    }
+
+    ptr_hooks = hashtable_get (index->names, name);
+    if (!ptr_hooks)
+        return;
+    if (arraylist_search (ptr_hooks, hook, &index_hook, NULL))
+        arraylist_remove (ptr_hooks, index_hook);
+    if (arraylist_size (ptr_hooks) == 0)
+        hashtable_remove (index->names, name);
+}
+
+/*
+ * Gets hooks matching a name in an index, sorted like the list of hooks
+ * (by priority, then creation order).
+ *
+ * Hooks are stored in array "hooks" (with "size" elements) if it is large
+ * enough, otherwise a new array is allocated (and must be freed by caller
+ * if different from "hooks").
+ *
+ * Returns pointer to array with hooks, NULL if error.
+ */
+
+struct t_hook **
+hook_index_match (struct t_hook_index *index, const char *name,
+                  struct t_hook **hooks, int size, int *num_hooks)
+{
+    struct t_arraylist *ptr_hooks;
+    struct t_hook **result, **new_result, *hook_name, *hook_mask;
+    int count, size_names, size_masks, index_names, index_masks;
+
+    if (num_hooks)
+        *num_hooks = 0;
+
+    if (!index || !name || !hooks || !num_hooks)
+        return NULL;
+
+    ptr_hooks = hashtable_get (index->names, name);
+    size_names = (ptr_hooks) ? arraylist_size (ptr_hooks) : 0;
+    size_masks = arraylist_size (index->masks);
+
+    result = hooks;
+    count = 0;
+    index_names = 0;
+    index_masks = 0;
+
+    /* merge the two sorted lists, keeping only masks matching the name */
+    while ((index_names < size_names) || (index_masks < size_masks))
+    {
+        hook_name = (index_names < size_names) ?
+            (struct t_hook *)arraylist_get (ptr_hooks, index_names) : NULL;
+        hook_mask = (index_masks < size_masks) ?
+            (struct t_hook *)arraylist_get (index->masks, index_masks) : NULL;
+        if (hook_name
+            && (!hook_mask
+                || (hook_index_cmp_cb (NULL, NULL, hook_name, hook_mask) < 0)))
+        {
+            index_names++;
+        }
+        else
+        {
+            index_masks++;
+            if (!string_match (name, (index->callback_name) (hook_mask), 0))
+                continue;
+            hook_name = hook_mask;
+        }
+        if (count >= size)
+        {
+            size = (size > 0) ? size * 2 : 16;
+            new_result = (result == hooks) ?
+                malloc (size * sizeof (*new_result)) :
+                realloc (result, size * sizeof (*new_result));
+            if (!new_result)
+            {
+                if (result != hooks)
+                    free (result);
+                return NULL;
+            }
+            if (result == hooks)
+                memcpy (new_result, hooks, count * sizeof (*new_result));
+            result = new_result;
+        }
+        result[count++] = hook_name;
+    }
+
+    *num_hooks = count;
+
+    return result;
+}
+
+/*
+ * Frees an index of hooks.
+ */
+
+void
+hook_index_free (struct t_hook_index *index)
+{
+    if (!index)
+        return;
+
+    if (index->names)
+        hashtable_free (index->names);
+    if (index->masks)
+        arraylist_free (index->masks);
+
+    free (index);
+}
+
 /*
  * Checks if a hook pointer is valid.
  *
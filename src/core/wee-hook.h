@@ -46,6 +46,7 @@ struct t_gui_line;
 struct t_gui_completion;
 struct t_gui_window;
 struct t_weelist;
+struct t_arraylist;
 struct t_hashtable;
 struct t_infolist;
 struct t_infolist_item;
@@ -85,6 +86,7 @@ enum t_hook_type
 typedef void (t_callback_hook)(struct t_hook *hook);
 typedef int (t_callback_hook_infolist)(struct t_infolist_item *item,
                                        struct t_hook *hook);
+typedef const char *(t_callback_hook_index_name)(struct t_hook *hook);
 
 struct t_hook
 {
@@ -99,6 +101,8 @@ struct t_hook
     int deleted;                       /* hook marked for deletion ?        */
     int running;                       /* 1 if hook is currently running    */
     int priority;                      /* priority (to sort hooks)          */
+    unsigned long long order;          /* creation order (to sort hooks     */
+                                       /* with same priority)               */
     const void *callback_pointer;      /* pointer sent to callback          */
     void *callback_data;               /* data sent to callback             */
 
@@ -108,6 +112,21 @@ struct t_hook
     struct t_hook *next_hook;          /* link to next hook                 */
 };
 
+/*
+ * index of hooks by name (used by signal and hsignal hooks): hooks with
+ * a name without wildcard are stored in a hashtable (key is the name, case
+ * insensitive), and hooks with a mask are stored in a separate list;
+ * each list of hooks is sorted like the list of hooks (by priority, then
+ * creation order)
+ */
+
+struct t_hook_index
+{
+    struct t_hashtable *names;         /* name -> hooks (arraylist)         */
+    struct t_arraylist *masks;         /* hooks with a mask (wildcard)      */
+    t_callback_hook_index_name *callback_name; /* get name/mask of a hook   */
+};
+
 /* hook variables */
 
 extern char *hook_type_string[];
@@ -127,6 +146,24 @@ extern void hook_init_data (struct t_hook *hook,
                             struct t_weechat_plugin *plugin,
                             int type, int priority,
                             const void *callback_pointer, void *callback_data);
+extern int hook_index_cmp_cb (void *data, struct t_arraylist *arraylist,
+                              void *pointer1, void *pointer2);
+extern unsigned long long hook_index_hash_key_cb (struct t_hashtable *hashtable,
+                                                  const void *key);
+extern int hook_index_keycmp_cb (struct t_hashtable *hashtable,
+                                 const void *key1, const void *key2);
+extern void hook_index_free_value_cb (struct t_hashtable *hashtable,
+                                      const void *key, void *value);
+extern int hook_index_name_is_mask (const char *name);
+extern struct t_hook_index *hook_index_new (t_callback_hook_index_name *callback_name);
+extern int hook_index_add (struct t_hook_index *index, struct t_hook *hook);
+extern void hook_index_remove (struct t_hook_index *index,
+                               struct t_hook *hook);
+extern struct t_hook **hook_index_match (struct t_hook_index *index,
+                                         const char *name,
+                                         struct t_hook **hooks, int size,
+                                         int *num_hooks);
+extern void hook_index_free (struct t_hook_index *index);
 extern int hook_valid (struct t_hook *hook);
 extern void hook_exec_start ();
 extern void hook_exec_end ();
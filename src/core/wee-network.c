@@ -46,6 +46,8 @@
 #include <netdb.h>
 #include <resolv.h>
 #include <errno.h>
+#include <signal.h>
+#include <pthread.h>
 #include <gcrypt.h>
 #include <sys/time.h>
 #if defined(__OpenBSD__)
@@ -68,6 +70,21 @@ int network_init_gnutls_ok = 0;
 
 gnutls_certificate_credentials_t gnutls_xcred; /* GnuTLS client credentials */
 
+/* names resolved in threads (connections without fork) */
+pthread_mutex_t network_resolve_mutex = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t network_resolve_cond = PTHREAD_COND_INITIALIZER;
+struct t_network_resolve *network_resolve_queue = NULL;
+struct t_network_resolve *last_network_resolve_queue = NULL;
+struct t_network_resolve *network_resolve_started = NULL;
+struct t_network_resolve *last_network_resolve_started = NULL;
+struct t_network_resolve *network_resolve_done = NULL;
+struct t_network_resolve *last_network_resolve_done = NULL;
+int network_resolve_threads = 0;       /* number of running threads         */
+int network_resolve_threads_idle = 0;  /* threads waiting for a resolution  */
+int network_resolve_quit = 0;          /* 1 if threads must exit            */
+int network_resolve_pipe[2] = { -1, -1 }; /* pipe to wake up main thread    */
+struct t_hook *network_resolve_hook_fd = NULL; /* fd hook on pipe           */
+
 
 /*
  * Initializes gcrypt.
@@ -146,6 +163,8 @@ network_init_gnutls ()
 void
 network_end ()
 {
+    network_resolve_end ();
+
     if (network_init_gnutls_ok)
     {
         if (!weechat_no_gnutls)
@@ -733,6 +752,181 @@ error:
     return -1;
 }
 
+/*
+ * Builds the list of addresses to try to connect to a peer, using addresses
+ * returned by getaddrinfo.
+ *
+ * Addresses are grouped by family, for example:
+ *   0 = [2001:db8::1, 2001:db8::2,
+ *   1 =  192.0.2.1, 192.0.2.2,
+ *   2 =  2002:c000:201::1, 2002:c000:201::2]
+ *
+ * The argument "retry" indicates that something is wrong with whichever group
+ * of servers is being tried first after connecting, so groups are rotated to
+ * start at a different offset and increase the chance of success; addresses
+ * are shuffled in each group.
+ *
+ * Returns the number of addresses in "*addresses" (array must be freed after
+ * use), 0 if no IP address is found, -1 if error.
+ */
+
+int
+network_sort_addresses (struct addrinfo *res, int retry,
+                        struct addrinfo ***addresses)
+{
+    struct addrinfo *ptr_res, **res_reorder;
+    int last_af, num_groups, tmp_num_groups, num_hosts, tmp_host;
+    int i, rand_num;
+
+    *addresses = NULL;
+
+    /* count all the groups of hosts by tracking family */
+    last_af = AF_UNSPEC;
+    num_groups = 0;
+    num_hosts = 0;
+    for (ptr_res = res; ptr_res; ptr_res = ptr_res->ai_next)
+    {
+        if (ptr_res->ai_family != last_af)
+            if (last_af != AF_UNSPEC)
+                num_groups++;
+
+        num_hosts++;
+        last_af = ptr_res->ai_family;
+    }
+    if (last_af != AF_UNSPEC)
+        num_groups++;
+
+    /* no IP addresses found (all AF_UNSPEC) */
+    if (num_groups == 0)
+        return 0;
+
+    res_reorder = malloc (sizeof (*res_reorder) * num_hosts);
+    if (!res_reorder)
+        return -1;
+
+    /* reorder groups */
+    retry %= num_groups;
+    i = 0;
+
+    last_af = AF_UNSPEC;
+    tmp_num_groups = 0;
+    tmp_host = i; /* start of current group */
+
+    /* top of list */
+    for (ptr_res = res; ptr_res; ptr_res = ptr_res->ai_next)
+    {
+        if (ptr_res->ai_family != last_af)
+        {
+            if (last_af != AF_UNSPEC)
+                tmp_num_groups++;
+
+            tmp_host = i;
+        }
+
+        if (tmp_num_groups >= retry)
+        {
+            /* shuffle while adding */
+            rand_num = tmp_host + (rand () % ((i + 1) - tmp_host));
+            if (rand_num == i)
+                res_reorder[i++] = ptr_res;
+            else
+            {
+                res_reorder[i++] = res_reorder[rand_num];
+                res_reorder[rand_num] = ptr_res;
+            }
+        }
+
+        last_af = ptr_res->ai_family;
+    }
+
+    last_af = AF_UNSPEC;
+    tmp_num_groups = 0;
+    tmp_host = i; /* start of current group */
+
+    /* remainder of list */
+    for (ptr_res = res; ptr_res; ptr_res = ptr_res->ai_next)
+    {
+        if (ptr_res->ai_family != last_af)
+        {
+            if (last_af != AF_UNSPEC)
+                tmp_num_groups++;
+
+            tmp_host = i;
+        }
+
+        if (tmp_num_groups < retry)
+        {
+            /* shuffle while adding */
+            rand_num = tmp_host + (rand () % ((i + 1) - tmp_host));
+            if (rand_num == i)
+                res_reorder[i++] = ptr_res;
+            else
+            {
+                res_reorder[i++] = res_reorder[rand_num];
+                res_reorder[rand_num] = ptr_res;
+            }
+        }
+        else
+            break;
+
+        last_af = ptr_res->ai_family;
+    }
+
+    *addresses = res_reorder;
+
+    return i;
+}
+
+/*
+ * Interleaves families of addresses (for example IPv6 and IPv4), as
+ * recommended by "Happy Eyeballs" (RFC 8305): the family of first address
+ * is kept first, then families are alternated.
+ */
+
+void
+network_interleave_addresses (struct addrinfo **addresses, int num_addresses)
+{
+    struct addrinfo **sorted;
+    int i, first_family, index_first, index_other;
+
+    if (!addresses || (num_addresses < 3))
+        return;
+
+    sorted = malloc (sizeof (*sorted) * num_addresses);
+    if (!sorted)
+        return;
+
+    first_family = addresses[0]->ai_family;
+    index_first = 0;
+    index_other = 0;
+    for (i = 0; i < num_addresses; i++)
+    {
+        while ((index_first < num_addresses)
+               && (addresses[index_first]->ai_family != first_family))
+        {
+            index_first++;
+        }
+        while ((index_other < num_addresses)
+               && (addresses[index_other]->ai_family == first_family))
+        {
+            index_other++;
+        }
+        if ((index_first < num_addresses)
+            && (((i % 2) == 0) || (index_other >= num_addresses)))
+        {
+            sorted[i] = addresses[index_first++];
+        }
+        else
+        {
+            sorted[i] = addresses[index_other++];
+        }
+    }
+
+    memcpy (addresses, sorted, sizeof (*sorted) * num_addresses);
+
+    free (sorted);
+}
+
 /*
  * Connects to peer in a child process.
  */
@@ -754,15 +948,8 @@ network_connect_child (struct t_hook *hook_connect)
     char msg_buf[CMSG_SPACE(sizeof (sock))];
     struct iovec iov[1];
     char iov_data[1] = { 0 };
-    /*
-     * indicates that something is wrong with whichever group of
-     * servers is being tried first after connecting, so start at
-     * a different offset to increase the chance of success
-     */
-    int retry, rand_num, i;
-    int num_groups, tmp_num_groups, num_hosts, tmp_host;
+    int num_hosts, i;
     struct addrinfo **res_reorder;
-    int last_af;
     struct timeval tv_time;
 
     res_local = NULL;
@@ -918,29 +1105,10 @@ network_connect_child (struct t_hook *hook_connect)
 
     /* res_local != NULL now indicates that bind() is required */
 
-    /*
-     * count all the groups of hosts by tracking family, e.g.
-     * 0 = [2001:db8::1, 2001:db8::2,
-     * 1 =  192.0.2.1, 192.0.2.2,
-     * 2 =  2002:c000:201::1, 2002:c000:201::2]
-     */
-    last_af = AF_UNSPEC;
-    num_groups = 0;
-    num_hosts = 0;
-    for (ptr_res = res_remote; ptr_res; ptr_res = ptr_res->ai_next)
-    {
-        if (ptr_res->ai_family != last_af)
-            if (last_af != AF_UNSPEC)
-                num_groups++;
-
-        num_hosts++;
-        last_af = ptr_res->ai_family;
-    }
-    if (last_af != AF_UNSPEC)
-        num_groups++;
-
-    res_reorder = malloc (sizeof (*res_reorder) * num_hosts);
-    if (!res_reorder)
+    num_hosts = network_sort_addresses (res_remote,
+                                        HOOK_CONNECT(hook_connect, retry),
+                                        &res_reorder);
+    if (num_hosts < 0)
     {
         snprintf (status_without_string, sizeof (status_without_string),
                   "%c00000", '0' + WEECHAT_HOOK_CONNECT_MEMORY_ERROR);
@@ -949,79 +1117,7 @@ network_connect_child (struct t_hook *hook_connect)
         (void) num_written;
         goto end;
     }
-
-    /* reorder groups */
-    retry = HOOK_CONNECT(hook_connect, retry);
-    if (num_groups > 0)
-    {
-        retry %= num_groups;
-        i = 0;
-
-        last_af = AF_UNSPEC;
-        tmp_num_groups = 0;
-        tmp_host = i; /* start of current group */
-
-        /* top of list */
-        for (ptr_res = res_remote; ptr_res; ptr_res = ptr_res->ai_next)
-        {
-            if (ptr_res->ai_family != last_af)
-            {
-                if (last_af != AF_UNSPEC)
-                    tmp_num_groups++;
-
-                tmp_host = i;
-            }
-
-            if (tmp_num_groups >= retry)
-            {
-                /* shuffle while adding */
-                rand_num = tmp_host + (rand () % ((i + 1) - tmp_host));
-                if (rand_num == i)
-                    res_reorder[i++] = ptr_res;
-                else
-                {
-                    res_reorder[i++] = res_reorder[rand_num];
-                    res_reorder[rand_num] = ptr_res;
-                }
-            }
-
-            last_af = ptr_res->ai_family;
-        }
-
-        last_af = AF_UNSPEC;
-        tmp_num_groups = 0;
-        tmp_host = i; /* start of current group */
-
-        /* remainder of list */
-        for (ptr_res = res_remote; ptr_res; ptr_res = ptr_res->ai_next)
-        {
-            if (ptr_res->ai_family != last_af)
-            {
-                if (last_af != AF_UNSPEC)
-                    tmp_num_groups++;
-
-                tmp_host = i;
-            }
-
-            if (tmp_num_groups < retry)
-            {
-                /* shuffle while adding */
-                rand_num = tmp_host + (rand () % ((i + 1) - tmp_host));
-                if (rand_num == i)
-                    res_reorder[i++] = ptr_res;
-                else
-                {
-                    res_reorder[i++] = res_reorder[rand_num];
-                    res_reorder[rand_num] = ptr_res;
-                }
-            }
-            else
-                break;
-
-            last_af = ptr_res->ai_family;
-        }
-    }
-    else
+    if (num_hosts == 0)
     {
         /* no IP addresses found (all AF_UNSPEC) */
         snprintf (status_without_string, sizeof (status_without_string),
@@ -1234,7 +1330,7 @@ end:
 }
 
 /*
- * Timer callback for timeout of child process.
+ * Timer callback for connection timeout.
  */
 
 int
@@ -1378,6 +1474,115 @@ network_connect_gnutls_handshake_timer_cb (const void *pointer,
     return WEECHAT_RC_OK;
 }
 
+/*
+ * Ends a connection to peer with a connected socket: performs the GnuTLS
+ * handshake (if SSL is asked), then calls the connect callback.
+ *
+ * Argument "ip_address" is freed by this function (or kept in hook if the
+ * handshake is not finished).
+ */
+
+void
+network_connect_ok (struct t_hook *hook_connect, int sock, char *ip_address)
+{
+    int rc, direction;
+
+    HOOK_CONNECT(hook_connect, sock) = sock;
+
+    if (HOOK_CONNECT(hook_connect, gnutls_sess))
+    {
+        /*
+         * the socket needs to be non-blocking since the call to
+         * gnutls_handshake can block
+         */
+        HOOK_CONNECT(hook_connect, handshake_fd_flags) =
+            fcntl (HOOK_CONNECT(hook_connect, sock), F_GETFL);
+        if (HOOK_CONNECT(hook_connect, handshake_fd_flags) == -1)
+            HOOK_CONNECT(hook_connect, handshake_fd_flags) = 0;
+        fcntl (HOOK_CONNECT(hook_connect, sock), F_SETFL,
+               HOOK_CONNECT(hook_connect, handshake_fd_flags) | O_NONBLOCK);
+        gnutls_transport_set_ptr (*HOOK_CONNECT(hook_connect, gnutls_sess),
+                                  (gnutls_transport_ptr_t) ((ptrdiff_t) HOOK_CONNECT(hook_connect, sock)));
+        if (HOOK_CONNECT(hook_connect, gnutls_dhkey_size) > 0)
+        {
+            gnutls_dh_set_prime_bits (*HOOK_CONNECT(hook_connect, gnutls_sess),
+                                      (unsigned int) HOOK_CONNECT(hook_connect, gnutls_dhkey_size));
+        }
+        rc = gnutls_handshake (*HOOK_CONNECT(hook_connect, gnutls_sess));
+        if ((rc == GNUTLS_E_AGAIN) || (rc == GNUTLS_E_INTERRUPTED))
+        {
+            /*
+             * gnutls was unable to proceed with the handshake without
+             * blocking: non fatal error, we just have to wait for an
+             * event about handshake
+             */
+            unhook (HOOK_CONNECT(hook_connect, hook_fd));
+            HOOK_CONNECT(hook_connect, hook_fd) = NULL;
+            direction = gnutls_record_get_direction (*HOOK_CONNECT(hook_connect, gnutls_sess));
+            HOOK_CONNECT(hook_connect, handshake_ip_address) = ip_address;
+            HOOK_CONNECT(hook_connect, handshake_hook_fd) =
+                hook_fd (hook_connect->plugin,
+                         HOOK_CONNECT(hook_connect, sock),
+                         (!direction ? 1 : 0), (direction  ? 1 : 0), 0,
+                         &network_connect_gnutls_handshake_fd_cb,
+                         hook_connect, NULL);
+            HOOK_CONNECT(hook_connect, handshake_hook_timer) =
+                hook_timer (hook_connect->plugin,
+                            CONFIG_INTEGER(config_network_gnutls_handshake_timeout) * 1000,
+                            0, 1,
+                            &network_connect_gnutls_handshake_timer_cb,
+                            hook_connect, NULL);
+            return;
+        }
+        else if (rc != GNUTLS_E_SUCCESS)
+        {
+            (void) (HOOK_CONNECT(hook_connect, callback))
+                (hook_connect->callback_pointer,
+                 hook_connect->callback_data,
+                 WEECHAT_HOOK_CONNECT_GNUTLS_HANDSHAKE_ERROR,
+                 rc, sock,
+                 gnutls_strerror (rc),
+                 ip_address);
+            unhook (hook_connect);
+            if (ip_address)
+                free (ip_address);
+            return;
+        }
+        fcntl (HOOK_CONNECT(hook_connect, sock), F_SETFL,
+               HOOK_CONNECT(hook_connect, handshake_fd_flags));
+#if LIBGNUTLS_VERSION_NUMBER < 0x02090a /* 2.9.10 */
+        /*
+         * gnutls only has the gnutls_certificate_set_verify_function()
+         * function since version 2.9.10. We need to call our verify
+         * function manually after the handshake for old gnutls versions
+         */
+        if (hook_connect_gnutls_verify_certificates (*HOOK_CONNECT(hook_connect, gnutls_sess)) != 0)
+        {
+            (void) (HOOK_CONNECT(hook_connect, callback))
+                (hook_connect->callback_pointer,
+                 hook_connect->callback_data,
+                 WEECHAT_HOOK_CONNECT_GNUTLS_HANDSHAKE_ERROR,
+                 rc, sock,
+                 "Error in the certificate.",
+                 ip_address);
+            unhook (hook_connect);
+            if (ip_address)
+                free (ip_address);
+            return;
+        }
+#endif /* LIBGNUTLS_VERSION_NUMBER < 0x02090a */
+    }
+
+    (void) (HOOK_CONNECT(hook_connect, callback))
+        (hook_connect->callback_pointer,
+         hook_connect->callback_data,
+         WEECHAT_HOOK_CONNECT_OK, 0,
+         sock, NULL, ip_address);
+    unhook (hook_connect);
+    if (ip_address)
+        free (ip_address);
+}
+
 /*
  * Reads connection progress from child process.
  */
@@ -1389,7 +1594,6 @@ network_connect_child_read_cb (const void *pointer, void *data, int fd)
     char buffer[1], buf_size[6], *cb_error, *cb_ip_address, *error;
     int num_read;
     long size_msg;
-    int rc, direction;
     int sock, i;
     struct msghdr msg;
     struct cmsghdr *cmsg;
@@ -1484,91 +1688,8 @@ network_connect_child_read_cb (const void *pointer, void *data, int fd)
                 }
             }
 
-            HOOK_CONNECT(hook_connect, sock) = sock;
-
-            if (HOOK_CONNECT(hook_connect, gnutls_sess))
-            {
-                /*
-                 * the socket needs to be non-blocking since the call to
-                 * gnutls_handshake can block
-                 */
-                HOOK_CONNECT(hook_connect, handshake_fd_flags) =
-                    fcntl (HOOK_CONNECT(hook_connect, sock), F_GETFL);
-                if (HOOK_CONNECT(hook_connect, handshake_fd_flags) == -1)
-                    HOOK_CONNECT(hook_connect, handshake_fd_flags) = 0;
-                fcntl (HOOK_CONNECT(hook_connect, sock), F_SETFL,
-                       HOOK_CONNECT(hook_connect, handshake_fd_flags) | O_NONBLOCK);
-                gnutls_transport_set_ptr (*HOOK_CONNECT(hook_connect, gnutls_sess),
-                                          (gnutls_transport_ptr_t) ((ptrdiff_t) HOOK_CONNECT(hook_connect, sock)));
-                if (HOOK_CONNECT(hook_connect, gnutls_dhkey_size) > 0)
-                {
-                    gnutls_dh_set_prime_bits (*HOOK_CONNECT(hook_connect, gnutls_sess),
-                                              (unsigned int) HOOK_CONNECT(hook_connect, gnutls_dhkey_size));
-                }
-                rc = gnutls_handshake (*HOOK_CONNECT(hook_connect, gnutls_sess));
-                if ((rc == GNUTLS_E_AGAIN) || (rc == GNUTLS_E_INTERRUPTED))
-                {
-                    /*
-                     * gnutls was unable to proceed with the handshake without
-                     * blocking: non fatal error, we just have to wait for an
-                     * event about handshake
-                     */
-                    unhook (HOOK_CONNECT(hook_connect, hook_fd));
-                    HOOK_CONNECT(hook_connect, hook_fd) = NULL;
-                    direction = gnutls_record_get_direction (*HOOK_CONNECT(hook_connect, gnutls_sess));
-                    HOOK_CONNECT(hook_connect, handshake_ip_address) = cb_ip_address;
-                    HOOK_CONNECT(hook_connect, handshake_hook_fd) =
-                        hook_fd (hook_connect->plugin,
-                                 HOOK_CONNECT(hook_connect, sock),
-                                 (!direction ? 1 : 0), (direction  ? 1 : 0), 0,
-                                 &network_connect_gnutls_handshake_fd_cb,
-                                 hook_connect, NULL);
-                    HOOK_CONNECT(hook_connect, handshake_hook_timer) =
-                        hook_timer (hook_connect->plugin,
-                                    CONFIG_INTEGER(config_network_gnutls_handshake_timeout) * 1000,
-                                    0, 1,
-                                    &network_connect_gnutls_handshake_timer_cb,
-                                    hook_connect, NULL);
-                    return WEECHAT_RC_OK;
-                }
-                else if (rc != GNUTLS_E_SUCCESS)
-                {
-                    (void) (HOOK_CONNECT(hook_connect, callback))
-                        (hook_connect->callback_pointer,
-                         hook_connect->callback_data,
-                         WEECHAT_HOOK_CONNECT_GNUTLS_HANDSHAKE_ERROR,
-                         rc, sock,
-                         gnutls_strerror (rc),
-                         cb_ip_address);
-                    unhook (hook_connect);
-                    if (cb_ip_address)
-                        free (cb_ip_address);
-                    return WEECHAT_RC_OK;
-                }
-                fcntl (HOOK_CONNECT(hook_connect, sock), F_SETFL,
-                       HOOK_CONNECT(hook_connect, handshake_fd_flags));
-#if LIBGNUTLS_VERSION_NUMBER < 0x02090a /* 2.9.10 */
-                /*
-                 * gnutls only has the gnutls_certificate_set_verify_function()
-                 * function since version 2.9.10. We need to call our verify
-                 * function manually after the handshake for old gnutls versions
-                 */
-                if (hook_connect_gnutls_verify_certificates (*HOOK_CONNECT(hook_connect, gnutls_sess)) != 0)
-                {
-                    (void) (HOOK_CONNECT(hook_connect, callback))
-                        (hook_connect->callback_pointer,
-                         hook_connect->callback_data,
-                         WEECHAT_HOOK_CONNECT_GNUTLS_HANDSHAKE_ERROR,
-                         rc, sock,
-                         "Error in the certificate.",
-                         cb_ip_address);
-                    unhook (hook_connect);
-                    if (cb_ip_address)
-                        free (cb_ip_address);
-                    return WEECHAT_RC_OK;
-                }
-#endif /* LIBGNUTLS_VERSION_NUMBER < 0x02090a */
-            }
+            network_connect_ok (hook_connect, sock, cb_ip_address);
+            return WEECHAT_RC_OK;
         }
         else
         {
@@ -1624,43 +1745,879 @@ network_connect_child_read_cb (const void *pointer, void *data, int fd)
 }
 
 /*
- * Connects with fork (called by hook_connect() only!).
+ * Frees addresses and connection attempts in a connect hook (used for
+ * connections without fork): sockets of attempts are closed.
  */
 
 void
-network_connect_with_fork (struct t_hook *hook_connect)
+network_connect_free_attempts (struct t_hook *hook_connect)
 {
-    int child_pipe[2], child_socket[2], rc, i;
-    char str_error[1024];
-    const char *pos_error;
-    pid_t pid;
+    int i;
 
-    /* initialize GnuTLS if SSL asked */
-    if (HOOK_CONNECT(hook_connect, gnutls_sess))
+    if (HOOK_CONNECT(hook_connect, attempt_hook_timer))
     {
-        if (gnutls_init (HOOK_CONNECT(hook_connect, gnutls_sess), GNUTLS_CLIENT) != GNUTLS_E_SUCCESS)
+        unhook (HOOK_CONNECT(hook_connect, attempt_hook_timer));
+        HOOK_CONNECT(hook_connect, attempt_hook_timer) = NULL;
+    }
+    if (HOOK_CONNECT(hook_connect, attempt_sock))
+    {
+        for (i = 0; i < HOOK_CONNECT(hook_connect, num_addresses); i++)
         {
-            (void) (HOOK_CONNECT(hook_connect, callback))
-                (hook_connect->callback_pointer,
-                 hook_connect->callback_data,
-                 WEECHAT_HOOK_CONNECT_GNUTLS_INIT_ERROR,
-                 0, -1, NULL, NULL);
-            unhook (hook_connect);
-            return;
+            if (HOOK_CONNECT(hook_connect, attempt_hook_fd)[i])
+                unhook (HOOK_CONNECT(hook_connect, attempt_hook_fd)[i]);
+            if (HOOK_CONNECT(hook_connect, attempt_sock)[i] != -1)
+                close (HOOK_CONNECT(hook_connect, attempt_sock)[i]);
         }
-        rc = gnutls_server_name_set (*HOOK_CONNECT(hook_connect, gnutls_sess),
-                                     GNUTLS_NAME_DNS,
-                                     HOOK_CONNECT(hook_connect, address),
-                                     strlen (HOOK_CONNECT(hook_connect, address)));
-        if (rc != GNUTLS_E_SUCCESS)
-        {
-            (void) (HOOK_CONNECT(hook_connect, callback))
-                (hook_connect->callback_pointer,
+        free (HOOK_CONNECT(hook_connect, attempt_sock));
+        HOOK_CONNECT(hook_connect, attempt_sock) = NULL;
+    }
+    if (HOOK_CONNECT(hook_connect, attempt_hook_fd))
+    {
+        free (HOOK_CONNECT(hook_connect, attempt_hook_fd));
+        HOOK_CONNECT(hook_connect, attempt_hook_fd) = NULL;
+    }
+    if (HOOK_CONNECT(hook_connect, addresses))
+    {
+        free (HOOK_CONNECT(hook_connect, addresses));
+        HOOK_CONNECT(hook_connect, addresses) = NULL;
+    }
+    HOOK_CONNECT(hook_connect, num_addresses) = 0;
+    HOOK_CONNECT(hook_connect, next_address) = 0;
+    if (HOOK_CONNECT(hook_connect, res_remote))
+    {
+        freeaddrinfo (HOOK_CONNECT(hook_connect, res_remote));
+        HOOK_CONNECT(hook_connect, res_remote) = NULL;
+    }
+    if (HOOK_CONNECT(hook_connect, res_local))
+    {
+        freeaddrinfo (HOOK_CONNECT(hook_connect, res_local));
+        HOOK_CONNECT(hook_connect, res_local) = NULL;
+    }
+}
+
+/*
+ * Ends a connection attempt which succeeded: other attempts are cancelled.
+ */
+
+void
+network_connect_attempt_ok (struct t_hook *hook_connect, int index)
+{
+    struct addrinfo *ptr_res;
+    char remote_address[NI_MAXHOST + 1], *ip_address;
+    int sock;
+
+    sock = HOOK_CONNECT(hook_connect, attempt_sock)[index];
+    HOOK_CONNECT(hook_connect, attempt_sock)[index] = -1;
+
+    ip_address = NULL;
+    ptr_res = HOOK_CONNECT(hook_connect, addresses)[index];
+    if (getnameinfo (ptr_res->ai_addr, ptr_res->ai_addrlen,
+                     remote_address, sizeof (remote_address),
+                     NULL, 0, NI_NUMERICHOST) == 0)
+    {
+        ip_address = strdup (remote_address);
+    }
+
+    network_connect_free_attempts (hook_connect);
+
+    network_connect_ok (hook_connect, sock, ip_address);
+}
+
+/*
+ * Saves the error of a failed connection attempt: it is sent to the callback
+ * if all attempts fail.
+ *
+ * For an error of connect, the status is WEECHAT_HOOK_CONNECT_TIMEOUT if the
+ * connection timed out, WEECHAT_HOOK_CONNECT_CONNECTION_REFUSED otherwise.
+ */
+
+void
+network_connect_attempt_error (struct t_hook *hook_connect, int status,
+                               int error)
+{
+    if ((status == WEECHAT_HOOK_CONNECT_CONNECTION_REFUSED)
+        && (error == ETIMEDOUT))
+    {
+        status = WEECHAT_HOOK_CONNECT_TIMEOUT;
+    }
+    HOOK_CONNECT(hook_connect, attempt_status) = status;
+    HOOK_CONNECT(hook_connect, attempt_errno) = error;
+}
+
+/*
+ * Callback for a connection attempt in progress (socket is writable when
+ * the connection is established or failed).
+ */
+
+int
+network_connect_attempt_fd_cb (const void *pointer, void *data, int fd)
+{
+    struct t_hook *hook_connect;
+    int i, value;
+    socklen_t len;
+
+    /* make C compiler happy */
+    (void) data;
+
+    hook_connect = (struct t_hook *)pointer;
+
+    for (i = 0; i < HOOK_CONNECT(hook_connect, num_addresses); i++)
+    {
+        if (HOOK_CONNECT(hook_connect, attempt_sock)[i] == fd)
+            break;
+    }
+    if (i >= HOOK_CONNECT(hook_connect, num_addresses))
+        return WEECHAT_RC_OK;
+
+    len = sizeof (value);
+    if (getsockopt (fd, SOL_SOCKET, SO_ERROR, &value, &len) != 0)
+        value = errno;
+    if (value == 0)
+    {
+        network_connect_attempt_ok (hook_connect, i);
+        return WEECHAT_RC_OK;
+    }
+
+    /* connection failed: start next attempt now (without waiting timer) */
+    unhook (HOOK_CONNECT(hook_connect, attempt_hook_fd)[i]);
+    HOOK_CONNECT(hook_connect, attempt_hook_fd)[i] = NULL;
+    close (fd);
+    HOOK_CONNECT(hook_connect, attempt_sock)[i] = -1;
+    network_connect_attempt_error (hook_connect,
+                                   WEECHAT_HOOK_CONNECT_CONNECTION_REFUSED,
+                                   value);
+
+    network_connect_next_attempt (hook_connect);
+
+    return WEECHAT_RC_OK;
+}
+
+/*
+ * Timer callback to start next connection attempt (while previous attempts
+ * are still in progress).
+ */
+
+int
+network_connect_attempt_timer_cb (const void *pointer, void *data,
+                                  int remaining_calls)
+{
+    struct t_hook *hook_connect;
+
+    /* make C compiler happy */
+    (void) data;
+    (void) remaining_calls;
+
+    hook_connect = (struct t_hook *)pointer;
+
+    HOOK_CONNECT(hook_connect, attempt_hook_timer) = NULL;
+
+    network_connect_next_attempt (hook_connect);
+
+    return WEECHAT_RC_OK;
+}
+
+/*
+ * Starts connection to next address of peer (non-blocking connect).
+ *
+ * Attempts are started one after the other, with a delay of
+ * NETWORK_CONNECT_ATTEMPT_DELAY ms (or immediately if an attempt fails),
+ * and the first established connection is used ("Happy Eyeballs", RFC 8305).
+ *
+ * If there is no more address to try and no attempt in progress, the
+ * callback is called with the error of last attempt.
+ */
+
+void
+network_connect_next_attempt (struct t_hook *hook_connect)
+{
+    struct addrinfo *ptr_res, *ptr_loc;
+    int i, sock, set, flags, rc, error;
+
+    if (HOOK_CONNECT(hook_connect, attempt_hook_timer))
+    {
+        unhook (HOOK_CONNECT(hook_connect, attempt_hook_timer));
+        HOOK_CONNECT(hook_connect, attempt_hook_timer) = NULL;
+    }
+
+    while (HOOK_CONNECT(hook_connect, next_address) < HOOK_CONNECT(hook_connect, num_addresses))
+    {
+        i = HOOK_CONNECT(hook_connect, next_address);
+        HOOK_CONNECT(hook_connect, next_address)++;
+        ptr_res = HOOK_CONNECT(hook_connect, addresses)[i];
+
+        /* create a socket */
+        sock = socket (ptr_res->ai_family,
+                       ptr_res->ai_socktype,
+                       ptr_res->ai_protocol);
+        if (sock < 0)
+        {
+            network_connect_attempt_error (hook_connect,
+                                           WEECHAT_HOOK_CONNECT_SOCKET_ERROR,
+                                           errno);
+            continue;
+        }
+
+        /* set SO_REUSEADDR option for socket */
+        set = 1;
+        setsockopt (sock, SOL_SOCKET, SO_REUSEADDR, (void *) &set, sizeof (set));
+
+        /* set SO_KEEPALIVE option for socket */
+        set = 1;
+        setsockopt (sock, SOL_SOCKET, SO_KEEPALIVE, (void *) &set, sizeof (set));
+
+        /* set flag O_NONBLOCK on socket */
+        flags = fcntl (sock, F_GETFL);
+        if (flags == -1)
+            flags = 0;
+        fcntl (sock, F_SETFL, flags | O_NONBLOCK);
+
+        /* bind local hostname/IP if asked by user */
+        if (HOOK_CONNECT(hook_connect, res_local))
+        {
+            rc = -1;
+            error = EAFNOSUPPORT;
+            for (ptr_loc = HOOK_CONNECT(hook_connect, res_local); ptr_loc;
+                 ptr_loc = ptr_loc->ai_next)
+            {
+                if (ptr_loc->ai_family != ptr_res->ai_family)
+                    continue;
+                rc = bind (sock, ptr_loc->ai_addr, ptr_loc->ai_addrlen);
+                if (rc == 0)
+                    break;
+                error = errno;
+            }
+            if (rc < 0)
+            {
+                network_connect_attempt_error (
+                    hook_connect,
+                    WEECHAT_HOOK_CONNECT_LOCAL_HOSTNAME_ERROR,
+                    error);
+                close (sock);
+                continue;
+            }
+        }
+
+        HOOK_CONNECT(hook_connect, attempt_sock)[i] = sock;
+
+        /* connect to peer */
+        if (connect (sock, ptr_res->ai_addr, ptr_res->ai_addrlen) == 0)
+        {
+            network_connect_attempt_ok (hook_connect, i);
+            return;
+        }
+        error = errno;
+        if (error == EINPROGRESS)
+        {
+            HOOK_CONNECT(hook_connect, attempt_hook_fd)[i] =
+                hook_fd (hook_connect->plugin, sock, 0, 1, 0,
+                         &network_connect_attempt_fd_cb,
+                         hook_connect, NULL);
+        }
+        if (!HOOK_CONNECT(hook_connect, attempt_hook_fd)[i])
+        {
+            network_connect_attempt_error (
+                hook_connect,
+                WEECHAT_HOOK_CONNECT_CONNECTION_REFUSED,
+                (error == EINPROGRESS) ? 0 : error);
+            close (sock);
+            HOOK_CONNECT(hook_connect, attempt_sock)[i] = -1;
+            continue;
+        }
+
+        /* start next attempt after a delay (if this one is too slow) */
+        if (HOOK_CONNECT(hook_connect, next_address) < HOOK_CONNECT(hook_connect, num_addresses))
+        {
+            HOOK_CONNECT(hook_connect, attempt_hook_timer) =
+                hook_timer (hook_connect->plugin,
+                            NETWORK_CONNECT_ATTEMPT_DELAY, 0, 1,
+                            &network_connect_attempt_timer_cb,
+                            hook_connect, NULL);
+        }
+        return;
+    }
+
+    /* no more address to try: wait for attempts in progress (if any) */
+    for (i = 0; i < HOOK_CONNECT(hook_connect, num_addresses); i++)
+    {
+        if (HOOK_CONNECT(hook_connect, attempt_sock)[i] != -1)
+            return;
+    }
+
+    (void) (HOOK_CONNECT(hook_connect, callback))
+        (hook_connect->callback_pointer,
+         hook_connect->callback_data,
+         HOOK_CONNECT(hook_connect, attempt_status),
+         0, -1,
+         (HOOK_CONNECT(hook_connect, attempt_errno)) ?
+         strerror (HOOK_CONNECT(hook_connect, attempt_errno)) : NULL,
+         NULL);
+    unhook (hook_connect);
+}
+
+/*
+ * Starts connection to peer after its name was resolved (in a thread).
+ *
+ * Addresses found are moved from "resolve" to the connect hook.
+ */
+
+void
+network_connect_resolved (struct t_hook *hook_connect,
+                          struct t_network_resolve *resolve)
+{
+    int i, num_addresses;
+
+    if ((resolve->rc_remote != 0) || !resolve->res_remote)
+    {
+        /* address not found */
+        (void) (HOOK_CONNECT(hook_connect, callback))
+            (hook_connect->callback_pointer,
+             hook_connect->callback_data,
+             WEECHAT_HOOK_CONNECT_ADDRESS_NOT_FOUND,
+             0, -1,
+             (resolve->rc_remote != 0) ? gai_strerror (resolve->rc_remote) : NULL,
+             NULL);
+        unhook (hook_connect);
+        return;
+    }
+
+    if (resolve->local_hostname
+        && ((resolve->rc_local != 0) || !resolve->res_local))
+    {
+        /* local hostname not found */
+        (void) (HOOK_CONNECT(hook_connect, callback))
+            (hook_connect->callback_pointer,
+             hook_connect->callback_data,
+             WEECHAT_HOOK_CONNECT_LOCAL_HOSTNAME_ERROR,
+             0, -1,
+             (resolve->rc_local != 0) ? gai_strerror (resolve->rc_local) : NULL,
+             NULL);
+        unhook (hook_connect);
+        return;
+    }
+
+    HOOK_CONNECT(hook_connect, res_remote) = resolve->res_remote;
+    resolve->res_remote = NULL;
+    HOOK_CONNECT(hook_connect, res_local) = resolve->res_local;
+    resolve->res_local = NULL;
+
+    num_addresses = network_sort_addresses (
+        HOOK_CONNECT(hook_connect, res_remote),
+        HOOK_CONNECT(hook_connect, retry),
+        &HOOK_CONNECT(hook_connect, addresses));
+    if (num_addresses <= 0)
+    {
+        (void) (HOOK_CONNECT(hook_connect, callback))
+            (hook_connect->callback_pointer,
+             hook_connect->callback_data,
+             (num_addresses < 0) ?
+             WEECHAT_HOOK_CONNECT_MEMORY_ERROR :
+             WEECHAT_HOOK_CONNECT_IP_ADDRESS_NOT_FOUND,
+             0, -1, NULL, NULL);
+        unhook (hook_connect);
+        return;
+    }
+    network_interleave_addresses (HOOK_CONNECT(hook_connect, addresses),
+                                  num_addresses);
+
+    HOOK_CONNECT(hook_connect, attempt_sock) =
+        malloc (sizeof (*HOOK_CONNECT(hook_connect, attempt_sock)) * num_addresses);
+    HOOK_CONNECT(hook_connect, attempt_hook_fd) =
+        malloc (sizeof (*HOOK_CONNECT(hook_connect, attempt_hook_fd)) * num_addresses);
+    if (!HOOK_CONNECT(hook_connect, attempt_sock)
+        || !HOOK_CONNECT(hook_connect, attempt_hook_fd))
+    {
+        (void) (HOOK_CONNECT(hook_connect, callback))
+            (hook_connect->callback_pointer,
+             hook_connect->callback_data,
+             WEECHAT_HOOK_CONNECT_MEMORY_ERROR,
+             0, -1, NULL, NULL);
+        unhook (hook_connect);
+        return;
+    }
+    for (i = 0; i < num_addresses; i++)
+    {
+        HOOK_CONNECT(hook_connect, attempt_sock)[i] = -1;
+        HOOK_CONNECT(hook_connect, attempt_hook_fd)[i] = NULL;
+    }
+    HOOK_CONNECT(hook_connect, num_addresses) = num_addresses;
+    HOOK_CONNECT(hook_connect, next_address) = 0;
+
+    network_connect_next_attempt (hook_connect);
+}
+
+/*
+ * Frees a name resolution.
+ */
+
+void
+network_resolve_free (struct t_network_resolve *resolve)
+{
+    if (!resolve)
+        return;
+
+    if (resolve->address)
+        free (resolve->address);
+    if (resolve->port)
+        free (resolve->port);
+    if (resolve->local_hostname)
+        free (resolve->local_hostname);
+    if (resolve->res_remote)
+        freeaddrinfo (resolve->res_remote);
+    if (resolve->res_local)
+        freeaddrinfo (resolve->res_local);
+
+    free (resolve);
+}
+
+/*
+ * Thread resolving names (with getaddrinfo, which is blocking).
+ *
+ * Resolutions are taken in queue and added to the list of resolutions
+ * started (so that the main thread starts the connection timeout), then to
+ * the list of resolutions done; the main thread is woken up with the pipe
+ * after each step.
+ *
+ * WARNING: no WeeChat function can be called in this thread.
+ */
+
+void *
+network_resolve_thread (void *arg)
+{
+    struct t_network_resolve *ptr_resolve;
+    struct addrinfo hints;
+    int num_written;
+
+    /* make C compiler happy */
+    (void) arg;
+
+    pthread_mutex_lock (&network_resolve_mutex);
+
+    while (1)
+    {
+        while (!network_resolve_quit && !network_resolve_queue)
+        {
+            network_resolve_threads_idle++;
+            pthread_cond_wait (&network_resolve_cond, &network_resolve_mutex);
+            network_resolve_threads_idle--;
+        }
+        if (network_resolve_quit)
+            break;
+
+        ptr_resolve = network_resolve_queue;
+        network_resolve_queue = ptr_resolve->next_resolve;
+        if (!network_resolve_queue)
+            last_network_resolve_queue = NULL;
+        ptr_resolve->next_resolve = NULL;
+
+        if (last_network_resolve_started)
+            last_network_resolve_started->next_started = ptr_resolve;
+        else
+            network_resolve_started = ptr_resolve;
+        last_network_resolve_started = ptr_resolve;
+
+        num_written = write (network_resolve_pipe[1], "x", 1);
+        (void) num_written;
+
+        pthread_mutex_unlock (&network_resolve_mutex);
+
+        /* get info about peer */
+        memset (&hints, 0, sizeof (hints));
+        hints.ai_family = ptr_resolve->family;
+        hints.ai_socktype = SOCK_STREAM;
+#ifdef AI_ADDRCONFIG
+        hints.ai_flags = AI_ADDRCONFIG;
+#endif /* AI_ADDRCONFIG */
+        res_init ();
+        ptr_resolve->rc_remote = getaddrinfo (ptr_resolve->address,
+                                              ptr_resolve->port,
+                                              &hints,
+                                              &ptr_resolve->res_remote);
+
+        /* get info about local hostname/IP (if asked by user) */
+        if ((ptr_resolve->rc_remote == 0) && ptr_resolve->local_hostname)
+        {
+            memset (&hints, 0, sizeof (hints));
+            hints.ai_family = AF_UNSPEC;
+            hints.ai_socktype = SOCK_STREAM;
+#ifdef AI_ADDRCONFIG
+            hints.ai_flags = AI_ADDRCONFIG;
+#endif /* AI_ADDRCONFIG */
+            ptr_resolve->rc_local = getaddrinfo (ptr_resolve->local_hostname,
+                                                 NULL,
+                                                 &hints,
+                                                 &ptr_resolve->res_local);
+        }
+
+        pthread_mutex_lock (&network_resolve_mutex);
+
+        if (network_resolve_quit)
+        {
+            network_resolve_free (ptr_resolve);
+            break;
+        }
+
+        if (last_network_resolve_done)
+            last_network_resolve_done->next_resolve = ptr_resolve;
+        else
+            network_resolve_done = ptr_resolve;
+        last_network_resolve_done = ptr_resolve;
+
+        num_written = write (network_resolve_pipe[1], "x", 1);
+        (void) num_written;
+    }
+
+    network_resolve_threads--;
+
+    pthread_mutex_unlock (&network_resolve_mutex);
+
+    return NULL;
+}
+
+/*
+ * Callback for resolutions started and done by threads (in WeeChat main
+ * thread): the connection timeout is started when a thread starts to resolve
+ * the name (and not when the resolution is queued), then connections to peers
+ * are started when names are resolved.
+ */
+
+int
+network_resolve_read_cb (const void *pointer, void *data, int fd)
+{
+    struct t_network_resolve *ptr_resolve, *next_resolve, *ptr_started;
+    struct t_hook *ptr_hook;
+    char buffer[64];
+
+    /* make C compiler happy */
+    (void) pointer;
+    (void) data;
+
+    while (read (fd, buffer, sizeof (buffer)) > 0)
+    {
+    }
+
+    /*
+     * both lists are taken at once: a resolution done is always in the list
+     * of resolutions started (in this call or a previous one), so it can not
+     * be freed before its timer is started
+     */
+    pthread_mutex_lock (&network_resolve_mutex);
+    ptr_started = network_resolve_started;
+    network_resolve_started = NULL;
+    last_network_resolve_started = NULL;
+    ptr_resolve = network_resolve_done;
+    network_resolve_done = NULL;
+    last_network_resolve_done = NULL;
+    pthread_mutex_unlock (&network_resolve_mutex);
+
+    while (ptr_started)
+    {
+        ptr_hook = ptr_started->hook_connect;
+        if (ptr_hook && !HOOK_CONNECT(ptr_hook, hook_child_timer))
+        {
+            HOOK_CONNECT(ptr_hook, hook_child_timer) =
+                hook_timer (ptr_hook->plugin,
+                            CONFIG_INTEGER(config_network_connection_timeout) * 1000,
+                            0, 1,
+                            &network_connect_child_timer_cb,
+                            ptr_hook,
+                            NULL);
+        }
+        ptr_started = ptr_started->next_started;
+    }
+
+    while (ptr_resolve)
+    {
+        next_resolve = ptr_resolve->next_resolve;
+        /*
+         * the hook is NULL if the resolution was cancelled, which can happen
+         * in the callback of a previous connection
+         */
+        ptr_hook = ptr_resolve->hook_connect;
+        if (ptr_hook)
+        {
+            HOOK_CONNECT(ptr_hook, resolve) = NULL;
+            network_connect_resolved (ptr_hook, ptr_resolve);
+        }
+        network_resolve_free (ptr_resolve);
+        ptr_resolve = next_resolve;
+    }
+
+    return WEECHAT_RC_OK;
+}
+
+/*
+ * Initializes the pipe used by threads to wake up the main thread.
+ *
+ * Returns:
+ *   1: OK
+ *   0: error
+ */
+
+int
+network_resolve_init ()
+{
+    int i, flags;
+    struct timeval tv_time;
+
+    if (network_resolve_hook_fd)
+        return 1;
+
+    /* initialize random generator (used to shuffle addresses of peers) */
+    gettimeofday (&tv_time, NULL);
+    srand ((tv_time.tv_sec * tv_time.tv_usec) ^ getpid ());
+
+    if (pipe (network_resolve_pipe) < 0)
+    {
+        network_resolve_pipe[0] = -1;
+        network_resolve_pipe[1] = -1;
+        return 0;
+    }
+    for (i = 0; i < 2; i++)
+    {
+        flags = fcntl (network_resolve_pipe[i], F_GETFL);
+        if (flags == -1)
+            flags = 0;
+        fcntl (network_resolve_pipe[i], F_SETFL, flags | O_NONBLOCK);
+        fcntl (network_resolve_pipe[i], F_SETFD, FD_CLOEXEC);
+    }
+
+    network_resolve_hook_fd = hook_fd (NULL, network_resolve_pipe[0],
+                                       1, 0, 0,
+                                       &network_resolve_read_cb, NULL, NULL);
+    if (!network_resolve_hook_fd)
+    {
+        close (network_resolve_pipe[0]);
+        close (network_resolve_pipe[1]);
+        network_resolve_pipe[0] = -1;
+        network_resolve_pipe[1] = -1;
+        return 0;
+    }
+
+    return 1;
+}
+
+/*
+ * Adds a name resolution for a connect hook: the name is resolved in a
+ * thread (a thread is created if all threads are busy, up to
+ * NETWORK_RESOLVE_MAX_THREADS threads).
+ *
+ * Returns pointer to new resolution, NULL if error.
+ */
+
+struct t_network_resolve *
+network_resolve_add (struct t_hook *hook_connect)
+{
+    struct t_network_resolve *new_resolve;
+    char str_port[32];
+    pthread_t thread;
+    pthread_attr_t attr;
+    sigset_t set, old_set;
+    int rc;
+
+    if (!network_resolve_init ())
+        return NULL;
+
+    new_resolve = malloc (sizeof (*new_resolve));
+    if (!new_resolve)
+        return NULL;
+
+    snprintf (str_port, sizeof (str_port), "%d",
+              HOOK_CONNECT(hook_connect, port));
+    new_resolve->hook_connect = hook_connect;
+    new_resolve->address = strdup (HOOK_CONNECT(hook_connect, address));
+    new_resolve->port = strdup (str_port);
+    new_resolve->family = (HOOK_CONNECT(hook_connect, ipv6)) ?
+        AF_UNSPEC : AF_INET;
+    new_resolve->local_hostname =
+        (HOOK_CONNECT(hook_connect, local_hostname)
+         && HOOK_CONNECT(hook_connect, local_hostname)[0]) ?
+        strdup (HOOK_CONNECT(hook_connect, local_hostname)) : NULL;
+    new_resolve->rc_remote = 0;
+    new_resolve->rc_local = 0;
+    new_resolve->res_remote = NULL;
+    new_resolve->res_local = NULL;
+    new_resolve->next_resolve = NULL;
+    new_resolve->next_started = NULL;
+    if (!new_resolve->address || !new_resolve->port)
+    {
+        network_resolve_free (new_resolve);
+        return NULL;
+    }
+
+    pthread_mutex_lock (&network_resolve_mutex);
+
+    if ((network_resolve_threads_idle == 0)
+        && (network_resolve_threads < NETWORK_RESOLVE_MAX_THREADS))
+    {
+        /* signals are blocked in thread (they are handled by main thread) */
+        sigfillset (&set);
+        pthread_sigmask (SIG_SETMASK, &set, &old_set);
+        pthread_attr_init (&attr);
+        pthread_attr_setdetachstate (&attr, PTHREAD_CREATE_DETACHED);
+        rc = pthread_create (&thread, &attr, &network_resolve_thread, NULL);
+        pthread_attr_destroy (&attr);
+        pthread_sigmask (SIG_SETMASK, &old_set, NULL);
+        if (rc == 0)
+            network_resolve_threads++;
+    }
+
+    if (network_resolve_threads == 0)
+    {
+        pthread_mutex_unlock (&network_resolve_mutex);
+        network_resolve_free (new_resolve);
+        return NULL;
+    }
+
+    if (last_network_resolve_queue)
+        last_network_resolve_queue->next_resolve = new_resolve;
+    else
+        network_resolve_queue = new_resolve;
+    last_network_resolve_queue = new_resolve;
+
+    pthread_cond_signal (&network_resolve_cond);
+
+    pthread_mutex_unlock (&network_resolve_mutex);
+
+    return new_resolve;
+}
+
+/*
+ * Cancels a name resolution (when the connect hook is freed).
+ *
+ * If the resolution is not yet started, it is removed from queue and freed,
+ * otherwise it will be freed when it's done.
+ */
+
+void
+network_resolve_cancel (struct t_network_resolve *resolve)
+{
+    struct t_network_resolve *ptr_resolve, *prev_resolve;
+
+    if (!resolve)
+        return;
+
+    pthread_mutex_lock (&network_resolve_mutex);
+
+    prev_resolve = NULL;
+    for (ptr_resolve = network_resolve_queue; ptr_resolve;
+         ptr_resolve = ptr_resolve->next_resolve)
+    {
+        if (ptr_resolve == resolve)
+            break;
+        prev_resolve = ptr_resolve;
+    }
+
+    if (ptr_resolve)
+    {
+        if (prev_resolve)
+            prev_resolve->next_resolve = ptr_resolve->next_resolve;
+        else
+            network_resolve_queue = ptr_resolve->next_resolve;
+        if (last_network_resolve_queue == ptr_resolve)
+            last_network_resolve_queue = prev_resolve;
+        network_resolve_free (ptr_resolve);
+    }
+    else
+    {
+        resolve->hook_connect = NULL;
+    }
+
+    pthread_mutex_unlock (&network_resolve_mutex);
+}
+
+/*
+ * Ends name resolutions: threads are asked to exit (they are not waited,
+ * since getaddrinfo can block for a long time).
+ */
+
+void
+network_resolve_end ()
+{
+    struct t_network_resolve *ptr_resolve;
+
+    pthread_mutex_lock (&network_resolve_mutex);
+
+    network_resolve_quit = 1;
+    pthread_cond_broadcast (&network_resolve_cond);
+
+    while (network_resolve_queue)
+    {
+        ptr_resolve = network_resolve_queue->next_resolve;
+        network_resolve_free (network_resolve_queue);
+        network_resolve_queue = ptr_resolve;
+    }
+    last_network_resolve_queue = NULL;
+    /* resolutions started are freed by threads or in list of resolutions done */
+    network_resolve_started = NULL;
+    last_network_resolve_started = NULL;
+    while (network_resolve_done)
+    {
+        ptr_resolve = network_resolve_done->next_resolve;
+        network_resolve_free (network_resolve_done);
+        network_resolve_done = ptr_resolve;
+    }
+    last_network_resolve_done = NULL;
+
+    if (network_resolve_pipe[0] != -1)
+    {
+        close (network_resolve_pipe[0]);
+        network_resolve_pipe[0] = -1;
+    }
+    if (network_resolve_pipe[1] != -1)
+    {
+        close (network_resolve_pipe[1]);
+        network_resolve_pipe[1] = -1;
+    }
+
+    pthread_mutex_unlock (&network_resolve_mutex);
+
+    if (network_resolve_hook_fd)
+    {
+        unhook (network_resolve_hook_fd);
+        network_resolve_hook_fd = NULL;
+    }
+}
+
+/*
+ * Initializes GnuTLS session of a connect hook (if SSL is asked).
+ *
+ * Returns:
+ *   1: OK
+ *   0: error (callback is called and hook is removed)
+ */
+
+int
+network_connect_gnutls_init (struct t_hook *hook_connect)
+{
+    const char *pos_error;
+    int rc;
+
+    /* initialize GnuTLS if SSL asked */
+    if (HOOK_CONNECT(hook_connect, gnutls_sess))
+    {
+        if (gnutls_init (HOOK_CONNECT(hook_connect, gnutls_sess), GNUTLS_CLIENT) != GNUTLS_E_SUCCESS)
+        {
+            (void) (HOOK_CONNECT(hook_connect, callback))
+                (hook_connect->callback_pointer,
+                 hook_connect->callback_data,
+                 WEECHAT_HOOK_CONNECT_GNUTLS_INIT_ERROR,
+                 0, -1, NULL, NULL);
+            unhook (hook_connect);
+            return 0;
+        }
+        rc = gnutls_server_name_set (*HOOK_CONNECT(hook_connect, gnutls_sess),
+                                     GNUTLS_NAME_DNS,
+                                     HOOK_CONNECT(hook_connect, address),
+                                     strlen (HOOK_CONNECT(hook_connect, address)));
+        if (rc != GNUTLS_E_SUCCESS)
+        {
+            (void) (HOOK_CONNECT(hook_connect, callback))
+                (hook_connect->callback_pointer,
                  hook_connect->callback_data,
                  WEECHAT_HOOK_CONNECT_GNUTLS_INIT_ERROR,
                  0, -1, _("set server name indication (SNI) failed"), NULL);
             unhook (hook_connect);
-            return;
+            return 0;
         }
         rc = gnutls_priority_set_direct (*HOOK_CONNECT(hook_connect, gnutls_sess),
                                          HOOK_CONNECT(hook_connect, gnutls_priorities),
@@ -1673,7 +2630,7 @@ network_connect_with_fork (struct t_hook *hook_connect)
                  WEECHAT_HOOK_CONNECT_GNUTLS_INIT_ERROR,
                  0, -1, _("invalid priorities"), NULL);
             unhook (hook_connect);
-            return;
+            return 0;
         }
         gnutls_credentials_set (*HOOK_CONNECT(hook_connect, gnutls_sess),
                                 GNUTLS_CRD_CERTIFICATE,
@@ -1682,6 +2639,20 @@ network_connect_with_fork (struct t_hook *hook_connect)
                                   (gnutls_transport_ptr_t) ((unsigned long) HOOK_CONNECT(hook_connect, sock)));
     }
 
+    return 1;
+}
+
+/*
+ * Connects with fork (called by network_connect_start() only!).
+ */
+
+void
+network_connect_with_fork (struct t_hook *hook_connect)
+{
+    int child_pipe[2], child_socket[2], rc, i;
+    char str_error[1024];
+    pid_t pid;
+
     /* create pipe for child process */
     if (pipe (child_pipe) < 0)
     {
@@ -1766,3 +2737,32 @@ network_connect_with_fork (struct t_hook *hook_connect)
                                                    &network_connect_child_read_cb,
                                                    hook_connect, NULL);
 }
+
+/*
+ * Connects to peer (called by hook_connect() only!).
+ *
+ * Without proxy, the name is resolved in a thread and the connection is made
+ * in WeeChat process (non-blocking connect).  With a proxy (or if a thread
+ * can not be used), the connection is made in a child process (fork).
+ */
+
+void
+network_connect_start (struct t_hook *hook_connect)
+{
+    if (!network_connect_gnutls_init (hook_connect))
+        return;
+
+    if (!HOOK_CONNECT(hook_connect, proxy)
+        || !HOOK_CONNECT(hook_connect, proxy)[0])
+    {
+        /*
+         * the connection timeout is started when a thread starts to resolve
+         * the name (see function network_resolve_read_cb)
+         */
+        HOOK_CONNECT(hook_connect, resolve) = network_resolve_add (hook_connect);
+        if (HOOK_CONNECT(hook_connect, resolve))
+            return;
+    }
+
+    network_connect_with_fork (hook_connect);
+}
@@ -23,7 +23,17 @@
 #include <sys/types.h>
 #include <sys/socket.h>
 
+/*
+ * max number of threads used to resolve names (getaddrinfo can block for
+ * many seconds when DNS is slow, and many servers can reconnect at once)
+ */
+#define NETWORK_RESOLVE_MAX_THREADS 16
+
+/* delay before starting next connection attempt (in ms, see RFC 8305) */
+#define NETWORK_CONNECT_ATTEMPT_DELAY 250
+
 struct t_hook;
+struct addrinfo;
 
 struct t_network_socks4
 {
@@ -43,6 +53,23 @@ struct t_network_socks5
                           /*              auth(user/pass) (2), ...          */
 };
 
+/* name resolution (made in a thread for a connect hook) */
+
+struct t_network_resolve
+{
+    struct t_hook *hook_connect;       /* connect hook (NULL if cancelled)  */
+    char *address;                     /* address of peer                   */
+    char *port;                        /* port of peer                      */
+    int family;                        /* AF_UNSPEC or AF_INET              */
+    char *local_hostname;              /* local hostname (optional)         */
+    int rc_remote;                     /* getaddrinfo return code (peer)    */
+    int rc_local;                      /* getaddrinfo return code (local)   */
+    struct addrinfo *res_remote;       /* addresses of peer                 */
+    struct addrinfo *res_local;        /* addresses of local hostname       */
+    struct t_network_resolve *next_resolve; /* link to next resolution      */
+    struct t_network_resolve *next_started; /* next resolution started      */
+};
+
 extern int network_init_gnutls_ok;
 
 extern void network_init_gcrypt ();
@@ -53,6 +80,15 @@ extern int network_pass_proxy (const char *proxy, int sock,
                                const char *address, int port);
 extern int network_connect_to (const char *proxy, struct sockaddr *address,
                                socklen_t address_length);
+extern int network_sort_addresses (struct addrinfo *res, int retry,
+                                   struct addrinfo ***addresses);
+extern void network_interleave_addresses (struct addrinfo **addresses,
+                                          int num_addresses);
+extern void network_connect_next_attempt (struct t_hook *hook_connect);
+extern void network_connect_free_attempts (struct t_hook *hook_connect);
 extern void network_connect_with_fork (struct t_hook *hook_connect);
+extern void network_resolve_cancel (struct t_network_resolve *resolve);
+extern void network_resolve_end ();
+extern void network_connect_start (struct t_hook *hook_connect);
 
 #endif /* WEECHAT_NETWORK_H */
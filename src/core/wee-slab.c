@@ -0,0 +1,312 @@
+/*
+ * wee-slab.c - slab allocator (many objects of same size)
+ *
+ * Copyright (C) 2020 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * A slab allocates objects of same size in chunks of SLAB_CHUNK_SIZE bytes,
+ * without the overhead of one malloc per object.
+ *
+ * Chunks are aligned on their size, so the chunk of an object is found with
+ * its address.  Chunks with free objects are kept first in list, so an
+ * object is always allocated in first chunk (a new chunk is allocated if
+ * this one is full).  A chunk is freed when all its objects are freed
+ * (except the first chunk, to prevent allocating/freeing it in a loop).
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "weechat.h"
+#include "wee-slab.h"
+#include "wee-log.h"
+
+
+/* offset of first object in a chunk (after the chunk header) */
+#define SLAB_CHUNK_OFFSET                                               \
+    ((sizeof (struct t_slab_chunk) + 15) & ~((size_t)15))
+
+/* chunk of an object */
+#define SLAB_CHUNK(__object)                                            \
+    ((struct t_slab_chunk *)((uintptr_t)(__object)                      \
+                             & ~((uintptr_t)(SLAB_CHUNK_SIZE - 1))))
+
+
+/*
+ * Creates a new slab for objects of size "object_size".
+ *
+ * Returns pointer to new slab, NULL if error.
+ */
+
+struct t_slab *
+slab_new (int object_size)
+{
+    struct t_slab *new_slab;
+    int size;
+
+    if (object_size <= 0)
+        return NULL;
+
+    /* objects are aligned on size of a pointer (to store list of free ones) */
+    size = ((object_size + (int)sizeof (void *) - 1)
+            / (int)sizeof (void *)) * (int)sizeof (void *);
+
+    if ((int)((SLAB_CHUNK_SIZE - SLAB_CHUNK_OFFSET) / size)
+        < SLAB_MIN_OBJECTS_PER_CHUNK)
+    {
+        return NULL;
+    }
+
+    new_slab = malloc (sizeof (*new_slab));
+    if (!new_slab)
+        return NULL;
+
+    new_slab->object_size = size;
+    new_slab->objects_per_chunk = (SLAB_CHUNK_SIZE - SLAB_CHUNK_OFFSET) / size;
+    new_slab->objects_count = 0;
+    new_slab->chunks_count = 0;
+    new_slab->chunks = NULL;
+    new_slab->last_chunk = NULL;
+
+    return new_slab;
+}
+
+/*
+ * Removes a chunk from list of chunks in slab.
+ */
+
+void
+slab_chunk_unlink (struct t_slab *slab, struct t_slab_chunk *chunk)
+{
+    if (chunk->prev_chunk)
+        (chunk->prev_chunk)->next_chunk = chunk->next_chunk;
+    if (chunk->next_chunk)
+        (chunk->next_chunk)->prev_chunk = chunk->prev_chunk;
+    if (slab->chunks == chunk)
+        slab->chunks = chunk->next_chunk;
+    if (slab->last_chunk == chunk)
+        slab->last_chunk = chunk->prev_chunk;
+    chunk->prev_chunk = NULL;
+    chunk->next_chunk = NULL;
+}
+
+/*
+ * Adds a chunk at beginning of list of chunks in slab.
+ */
+
+void
+slab_chunk_link_first (struct t_slab *slab, struct t_slab_chunk *chunk)
+{
+    chunk->prev_chunk = NULL;
+    chunk->next_chunk = slab->chunks;
+    if (slab->chunks)
+        (slab->chunks)->prev_chunk = chunk;
+    else
+        slab->last_chunk = chunk;
+    slab->chunks = chunk;
+}
+
+/*
+ * Adds a chunk at end of list of chunks in slab.
+ */
+
+void
+slab_chunk_link_last (struct t_slab *slab, struct t_slab_chunk *chunk)
+{
+    chunk->prev_chunk = slab->last_chunk;
+    chunk->next_chunk = NULL;
+    if (slab->last_chunk)
+        (slab->last_chunk)->next_chunk = chunk;
+    else
+        slab->chunks = chunk;
+    slab->last_chunk = chunk;
+}
+
+/*
+ * Frees a chunk.
+ */
+
+void
+slab_chunk_free (struct t_slab *slab, struct t_slab_chunk *chunk)
+{
+    slab_chunk_unlink (slab, chunk);
+    free (chunk);
+    slab->chunks_count--;
+}
+
+/*
+ * Allocates a new chunk and adds it at beginning of list of chunks.
+ *
+ * Returns pointer to new chunk, NULL if error.
+ */
+
+struct t_slab_chunk *
+slab_chunk_new (struct t_slab *slab)
+{
+    struct t_slab_chunk *new_chunk;
+    void *ptr;
+
+    if (posix_memalign (&ptr, SLAB_CHUNK_SIZE, SLAB_CHUNK_SIZE) != 0)
+        return NULL;
+
+    new_chunk = (struct t_slab_chunk *)ptr;
+    new_chunk->slab = slab;
+    new_chunk->objects_used = 0;
+    new_chunk->objects_initialized = 0;
+    new_chunk->free_objects = NULL;
+
+    slab_chunk_link_first (slab, new_chunk);
+    slab->chunks_count++;
+
+    return new_chunk;
+}
+
+/*
+ * Allocates an object in a slab.
+ *
+ * Returns pointer to object (content is not initialized), NULL if error.
+ */
+
+void *
+slab_alloc (struct t_slab *slab)
+{
+    struct t_slab_chunk *ptr_chunk;
+    void *object;
+
+    if (!slab)
+        return NULL;
+
+    ptr_chunk = slab->chunks;
+    if (!ptr_chunk || (ptr_chunk->objects_used >= slab->objects_per_chunk))
+    {
+        ptr_chunk = slab_chunk_new (slab);
+        if (!ptr_chunk)
+            return NULL;
+    }
+
+    if (ptr_chunk->free_objects)
+    {
+        object = ptr_chunk->free_objects;
+        ptr_chunk->free_objects = *((void **)object);
+    }
+    else
+    {
+        object = (char *)ptr_chunk + SLAB_CHUNK_OFFSET
+            + ((size_t)ptr_chunk->objects_initialized * slab->object_size);
+        ptr_chunk->objects_initialized++;
+    }
+
+    ptr_chunk->objects_used++;
+    slab->objects_count++;
+
+    /* full chunk is moved at end of list */
+    if ((ptr_chunk->objects_used >= slab->objects_per_chunk)
+        && (ptr_chunk != slab->last_chunk))
+    {
+        slab_chunk_unlink (slab, ptr_chunk);
+        slab_chunk_link_last (slab, ptr_chunk);
+    }
+
+    return object;
+}
+
+/*
+ * Frees an object allocated in a slab.
+ */
+
+void
+slab_free_object (struct t_slab *slab, void *object)
+{
+    struct t_slab_chunk *ptr_chunk;
+    int chunk_was_full;
+
+    if (!slab || !object)
+        return;
+
+    ptr_chunk = SLAB_CHUNK(object);
+
+    chunk_was_full = (ptr_chunk->objects_used >= slab->objects_per_chunk);
+
+    *((void **)object) = ptr_chunk->free_objects;
+    ptr_chunk->free_objects = object;
+    ptr_chunk->objects_used--;
+    slab->objects_count--;
+
+    if ((ptr_chunk->objects_used == 0) && (ptr_chunk != slab->chunks))
+    {
+        /* empty chunk is freed (except the first one) */
+        slab_chunk_free (slab, ptr_chunk);
+    }
+    else if (chunk_was_full && (ptr_chunk != slab->chunks))
+    {
+        /* chunk has now a free object: move it at beginning of list */
+        slab_chunk_unlink (slab, ptr_chunk);
+        if (slab->chunks && (slab->chunks->objects_used == 0))
+            slab_chunk_free (slab, slab->chunks);
+        slab_chunk_link_first (slab, ptr_chunk);
+    }
+}
+
+/*
+ * Frees a slab and all objects allocated in this slab.
+ */
+
+void
+slab_free (struct t_slab *slab)
+{
+    if (!slab)
+        return;
+
+    while (slab->chunks)
+    {
+        slab_chunk_free (slab, slab->chunks);
+    }
+
+    free (slab);
+}
+
+/*
+ * Prints a slab in WeeChat log file (usually for crash dump).
+ */
+
+void
+slab_print_log (struct t_slab *slab, const char *name)
+{
+    struct t_slab_chunk *ptr_chunk;
+
+    log_printf ("[slab %s (addr:0x%lx)]", name, slab);
+    log_printf ("  object_size. . . . . . : %d", slab->object_size);
+    log_printf ("  objects_per_chunk. . . : %d", slab->objects_per_chunk);
+    log_printf ("  objects_count. . . . . : %d", slab->objects_count);
+    log_printf ("  chunks_count . . . . . : %d", slab->chunks_count);
+    log_printf ("  chunks . . . . . . . . : 0x%lx", slab->chunks);
+    for (ptr_chunk = slab->chunks; ptr_chunk;
+         ptr_chunk = ptr_chunk->next_chunk)
+    {
+        log_printf ("    chunk 0x%lx: objects_used: %d, initialized: %d",
+                    ptr_chunk,
+                    ptr_chunk->objects_used,
+                    ptr_chunk->objects_initialized);
+    }
+    log_printf ("  last_chunk . . . . . . : 0x%lx", slab->last_chunk);
+}
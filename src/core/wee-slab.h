@@ -0,0 +1,59 @@
+/*
+ * Copyright (C) 2020 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef WEECHAT_SLAB_H
+#define WEECHAT_SLAB_H
+
+/* size of a chunk (must be a power of 2, chunks are aligned on this size) */
+#define SLAB_CHUNK_SIZE (64 * 1024)
+
+/* min number of objects in a chunk */
+#define SLAB_MIN_OBJECTS_PER_CHUNK 8
+
+struct t_slab;
+
+struct t_slab_chunk
+{
+    struct t_slab *slab;               /* slab of this chunk                */
+    int objects_used;                  /* number of objects allocated       */
+    int objects_initialized;           /* number of objects used at least   */
+                                       /* once (next ones were never used)  */
+    void *free_objects;                /* list of free objects              */
+    struct t_slab_chunk *prev_chunk;   /* link to previous chunk            */
+    struct t_slab_chunk *next_chunk;   /* link to next chunk                */
+};
+
+struct t_slab
+{
+    int object_size;                   /* size of an object (bytes)         */
+    int objects_per_chunk;             /* number of objects in a chunk      */
+    int objects_count;                 /* number of objects allocated       */
+    int chunks_count;                  /* number of chunks allocated        */
+    struct t_slab_chunk *chunks;       /* chunks (chunks with free objects  */
+                                       /* first, then full chunks)          */
+    struct t_slab_chunk *last_chunk;   /* last chunk                        */
+};
+
+extern struct t_slab *slab_new (int object_size);
+extern void *slab_alloc (struct t_slab *slab);
+extern void slab_free_object (struct t_slab *slab, void *object);
+extern void slab_free (struct t_slab *slab);
+extern void slab_print_log (struct t_slab *slab, const char *name);
+
+#endif /* WEECHAT_SLAB_H */
@@ -162,7 +162,8 @@ upgrade_weechat_save_buffers (struct t_upgrade_file *upgrade_file)
                 return 0;
         }
 
-        /* save buffer lines */
+        /* save buffer lines (compressed lines are uncompressed first) */
+        gui_line_uncompress_all (ptr_buffer);
         for (ptr_line = ptr_buffer->own_lines->first_line; ptr_line;
              ptr_line = ptr_line->next_line)
         {
@@ -30,8 +30,10 @@
 
 #include "weechat.h"
 #include "wee-url.h"
+#include "wee-arraylist.h"
 #include "wee-config.h"
 #include "wee-hashtable.h"
+#include "wee-hook.h"
 #include "wee-infolist.h"
 #include "wee-proxy.h"
 #include "wee-string.h"
@@ -890,7 +892,15 @@ struct t_url_option url_options[] =
     { NULL, 0, 0, NULL },
 };
 
-char url_error[CURL_ERROR_SIZE + 1];
+CURLM *url_multi = NULL;               /* curl multi handle (transfers in   */
+                                       /* WeeChat process)                  */
+int url_multi_failed = 0;              /* 1 if multi handle can't be used   */
+int url_multi_action = 0;              /* > 0 during a curl action          */
+struct t_hook *url_multi_timer = NULL; /* timer for curl multi handle       */
+struct t_url_transfer *url_transfers = NULL; /* transfers in multi handle   */
+struct t_url_transfer *last_url_transfer = NULL; /* last transfer           */
+int url_transfers_pending = 0;         /* 1 if some transfers must be added */
+int url_transfers_deleted = 0;         /* 1 if some transfers must be freed */
 
 
 /*
@@ -1009,6 +1019,7 @@ weeurl_option_map_cb (void *data,
                       struct t_hashtable *hashtable,
                       const void *key, const void *value)
 {
+    struct t_url_transfer *transfer;
     CURL *curl;
     int i, index, index_constant, rc, num_items;
     long long_value;
@@ -1019,10 +1030,12 @@ weeurl_option_map_cb (void *data,
     /* make C compiler happy */
     (void) hashtable;
 
-    curl = (CURL *)data;
-    if (!curl)
+    transfer = (struct t_url_transfer *)data;
+    if (!transfer || !transfer->curl)
         return;
 
+    curl = (CURL *)transfer->curl;
+
     index = weeurl_search_option ((const char *)key);
     if (index >= 0)
     {
@@ -1099,6 +1112,9 @@ weeurl_option_map_cb (void *data,
                     curl_easy_setopt (curl,
                                       url_options[index].option,
                                       slist);
+                    /* list must be kept until the end of transfer */
+                    if (slist)
+                        arraylist_add (transfer->slists, slist);
                     string_free_split (items);
                 }
                 break;
@@ -1169,49 +1185,108 @@ weeurl_set_proxy (CURL *curl, struct t_proxy *proxy)
 }
 
 /*
- * Downloads URL using options.
+ * Frees a list of strings set in an option (callback called for each list
+ * when the arraylist is freed).
+ */
+
+void
+weeurl_transfer_slist_free_cb (void *data, struct t_arraylist *arraylist,
+                               void *pointer)
+{
+    /* make C compiler happy */
+    (void) data;
+    (void) arraylist;
+
+    curl_slist_free_all ((struct curl_slist *)pointer);
+}
+
+/*
+ * Frees a transfer (curl easy handle must have been removed from multi
+ * handle before the call to this function).
+ */
+
+void
+weeurl_transfer_free_data (struct t_url_transfer *transfer)
+{
+    int i;
+
+    if (transfer->curl)
+        curl_easy_cleanup ((CURL *)transfer->curl);
+    if (transfer->url)
+        free (transfer->url);
+    for (i = 0; i < 2; i++)
+    {
+        if (transfer->url_file[i].stream)
+            fclose (transfer->url_file[i].stream);
+    }
+    if (transfer->slists)
+        arraylist_free (transfer->slists);
+    if (transfer->error)
+        free (transfer->error);
+
+    free (transfer);
+}
+
+/*
+ * Creates a transfer: creates the curl easy handle and sets options.
  *
- * Returns:
- *   0: OK
- *   1: invalid URL
- *   2: error downloading URL
- *   3: not enough memory
- *   4: file error
+ * Returns pointer to new transfer, NULL if error (and then "return_code" is
+ * set to the error code, see function weeurl_download).
  */
 
-int
-weeurl_download (const char *url, struct t_hashtable *options)
+struct t_url_transfer *
+weeurl_transfer_new (const char *url, struct t_hashtable *options,
+                     int *return_code)
 {
+    struct t_url_transfer *new_transfer;
     CURL *curl;
-    struct t_url_file url_file[2];
     char *url_file_option[2] = { "file_in", "file_out" };
     char *url_file_mode[2] = { "rb", "wb" };
     CURLoption url_file_opt_func[2] = { CURLOPT_READFUNCTION, CURLOPT_WRITEFUNCTION };
     CURLoption url_file_opt_data[2] = { CURLOPT_READDATA, CURLOPT_WRITEDATA };
     void *url_file_opt_cb[2] = { &weeurl_read, &weeurl_write };
     struct t_proxy *ptr_proxy;
-    int rc, curl_rc, i;
-
-    rc = 0;
+    int i;
 
-    for (i = 0; i < 2; i++)
+    if (!url || !url[0])
     {
-        url_file[i].filename = NULL;
-        url_file[i].stream = NULL;
+        *return_code = 1;
+        return NULL;
     }
 
-    if (!url || !url[0])
+    *return_code = 3;
+
+    new_transfer = malloc (sizeof (*new_transfer));
+    if (!new_transfer)
+        return NULL;
+
+    new_transfer->curl = NULL;
+    new_transfer->url = strdup (url);
+    for (i = 0; i < 2; i++)
     {
-        rc = 1;
-        goto end;
+        new_transfer->url_file[i].filename = NULL;
+        new_transfer->url_file[i].stream = NULL;
     }
+    new_transfer->slists = arraylist_new (4, 0, 1, NULL, NULL,
+                                          &weeurl_transfer_slist_free_cb,
+                                          NULL);
+    new_transfer->error = calloc (1, CURL_ERROR_SIZE + 1);
+    new_transfer->callback_write = NULL;
+    new_transfer->callback_end = NULL;
+    new_transfer->callback_pointer = NULL;
+    new_transfer->running = 0;
+    new_transfer->pending = 0;
+    new_transfer->deleted = 0;
+    new_transfer->prev_transfer = NULL;
+    new_transfer->next_transfer = NULL;
+
+    if (!new_transfer->url || !new_transfer->slists || !new_transfer->error)
+        goto error;
 
     curl = curl_easy_init ();
     if (!curl)
-    {
-        rc = 3;
-        goto end;
-    }
+        goto error;
+    new_transfer->curl = curl;
 
     /* set default options */
     curl_easy_setopt (curl, CURLOPT_URL, url);
@@ -1231,47 +1306,558 @@ weeurl_download (const char *url, struct t_hashtable *options)
     {
         for (i = 0; i < 2; i++)
         {
-            url_file[i].filename = hashtable_get (options, url_file_option[i]);
-            if (url_file[i].filename)
+            new_transfer->url_file[i].filename = hashtable_get (
+                options, url_file_option[i]);
+            if (new_transfer->url_file[i].filename)
             {
-                url_file[i].stream = fopen (url_file[i].filename, url_file_mode[i]);
-                if (!url_file[i].stream)
+                new_transfer->url_file[i].stream = fopen (
+                    new_transfer->url_file[i].filename, url_file_mode[i]);
+                if (!new_transfer->url_file[i].stream)
                 {
-                    rc = 4;
-                    goto end;
+                    *return_code = 4;
+                    goto error;
                 }
-                curl_easy_setopt (curl, url_file_opt_func[i], url_file_opt_cb[i]);
-                curl_easy_setopt (curl, url_file_opt_data[i], url_file[i].stream);
+                curl_easy_setopt (curl, url_file_opt_func[i],
+                                  url_file_opt_cb[i]);
+                curl_easy_setopt (curl, url_file_opt_data[i],
+                                  new_transfer->url_file[i].stream);
             }
         }
     }
 
     /* set other options in hashtable */
-    hashtable_map (options, &weeurl_option_map_cb, curl);
+    hashtable_map (options, &weeurl_option_map_cb, new_transfer);
 
     /* set error buffer */
-    curl_easy_setopt (curl, CURLOPT_ERRORBUFFER, url_error);
+    curl_easy_setopt (curl, CURLOPT_ERRORBUFFER, new_transfer->error);
+
+    *return_code = 0;
+
+    return new_transfer;
+
+error:
+    weeurl_transfer_free_data (new_transfer);
+    return NULL;
+}
+
+/*
+ * Downloads URL using options (blocking call, used in a child process).
+ *
+ * Returns:
+ *   0: OK
+ *   1: invalid URL
+ *   2: error downloading URL
+ *   3: not enough memory
+ *   4: file error
+ */
+
+int
+weeurl_download (const char *url, struct t_hashtable *options)
+{
+    struct t_url_transfer *transfer;
+    int rc, curl_rc;
+
+    transfer = weeurl_transfer_new (url, options, &rc);
+    if (!transfer)
+        return rc;
 
     /* perform action! */
-    curl_rc = curl_easy_perform (curl);
+    curl_rc = curl_easy_perform ((CURL *)transfer->curl);
     if (curl_rc != CURLE_OK)
     {
         fprintf (stderr,
                  _("curl error %d (%s) (URL: \"%s\")\n"),
-                 curl_rc, url_error, url);
+                 curl_rc, transfer->error, url);
         rc = 2;
     }
 
     /* cleanup */
-    curl_easy_cleanup (curl);
+    weeurl_transfer_free_data (transfer);
 
-end:
-    for (i = 0; i < 2; i++)
+    return rc;
+}
+
+/*
+ * Removes a transfer from the curl multi handle and from list of transfers,
+ * then frees it.
+ */
+
+void
+weeurl_transfer_remove (struct t_url_transfer *transfer)
+{
+    if (transfer->running)
     {
-        if (url_file[i].stream)
-            fclose (url_file[i].stream);
+        curl_multi_remove_handle (url_multi, (CURL *)transfer->curl);
+        transfer->running = 0;
     }
-    return rc;
+
+    if (transfer->prev_transfer)
+        (transfer->prev_transfer)->next_transfer = transfer->next_transfer;
+    if (transfer->next_transfer)
+        (transfer->next_transfer)->prev_transfer = transfer->prev_transfer;
+    if (url_transfers == transfer)
+        url_transfers = transfer->next_transfer;
+    if (last_url_transfer == transfer)
+        last_url_transfer = transfer->prev_transfer;
+
+    weeurl_transfer_free_data (transfer);
+}
+
+/*
+ * Frees transfers marked as deleted during a curl action.
+ */
+
+void
+weeurl_transfer_remove_deleted ()
+{
+    struct t_url_transfer *ptr_transfer, *next_transfer;
+
+    if (!url_transfers_deleted)
+        return;
+
+    ptr_transfer = url_transfers;
+    while (ptr_transfer)
+    {
+        next_transfer = ptr_transfer->next_transfer;
+        if (ptr_transfer->deleted)
+            weeurl_transfer_remove (ptr_transfer);
+        ptr_transfer = next_transfer;
+    }
+
+    url_transfers_deleted = 0;
+}
+
+/*
+ * Adds a transfer in the curl multi handle.
+ *
+ * Returns:
+ *   1: OK
+ *   0: error
+ */
+
+int
+weeurl_transfer_add_to_multi (struct t_url_transfer *transfer)
+{
+    transfer->pending = 0;
+
+    if (curl_multi_add_handle (url_multi, (CURL *)transfer->curl) != CURLM_OK)
+        return 0;
+
+    transfer->running = 1;
+
+    return 1;
+}
+
+/*
+ * Adds transfers started during a curl action in the curl multi handle
+ * (Curl does not allow to add them during an action).
+ *
+ * The end callback is called for transfers that can not be added.
+ */
+
+void
+weeurl_transfer_add_pending ()
+{
+    struct t_url_transfer *ptr_transfer;
+    t_url_callback_end *callback_end;
+    void *callback_pointer;
+
+    if (!url_transfers_pending)
+        return;
+
+    url_transfers_pending = 0;
+
+    ptr_transfer = url_transfers;
+    while (ptr_transfer)
+    {
+        if (ptr_transfer->pending && !ptr_transfer->deleted
+            && !weeurl_transfer_add_to_multi (ptr_transfer))
+        {
+            callback_end = ptr_transfer->callback_end;
+            callback_pointer = ptr_transfer->callback_pointer;
+            ptr_transfer->callback_write = NULL;
+            ptr_transfer->callback_end = NULL;
+            if (callback_end)
+            {
+                (void) (callback_end) (callback_pointer, 3, NULL);
+                /* list may have been changed by callback: restart from start */
+                ptr_transfer = url_transfers;
+                continue;
+            }
+        }
+        ptr_transfer = ptr_transfer->next_transfer;
+    }
+}
+
+/*
+ * Frees a transfer.
+ *
+ * If the transfer is freed during a curl action (for example by a callback
+ * called with data received), it is only marked as deleted and freed after
+ * the curl action.
+ */
+
+void
+weeurl_transfer_free (struct t_url_transfer *transfer)
+{
+    if (!transfer || transfer->deleted)
+        return;
+
+    transfer->callback_write = NULL;
+    transfer->callback_end = NULL;
+    transfer->callback_pointer = NULL;
+
+    if (url_multi_action > 0)
+    {
+        transfer->deleted = 1;
+        url_transfers_deleted = 1;
+        return;
+    }
+
+    weeurl_transfer_remove (transfer);
+}
+
+/*
+ * Writes data received (callback called by Curl if there is no "file_out"
+ * in options).
+ */
+
+size_t
+weeurl_transfer_write_cb (void *buffer, size_t size, size_t nmemb,
+                          void *stream)
+{
+    struct t_url_transfer *transfer;
+
+    transfer = (struct t_url_transfer *)stream;
+
+    /* transfer freed: abort it */
+    if (transfer->deleted)
+        return 0;
+
+    if (transfer->callback_write && (size * nmemb > 0))
+    {
+        (void) (transfer->callback_write) (transfer->callback_pointer,
+                                           (const char *)buffer,
+                                           (int)(size * nmemb));
+    }
+
+    return size * nmemb;
+}
+
+/*
+ * Ends transfers completed by Curl: calls the end callback of each transfer
+ * then frees transfers marked as deleted.
+ */
+
+void
+weeurl_multi_check_done ()
+{
+    CURLMsg *msg;
+    struct t_url_transfer *ptr_transfer;
+    char *ptr_private, str_error[1024];
+    int msgs_left, rc;
+    t_url_callback_end *callback_end;
+    void *callback_pointer;
+
+    while ((msg = curl_multi_info_read (url_multi, &msgs_left)))
+    {
+        if (msg->msg != CURLMSG_DONE)
+            continue;
+
+        ptr_private = NULL;
+        curl_easy_getinfo (msg->easy_handle, CURLINFO_PRIVATE, &ptr_private);
+        ptr_transfer = (struct t_url_transfer *)ptr_private;
+        if (!ptr_transfer || ptr_transfer->deleted)
+            continue;
+
+        str_error[0] = '\0';
+        rc = 0;
+        if (msg->data.result != CURLE_OK)
+        {
+            snprintf (str_error, sizeof (str_error),
+                      _("curl error %d (%s) (URL: \"%s\")\n"),
+                      msg->data.result,
+                      ptr_transfer->error,
+                      ptr_transfer->url);
+            rc = 2;
+        }
+
+        /* remove transfer from multi handle, close files */
+        curl_multi_remove_handle (url_multi, (CURL *)ptr_transfer->curl);
+        ptr_transfer->running = 0;
+        if (ptr_transfer->url_file[1].stream)
+        {
+            fclose (ptr_transfer->url_file[1].stream);
+            ptr_transfer->url_file[1].stream = NULL;
+        }
+
+        /*
+         * the end callback is called only once: the transfer is usually
+         * freed by this callback
+         */
+        callback_end = ptr_transfer->callback_end;
+        callback_pointer = ptr_transfer->callback_pointer;
+        ptr_transfer->callback_write = NULL;
+        ptr_transfer->callback_end = NULL;
+        if (callback_end)
+        {
+            (void) (callback_end) (callback_pointer, rc,
+                                   (str_error[0]) ? str_error : NULL);
+        }
+    }
+
+    weeurl_transfer_remove_deleted ();
+    weeurl_transfer_add_pending ();
+}
+
+/*
+ * Runs a curl action on a socket (or CURL_SOCKET_TIMEOUT for timeout).
+ */
+
+void
+weeurl_multi_socket_action (curl_socket_t sock)
+{
+    int running_handles;
+
+    url_multi_action++;
+    (void) curl_multi_socket_action (url_multi, sock, 0, &running_handles);
+    url_multi_action--;
+
+    if (url_multi_action == 0)
+        weeurl_multi_check_done ();
+}
+
+/*
+ * Callback for activity on a socket used by Curl.
+ */
+
+int
+weeurl_multi_fd_cb (const void *pointer, void *data, int fd)
+{
+    /* make C compiler happy */
+    (void) pointer;
+    (void) data;
+
+    weeurl_multi_socket_action (fd);
+
+    return WEECHAT_RC_OK;
+}
+
+/*
+ * Callback for timer of Curl.
+ */
+
+int
+weeurl_multi_timer_cb (const void *pointer, void *data, int remaining_calls)
+{
+    /* make C compiler happy */
+    (void) pointer;
+    (void) data;
+    (void) remaining_calls;
+
+    /* the timer is called only once: it is removed after this callback */
+    url_multi_timer = NULL;
+
+    weeurl_multi_socket_action (CURL_SOCKET_TIMEOUT);
+
+    return WEECHAT_RC_OK;
+}
+
+/*
+ * Adds/updates/removes the fd hook for a socket used by Curl (callback
+ * called by Curl).
+ */
+
+int
+weeurl_multi_socket_cb (CURL *easy, curl_socket_t sock, int what,
+                        void *userp, void *socketp)
+{
+    struct t_hook *ptr_hook;
+
+    /* make C compiler happy */
+    (void) easy;
+    (void) userp;
+
+    if (socketp)
+    {
+        unhook ((struct t_hook *)socketp);
+        curl_multi_assign (url_multi, sock, NULL);
+    }
+
+    if (what != CURL_POLL_REMOVE)
+    {
+        ptr_hook = hook_fd (NULL, sock,
+                            (what & CURL_POLL_IN) ? 1 : 0,
+                            (what & CURL_POLL_OUT) ? 1 : 0,
+                            0,
+                            &weeurl_multi_fd_cb, NULL, NULL);
+        curl_multi_assign (url_multi, sock, ptr_hook);
+    }
+
+    return 0;
+}
+
+/*
+ * Sets the timer for the curl multi handle (callback called by Curl).
+ */
+
+int
+weeurl_multi_timer_function_cb (CURLM *multi, long timeout_ms, void *userp)
+{
+    /* make C compiler happy */
+    (void) multi;
+    (void) userp;
+
+    if (url_multi_timer)
+    {
+        unhook (url_multi_timer);
+        url_multi_timer = NULL;
+    }
+
+    if (timeout_ms >= 0)
+    {
+        url_multi_timer = hook_timer (NULL,
+                                      (timeout_ms > 0) ? timeout_ms : 1,
+                                      0, 1,
+                                      &weeurl_multi_timer_cb, NULL, NULL);
+    }
+
+    return 0;
+}
+
+/*
+ * Checks if transfers can be made in WeeChat process, with the curl multi
+ * handle (only if Curl resolves names asynchronously, otherwise the
+ * resolution of names would block WeeChat).
+ *
+ * Returns:
+ *   1: transfers can be made in WeeChat process
+ *   0: transfers must be made in a child process (function weeurl_download)
+ */
+
+int
+weeurl_transfer_available ()
+{
+    curl_version_info_data *info;
+
+    if (url_multi)
+        return 1;
+
+    if (url_multi_failed)
+        return 0;
+
+    info = curl_version_info (CURLVERSION_NOW);
+    if (!info || !(info->features & CURL_VERSION_ASYNCHDNS))
+    {
+        url_multi_failed = 1;
+        return 0;
+    }
+
+    url_multi = curl_multi_init ();
+    if (!url_multi)
+    {
+        url_multi_failed = 1;
+        return 0;
+    }
+
+    curl_multi_setopt (url_multi, CURLMOPT_SOCKETFUNCTION,
+                       &weeurl_multi_socket_cb);
+    curl_multi_setopt (url_multi, CURLMOPT_TIMERFUNCTION,
+                       &weeurl_multi_timer_function_cb);
+    weeurl_set_max_connections (
+        CONFIG_INTEGER(config_network_url_max_connections));
+
+    return 1;
+}
+
+/*
+ * Sets max number of connections opened by the curl multi handle (0 = no
+ * limit); other transfers are queued until a connection is available.
+ */
+
+void
+weeurl_set_max_connections (int max_connections)
+{
+    if (!url_multi)
+        return;
+
+#if LIBCURL_VERSION_NUM >= 0x071E00 /* 7.30.0 */
+    curl_multi_setopt (url_multi, CURLMOPT_MAX_TOTAL_CONNECTIONS,
+                       (long)max_connections);
+#else
+    /* make C compiler happy */
+    (void) max_connections;
+#endif /* LIBCURL_VERSION_NUM >= 0x071E00 */
+}
+
+/*
+ * Starts an asynchronous transfer in WeeChat process, with the curl multi
+ * handle (connections are reused by next transfers).
+ *
+ * Data received is sent to "callback_write" (if there is no "file_out" in
+ * options), and "callback_end" is called at the end of transfer, with the
+ * same return code as function weeurl_download.
+ *
+ * Returns pointer to new transfer, NULL if error (and then "return_code" is
+ * set to the error code, see function weeurl_download).
+ */
+
+struct t_url_transfer *
+weeurl_transfer_start (const char *url, struct t_hashtable *options,
+                       t_url_callback_write *callback_write,
+                       t_url_callback_end *callback_end,
+                       void *callback_pointer,
+                       int *return_code)
+{
+    struct t_url_transfer *new_transfer;
+
+    if (!weeurl_transfer_available ())
+    {
+        *return_code = 3;
+        return NULL;
+    }
+
+    new_transfer = weeurl_transfer_new (url, options, return_code);
+    if (!new_transfer)
+        return NULL;
+
+    new_transfer->callback_write = callback_write;
+    new_transfer->callback_end = callback_end;
+    new_transfer->callback_pointer = callback_pointer;
+
+    curl_easy_setopt ((CURL *)new_transfer->curl, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt ((CURL *)new_transfer->curl, CURLOPT_PRIVATE,
+                      new_transfer);
+    if (!new_transfer->url_file[1].stream)
+    {
+        curl_easy_setopt ((CURL *)new_transfer->curl, CURLOPT_WRITEFUNCTION,
+                          &weeurl_transfer_write_cb);
+        curl_easy_setopt ((CURL *)new_transfer->curl, CURLOPT_WRITEDATA,
+                          new_transfer);
+    }
+
+    if (url_multi_action > 0)
+    {
+        /* called during a curl action: transfer is added after the action */
+        new_transfer->pending = 1;
+        url_transfers_pending = 1;
+    }
+    else if (!weeurl_transfer_add_to_multi (new_transfer))
+    {
+        *return_code = 3;
+        weeurl_transfer_free_data (new_transfer);
+        return NULL;
+    }
+
+    /* add transfer at end of list */
+    new_transfer->prev_transfer = last_url_transfer;
+    if (last_url_transfer)
+        last_url_transfer->next_transfer = new_transfer;
+    else
+        url_transfers = new_transfer;
+    last_url_transfer = new_transfer;
+
+    return new_transfer;
 }
 
 /*
@@ -1331,3 +1917,28 @@ weeurl_option_add_to_infolist (struct t_infolist *infolist,
 
     return 1;
 }
+
+/*
+ * Ends transfers in WeeChat process and frees the curl multi handle.
+ */
+
+void
+weeurl_end ()
+{
+    while (url_transfers)
+    {
+        weeurl_transfer_remove (url_transfers);
+    }
+
+    if (url_multi)
+    {
+        curl_multi_cleanup (url_multi);
+        url_multi = NULL;
+    }
+
+    if (url_multi_timer)
+    {
+        unhook (url_multi_timer);
+        url_multi_timer = NULL;
+    }
+}
@@ -24,6 +24,7 @@
 
 struct t_hashtable;
 struct t_infolist;
+struct t_arraylist;
 
 enum t_url_type
 {
@@ -54,10 +55,44 @@ struct t_url_file
     FILE *stream;                      /* file stream                       */
 };
 
+typedef void (t_url_callback_write)(void *pointer,
+                                    const char *data, int size);
+typedef void (t_url_callback_end)(void *pointer, int return_code,
+                                  const char *error);
+
+struct t_url_transfer
+{
+    void *curl;                        /* curl easy handle                  */
+    char *url;                         /* URL                               */
+    struct t_url_file url_file[2];     /* files for input/output            */
+    struct t_arraylist *slists;        /* lists of strings set in options   */
+    char *error;                       /* curl error buffer                 */
+    t_url_callback_write *callback_write; /* data received (if no file_out) */
+    t_url_callback_end *callback_end;  /* end of transfer                   */
+    void *callback_pointer;            /* pointer sent to callbacks         */
+    int running;                       /* 1 if transfer is in multi handle  */
+    int pending;                       /* 1 if transfer must be added in    */
+                                       /* multi handle (after curl action)  */
+    int deleted;                       /* 1 if transfer must be freed       */
+                                       /* (after current curl action)       */
+    struct t_url_transfer *prev_transfer; /* link to previous transfer      */
+    struct t_url_transfer *next_transfer; /* link to next transfer          */
+};
+
 extern struct t_url_option url_options[];
 
 extern int weeurl_download (const char *url, struct t_hashtable *options);
+extern int weeurl_transfer_available ();
+extern struct t_url_transfer *weeurl_transfer_start (const char *url,
+                                                     struct t_hashtable *options,
+                                                     t_url_callback_write *callback_write,
+                                                     t_url_callback_end *callback_end,
+                                                     void *callback_pointer,
+                                                     int *return_code);
+extern void weeurl_transfer_free (struct t_url_transfer *transfer);
+extern void weeurl_set_max_connections (int max_connections);
 extern int weeurl_option_add_to_infolist (struct t_infolist *infolist,
                                           struct t_url_option *option);
+extern void weeurl_end ();
 
 #endif /* WEECHAT_URL_H */
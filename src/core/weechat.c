@@ -70,6 +70,7 @@
 #include "wee-secure-config.h"
 #include "wee-string.h"
 #include "wee-upgrade.h"
+#include "wee-url.h"
 #include "wee-utf8.h"
 #include "wee-util.h"
 #include "wee-version.h"
@@ -863,7 +864,9 @@ weechat_end (void (*gui_end_cb)(int clean_exit))
     config_file_free_all ();            /* free all configuration files     */
     gui_key_end ();                     /* remove all keys                  */
     unhook_all ();                      /* remove all hooks                 */
+    weeurl_end ();                      /* end URL transfers                */
     hdata_end ();                       /* end hdata                        */
+    eval_end ();                        /* end eval                         */
     secure_end ();                      /* end secured data                 */
     string_end ();                      /* end string                       */
     weechat_shutdown (-1, 0);           /* end other things                 */
@@ -1292,6 +1292,114 @@ gui_chat_display_time_to_prefix (struct t_gui_window *window,
         free (ptr_prefix);
 }
 
+/*
+ * Checks if the message "day changed" must be displayed before a line: if the
+ * line is the first line displayed in buffer and if its date is not today.
+ *
+ * Returns:
+ *   1: message must be displayed (date of line is stored in "date")
+ *   0: no message
+ */
+
+int
+gui_chat_day_changed_before_line (struct t_gui_window *window,
+                                  struct t_gui_line *line, struct tm *date)
+{
+    struct t_gui_line *ptr_prev_line;
+    struct tm local_time;
+    struct timeval tv_time;
+    time_t seconds;
+
+    if ((line->data->date == 0)
+        || !CONFIG_BOOLEAN(config_look_day_change)
+        || !window->buffer->day_change)
+    {
+        return 0;
+    }
+
+    /*
+     * lines are read with pointers (without uncompressing older lines): if
+     * older lines are compressed, this line is not the first one in buffer
+     */
+    ptr_prev_line = line->prev_line;
+    while (ptr_prev_line
+           && (!gui_line_is_displayed (ptr_prev_line)
+               || (ptr_prev_line->data->date == 0)))
+    {
+        ptr_prev_line = ptr_prev_line->prev_line;
+    }
+    if (ptr_prev_line)
+        return 0;
+    if (line->data->buffer->own_lines
+        && line->data->buffer->own_lines->last_block)
+    {
+        return 0;
+    }
+
+    gettimeofday (&tv_time, NULL);
+    seconds = tv_time.tv_sec;
+    localtime_r (&seconds, &local_time);
+    localtime_r (&line->data->date, date);
+
+    return ((local_time.tm_mday != date->tm_mday)
+            || (local_time.tm_mon != date->tm_mon)
+            || (local_time.tm_year != date->tm_year)) ? 1 : 0;
+}
+
+/*
+ * Checks if the message "day changed" must be displayed after a line: if the
+ * date of next line displayed (or current date for the last line) is not the
+ * same day.
+ *
+ * Returns:
+ *   1: message must be displayed (dates are stored in "date1" and "date2")
+ *   0: no message
+ */
+
+int
+gui_chat_day_changed_after_line (struct t_gui_window *window,
+                                 struct t_gui_line *line,
+                                 struct tm *date1, struct tm *date2)
+{
+    struct t_gui_line *ptr_next_line;
+    struct timeval tv_time;
+    time_t seconds, *ptr_time;
+
+    if ((line->data->date == 0)
+        || !CONFIG_BOOLEAN(config_look_day_change)
+        || !window->buffer->day_change)
+    {
+        return 0;
+    }
+
+    ptr_next_line = gui_line_get_next_displayed (line);
+    while (ptr_next_line && (ptr_next_line->data->date == 0))
+    {
+        ptr_next_line = gui_line_get_next_displayed (ptr_next_line);
+    }
+    if (ptr_next_line)
+    {
+        /* get time of next line */
+        ptr_time = &ptr_next_line->data->date;
+    }
+    else
+    {
+        /* it was the last line => compare with current system time */
+        gettimeofday (&tv_time, NULL);
+        seconds = tv_time.tv_sec;
+        ptr_time = &seconds;
+    }
+    if (*ptr_time == 0)
+        return 0;
+
+    localtime_r (&line->data->date, date1);
+    localtime_r (ptr_time, date2);
+
+    return ((date1->tm_mday != date2->tm_mday)
+            || (date1->tm_mon != date2->tm_mon)
+            || (date1->tm_year != date2->tm_year)) ? 1 : 0;
+}
+
 /*
  * Displays a line in the chat window.
  *
@@ -1304,8 +1412,9 @@ gui_chat_display_time_to_prefix (struct t_gui_window *window,
  */
 
 int
-gui_chat_display_line (struct t_gui_window *window, struct t_gui_line *line,
-                       int count, int simulate)
+gui_chat_display_line_internal (struct t_gui_window *window,
+                                struct t_gui_line *line,
+                                int count, int simulate)
 {
     int num_lines, x, y, pre_lines_displayed, lines_displayed, line_align;
     int read_marker_x, read_marker_y;
@@ -1313,10 +1422,7 @@ gui_chat_display_line (struct t_gui_window *window, struct t_gui_line *line,
     int word_length_with_spaces, word_length;
     char *message_with_tags, *message_with_search;
     const char *ptr_data, *ptr_end_offset, *ptr_style, *next_char;
-    struct t_gui_line *ptr_prev_line, *ptr_next_line;
     struct tm local_time, local_time2;
-    struct timeval tv_time;
-    time_t seconds, *ptr_time;
 
     if (!line)
         return 0;
@@ -1335,7 +1441,7 @@ gui_chat_display_line (struct t_gui_window *window, struct t_gui_line *line,
             return 0;
         x = window->win_chat_cursor_x;
         y = window->win_chat_cursor_y;
-        num_lines = gui_chat_display_line (window, line, 0, 1);
+        num_lines = gui_chat_get_line_height (window, line);
         window->win_chat_cursor_x = x;
         window->win_chat_cursor_y = y;
         gui_window_current_emphasis = 0;
@@ -1345,36 +1451,12 @@ gui_chat_display_line (struct t_gui_window *window, struct t_gui_line *line,
     lines_displayed = 0;
 
     /* display message before first line of buffer if date is not today */
-    if ((line->data->date != 0)
-        && CONFIG_BOOLEAN(config_look_day_change)
-        && window->buffer->day_change)
+    if (gui_chat_day_changed_before_line (window, line, &local_time2))
     {
-        ptr_time = NULL;
-        ptr_prev_line = gui_line_get_prev_displayed (line);
-        if (ptr_prev_line)
-        {
-            while (ptr_prev_line && (ptr_prev_line->data->date == 0))
-            {
-                ptr_prev_line = gui_line_get_prev_displayed (ptr_prev_line);
-            }
-        }
-        if (!ptr_prev_line)
-        {
-            gettimeofday (&tv_time, NULL);
-            seconds = tv_time.tv_sec;
-            localtime_r (&seconds, &local_time);
-            localtime_r (&line->data->date, &local_time2);
-            if ((local_time.tm_mday != local_time2.tm_mday)
-                || (local_time.tm_mon != local_time2.tm_mon)
-                || (local_time.tm_year != local_time2.tm_year))
-            {
-                gui_chat_display_day_changed (window, NULL, &local_time2,
-                                              simulate);
-                gui_chat_display_new_line (window, num_lines, count,
-                                           &lines_displayed, simulate);
-                pre_lines_displayed++;
-            }
-        }
+        gui_chat_display_day_changed (window, NULL, &local_time2, simulate);
+        gui_chat_display_new_line (window, num_lines, count,
+                                   &lines_displayed, simulate);
+        pre_lines_displayed++;
     }
 
     /* calculate marker position (maybe not used for this line!) */
@@ -1544,45 +1626,13 @@ gui_chat_display_line (struct t_gui_window *window, struct t_gui_line *line,
         free (message_with_search);
 
     /* display message if day has changed after this line */
-    if ((line->data->date != 0)
-        && CONFIG_BOOLEAN(config_look_day_change)
-        && window->buffer->day_change)
+    if (gui_chat_day_changed_after_line (window, line,
+                                         &local_time, &local_time2))
     {
-        ptr_time = NULL;
-        ptr_next_line = gui_line_get_next_displayed (line);
-        if (ptr_next_line)
-        {
-            while (ptr_next_line && (ptr_next_line->data->date == 0))
-            {
-                ptr_next_line = gui_line_get_next_displayed (ptr_next_line);
-            }
-        }
-        if (ptr_next_line)
-        {
-            /* get time of next line */
-            ptr_time = &ptr_next_line->data->date;
-        }
-        else
-        {
-            /* it was the last line => compare with current system time */
-            gettimeofday (&tv_time, NULL);
-            seconds = tv_time.tv_sec;
-            ptr_time = &seconds;
-        }
-        if (ptr_time && (*ptr_time != 0))
-        {
-            localtime_r (&line->data->date, &local_time);
-            localtime_r (ptr_time, &local_time2);
-            if ((local_time.tm_mday != local_time2.tm_mday)
-                || (local_time.tm_mon != local_time2.tm_mon)
-                || (local_time.tm_year != local_time2.tm_year))
-            {
-                gui_chat_display_day_changed (window, &local_time, &local_time2,
-                                              simulate);
-                gui_chat_display_new_line (window, num_lines, count,
-                                           &lines_displayed, simulate);
-            }
-        }
+        gui_chat_display_day_changed (window, &local_time, &local_time2,
+                                      simulate);
+        gui_chat_display_new_line (window, num_lines, count,
+                                   &lines_displayed, simulate);
     }
 
     /* display read marker (after line) */
@@ -1631,6 +1681,74 @@ gui_chat_display_line (struct t_gui_window *window, struct t_gui_line *line,
     return lines_displayed;
 }
 
+/*
+ * Returns number of lines on screen for a line: the line itself (with
+ * wrapped words) and the message "day changed" and the read marker if they
+ * are displayed with the line.
+ *
+ * The number of lines for the line itself is cached in line data; it is
+ * computed again if the chat width changed or if the stamp of line is not
+ * gui_line_height_stamp (changes in options, alignment, filters...).
+ */
+
+int
+gui_chat_get_line_height (struct t_gui_window *window, struct t_gui_line *line)
+{
+    struct tm date1, date2;
+    int width, height, extra_lines;
+
+    if (!line)
+        return 0;
+
+    /*
+     * the message "day changed" displayed before the first line changes
+     * alignment of the line: no cache in this case (only for one line)
+     */
+    if (gui_chat_day_changed_before_line (window, line, &date2))
+        return gui_chat_display_line_internal (window, line, 0, 1);
+
+    extra_lines = 0;
+    if (gui_chat_day_changed_after_line (window, line, &date1, &date2))
+        extra_lines++;
+    if (gui_chat_marker_for_line (window->buffer, line))
+        extra_lines++;
+
+    width = gui_chat_get_real_width (window);
+
+    if ((line->data->height_stamp != gui_line_height_stamp)
+        || (line->data->height_width != width))
+    {
+        height = gui_chat_display_line_internal (window, line, 0, 1);
+        line->data->height = height - extra_lines;
+        line->data->height_width = width;
+        line->data->height_stamp = gui_line_height_stamp;
+        return height;
+    }
+
+    return line->data->height + extra_lines;
+}
+
+/*
+ * Displays a line in the chat window.
+ *
+ * If count == 0, display whole line.
+ * If count > 0, display 'count' lines (beginning from the end).
+ * If simulate == 1, nothing is displayed and the number of lines that would
+ * have been displayed is returned (using the height of line in cache).
+ *
+ * Returns number of lines displayed (or simulated).
+ */
+
+int
+gui_chat_display_line (struct t_gui_window *window, struct t_gui_line *line,
+                       int count, int simulate)
+{
+    if (simulate)
+        return gui_chat_get_line_height (window, line);
+
+    return gui_chat_display_line_internal (window, line, count, 0);
+}
+
 /*
  * Displays a line in the chat window (for a buffer with free content).
  */
@@ -1860,7 +1978,7 @@ gui_chat_draw_formatted_buffer (struct t_gui_window *window)
     }
     else
         window->scroll->first_line_displayed =
-            (ptr_line == gui_line_get_first_displayed (window->buffer));
+            gui_line_is_first_displayed (window->buffer, ptr_line);
 
     /* display lines */
     while (ptr_line && (window->win_chat_cursor_y <= window->win_chat_height - 1))
@@ -1884,7 +2002,8 @@ gui_chat_draw_formatted_buffer (struct t_gui_window *window)
     }
 
     if (!window->scroll->scrolling
-        && (window->scroll->start_line == gui_line_get_first_displayed (window->buffer)))
+        && gui_line_is_first_displayed (window->buffer,
+                                        window->scroll->start_line))
     {
         window->scroll->start_line = NULL;
         window->scroll->start_line_pos = 0;
@@ -2059,7 +2178,7 @@ gui_chat_draw_bare (struct t_gui_window *window)
         {
             ptr_line = window->scroll->start_line;
             window->scroll->first_line_displayed =
-                (ptr_line == gui_line_get_first_displayed (window->buffer));
+                gui_line_is_first_displayed (window->buffer, ptr_line);
         }
         else
         {
@@ -2103,7 +2222,7 @@ gui_chat_draw_bare (struct t_gui_window *window)
             ptr_line = gui_line_get_prev_displayed (ptr_line);
         }
         window->scroll->first_line_displayed =
-            (ptr_line == gui_line_get_first_displayed (window->buffer));
+            gui_line_is_first_displayed (window->buffer, ptr_line);
     }
 
     /*
@@ -546,6 +546,9 @@ gui_main_loop ()
             send_signal_sigwinch = 1;
         }
 
+        /* send signal "nicklist_updated" for buffers with nicklist changed */
+        gui_nicklist_send_updated ();
+
         gui_main_refreshes ();
         if (gui_window_refresh_needed && !gui_window_bare_display)
             gui_main_refreshes ();
@@ -633,6 +636,9 @@ gui_main_end (int clean_exit)
             gui_buffer_close (gui_buffers);
         }
 
+        /* free memory used for lines */
+        gui_line_end ();
+
         gui_init_ok = 0;
 
         /* delete global history */
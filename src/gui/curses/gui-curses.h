@@ -98,6 +98,8 @@ extern int gui_color_weechat_get_pair (int weechat_color);
 extern void gui_color_alloc ();
 
 /* chat functions */
+extern int gui_chat_get_line_height (struct t_gui_window *window,
+                                     struct t_gui_line *line);
 extern void gui_chat_calculate_line_diff (struct t_gui_window *window,
                                           struct t_gui_line **line,
                                           int *line_pos, int difference);
@@ -2329,7 +2329,7 @@ gui_bar_item_init ()
                               gui_bar_item_names[GUI_BAR_ITEM_BUFFER_NICKLIST_COUNT]);
     gui_bar_item_hook_signal ("buffer_switch",
                               gui_bar_item_names[GUI_BAR_ITEM_BUFFER_NICKLIST_COUNT]);
-    gui_bar_item_hook_signal ("nicklist_*",
+    gui_bar_item_hook_signal ("nicklist_updated",
                               gui_bar_item_names[GUI_BAR_ITEM_BUFFER_NICKLIST_COUNT]);
 
     /* buffer nicklist count: groups displayed */
@@ -2340,7 +2340,7 @@ gui_bar_item_init ()
                               gui_bar_item_names[GUI_BAR_ITEM_BUFFER_NICKLIST_COUNT_GROUPS]);
     gui_bar_item_hook_signal ("buffer_switch",
                               gui_bar_item_names[GUI_BAR_ITEM_BUFFER_NICKLIST_COUNT_GROUPS]);
-    gui_bar_item_hook_signal ("nicklist_*",
+    gui_bar_item_hook_signal ("nicklist_updated",
                               gui_bar_item_names[GUI_BAR_ITEM_BUFFER_NICKLIST_COUNT_GROUPS]);
 
     /* buffer nicklist count: groups + nicks displayed */
@@ -2351,7 +2351,7 @@ gui_bar_item_init ()
                               gui_bar_item_names[GUI_BAR_ITEM_BUFFER_NICKLIST_COUNT_ALL]);
     gui_bar_item_hook_signal ("buffer_switch",
                               gui_bar_item_names[GUI_BAR_ITEM_BUFFER_NICKLIST_COUNT_ALL]);
-    gui_bar_item_hook_signal ("nicklist_*",
+    gui_bar_item_hook_signal ("nicklist_updated",
                               gui_bar_item_names[GUI_BAR_ITEM_BUFFER_NICKLIST_COUNT_ALL]);
 
     /* scroll indicator */
@@ -2398,7 +2398,7 @@ gui_bar_item_init ()
     gui_bar_item_new (NULL,
                       gui_bar_item_names[GUI_BAR_ITEM_BUFFER_NICKLIST],
                       &gui_bar_item_buffer_nicklist_cb, NULL, NULL);
-    gui_bar_item_hook_signal ("nicklist_*",
+    gui_bar_item_hook_signal ("nicklist_updated",
                               gui_bar_item_names[GUI_BAR_ITEM_BUFFER_NICKLIST]);
     gui_bar_item_hook_signal ("window_switch",
                               gui_bar_item_names[GUI_BAR_ITEM_BUFFER_NICKLIST]);
@@ -112,12 +112,13 @@ char *gui_buffer_properties_get_pointer[] =
   NULL
 };
 char *gui_buffer_properties_set[] =
-{ "hotlist", "unread", "display", "hidden", "print_hooks_enabled", "day_change",
-  "clear", "filter", "number", "name", "short_name", "type", "notify", "title",
-  "time_for_each_line", "nicklist", "nicklist_case_sensitive",
-  "nicklist_display_groups", "highlight_words", "highlight_words_add",
-  "highlight_words_del", "highlight_regex", "highlight_tags_restrict",
-  "highlight_tags", "hotlist_max_level_nicks", "hotlist_max_level_nicks_add",
+{ "hotlist", "unread", "uncompress_lines", "display", "hidden",
+  "print_hooks_enabled", "day_change", "clear", "filter", "number", "name",
+  "short_name", "type", "notify", "title", "time_for_each_line", "nicklist",
+  "nicklist_case_sensitive", "nicklist_display_groups", "nicklist_bulk_add",
+  "highlight_words", "highlight_words_add", "highlight_words_del",
+  "highlight_regex", "highlight_tags_restrict", "highlight_tags",
+  "hotlist_max_level_nicks", "hotlist_max_level_nicks_add",
   "hotlist_max_level_nicks_del", "input", "input_pos",
   "input_get_unknown_commands", "input_get_empty", "input_multiline",
   NULL
@@ -735,6 +736,10 @@ gui_buffer_new (struct t_weechat_plugin *plugin,
     new_buffer->nicklist_groups_visible_count = 0;
     new_buffer->nicklist_nicks_count = 0;
     new_buffer->nicklist_nicks_visible_count = 0;
+    new_buffer->nicklist_nicks_hashtable = NULL;
+    new_buffer->nicklist_nicks_key_collisions = 0;
+    new_buffer->nicklist_bulk_add = 0;
+    new_buffer->nicklist_updated = 0;
     new_buffer->nickcmp_callback = NULL;
     new_buffer->nickcmp_callback_pointer = NULL;
     new_buffer->nickcmp_callback_data = NULL;
@@ -815,6 +820,7 @@ gui_buffer_new (struct t_weechat_plugin *plugin,
     /* add buffer to buffers list */
     first_buffer_creation = (gui_buffers == NULL);
     gui_buffer_insert (new_buffer);
+    hdata_list_add_pointer (&gui_buffers, new_buffer);
 
     gui_buffers_count++;
 
@@ -914,11 +920,17 @@ int
 gui_buffer_valid (struct t_gui_buffer *buffer)
 {
     struct t_gui_buffer *ptr_buffer;
+    int rc;
 
     /* NULL buffer is valid (it's for printing on first buffer) */
     if (!buffer)
         return 1;
 
+    /* search in index of buffers pointers (if available) */
+    rc = hdata_list_search_pointer (&gui_buffers, buffer);
+    if (rc >= 0)
+        return rc;
+
     for (ptr_buffer = gui_buffers; ptr_buffer;
          ptr_buffer = ptr_buffer->next_buffer)
     {
@@ -1360,7 +1372,10 @@ gui_buffer_set_short_name (struct t_gui_buffer *buffer, const char *short_name)
         strdup (short_name) : NULL;
 
     if (buffer->mixed_lines)
+    {
         buffer->mixed_lines->buffer_max_length_refresh = 1;
+        gui_line_height_invalidate_all ();
+    }
     gui_buffer_ask_chat_refresh (buffer, 1);
 
     (void) hook_signal_send ("buffer_renamed",
@@ -1442,6 +1457,7 @@ gui_buffer_set_time_for_each_line (struct t_gui_buffer *buffer,
         return;
 
     buffer->time_for_each_line = (time_for_each_line) ? 1 : 0;
+    gui_line_height_invalidate_all ();
     gui_buffer_ask_chat_refresh (buffer, 2);
 }
 
@@ -2015,6 +2031,10 @@ gui_buffer_set (struct t_gui_buffer *buffer, const char *property,
     {
         gui_buffer_set_unread (buffer);
     }
+    else if (string_strcasecmp (property, "uncompress_lines") == 0)
+    {
+        gui_line_uncompress_all (buffer);
+    }
     else if (string_strcasecmp (property, "display") == 0)
     {
         /*
@@ -2152,6 +2172,13 @@ gui_buffer_set (struct t_gui_buffer *buffer, const char *property,
         if (error && !error[0])
             gui_buffer_set_nicklist_display_groups (buffer, number);
     }
+    else if (string_strcasecmp (property, "nicklist_bulk_add") == 0)
+    {
+        error = NULL;
+        number = strtol (value, &error, 10);
+        if (error && !error[0])
+            gui_nicklist_set_bulk_add (buffer, number);
+    }
     else if (string_strcasecmp (property, "highlight_words") == 0)
     {
         gui_buffer_set_highlight_words (buffer, value);
@@ -2919,10 +2946,8 @@ gui_buffer_close (struct t_gui_buffer *buffer)
 
     /* free all lines */
     gui_line_free_all (buffer);
-    if (buffer->own_lines)
-        free (buffer->own_lines);
-    if (buffer->mixed_lines)
-        free (buffer->mixed_lines);
+    gui_lines_free (buffer->own_lines);
+    gui_lines_free (buffer->mixed_lines);
 
     /* free some data */
     gui_buffer_undo_free_all (buffer);
@@ -2931,6 +2956,8 @@ gui_buffer_close (struct t_gui_buffer *buffer)
         gui_completion_free (buffer->completion);
     gui_nicklist_remove_all (buffer);
     gui_nicklist_remove_group (buffer, buffer->nicklist_root);
+    if (buffer->nicklist_nicks_hashtable)
+        hashtable_free (buffer->nicklist_nicks_hashtable);
     if (buffer->hotlist_max_level_nicks)
         hashtable_free (buffer->hotlist_max_level_nicks);
     gui_key_free_all (&buffer->keys, &buffer->last_key,
@@ -2993,6 +3020,7 @@ gui_buffer_close (struct t_gui_buffer *buffer)
         gui_buffers = buffer->next_buffer;
     if (last_gui_buffer == buffer)
         last_gui_buffer = buffer->prev_buffer;
+    hdata_list_remove_pointer (&gui_buffers, buffer);
 
     for (ptr_window = gui_windows; ptr_window;
          ptr_window = ptr_window->next_window)
@@ -3073,13 +3101,19 @@ gui_buffer_set_active_buffer (struct t_gui_buffer *buffer)
             if (ptr_buffer == buffer)
             {
                 if (active == 2)
+                {
                     ptr_buffer->lines = ptr_buffer->own_lines;
+                    gui_line_height_invalidate_all ();
+                }
                 ptr_buffer->active = active;
             }
             else
             {
                 if (ptr_buffer->active == 2)
+                {
                     ptr_buffer->lines = ptr_buffer->mixed_lines;
+                    gui_line_height_invalidate_all ();
+                }
                 ptr_buffer->active = 0;
             }
         }
@@ -3684,6 +3718,9 @@ gui_buffer_unmerge (struct t_gui_buffer *buffer, int number)
         buffer->lines = buffer->own_lines;
     }
 
+    /* lines are now displayed without buffer names */
+    gui_line_height_invalidate_all ();
+
     /* remove buffer from list */
     if (buffer->prev_buffer)
         (buffer->prev_buffer)->next_buffer = buffer->next_buffer;
@@ -4323,6 +4360,10 @@ gui_buffer_hdata_buffer_cb (const void *pointer, void *data,
         HDATA_VAR(struct t_gui_buffer, nicklist_groups_visible_count, INTEGER, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_buffer, nicklist_nicks_count, INTEGER, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_buffer, nicklist_nicks_visible_count, INTEGER, 0, NULL, NULL);
+        HDATA_VAR(struct t_gui_buffer, nicklist_nicks_hashtable, HASHTABLE, 0, NULL, NULL);
+        HDATA_VAR(struct t_gui_buffer, nicklist_nicks_key_collisions, INTEGER, 0, NULL, NULL);
+        HDATA_VAR(struct t_gui_buffer, nicklist_bulk_add, INTEGER, 0, NULL, NULL);
+        HDATA_VAR(struct t_gui_buffer, nicklist_updated, INTEGER, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_buffer, nickcmp_callback, POINTER, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_buffer, nickcmp_callback_pointer, POINTER, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_buffer, nickcmp_callback_data, POINTER, 0, NULL, NULL);
@@ -4747,6 +4788,10 @@ gui_buffer_print_log ()
         log_printf ("  nicklist_groups_vis_cnt : %d",    ptr_buffer->nicklist_groups_visible_count);
         log_printf ("  nicklist_nicks_count. . : %d",    ptr_buffer->nicklist_nicks_count);
         log_printf ("  nicklist_nicks_vis_cnt. : %d",    ptr_buffer->nicklist_nicks_visible_count);
+        log_printf ("  nicklist_nicks_hashtable: 0x%lx", ptr_buffer->nicklist_nicks_hashtable);
+        log_printf ("  nicklist_nicks_key_coll.: %d",    ptr_buffer->nicklist_nicks_key_collisions);
+        log_printf ("  nicklist_bulk_add . . . : %d",    ptr_buffer->nicklist_bulk_add);
+        log_printf ("  nicklist_updated. . . . : %d",    ptr_buffer->nicklist_updated);
         log_printf ("  nickcmp_callback. . . . : 0x%lx", ptr_buffer->nickcmp_callback);
         log_printf ("  nickcmp_callback_pointer: 0x%lx", ptr_buffer->nickcmp_callback_pointer);
         log_printf ("  nickcmp_callback_data . : 0x%lx", ptr_buffer->nickcmp_callback_data);
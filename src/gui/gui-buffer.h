@@ -138,6 +138,14 @@ struct t_gui_buffer
     int nicklist_groups_visible_count; /* number of groups displayed        */
     int nicklist_nicks_count;          /* number of nicks                   */
     int nicklist_nicks_visible_count;  /* number of nicks displayed         */
+    struct t_hashtable *nicklist_nicks_hashtable; /* nicks by name (key is  */
+                                       /* name in lower case)               */
+    int nicklist_nicks_key_collisions; /* > 0 if different nicks had same   */
+                                       /* key in hashtable                  */
+    int nicklist_bulk_add;             /* 1 if nicks are added in bulk      */
+                                       /* (sorted when bulk add ends)       */
+    int nicklist_updated;              /* 1 if nicklist has changed since   */
+                                       /* last signal "nicklist_updated"    */
     int (*nickcmp_callback)(const void *pointer, /* called to compare nicks */
                             void *data,          /* (search in nicklist)    */
                             struct t_gui_buffer *buffer,
@@ -88,6 +88,10 @@ gui_chat_init ()
                   &gui_chat_hsignal_quote_line_cb, NULL, NULL);
     hook_hsignal (NULL, "chat_quote_message",
                   &gui_chat_hsignal_quote_line_cb, NULL, NULL);
+
+    /* changes in options can change the height of lines displayed */
+    hook_config (NULL, "weechat.*",
+                 &gui_chat_config_weechat_cb, NULL, NULL);
 }
 
 /*
@@ -556,18 +560,27 @@ gui_chat_change_time_format ()
 {
     struct t_gui_buffer *ptr_buffer;
     struct t_gui_line *ptr_line;
+    struct t_gui_line_block *ptr_block;
+    char *str_time;
 
     for (ptr_buffer = gui_buffers; ptr_buffer;
          ptr_buffer = ptr_buffer->next_buffer)
     {
+        /* time of compressed lines is rebuilt when they are uncompressed */
+        for (ptr_block = ptr_buffer->own_lines->first_block; ptr_block;
+             ptr_block = ptr_block->next_block)
+        {
+            ptr_block->time_format_changed = 1;
+        }
         for (ptr_line = ptr_buffer->lines->first_line; ptr_line;
              ptr_line = ptr_line->next_line)
         {
             if (ptr_line->data->date != 0)
             {
-                if (ptr_line->data->str_time)
-                    free (ptr_line->data->str_time);
-                ptr_line->data->str_time = gui_chat_get_time_string (ptr_line->data->date);
+                str_time = gui_chat_get_time_string (ptr_line->data->date);
+                gui_line_set_str_time (ptr_line->data, str_time);
+                if (str_time)
+                    free (str_time);
             }
         }
     }
@@ -849,9 +862,7 @@ gui_chat_printf_date_tags_internal (struct t_gui_buffer *buffer,
                 }
                 new_line->data->prefix_length = gui_chat_strlen_screen (
                     new_line->data->prefix);
-                if (new_line->data->message)
-                    free (new_line->data->message);
-                new_line->data->message = strdup (ptr_msg);
+                gui_line_set_message (new_line->data, ptr_msg);
             }
         }
     }
@@ -878,7 +889,7 @@ no_print:
     if (new_line)
     {
         gui_line_free_data (new_line);
-        free (new_line);
+        gui_line_free_line (new_line);
     }
     if (string)
         free (string);
@@ -1050,7 +1061,7 @@ gui_chat_printf_y (struct t_gui_buffer *buffer, int y, const char *message, ...)
     if (!new_line->data->buffer)
     {
         gui_line_free_data (new_line);
-        free (new_line);
+        gui_line_free_line (new_line);
         goto end;
     }
 
@@ -1089,7 +1100,7 @@ gui_chat_printf_y (struct t_gui_buffer *buffer, int y, const char *message, ...)
         {
             string_fprintf (stdout, "%s\n", new_line->data->message);
             gui_line_free_data (new_line);
-            free (new_line);
+            gui_line_free_line (new_line);
         }
     }
     else if (gui_init_ok)
@@ -1120,6 +1131,26 @@ end:
     free (vbuffer);
 }
 
+/*
+ * Callback for changes on WeeChat options: the height of lines in chat area
+ * (cached) must be computed again.
+ */
+
+int
+gui_chat_config_weechat_cb (const void *pointer, void *data,
+                            const char *option, const char *value)
+{
+    /* make C compiler happy */
+    (void) pointer;
+    (void) data;
+    (void) option;
+    (void) value;
+
+    gui_line_height_invalidate_all ();
+
+    return WEECHAT_RC_OK;
+}
+
 /*
  * Quotes a line.
  */
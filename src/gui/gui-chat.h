@@ -98,6 +98,8 @@ extern void gui_chat_print_lines_waiting_buffer (FILE *f);
 extern int gui_chat_hsignal_quote_line_cb (const void *pointer, void *data,
                                            const char *signal,
                                            struct t_hashtable *hashtable);
+extern int gui_chat_config_weechat_cb (const void *pointer, void *data,
+                                       const char *option, const char *value);
 extern void gui_chat_end ();
 
 /* chat functions (GUI dependent) */
@@ -46,10 +46,109 @@
 struct t_gui_filter *gui_filters = NULL;           /* first filter          */
 struct t_gui_filter *last_gui_filter = NULL;       /* last filter           */
 int gui_filters_enabled = 1;                       /* filters enabled?      */
+unsigned long long gui_filter_cache_used = 0;      /* indexes of cache used */
+int gui_filter_count_no_cache = 0;                 /* filters without cache */
+
+struct t_gui_buffer *gui_filter_pending_buffer = NULL; /* lines to check    */
+struct t_gui_line *gui_filter_pending_line = NULL;     /* (with a timer)    */
+struct t_hook *gui_filter_pending_timer = NULL;
 
 
 /*
- * Checks if a line must be displayed or not (filtered).
+ * Checks if a filter matches a line (tags and regex), so that the line must
+ * be hidden if the filter is enabled and applies to the buffer of line.
+ *
+ * The result is cached in line data (one bit by filter), so that the tags and
+ * regex are checked only once for each line.
+ *
+ * Returns:
+ *   1: filter matches the line
+ *   0: filter does not match the line
+ */
+
+int
+gui_filter_match_line (struct t_gui_filter *filter,
+                       struct t_gui_line_data *line_data)
+{
+    unsigned long long bit;
+    int rc, match;
+
+    bit = 0;
+    if (filter->cache_index >= 0)
+    {
+        bit = 1ULL << filter->cache_index;
+        if (line_data->filters_checked & bit)
+            return (line_data->filters_match & bit) ? 1 : 0;
+    }
+
+    match = 0;
+    if ((strcmp (filter->tags, "*") == 0)
+        || (gui_line_match_tags (line_data,
+                                 filter->tags_count,
+                                 filter->tags_array)))
+    {
+        /* check line with regex */
+        rc = 1;
+        if (!filter->regex_prefix && !filter->regex_message)
+            rc = 0;
+        if (gui_line_match_regex (line_data,
+                                  filter->regex_prefix,
+                                  filter->regex_message))
+        {
+            rc = 0;
+        }
+        if (filter->regex && (filter->regex[0] == '!'))
+            rc ^= 1;
+        match = (rc == 0) ? 1 : 0;
+    }
+
+    if (bit)
+    {
+        line_data->filters_checked |= bit;
+        if (match)
+            line_data->filters_match |= bit;
+        else
+            line_data->filters_match &= ~bit;
+    }
+
+    return match;
+}
+
+/*
+ * Returns mask with bits of filters with a cache that are enabled and apply to
+ * a buffer.
+ */
+
+unsigned long long
+gui_filter_buffer_mask (struct t_gui_buffer *buffer)
+{
+    struct t_gui_filter *ptr_filter;
+    unsigned long long mask;
+
+    mask = 0;
+
+    for (ptr_filter = gui_filters; ptr_filter;
+         ptr_filter = ptr_filter->next_filter)
+    {
+        if (ptr_filter->enabled
+            && (ptr_filter->cache_index >= 0)
+            && string_match_list (buffer->full_name,
+                                  (const char **)ptr_filter->buffers,
+                                  0))
+        {
+            mask |= 1ULL << ptr_filter->cache_index;
+        }
+    }
+
+    return mask;
+}
+
+/*
+ * Checks if a line must be displayed or not (filtered), using mask of filters
+ * applying to the buffer of line (see function gui_filter_buffer_mask).
+ *
+ * If check_all == 0, the filters not yet checked on the line are ignored
+ * (they are checked later, see function gui_filter_check_pending).
  *
  * Returns:
  *   1: line must be displayed (not filtered)
@@ -57,10 +156,11 @@ int gui_filters_enabled = 1;                       /* filters enabled?      */
  */
 
 int
-gui_filter_check_line (struct t_gui_line_data *line_data)
+gui_filter_check_line_mask (struct t_gui_line_data *line_data,
+                            unsigned long long mask, int check_all)
 {
     struct t_gui_filter *ptr_filter;
-    int rc;
+    unsigned long long bit;
 
     /* line is always displayed if filters are disabled (globally or in buffer) */
     if (!gui_filters_enabled || !line_data->buffer->filter)
@@ -69,49 +169,72 @@ gui_filter_check_line (struct t_gui_line_data *line_data)
     if (gui_line_has_tag_no_filter (line_data))
         return 1;
 
+    /* fast path: all filters with a cache have been checked on the line */
+    if ((line_data->filters_checked & mask) == mask)
+    {
+        if (line_data->filters_match & mask)
+            return 0;
+        if (gui_filter_count_no_cache == 0)
+            return 1;
+    }
+
     for (ptr_filter = gui_filters; ptr_filter;
          ptr_filter = ptr_filter->next_filter)
     {
-        if (ptr_filter->enabled)
+        if (!ptr_filter->enabled)
+            continue;
+        if (ptr_filter->cache_index >= 0)
         {
-            /* check buffer */
-            if (string_match_list (line_data->buffer->full_name,
-                                   (const char **)ptr_filter->buffers,
-                                   0))
-            {
-                if ((strcmp (ptr_filter->tags, "*") == 0)
-                    || (gui_line_match_tags (line_data,
-                                             ptr_filter->tags_count,
-                                             ptr_filter->tags_array)))
-                {
-                    /* check line with regex */
-                    rc = 1;
-                    if (!ptr_filter->regex_prefix && !ptr_filter->regex_message)
-                        rc = 0;
-                    if (gui_line_match_regex (line_data,
-                                              ptr_filter->regex_prefix,
-                                              ptr_filter->regex_message))
-                    {
-                        rc = 0;
-                    }
-                    if (ptr_filter->regex && (ptr_filter->regex[0] == '!'))
-                        rc ^= 1;
-                    if (rc == 0)
-                        return 0;
-                }
-            }
+            bit = 1ULL << ptr_filter->cache_index;
+            if (!(mask & bit))
+                continue;
+            if (!check_all && !(line_data->filters_checked & bit))
+                continue;
+        }
+        else if (!string_match_list (line_data->buffer->full_name,
+                                     (const char **)ptr_filter->buffers,
+                                     0))
+        {
+            continue;
         }
+        if (gui_filter_match_line (ptr_filter, line_data))
+            return 0;
     }
 
     /* no tag or regex matching, then line is displayed */
     return 1;
 }
 
+/*
+ * Checks if a line must be displayed or not (filtered).
+ *
+ * Returns:
+ *   1: line must be displayed (not filtered)
+ *   0: line must be hidden (filtered)
+ */
+
+int
+gui_filter_check_line (struct t_gui_line_data *line_data)
+{
+    /* line is always displayed if filters are disabled (globally or in buffer) */
+    if (!gui_filters_enabled || !line_data->buffer->filter)
+        return 1;
+
+    return gui_filter_check_line_mask (
+        line_data,
+        gui_filter_buffer_mask (line_data->buffer),
+        1);
+}
+
 /*
  * Filters a buffer, using message filters.
  *
  * If line_data is NULL, filters all lines in buffer.
  * If line_data is not NULL, filters only this line_data.
+ *
+ * If lines are being checked in a timer (new or enabled filters), the filters
+ * not yet checked on lines are ignored: the buffer is filtered again when
+ * all lines have been checked.
  */
 
 void
@@ -120,18 +243,32 @@ gui_filter_buffer (struct t_gui_buffer *buffer,
 {
     struct t_gui_line *ptr_line;
     struct t_gui_line_data *ptr_line_data;
+    struct t_gui_buffer *ptr_mask_buffer;
     struct t_gui_window *ptr_window;
-    int lines_changed, line_displayed, lines_hidden;
+    unsigned long long mask;
+    int lines_changed, line_displayed, lines_hidden, check_all;
 
     lines_changed = 0;
     lines_hidden = buffer->lines->lines_hidden;
 
+    check_all = (line_data || !gui_filter_pending_buffer) ? 1 : 0;
+    ptr_mask_buffer = NULL;
+    mask = 0;
+
     ptr_line = buffer->lines->first_line;
     while (ptr_line || line_data)
     {
         ptr_line_data = (line_data) ? line_data : ptr_line->data;
 
-        line_displayed = gui_filter_check_line (ptr_line_data);
+        /* lines may come from different buffers (merged buffers) */
+        if (ptr_line_data->buffer != ptr_mask_buffer)
+        {
+            ptr_mask_buffer = ptr_line_data->buffer;
+            mask = gui_filter_buffer_mask (ptr_mask_buffer);
+        }
+
+        line_displayed = gui_filter_check_line_mask (ptr_line_data, mask,
+                                                     check_all);
 
         if (ptr_line_data->displayed != line_displayed)
         {
@@ -161,6 +298,9 @@ gui_filter_buffer (struct t_gui_buffer *buffer,
 
     if (lines_changed)
     {
+        /* display of lines depends on previous/next displayed lines */
+        gui_line_height_invalidate_all ();
+
         /* force a full refresh of buffer */
         gui_buffer_ask_chat_refresh (buffer, 2);
 
@@ -184,11 +324,102 @@ gui_filter_buffer (struct t_gui_buffer *buffer,
     }
 }
 
+/*
+ * Checks enabled filters on lines of all buffers (starting at
+ * gui_filter_pending_buffer/gui_filter_pending_line), so that the result is
+ * cached in lines.
+ *
+ * At most "max_lines" lines are checked (the lines already checked with all
+ * filters are skipped and not counted).
+ *
+ * Returns:
+ *   1: all lines have been checked
+ *   0: some lines remain to be checked
+ */
+
+int
+gui_filter_check_pending (int max_lines)
+{
+    struct t_gui_filter *ptr_filter;
+    unsigned long long mask;
+    int count;
+
+    count = 0;
+
+    while (gui_filter_pending_buffer)
+    {
+        if (!gui_buffer_valid (gui_filter_pending_buffer))
+        {
+            /* buffer closed: start again with first buffer */
+            gui_filter_pending_buffer = gui_buffers;
+            gui_filter_pending_line = (gui_buffers) ?
+                gui_buffers->own_lines->first_line : NULL;
+            continue;
+        }
+
+        mask = gui_filter_buffer_mask (gui_filter_pending_buffer);
+
+        while (mask && gui_filter_pending_line)
+        {
+            if (count >= max_lines)
+                return 0;
+            if ((gui_filter_pending_line->data->filters_checked & mask) != mask)
+            {
+                for (ptr_filter = gui_filters; ptr_filter;
+                     ptr_filter = ptr_filter->next_filter)
+                {
+                    if ((ptr_filter->cache_index >= 0)
+                        && (mask & (1ULL << ptr_filter->cache_index)))
+                    {
+                        (void) gui_filter_match_line (
+                            ptr_filter, gui_filter_pending_line->data);
+                    }
+                }
+                count++;
+            }
+            gui_filter_pending_line = gui_filter_pending_line->next_line;
+        }
+
+        gui_filter_pending_buffer = gui_filter_pending_buffer->next_buffer;
+        gui_filter_pending_line = (gui_filter_pending_buffer) ?
+            gui_filter_pending_buffer->own_lines->first_line : NULL;
+    }
+
+    return 1;
+}
+
+/*
+ * Callback of timer used to check filters on lines.
+ */
+
+int
+gui_filter_pending_timer_cb (const void *pointer, void *data,
+                             int remaining_calls)
+{
+    /* make C compiler happy */
+    (void) pointer;
+    (void) data;
+    (void) remaining_calls;
+
+    if (gui_filter_check_pending (GUI_FILTER_PENDING_MAX_LINES))
+    {
+        unhook (gui_filter_pending_timer);
+        gui_filter_pending_timer = NULL;
+        gui_filter_all_buffers (NULL);
+    }
+
+    return WEECHAT_RC_OK;
+}
+
 /*
  * Filters all buffers, using message filters.
  *
  * If filter is NULL, filters all buffers.
  * If filter is not NULL, filters only buffers matched by this filter.
+ *
+ * Filters are checked immediately on at most GUI_FILTER_PENDING_MAX_LINES
+ * lines not yet checked; other lines are checked in a timer and all buffers
+ * are filtered again when all lines have been checked.
  */
 
 void
@@ -196,6 +427,27 @@ gui_filter_all_buffers (struct t_gui_filter *filter)
 {
     struct t_gui_buffer *ptr_buffer;
 
+    if (gui_filters_enabled)
+    {
+        gui_filter_pending_buffer = gui_buffers;
+        gui_filter_pending_line = (gui_buffers) ?
+            gui_buffers->own_lines->first_line : NULL;
+        if (gui_filter_check_pending (GUI_FILTER_PENDING_MAX_LINES))
+        {
+            if (gui_filter_pending_timer)
+            {
+                unhook (gui_filter_pending_timer);
+                gui_filter_pending_timer = NULL;
+            }
+        }
+        else if (!gui_filter_pending_timer)
+        {
+            gui_filter_pending_timer = hook_timer (
+                NULL, 1, 0, 0,
+                &gui_filter_pending_timer_cb, NULL, NULL);
+        }
+    }
+
     for (ptr_buffer = gui_buffers; ptr_buffer;
          ptr_buffer = ptr_buffer->next_buffer)
     {
@@ -262,6 +514,59 @@ gui_filter_search_by_name (const char *name)
     return NULL;
 }
 
+/*
+ * Gets a free index for cache of filter result in lines.
+ *
+ * Returns index (between 0 and GUI_FILTER_CACHE_MAX - 1), -1 if all indexes
+ * are used.
+ */
+
+int
+gui_filter_cache_index_new ()
+{
+    int i;
+
+    for (i = 0; i < GUI_FILTER_CACHE_MAX; i++)
+    {
+        if (!(gui_filter_cache_used & (1ULL << i)))
+        {
+            gui_filter_cache_used |= 1ULL << i;
+            return i;
+        }
+    }
+
+    /* all indexes are used */
+    return -1;
+}
+
+/*
+ * Releases an index for cache of filter result in lines: the bit is cleared
+ * in all lines, so that the index can be used by another filter.
+ */
+
+void
+gui_filter_cache_index_free (int index)
+{
+    struct t_gui_buffer *ptr_buffer;
+    struct t_gui_line *ptr_line;
+    unsigned long long bit;
+
+    bit = 1ULL << index;
+
+    for (ptr_buffer = gui_buffers; ptr_buffer;
+         ptr_buffer = ptr_buffer->next_buffer)
+    {
+        for (ptr_line = ptr_buffer->own_lines->first_line; ptr_line;
+             ptr_line = ptr_line->next_line)
+        {
+            ptr_line->data->filters_checked &= ~bit;
+            ptr_line->data->filters_match &= ~bit;
+        }
+    }
+
+    gui_filter_cache_used &= ~bit;
+}
+
 /*
  * Displays an error when a new filter is created.
  */
@@ -410,6 +715,9 @@ gui_filter_new (int enabled, const char *name, const char *buffer_name,
         new_filter->regex = strdup (regex);
         new_filter->regex_prefix = regex1;
         new_filter->regex_message = regex2;
+        new_filter->cache_index = gui_filter_cache_index_new ();
+        if (new_filter->cache_index < 0)
+            gui_filter_count_no_cache++;
 
         /* add filter to filters list */
         new_filter->prev_filter = last_gui_filter;
@@ -491,6 +799,12 @@ gui_filter_free (struct t_gui_filter *filter)
         free (filter->regex_message);
     }
 
+    /* release index of cache in lines */
+    if (filter->cache_index >= 0)
+        gui_filter_cache_index_free (filter->cache_index);
+    else
+        gui_filter_count_no_cache--;
+
     /* remove filter from filters list */
     if (filter->prev_filter)
         (filter->prev_filter)->next_filter = filter->next_filter;
@@ -517,6 +831,14 @@ gui_filter_free_all ()
     {
         gui_filter_free (gui_filters);
     }
+
+    if (gui_filter_pending_timer)
+    {
+        unhook (gui_filter_pending_timer);
+        gui_filter_pending_timer = NULL;
+    }
+    gui_filter_pending_buffer = NULL;
+    gui_filter_pending_line = NULL;
 }
 
 /*
@@ -622,6 +944,8 @@ gui_filter_print_log ()
 
     log_printf ("");
     log_printf ("gui_filters_enabled = %d", gui_filters_enabled);
+    log_printf ("gui_filter_pending_buffer = 0x%lx", gui_filter_pending_buffer);
+    log_printf ("gui_filter_pending_line = 0x%lx", gui_filter_pending_line);
 
     for (ptr_filter = gui_filters; ptr_filter;
          ptr_filter = ptr_filter->next_filter)
@@ -641,6 +965,7 @@ gui_filter_print_log ()
         log_printf ("  regex. . . . . . . . . : '%s'",  ptr_filter->regex);
         log_printf ("  regex_prefix . . . . . : 0x%lx", ptr_filter->regex_prefix);
         log_printf ("  regex_message. . . . . : 0x%lx", ptr_filter->regex_message);
+        log_printf ("  cache_index. . . . . . : %d",    ptr_filter->cache_index);
         log_printf ("  prev_filter. . . . . . : 0x%lx", ptr_filter->prev_filter);
         log_printf ("  next_filter. . . . . . : 0x%lx", ptr_filter->next_filter);
     }
@@ -24,8 +24,16 @@
 
 #define GUI_FILTER_TAG_NO_FILTER "no_filter"
 
+/* max number of filters with result cached in lines (1 bit by filter) */
+#define GUI_FILTER_CACHE_MAX 64
+
+/* max number of lines checked at once (other lines are checked in a timer) */
+#define GUI_FILTER_PENDING_MAX_LINES 1000
+
 /* filter structures */
 
+struct t_gui_buffer;
+struct t_gui_line;
 struct t_gui_line_data;
 
 struct t_gui_filter
@@ -41,6 +49,8 @@ struct t_gui_filter
     char *regex;                       /* regex                             */
     regex_t *regex_prefix;             /* regex for line prefix             */
     regex_t *regex_message;            /* regex for line message            */
+    int cache_index;                   /* index of bit in lines (cache of   */
+                                       /* filter result), -1 if no cache    */
     struct t_gui_filter *prev_filter;  /* link to previous filter           */
     struct t_gui_filter *next_filter;  /* link to next filter               */
 };
@@ -50,16 +60,27 @@ struct t_gui_filter
 extern struct t_gui_filter *gui_filters;
 extern struct t_gui_filter *last_gui_filter;
 extern int gui_filters_enabled;
+extern struct t_gui_buffer *gui_filter_pending_buffer;
+extern struct t_gui_line *gui_filter_pending_line;
 
 /* filter functions */
 
+extern int gui_filter_match_line (struct t_gui_filter *filter,
+                                  struct t_gui_line_data *line_data);
+extern unsigned long long gui_filter_buffer_mask (struct t_gui_buffer *buffer);
+extern int gui_filter_check_line_mask (struct t_gui_line_data *line_data,
+                                       unsigned long long mask,
+                                       int check_all);
 extern int gui_filter_check_line (struct t_gui_line_data *line_data);
 extern void gui_filter_buffer (struct t_gui_buffer *buffer,
                                struct t_gui_line_data *line_data);
+extern int gui_filter_check_pending (int max_lines);
 extern void gui_filter_all_buffers (struct t_gui_filter *filter);
 extern void gui_filter_global_enable ();
 extern void gui_filter_global_disable ();
 extern struct t_gui_filter *gui_filter_search_by_name (const char *name);
+extern int gui_filter_cache_index_new ();
+extern void gui_filter_cache_index_free (int index);
 extern struct t_gui_filter *gui_filter_new (int enabled,
                                             const char *name,
                                             const char *buffer_name,
@@ -1764,6 +1764,7 @@ gui_input_zoom_merged_buffer (struct t_gui_buffer *buffer)
         buffer->active = 1;
         buffer->lines = buffer->mixed_lines;
     }
+    gui_line_height_invalidate_all ();
 
     /* set "zoomed" in merged buffers */
     for (ptr_buffer = gui_buffers; ptr_buffer;
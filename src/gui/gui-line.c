@@ -25,8 +25,10 @@
 
 #include <stdlib.h>
 #include <stddef.h>
+#include <limits.h>
 #include <string.h>
 #include <time.h>
+#include <zlib.h>
 
 #include "../core/weechat.h"
 #include "../core/wee-config.h"
@@ -35,6 +37,7 @@
 #include "../core/wee-hook.h"
 #include "../core/wee-infolist.h"
 #include "../core/wee-log.h"
+#include "../core/wee-slab.h"
 #include "../core/wee-string.h"
 #include "../plugins/plugin.h"
 #include "gui-line.h"
@@ -47,6 +50,14 @@
 #include "gui-window.h"
 
 
+int gui_line_height_stamp = 1;         /* stamp for height of lines: the    */
+                                       /* height of a line is valid if its  */
+                                       /* stamp is equal to this one        */
+
+struct t_slab *gui_line_slab_lines = NULL;      /* slab for lines           */
+struct t_slab *gui_line_slab_lines_data = NULL; /* slab for lines data      */
+
+
 /*
  * Allocates structure "t_gui_lines" and initializes it.
  *
@@ -71,6 +82,10 @@ gui_lines_alloc ()
         new_lines->buffer_max_length_refresh = 0;
         new_lines->prefix_max_length = CONFIG_INTEGER(config_look_prefix_align_min);
         new_lines->prefix_max_length_refresh = 0;
+        new_lines->first_block = NULL;
+        new_lines->last_block = NULL;
+        new_lines->compressed_lines_count = 0;
+        hdata_list_index_new (&new_lines->first_line);
     }
 
     return new_lines;
@@ -86,9 +101,150 @@ gui_lines_free (struct t_gui_lines *lines)
     if (!lines)
         return;
 
+    gui_line_free_all_blocks (lines);
+
+    hdata_list_index_free (&lines->first_line);
+
     free (lines);
 }
 
+/*
+ * Allocates a line (structure only, data is not allocated).
+ *
+ * Returns pointer to new line, NULL if error.
+ */
+
+struct t_gui_line *
+gui_line_alloc ()
+{
+    if (!gui_line_slab_lines)
+    {
+        gui_line_slab_lines = slab_new (sizeof (struct t_gui_line));
+        if (!gui_line_slab_lines)
+            return NULL;
+    }
+    return slab_alloc (gui_line_slab_lines);
+}
+
+/*
+ * Allocates data for a line (content is not initialized).
+ *
+ * Returns pointer to new line data, NULL if error.
+ */
+
+struct t_gui_line_data *
+gui_line_alloc_data ()
+{
+    if (!gui_line_slab_lines_data)
+    {
+        gui_line_slab_lines_data = slab_new (sizeof (struct t_gui_line_data));
+        if (!gui_line_slab_lines_data)
+            return NULL;
+    }
+    return slab_alloc (gui_line_slab_lines_data);
+}
+
+/*
+ * Frees a line (structure only, data is not freed).
+ */
+
+void
+gui_line_free_line (struct t_gui_line *line)
+{
+    slab_free_object (gui_line_slab_lines, line);
+}
+
+/*
+ * Sets strings of a line_data: time, tags and message.
+ *
+ * They are stored in a single block (pointed by line_data->message):
+ * message + '\0' + array of tags (+ NULL) + time + '\0'.
+ *
+ * Arguments can point to the current strings of line_data (the old block is
+ * freed after the new one is built).  Tags must be shared strings (see
+ * function string_split_shared) and they are given to the line (they are not
+ * freed by this function).
+ *
+ * Returns:
+ *   1: OK
+ *   0: error (line_data is unchanged)
+ */
+
+int
+gui_line_set_strings (struct t_gui_line_data *line_data,
+                      const char *str_time,
+                      int tags_count, char **tags_array,
+                      const char *message)
+{
+    char *block, **new_tags_array, *new_str_time;
+    size_t length_message, offset_tags, length_tags, length_time;
+
+    if (!message)
+        message = "";
+    if (!tags_array)
+        tags_count = 0;
+
+    length_message = strlen (message) + 1;
+    offset_tags = ((length_message + sizeof (char *) - 1) / sizeof (char *))
+        * sizeof (char *);
+    length_tags = (tags_count > 0) ? (tags_count + 1) * sizeof (char *) : 0;
+    length_time = (str_time) ? strlen (str_time) + 1 : 0;
+
+    block = malloc (offset_tags + length_tags + length_time);
+    if (!block)
+        return 0;
+
+    memcpy (block, message, length_message);
+
+    new_tags_array = NULL;
+    if (tags_count > 0)
+    {
+        new_tags_array = (char **)(block + offset_tags);
+        memcpy (new_tags_array, tags_array, tags_count * sizeof (char *));
+        new_tags_array[tags_count] = NULL;
+    }
+
+    new_str_time = NULL;
+    if (str_time)
+    {
+        new_str_time = block + offset_tags + length_tags;
+        memcpy (new_str_time, str_time, length_time);
+    }
+
+    if (line_data->message)
+        free (line_data->message);
+    line_data->message = block;
+    line_data->tags_count = tags_count;
+    line_data->tags_array = new_tags_array;
+    line_data->str_time = new_str_time;
+
+    return 1;
+}
+
+/*
+ * Sets time string of a line_data.
+ */
+
+void
+gui_line_set_str_time (struct t_gui_line_data *line_data, const char *str_time)
+{
+    gui_line_set_strings (line_data, str_time,
+                          line_data->tags_count, line_data->tags_array,
+                          line_data->message);
+}
+
+/*
+ * Sets message of a line_data.
+ */
+
+void
+gui_line_set_message (struct t_gui_line_data *line_data, const char *message)
+{
+    gui_line_set_strings (line_data, line_data->str_time,
+                          line_data->tags_count, line_data->tags_array,
+                          message);
+}
+
 /*
  * Allocates array with tags in a line_data.
  */
@@ -96,15 +252,24 @@ gui_lines_free (struct t_gui_lines *lines)
 void
 gui_line_tags_alloc (struct t_gui_line_data *line_data, const char *tags)
 {
+    char **tags_array;
+    int tags_count;
+
+    tags_array = NULL;
+    tags_count = 0;
     if (tags)
+        tags_array = string_split_shared (tags, ",", NULL, 0, 0, &tags_count);
+
+    if (gui_line_set_strings (line_data, line_data->str_time,
+                              tags_count, tags_array, line_data->message))
     {
-        line_data->tags_array = string_split_shared (tags, ",", NULL, 0, 0,
-                                                     &line_data->tags_count);
+        /* tags are now in line_data, free only the array */
+        if (tags_array)
+            free (tags_array);
     }
-    else
+    else if (tags_array)
     {
-        line_data->tags_count = 0;
-        line_data->tags_array = NULL;
+        string_free_split_shared (tags_array);
     }
 }
 
@@ -115,12 +280,18 @@ gui_line_tags_alloc (struct t_gui_line_data *line_data, const char *tags)
 void
 gui_line_tags_free (struct t_gui_line_data *line_data)
 {
+    int i;
+
     if (!line_data)
         return;
 
     if (line_data->tags_array)
     {
-        string_free_split_shared (line_data->tags_array);
+        /* array is in block of line_data strings, free only the tags */
+        for (i = 0; i < line_data->tags_count; i++)
+        {
+            string_shared_free (line_data->tags_array[i]);
+        }
         line_data->tags_count = 0;
         line_data->tags_array = NULL;
     }
@@ -369,6 +540,45 @@ gui_line_get_align (struct t_gui_buffer *buffer, struct t_gui_line *line,
         + length_suffix;
 }
 
+/*
+ * Invalidates height of all lines (cached for display in chat area).
+ *
+ * This function must be called when something changes the display of lines:
+ * options, alignment of prefix, merged buffers, filters, etc.
+ */
+
+void
+gui_line_height_invalidate_all ()
+{
+    gui_line_height_stamp = (gui_line_height_stamp < INT_MAX) ?
+        gui_line_height_stamp + 1 : 1;
+}
+
+/*
+ * Invalidates height of displayed lines before and after a line: their
+ * display can depend on this line (for example with options
+ * weechat.look.prefix_same_nick and weechat.look.buffer_time_same).
+ */
+
+void
+gui_line_height_invalidate_neighbours (struct t_gui_line *line)
+{
+    struct t_gui_line *ptr_line;
+
+    /* compressed lines have no height: they are not uncompressed here */
+    ptr_line = line->prev_line;
+    while (ptr_line && !gui_line_is_displayed (ptr_line))
+    {
+        ptr_line = ptr_line->prev_line;
+    }
+    if (ptr_line)
+        ptr_line->data->height_stamp = 0;
+
+    ptr_line = gui_line_get_next_displayed (line);
+    if (ptr_line)
+        ptr_line->data->height_stamp = 0;
+}
+
 /*
  * Checks if a line is displayed (no filter on line or filters disabled).
  *
@@ -391,6 +601,8 @@ gui_line_is_displayed (struct t_gui_line *line)
 /*
  * Gets the first line displayed of a buffer.
  *
+ * All compressed lines of buffer are uncompressed (if any).
+ *
  * Returns pointer to first line displayed, NULL if not found.
  */
 
@@ -399,6 +611,8 @@ gui_line_get_first_displayed (struct t_gui_buffer *buffer)
 {
     struct t_gui_line *ptr_line;
 
+    gui_line_uncompress_all (buffer);
+
     ptr_line = buffer->lines->first_line;
     while (ptr_line && !gui_line_is_displayed (ptr_line))
     {
@@ -428,6 +642,64 @@ gui_line_get_last_displayed (struct t_gui_buffer *buffer)
     return ptr_line;
 }
 
+/*
+ * Checks if a line is the first line displayed of a buffer.
+ *
+ * Unlike function gui_line_get_first_displayed, compressed lines are not
+ * uncompressed: if buffer has compressed lines, the line is not the first
+ * one displayed.
+ *
+ * Returns:
+ *   1: line is the first line displayed
+ *   0: line is not the first line displayed
+ */
+
+int
+gui_line_is_first_displayed (struct t_gui_buffer *buffer,
+                             struct t_gui_line *line)
+{
+    struct t_gui_line *ptr_line;
+
+    if (buffer->lines->first_block)
+        return 0;
+
+    ptr_line = buffer->lines->first_line;
+    while (ptr_line && !gui_line_is_displayed (ptr_line))
+    {
+        ptr_line = ptr_line->next_line;
+    }
+
+    return (ptr_line == line) ? 1 : 0;
+}
+
+/*
+ * Gets previous line.
+ *
+ * If line is the first line of buffer and that older lines are compressed,
+ * the last block of compressed lines is uncompressed: this is for navigation
+ * in lines (scroll, search); internal bookkeeping must use line->prev_line.
+ *
+ * Returns pointer to previous line, NULL if not found.
+ */
+
+struct t_gui_line *
+gui_line_get_prev (struct t_gui_line *line)
+{
+    struct t_gui_lines *ptr_lines;
+
+    if (!line->prev_line)
+    {
+        ptr_lines = line->data->buffer->own_lines;
+        if (ptr_lines && (ptr_lines->first_line == line)
+            && ptr_lines->last_block)
+        {
+            gui_line_uncompress_block (line->data->buffer);
+        }
+    }
+
+    return line->prev_line;
+}
+
 /*
  * Gets previous line displayed.
  *
@@ -439,10 +711,10 @@ gui_line_get_prev_displayed (struct t_gui_line *line)
 {
     if (line)
     {
-        line = line->prev_line;
+        line = gui_line_get_prev (line);
         while (line && !gui_line_is_displayed (line))
         {
-            line = line->prev_line;
+            line = gui_line_get_prev (line);
         }
     }
     return line;
@@ -926,9 +1198,10 @@ gui_line_compute_buffer_max_length (struct t_gui_buffer *buffer,
                                     struct t_gui_lines *lines)
 {
     struct t_gui_buffer *ptr_buffer;
-    int length;
+    int length, old_buffer_max_length;
     const char *short_name;
 
+    old_buffer_max_length = lines->buffer_max_length;
     lines->buffer_max_length = 0;
 
     for (ptr_buffer = gui_buffers; ptr_buffer;
@@ -943,6 +1216,9 @@ gui_line_compute_buffer_max_length (struct t_gui_buffer *buffer,
         }
     }
 
+    if (lines->buffer_max_length != old_buffer_max_length)
+        gui_line_height_invalidate_all ();
+
     lines->buffer_max_length_refresh = 0;
 }
 
@@ -954,8 +1230,9 @@ void
 gui_line_compute_prefix_max_length (struct t_gui_lines *lines)
 {
     struct t_gui_line *ptr_line;
-    int prefix_length, prefix_is_nick;
+    int prefix_length, prefix_is_nick, old_prefix_max_length;
 
+    old_prefix_max_length = lines->prefix_max_length;
     lines->prefix_max_length = CONFIG_INTEGER(config_look_prefix_align_min);
 
     for (ptr_line = lines->first_line; ptr_line;
@@ -972,6 +1249,9 @@ gui_line_compute_prefix_max_length (struct t_gui_lines *lines)
         }
     }
 
+    if (lines->prefix_max_length != old_prefix_max_length)
+        gui_line_height_invalidate_all ();
+
     lines->prefix_max_length_refresh = 0;
 }
 
@@ -993,6 +1273,10 @@ gui_line_add_to_list (struct t_gui_lines *lines,
     line->next_line = NULL;
     lines->last_line = line;
 
+    hdata_list_add_pointer (&lines->first_line, line);
+
+    gui_line_height_invalidate_neighbours (line);
+
     /*
      * adjust "prefix_max_length" if this prefix length is > max
      * (only if the line is displayed
@@ -1004,7 +1288,10 @@ gui_line_add_to_list (struct t_gui_lines *lines,
         if (prefix_is_nick)
             prefix_length += config_length_nick_prefix_suffix;
         if (prefix_length > lines->prefix_max_length)
+        {
             lines->prefix_max_length = prefix_length;
+            gui_line_height_invalidate_all ();
+        }
     }
     else
     {
@@ -1022,14 +1309,12 @@ gui_line_add_to_list (struct t_gui_lines *lines,
 void
 gui_line_free_data (struct t_gui_line *line)
 {
-    if (line->data->str_time)
-        free (line->data->str_time);
     gui_line_tags_free (line->data);
     if (line->data->prefix)
         string_shared_free (line->data->prefix);
     if (line->data->message)
         free (line->data->message);
-    free (line->data);
+    slab_free_object (gui_line_slab_lines_data, line->data);
 
     line->data = NULL;
 }
@@ -1097,6 +1382,12 @@ gui_line_remove_from_list (struct t_gui_buffer *buffer,
     if (!line->data->displayed && (lines->lines_hidden > 0))
         (lines->lines_hidden)--;
 
+    gui_line_height_invalidate_neighbours (line);
+
+    /* move position of filters check if it was on line we are removing */
+    if (gui_filter_pending_line == line)
+        gui_filter_pending_line = line->next_line;
+
     /* free data */
     if (free_data)
         gui_line_free_data (line);
@@ -1111,9 +1402,11 @@ gui_line_remove_from_list (struct t_gui_buffer *buffer,
     if (lines->last_line == line)
         lines->last_line = line->prev_line;
 
+    hdata_list_remove_pointer (&lines->first_line, line);
+
     lines->lines_count--;
 
-    free (line);
+    gui_line_free_line (line);
 }
 
 /*
@@ -1126,7 +1419,7 @@ gui_line_mixed_add (struct t_gui_lines *lines,
 {
     struct t_gui_line *new_line;
 
-    new_line = malloc (sizeof (*new_line));
+    new_line = gui_line_alloc ();
     if (new_line)
     {
         new_line->data = line_data;
@@ -1222,12 +1515,518 @@ gui_line_free (struct t_gui_buffer *buffer, struct t_gui_line *line)
 void
 gui_line_free_all (struct t_gui_buffer *buffer)
 {
+    gui_line_free_all_blocks (buffer->own_lines);
+
     while (buffer->own_lines->first_line)
     {
         gui_line_free (buffer, buffer->own_lines->first_line);
     }
 }
 
+/*
+ * Frees a block of compressed lines.
+ */
+
+void
+gui_line_free_block (struct t_gui_lines *lines,
+                     struct t_gui_line_block *block)
+{
+    if (!lines || !block)
+        return;
+
+    /* remove block from list */
+    if (block->prev_block)
+        (block->prev_block)->next_block = block->next_block;
+    if (block->next_block)
+        (block->next_block)->prev_block = block->prev_block;
+    if (lines->first_block == block)
+        lines->first_block = block->next_block;
+    if (lines->last_block == block)
+        lines->last_block = block->prev_block;
+
+    lines->compressed_lines_count -= block->lines_count;
+
+    if (block->data)
+        free (block->data);
+    free (block);
+}
+
+/*
+ * Frees all blocks of compressed lines.
+ */
+
+void
+gui_line_free_all_blocks (struct t_gui_lines *lines)
+{
+    if (!lines)
+        return;
+
+    while (lines->first_block)
+    {
+        gui_line_free_block (lines, lines->first_block);
+    }
+}
+
+/*
+ * Checks if a line is used by a window (start of scroll or search): such
+ * line can not be compressed.
+ *
+ * Returns:
+ *   1: line is used by a window
+ *   0: line is not used
+ */
+
+int
+gui_line_is_used_by_window (struct t_gui_line *line)
+{
+    struct t_gui_window *ptr_win;
+    struct t_gui_window_scroll *ptr_scroll;
+
+    for (ptr_win = gui_windows; ptr_win; ptr_win = ptr_win->next_window)
+    {
+        for (ptr_scroll = ptr_win->scroll; ptr_scroll;
+             ptr_scroll = ptr_scroll->next_scroll)
+        {
+            if ((ptr_scroll->start_line == line)
+                || (ptr_scroll->text_search_start_line == line))
+            {
+                return 1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * Compresses the oldest lines of a buffer (GUI_LINE_BLOCK_LINES lines) in a
+ * new block, if option weechat.history.max_buffer_lines_uncompressed is set
+ * and that buffer has enough lines.
+ *
+ * Each line is stored with: date, date printed, tags count, highlight,
+ * notify level, flags, then strings: time (only if different from the time
+ * built with date), prefix, tags and message.
+ *
+ * Returns:
+ *   1: lines compressed
+ *   0: no lines compressed
+ */
+
+int
+gui_line_compress_block (struct t_gui_buffer *buffer)
+{
+    struct t_gui_lines *lines;
+    struct t_gui_line *ptr_line, *ptr_next_line;
+    struct t_gui_line_block *new_block;
+    struct t_gui_window *ptr_win;
+    char flags[GUI_LINE_BLOCK_LINES], *str_time;
+    unsigned char *data, *data_compressed, *ptr_data;
+    uLongf size_compressed;
+    size_t size, length;
+    int i, count, tags_count, prefix_length, prefix_is_nick;
+    time_t date_printed;
+
+    if (!buffer
+        || (CONFIG_INTEGER(config_history_max_buffer_lines_uncompressed) <= 0)
+        || (buffer->type != GUI_BUFFER_TYPE_FORMATTED)
+        || buffer->mixed_lines)
+    {
+        return 0;
+    }
+
+    lines = buffer->own_lines;
+
+    if (lines->lines_count - GUI_LINE_BLOCK_LINES
+        < CONFIG_INTEGER(config_history_max_buffer_lines_uncompressed))
+    {
+        return 0;
+    }
+
+    /* check lines and compute size of block */
+    size = 0;
+    date_printed = 0;
+    ptr_line = lines->first_line;
+    for (count = 0; count < GUI_LINE_BLOCK_LINES; count++)
+    {
+        if (gui_line_is_used_by_window (ptr_line))
+            return 0;
+        flags[count] = 0;
+        str_time = gui_chat_get_time_string (ptr_line->data->date);
+        if ((str_time && !ptr_line->data->str_time)
+            || (!str_time && ptr_line->data->str_time)
+            || (str_time && (strcmp (str_time, ptr_line->data->str_time) != 0)))
+        {
+            flags[count] |= GUI_LINE_BLOCK_FLAG_STR_TIME;
+        }
+        if (str_time)
+            free (str_time);
+        size += (2 * sizeof (time_t)) + sizeof (int) + 3;
+        if ((flags[count] & GUI_LINE_BLOCK_FLAG_STR_TIME)
+            && ptr_line->data->str_time)
+        {
+            flags[count] |= GUI_LINE_BLOCK_FLAG_STR_TIME_SET;
+            size += strlen (ptr_line->data->str_time) + 1;
+        }
+        if (ptr_line->data->prefix)
+        {
+            flags[count] |= GUI_LINE_BLOCK_FLAG_PREFIX;
+            size += strlen (ptr_line->data->prefix) + 1;
+        }
+        for (i = 0; i < ptr_line->data->tags_count; i++)
+        {
+            size += strlen (ptr_line->data->tags_array[i]) + 1;
+        }
+        size += strlen (ptr_line->data->message) + 1;
+        if (lines->last_read_line == ptr_line)
+            flags[count] |= GUI_LINE_BLOCK_FLAG_READ_MARKER;
+        ptr_line = ptr_line->next_line;
+    }
+
+    /* build the block (uncompressed) */
+    data = malloc (size);
+    if (!data)
+        return 0;
+    ptr_data = data;
+    ptr_line = lines->first_line;
+    for (count = 0; count < GUI_LINE_BLOCK_LINES; count++)
+    {
+        memcpy (ptr_data, &(ptr_line->data->date), sizeof (time_t));
+        ptr_data += sizeof (time_t);
+        memcpy (ptr_data, &(ptr_line->data->date_printed), sizeof (time_t));
+        ptr_data += sizeof (time_t);
+        tags_count = ptr_line->data->tags_count;
+        memcpy (ptr_data, &tags_count, sizeof (int));
+        ptr_data += sizeof (int);
+        *(ptr_data++) = (unsigned char)ptr_line->data->highlight;
+        *(ptr_data++) = (unsigned char)ptr_line->data->notify_level;
+        *(ptr_data++) = (unsigned char)flags[count];
+        if (flags[count] & GUI_LINE_BLOCK_FLAG_STR_TIME_SET)
+        {
+            length = strlen (ptr_line->data->str_time) + 1;
+            memcpy (ptr_data, ptr_line->data->str_time, length);
+            ptr_data += length;
+        }
+        if (flags[count] & GUI_LINE_BLOCK_FLAG_PREFIX)
+        {
+            length = strlen (ptr_line->data->prefix) + 1;
+            memcpy (ptr_data, ptr_line->data->prefix, length);
+            ptr_data += length;
+        }
+        for (i = 0; i < tags_count; i++)
+        {
+            length = strlen (ptr_line->data->tags_array[i]) + 1;
+            memcpy (ptr_data, ptr_line->data->tags_array[i], length);
+            ptr_data += length;
+        }
+        length = strlen (ptr_line->data->message) + 1;
+        memcpy (ptr_data, ptr_line->data->message, length);
+        ptr_data += length;
+        date_printed = ptr_line->data->date_printed;
+        ptr_line = ptr_line->next_line;
+    }
+
+    /* compress the block */
+    size_compressed = compressBound (size);
+    data_compressed = malloc (size_compressed);
+    if (!data_compressed)
+    {
+        free (data);
+        return 0;
+    }
+    if (compress2 (data_compressed, &size_compressed, data, size,
+                   Z_DEFAULT_COMPRESSION) != Z_OK)
+    {
+        free (data_compressed);
+        free (data);
+        return 0;
+    }
+    free (data);
+    data = realloc (data_compressed, size_compressed);
+    if (data)
+        data_compressed = data;
+
+    new_block = malloc (sizeof (*new_block));
+    if (!new_block)
+    {
+        free (data_compressed);
+        return 0;
+    }
+    new_block->lines_count = GUI_LINE_BLOCK_LINES;
+    new_block->date_printed = date_printed;
+    new_block->size = (int)size;
+    new_block->size_compressed = (int)size_compressed;
+    new_block->data = data_compressed;
+    new_block->time_format_changed = 0;
+
+    /* add block at the end of list (just before the first line) */
+    new_block->prev_block = lines->last_block;
+    new_block->next_block = NULL;
+    if (lines->last_block)
+        (lines->last_block)->next_block = new_block;
+    else
+        lines->first_block = new_block;
+    lines->last_block = new_block;
+    lines->compressed_lines_count += GUI_LINE_BLOCK_LINES;
+
+    /* remove compressed lines from buffer */
+    ptr_line = lines->first_line;
+    for (count = 0; count < GUI_LINE_BLOCK_LINES; count++)
+    {
+        ptr_next_line = ptr_line->next_line;
+        for (ptr_win = gui_windows; ptr_win; ptr_win = ptr_win->next_window)
+        {
+            gui_window_coords_remove_line (ptr_win, ptr_line);
+        }
+        if (ptr_line->data->displayed)
+        {
+            gui_line_get_prefix_for_display (ptr_line, NULL, &prefix_length,
+                                             NULL, &prefix_is_nick);
+            if (prefix_is_nick)
+                prefix_length += config_length_nick_prefix_suffix;
+            if (prefix_length == lines->prefix_max_length)
+                lines->prefix_max_length_refresh = 1;
+        }
+        else if (lines->lines_hidden > 0)
+        {
+            (lines->lines_hidden)--;
+        }
+        if (lines->last_read_line == ptr_line)
+        {
+            /* read marker is now before first line (restored if uncompressed) */
+            lines->last_read_line = NULL;
+            lines->first_line_not_read = 1;
+        }
+        if (gui_filter_pending_line == ptr_line)
+            gui_filter_pending_line = ptr_next_line;
+        gui_line_free_data (ptr_line);
+        gui_line_free_line (ptr_line);
+        ptr_line = ptr_next_line;
+    }
+    lines->first_line = ptr_line;
+    ptr_line->prev_line = NULL;
+    ptr_line->data->height_stamp = 0;
+    lines->lines_count -= GUI_LINE_BLOCK_LINES;
+    hdata_list_index_reset (&lines->first_line);
+
+    return 1;
+}
+
+/*
+ * Uncompresses the last block of compressed lines of a buffer: lines are
+ * added before the first line of buffer.
+ *
+ * Returns:
+ *   1: lines uncompressed
+ *   0: no lines uncompressed (no block or error)
+ */
+
+int
+gui_line_uncompress_block (struct t_gui_buffer *buffer)
+{
+    struct t_gui_lines *lines;
+    struct t_gui_line_block *ptr_block;
+    struct t_gui_line *new_line, *first_new_line, *last_new_line, *ptr_line;
+    struct t_gui_line_data *new_line_data;
+    unsigned char *data, *ptr_data;
+    uLongf size;
+    char **tags_array, flags, *str_time, *ptr_str_time, *prefix;
+    int i, count, tags_count, prefix_length, prefix_is_nick;
+    time_t date, date_printed;
+
+    if (!buffer || !buffer->own_lines || !buffer->own_lines->last_block)
+        return 0;
+
+    lines = buffer->own_lines;
+    ptr_block = lines->last_block;
+
+    size = ptr_block->size;
+    data = malloc (size);
+    if (!data)
+        return 0;
+    if ((uncompress (data, &size, ptr_block->data,
+                     ptr_block->size_compressed) != Z_OK)
+        || ((int)size != ptr_block->size))
+    {
+        /* invalid block: lines are lost */
+        free (data);
+        gui_line_free_block (lines, ptr_block);
+        return 0;
+    }
+
+    /* build lines */
+    first_new_line = NULL;
+    last_new_line = NULL;
+    ptr_data = data;
+    for (count = 0; count < ptr_block->lines_count; count++)
+    {
+        memcpy (&date, ptr_data, sizeof (time_t));
+        ptr_data += sizeof (time_t);
+        memcpy (&date_printed, ptr_data, sizeof (time_t));
+        ptr_data += sizeof (time_t);
+        memcpy (&tags_count, ptr_data, sizeof (int));
+        ptr_data += sizeof (int);
+
+        new_line = gui_line_alloc ();
+        if (!new_line)
+            break;
+        new_line_data = gui_line_alloc_data ();
+        if (!new_line_data)
+        {
+            gui_line_free_line (new_line);
+            break;
+        }
+        new_line->data = new_line_data;
+        new_line_data->buffer = buffer;
+        new_line_data->y = -1;
+        new_line_data->date = date;
+        new_line_data->date_printed = date_printed;
+        new_line_data->highlight = (char)*(ptr_data++);
+        new_line_data->notify_level = (char)*(ptr_data++);
+        flags = (char)*(ptr_data++);
+        new_line_data->refresh_needed = 0;
+
+        ptr_str_time = NULL;
+        if (flags & GUI_LINE_BLOCK_FLAG_STR_TIME_SET)
+        {
+            ptr_str_time = (char *)ptr_data;
+            ptr_data += strlen (ptr_str_time) + 1;
+        }
+        prefix = NULL;
+        if (flags & GUI_LINE_BLOCK_FLAG_PREFIX)
+        {
+            prefix = (char *)ptr_data;
+            ptr_data += strlen (prefix) + 1;
+        }
+        tags_array = (tags_count > 0) ?
+            malloc (tags_count * sizeof (*tags_array)) : NULL;
+        for (i = 0; i < tags_count; i++)
+        {
+            if (tags_array)
+                tags_array[i] = (char *)string_shared_get ((char *)ptr_data);
+            ptr_data += strlen ((char *)ptr_data) + 1;
+        }
+        if (!tags_array)
+            tags_count = 0;
+
+        /* time, tags and message are stored in a single block */
+        new_line_data->str_time = NULL;
+        new_line_data->tags_count = 0;
+        new_line_data->tags_array = NULL;
+        new_line_data->message = NULL;
+        str_time = NULL;
+        if (!(flags & GUI_LINE_BLOCK_FLAG_STR_TIME)
+            || (ptr_block->time_format_changed && (date != 0)))
+        {
+            /* time was not stored: build it with date */
+            str_time = gui_chat_get_time_string (date);
+            ptr_str_time = str_time;
+        }
+        if (!gui_line_set_strings (new_line_data, ptr_str_time,
+                                   tags_count, tags_array,
+                                   (const char *)ptr_data))
+        {
+            if (str_time)
+                free (str_time);
+            if (tags_array)
+                string_free_split_shared (tags_array);
+            slab_free_object (gui_line_slab_lines_data, new_line_data);
+            gui_line_free_line (new_line);
+            break;
+        }
+        ptr_data += strlen ((char *)ptr_data) + 1;
+        if (str_time)
+            free (str_time);
+        if (tags_array)
+            free (tags_array);
+
+        new_line_data->prefix = (prefix) ?
+            (char *)string_shared_get (prefix) : NULL;
+        new_line_data->prefix_length = (prefix) ?
+            gui_chat_strlen_screen (prefix) : 0;
+
+        new_line_data->filters_checked = 0;
+        new_line_data->filters_match = 0;
+        new_line_data->displayed = gui_filter_check_line (new_line_data);
+
+        new_line_data->height = 0;
+        new_line_data->height_width = 0;
+        new_line_data->height_stamp = 0;
+
+        /* restore read marker if it was on this line */
+        if ((flags & GUI_LINE_BLOCK_FLAG_READ_MARKER)
+            && !lines->last_read_line && lines->first_line_not_read)
+        {
+            lines->last_read_line = new_line;
+            lines->first_line_not_read = 0;
+        }
+
+        new_line->prev_line = last_new_line;
+        new_line->next_line = NULL;
+        if (last_new_line)
+            last_new_line->next_line = new_line;
+        else
+            first_new_line = new_line;
+        last_new_line = new_line;
+    }
+
+    free (data);
+    gui_line_free_block (lines, ptr_block);
+
+    if (!first_new_line)
+        return 0;
+
+    /* add lines before first line of buffer */
+    for (ptr_line = first_new_line; ptr_line; ptr_line = ptr_line->next_line)
+    {
+        if (ptr_line->data->displayed)
+        {
+            gui_line_get_prefix_for_display (ptr_line, NULL, &prefix_length,
+                                             NULL, &prefix_is_nick);
+            if (prefix_is_nick)
+                prefix_length += config_length_nick_prefix_suffix;
+            if (prefix_length > lines->prefix_max_length)
+            {
+                lines->prefix_max_length = prefix_length;
+                gui_line_height_invalidate_all ();
+            }
+        }
+        else
+        {
+            (lines->lines_hidden)++;
+        }
+        lines->lines_count++;
+    }
+    last_new_line->next_line = lines->first_line;
+    if (lines->first_line)
+    {
+        (lines->first_line)->prev_line = last_new_line;
+        (lines->first_line)->data->height_stamp = 0;
+    }
+    else
+        lines->last_line = last_new_line;
+    lines->first_line = first_new_line;
+    hdata_list_index_reset (&lines->first_line);
+
+    return 1;
+}
+
+/*
+ * Uncompresses all compressed lines of a buffer.
+ */
+
+void
+gui_line_uncompress_all (struct t_gui_buffer *buffer)
+{
+    if (!buffer || !buffer->own_lines)
+        return;
+
+    while (buffer->own_lines->last_block)
+    {
+        if (!gui_line_uncompress_block (buffer))
+            break;
+    }
+}
+
 /*
  * Gets notify level for a line.
  *
@@ -1313,32 +2112,64 @@ gui_line_new (struct t_gui_buffer *buffer, int y, time_t date,
 {
     struct t_gui_line *new_line;
     struct t_gui_line_data *new_line_data;
+    char *str_time, **tags_array;
+    int tags_count;
 
     /* create new line */
-    new_line = malloc (sizeof (*new_line));
+    new_line = gui_line_alloc ();
     if (!new_line)
         return NULL;
 
     /* create data for line */
-    new_line_data = malloc (sizeof (*new_line_data));
+    new_line_data = gui_line_alloc_data ();
     if (!new_line_data)
     {
-        free (new_line);
+        gui_line_free_line (new_line);
         return NULL;
     }
     new_line->data = new_line_data;
 
     /* fill data in new line */
     new_line->data->buffer = buffer;
-    new_line->data->message = (message) ? strdup (message) : strdup ("");
+
+    /* time, tags and message are stored in a single block */
+    new_line->data->str_time = NULL;
+    new_line->data->tags_count = 0;
+    new_line->data->tags_array = NULL;
+    new_line->data->message = NULL;
+    str_time = NULL;
+    tags_array = NULL;
+    tags_count = 0;
+    if (buffer->type == GUI_BUFFER_TYPE_FORMATTED)
+    {
+        str_time = gui_chat_get_time_string (date);
+        if (tags)
+        {
+            tags_array = string_split_shared (tags, ",", NULL, 0, 0,
+                                              &tags_count);
+        }
+    }
+    if (!gui_line_set_strings (new_line->data, str_time,
+                               tags_count, tags_array, message))
+    {
+        if (str_time)
+            free (str_time);
+        if (tags_array)
+            string_free_split_shared (tags_array);
+        slab_free_object (gui_line_slab_lines_data, new_line->data);
+        gui_line_free_line (new_line);
+        return NULL;
+    }
+    if (str_time)
+        free (str_time);
+    if (tags_array)
+        free (tags_array);
 
     if (buffer->type == GUI_BUFFER_TYPE_FORMATTED)
     {
         new_line->data->y = -1;
         new_line->data->date = date;
         new_line->data->date_printed = date_printed;
-        new_line->data->str_time = gui_chat_get_time_string (date);
-        gui_line_tags_alloc (new_line->data, tags);
         new_line->data->refresh_needed = 0;
         new_line->data->prefix = (prefix) ?
             (char *)string_shared_get (prefix) : ((date != 0) ? (char *)string_shared_get ("") : NULL);
@@ -1352,9 +2183,6 @@ gui_line_new (struct t_gui_buffer *buffer, int y, time_t date,
         new_line->data->y = y;
         new_line->data->date = 0;
         new_line->data->date_printed = 0;
-        new_line->data->str_time = NULL;
-        new_line->data->tags_count = 0;
-        new_line->data->tags_array = NULL;
         new_line->data->refresh_needed = 1;
         new_line->data->prefix = NULL;
         new_line->data->prefix_length = 0;
@@ -1363,8 +2191,15 @@ gui_line_new (struct t_gui_buffer *buffer, int y, time_t date,
     }
 
     /* set display flag (check if line is filtered or not) */
+    new_line->data->filters_checked = 0;
+    new_line->data->filters_match = 0;
     new_line->data->displayed = gui_filter_check_line (new_line->data);
 
+    /* height is computed on first display */
+    new_line->data->height = 0;
+    new_line->data->height_width = 0;
+    new_line->data->height_stamp = 0;
+
     new_line->prev_line = NULL;
     new_line->next_line = NULL;
 
@@ -1384,7 +2219,7 @@ gui_line_hook_update (struct t_gui_line *line,
     struct t_gui_buffer *ptr_buffer;
     unsigned long value_pointer;
     long value;
-    char *error;
+    char *error, *str_time;
     int rc, tags_updated, notify_level_updated, highlight_updated;
 
     tags_updated = 0;
@@ -1453,9 +2288,10 @@ gui_line_hook_update (struct t_gui_line *line,
         if (error && !error[0] && (value >= 0))
         {
             line->data->date = (time_t)value;
-            if (line->data->str_time)
-                free (line->data->str_time);
-            line->data->str_time = gui_chat_get_time_string (line->data->date);
+            str_time = gui_chat_get_time_string (line->data->date);
+            gui_line_set_str_time (line->data, str_time);
+            if (str_time)
+                free (str_time);
         }
     }
 
@@ -1472,9 +2308,7 @@ gui_line_hook_update (struct t_gui_line *line,
     ptr_value2 = hashtable_get (hashtable2, "str_time");
     if (ptr_value2 && (!ptr_value || (strcmp (ptr_value, ptr_value2) != 0)))
     {
-        if (line->data->str_time)
-            free (line->data->str_time);
-        line->data->str_time = (ptr_value2) ? strdup (ptr_value2) : NULL;
+        gui_line_set_str_time (line->data, ptr_value2);
     }
 
     ptr_value = hashtable_get (hashtable, "tags");
@@ -1484,6 +2318,7 @@ gui_line_hook_update (struct t_gui_line *line,
         tags_updated = 1;
         gui_line_tags_free (line->data);
         gui_line_tags_alloc (line->data, ptr_value2);
+        line->data->filters_checked = 0;
     }
 
     ptr_value2 = hashtable_get (hashtable2, "notify_level");
@@ -1520,15 +2355,15 @@ gui_line_hook_update (struct t_gui_line *line,
             (ptr_value2) ? ptr_value2 : "");
         line->data->prefix_length = (line->data->prefix) ?
             gui_chat_strlen_screen (line->data->prefix) : 0;
+        line->data->filters_checked = 0;
     }
 
     ptr_value = hashtable_get (hashtable, "message");
     ptr_value2 = hashtable_get (hashtable2, "message");
     if (ptr_value2 && (!ptr_value || (strcmp (ptr_value, ptr_value2) != 0)))
     {
-        if (line->data->message)
-            free (line->data->message);
-        line->data->message = (ptr_value2) ? strdup (ptr_value2) : NULL;
+        gui_line_set_message (line->data, ptr_value2);
+        line->data->filters_checked = 0;
     }
 
     /* if tags were updated but not notify_level, adjust notify level */
@@ -1562,6 +2397,20 @@ gui_line_add (struct t_gui_line *line)
      */
     lines_removed = 0;
     current_time = time (NULL);
+    while (line->data->buffer->own_lines->first_block
+           && (((CONFIG_INTEGER(config_history_max_buffer_lines_number) > 0)
+                && (line->data->buffer->own_lines->lines_count
+                    + line->data->buffer->own_lines->compressed_lines_count + 1 >
+                    CONFIG_INTEGER(config_history_max_buffer_lines_number)))
+               || ((CONFIG_INTEGER(config_history_max_buffer_lines_minutes) > 0)
+                   && (current_time - line->data->buffer->own_lines->first_block->date_printed >
+                       CONFIG_INTEGER(config_history_max_buffer_lines_minutes) * 60))))
+    {
+        /* oldest lines are compressed: remove the whole block */
+        lines_removed += line->data->buffer->own_lines->first_block->lines_count;
+        gui_line_free_block (line->data->buffer->own_lines,
+                             line->data->buffer->own_lines->first_block);
+    }
     while (line->data->buffer->own_lines->first_line
            && (((CONFIG_INTEGER(config_history_max_buffer_lines_number) > 0)
                 && (line->data->buffer->own_lines->lines_count + 1 >
@@ -1650,6 +2499,9 @@ gui_line_add (struct t_gui_line *line)
         }
     }
 
+    /* compress oldest lines if there are too many lines in buffer */
+    (void) gui_line_compress_block (line->data->buffer);
+
     (void) hook_signal_send ("buffer_line_added",
                              WEECHAT_HOOK_SIGNAL_POINTER, line);
 }
@@ -1693,7 +2545,7 @@ gui_line_add_y (struct t_gui_line *line)
         /* replace ptr_line by line in list */
         gui_line_free_data (ptr_line);
         ptr_line->data = line->data;
-        free (line);
+        gui_line_free_line (line);
     }
     else
     {
@@ -1723,6 +2575,9 @@ gui_line_add_y (struct t_gui_line *line)
         }
         ptr_line = line;
 
+        hdata_list_add_pointer (&line->data->buffer->own_lines->first_line,
+                                line);
+
         line->data->buffer->own_lines->lines_count++;
     }
 
@@ -1756,9 +2611,7 @@ gui_line_clear (struct t_gui_line *line)
         string_shared_free (line->data->prefix);
     line->data->prefix = (char *)string_shared_get ("");
 
-    if (line->data->message)
-        free (line->data->message);
-    line->data->message = strdup ("");
+    gui_line_set_message (line->data, "");
 }
 
 /*
@@ -1786,6 +2639,10 @@ gui_line_mix_buffers (struct t_gui_buffer *buffer)
     if (!ptr_buffer_found)
         return;
 
+    /* lines are never compressed in merged buffers */
+    gui_line_uncompress_all (ptr_buffer_found);
+    gui_line_uncompress_all (buffer);
+
     /* mix all lines (sorting by date) to a new structure "new_lines" */
     new_lines = gui_lines_alloc ();
     if (!new_lines)
@@ -1835,11 +2692,14 @@ gui_line_mix_buffers (struct t_gui_buffer *buffer)
     new_lines->prefix_max_length_refresh = 1;
     new_lines->buffer_max_length_refresh = 1;
 
+    /* lines are now displayed with buffer names */
+    gui_line_height_invalidate_all ();
+
     /* free old mixed lines */
     if (ptr_buffer_found->mixed_lines)
     {
         gui_line_mixed_free_all (ptr_buffer_found);
-        free (ptr_buffer_found->mixed_lines);
+        gui_lines_free (ptr_buffer_found->mixed_lines);
     }
 
     /* use new structure with mixed lines in all buffers with correct number */
@@ -1881,6 +2741,7 @@ gui_line_hdata_lines_cb (const void *pointer, void *data,
         HDATA_VAR(struct t_gui_lines, buffer_max_length_refresh, INTEGER, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_lines, prefix_max_length, INTEGER, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_lines, prefix_max_length_refresh, INTEGER, 0, NULL, NULL);
+        HDATA_VAR(struct t_gui_lines, compressed_lines_count, INTEGER, 0, NULL, NULL);
     }
     return hdata;
 }
@@ -1921,6 +2782,7 @@ gui_line_hdata_line_data_update_cb (void *data,
                                     struct t_hashtable *hashtable)
 {
     const char *value;
+    char *str_time;
     struct t_gui_line_data *line_data;
     struct t_gui_window *ptr_win;
     int rc, update_coords;
@@ -1939,9 +2801,10 @@ gui_line_hdata_line_data_update_cb (void *data,
         if (value)
         {
             hdata_set (hdata, pointer, "date", value);
-            if (line_data->str_time)
-                free (line_data->str_time);
-            line_data->str_time = gui_chat_get_time_string (line_data->date);
+            str_time = gui_chat_get_time_string (line_data->date);
+            gui_line_set_str_time (line_data, str_time);
+            if (str_time)
+                free (str_time);
             rc++;
             update_coords = 1;
         }
@@ -1962,6 +2825,7 @@ gui_line_hdata_line_data_update_cb (void *data,
         value = hashtable_get (hashtable, "tags_array");
         gui_line_tags_free (line_data);
         gui_line_tags_alloc (line_data, value);
+        line_data->filters_checked = 0;
         rc++;
     }
 
@@ -1972,6 +2836,7 @@ gui_line_hdata_line_data_update_cb (void *data,
         line_data->prefix_length = (line_data->prefix) ?
             gui_chat_strlen_screen (line_data->prefix) : 0;
         line_data->buffer->lines->prefix_max_length_refresh = 1;
+        line_data->filters_checked = 0;
         rc++;
         update_coords = 1;
     }
@@ -1979,7 +2844,8 @@ gui_line_hdata_line_data_update_cb (void *data,
     if (hashtable_has_key (hashtable, "message"))
     {
         value = hashtable_get (hashtable, "message");
-        hdata_set (hdata, pointer, "message", value);
+        gui_line_set_message (line_data, value);
+        line_data->filters_checked = 0;
         rc++;
         update_coords = 1;
     }
@@ -1993,6 +2859,7 @@ gui_line_hdata_line_data_update_cb (void *data,
                 gui_window_coords_remove_line_data (ptr_win, line_data);
             }
         }
+        gui_line_height_invalidate_all ();
         gui_filter_buffer (line_data->buffer, line_data);
         gui_buffer_ask_chat_refresh (line_data->buffer, 1);
     }
@@ -2134,5 +3001,22 @@ gui_lines_print_log (struct t_gui_lines *lines)
         log_printf ("    buffer_max_length_refresh: %d",    lines->buffer_max_length_refresh);
         log_printf ("    prefix_max_length. . . . : %d",    lines->prefix_max_length);
         log_printf ("    prefix_max_length_refresh: %d",    lines->prefix_max_length_refresh);
+        log_printf ("    first_block. . . . . . . : 0x%lx", lines->first_block);
+        log_printf ("    last_block . . . . . . . : 0x%lx", lines->last_block);
+        log_printf ("    compressed_lines_count . : %d",    lines->compressed_lines_count);
     }
 }
+
+/*
+ * Frees memory used for lines (slabs); must be called when all lines have
+ * been freed.
+ */
+
+void
+gui_line_end ()
+{
+    slab_free (gui_line_slab_lines);
+    gui_line_slab_lines = NULL;
+    slab_free (gui_line_slab_lines_data);
+    gui_line_slab_lines_data = NULL;
+}
@@ -25,6 +25,15 @@
 
 struct t_infolist;
 
+/* number of lines in a block of compressed lines */
+#define GUI_LINE_BLOCK_LINES 256
+
+/* flags of a line in a block of compressed lines */
+#define GUI_LINE_BLOCK_FLAG_STR_TIME     (1 << 0) /* time is stored      */
+#define GUI_LINE_BLOCK_FLAG_STR_TIME_SET (1 << 1) /* time is not NULL    */
+#define GUI_LINE_BLOCK_FLAG_PREFIX       (1 << 2) /* prefix is not NULL  */
+#define GUI_LINE_BLOCK_FLAG_READ_MARKER  (1 << 3) /* read marker on line */
+
 /* line structures */
 
 struct t_gui_line_data
@@ -43,6 +52,14 @@ struct t_gui_line_data
     char *prefix;                      /* prefix for line (may be NULL)     */
     int prefix_length;                 /* prefix length (on screen)         */
     char *message;                     /* line content (after prefix)       */
+    int height;                        /* number of lines on screen (cache, */
+                                       /* without day change/read marker)   */
+    int height_width;                  /* chat width used for height        */
+    int height_stamp;                  /* stamp used for height (cache is   */
+                                       /* valid if == gui_line_height_stamp)*/
+    unsigned long long filters_checked; /* filters checked (1 bit by filter,*/
+                                       /* see cache_index in filter)        */
+    unsigned long long filters_match;  /* filters matching line (cache)     */
 };
 
 struct t_gui_line
@@ -52,6 +69,19 @@ struct t_gui_line
     struct t_gui_line *next_line;      /* link to next line                 */
 };
 
+struct t_gui_line_block
+{
+    int lines_count;                   /* number of lines in block          */
+    time_t date_printed;               /* date printed of last line         */
+    int size;                          /* size of lines (uncompressed)      */
+    int size_compressed;               /* size of compressed lines          */
+    unsigned char *data;               /* compressed lines                  */
+    int time_format_changed;           /* 1 if time format has changed      */
+                                       /* (time of lines is rebuilt)        */
+    struct t_gui_line_block *prev_block; /* link to previous block          */
+    struct t_gui_line_block *next_block; /* link to next block              */
+};
+
 struct t_gui_lines
 {
     struct t_gui_line *first_line;     /* pointer to first line             */
@@ -65,12 +95,30 @@ struct t_gui_lines
     int buffer_max_length_refresh;     /* refresh asked for buffer max len. */
     int prefix_max_length;             /* max length for prefix align       */
     int prefix_max_length_refresh;     /* refresh asked for prefix max len. */
+    struct t_gui_line_block *first_block; /* compressed lines (before       */
+    struct t_gui_line_block *last_block;  /* first_line, oldest block first)*/
+    int compressed_lines_count;        /* number of lines compressed        */
 };
 
+/* line variables */
+
+extern int gui_line_height_stamp;
+
 /* line functions */
 
 extern struct t_gui_lines *gui_lines_alloc ();
 extern void gui_lines_free (struct t_gui_lines *lines);
+extern struct t_gui_line *gui_line_alloc ();
+extern struct t_gui_line_data *gui_line_alloc_data ();
+extern void gui_line_free_line (struct t_gui_line *line);
+extern int gui_line_set_strings (struct t_gui_line_data *line_data,
+                                 const char *str_time,
+                                 int tags_count, char **tags_array,
+                                 const char *message);
+extern void gui_line_set_str_time (struct t_gui_line_data *line_data,
+                                   const char *str_time);
+extern void gui_line_set_message (struct t_gui_line_data *line_data,
+                                  const char *message);
 extern void gui_line_tags_alloc (struct t_gui_line_data *line_data,
                                  const char *tags);
 extern void gui_line_tags_free (struct t_gui_line_data *line_data);
@@ -80,9 +128,13 @@ extern void gui_line_get_prefix_for_display (struct t_gui_line *line,
 extern int gui_line_get_align (struct t_gui_buffer *buffer,
                                struct t_gui_line *line,
                                int with_suffix, int first_line);
+extern void gui_line_height_invalidate_all ();
 extern int gui_line_is_displayed (struct t_gui_line *line);
 extern struct t_gui_line *gui_line_get_first_displayed (struct t_gui_buffer *buffer);
 extern struct t_gui_line *gui_line_get_last_displayed (struct t_gui_buffer *buffer);
+extern int gui_line_is_first_displayed (struct t_gui_buffer *buffer,
+                                        struct t_gui_line *line);
+extern struct t_gui_line *gui_line_get_prev (struct t_gui_line *line);
 extern struct t_gui_line *gui_line_get_prev_displayed (struct t_gui_line *line);
 extern struct t_gui_line *gui_line_get_next_displayed (struct t_gui_line *line);
 extern int gui_line_search_text (struct t_gui_buffer *buffer,
@@ -107,6 +159,12 @@ extern void gui_line_free_data (struct t_gui_line *line);
 extern void gui_line_free (struct t_gui_buffer *buffer,
                            struct t_gui_line *line);
 extern void gui_line_free_all (struct t_gui_buffer *buffer);
+extern void gui_line_free_block (struct t_gui_lines *lines,
+                                 struct t_gui_line_block *block);
+extern void gui_line_free_all_blocks (struct t_gui_lines *lines);
+extern int gui_line_compress_block (struct t_gui_buffer *buffer);
+extern int gui_line_uncompress_block (struct t_gui_buffer *buffer);
+extern void gui_line_uncompress_all (struct t_gui_buffer *buffer);
 extern int gui_line_get_notify_level (struct t_gui_line *line);
 extern struct t_gui_line *gui_line_new (struct t_gui_buffer *buffer,
                                         int y,
@@ -135,5 +193,6 @@ extern int gui_line_add_to_infolist (struct t_infolist *infolist,
                                      struct t_gui_lines *lines,
                                      struct t_gui_line *line);
 extern void gui_lines_print_log (struct t_gui_lines *lines);
+extern void gui_line_end ();
 
 #endif /* WEECHAT_GUI_LINE_H */
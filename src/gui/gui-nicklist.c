@@ -34,6 +34,7 @@
 #include <ctype.h>
 
 #include "../core/weechat.h"
+#include "../core/wee-arraylist.h"
 #include "../core/wee-config.h"
 #include "../core/wee-hashtable.h"
 #include "../core/wee-hdata.h"
@@ -49,8 +50,23 @@
 
 
 struct t_hashtable *gui_nicklist_hsignal = NULL;
+int gui_nicklist_updated = 0;          /* 1 if at least one buffer has      */
+                                       /* nicklist updated (signal to send) */
 
 
+/*
+ * Flags nicklist of buffer as updated: the signal "nicklist_updated" will be
+ * sent once for this buffer, even if many changes are done (see function
+ * gui_nicklist_send_updated).
+ */
+
+void
+gui_nicklist_set_updated (struct t_gui_buffer *buffer)
+{
+    buffer->nicklist_updated = 1;
+    gui_nicklist_updated = 1;
+}
+
 /*
  * Sends a signal when something has changed in nicklist.
  */
@@ -64,6 +80,7 @@ gui_nicklist_send_signal (const char *signal, struct t_gui_buffer *buffer,
 
     if (buffer)
     {
+        gui_nicklist_set_updated (buffer);
         length = 128 + ((arguments) ? strlen (arguments) : 0) + 1 + 1;
         str_args = malloc (length);
         if (str_args)
@@ -179,6 +196,8 @@ gui_nicklist_insert_group_sorted (struct t_gui_nick_group **groups,
         *groups = group;
         *last_group = group;
     }
+
+    hdata_list_add_pointer (groups, group);
 }
 
 /*
@@ -277,8 +296,12 @@ gui_nicklist_add_group (struct t_gui_buffer *buffer,
     new_group->last_child = NULL;
     new_group->nicks = NULL;
     new_group->last_nick = NULL;
+    new_group->nicks_sorted = NULL;
+    new_group->nicks_unsorted = 0;
     new_group->prev_group = NULL;
     new_group->next_group = NULL;
+    hdata_list_index_new (&new_group->children);
+    hdata_list_index_new (&new_group->nicks);
 
     if (new_group->parent)
     {
@@ -306,74 +329,393 @@ gui_nicklist_add_group (struct t_gui_buffer *buffer,
 }
 
 /*
- * Searches for position of a nick (to keep nicklist sorted).
+ * Callbacks to hash and compare keys of hashtable with nicks in buffer.
+ *
+ * Keys are names of nicks (pointers to strings, which are not duplicated in
+ * the hashtable); case is ignored for chars "A-Z [ \ ] ^", so that nicks
+ * considered equal by the callback "nickcmp" of buffer (for example with IRC
+ * casemapping) have the same key.
  */
 
-struct t_gui_nick *
-gui_nicklist_find_pos_nick (struct t_gui_nick_group *group,
-                            struct t_gui_nick *nick)
+unsigned long long
+gui_nicklist_hash_key_cb (struct t_hashtable *hashtable, const void *key)
 {
-    struct t_gui_nick *ptr_nick;
+    const unsigned char *ptr_key;
+    unsigned long long hash;
+    unsigned char c;
 
-    if (!group)
-        return NULL;
+    /* make C compiler happy */
+    (void) hashtable;
 
-    for (ptr_nick = group->nicks; ptr_nick; ptr_nick = ptr_nick->next_nick)
+    hash = 5381;
+    for (ptr_key = (const unsigned char *)key; ptr_key[0]; ptr_key++)
     {
-        if (string_strcasecmp (nick->name, ptr_nick->name) < 0)
-            return ptr_nick;
+        c = ptr_key[0];
+        if ((c >= 'A') && (c <= '^'))
+            c += ('a' - 'A');
+        hash ^= (hash << 5) + (hash >> 2) + c;
     }
 
-    /* nick will be inserted at end of list */
-    return NULL;
+    return hash;
+}
+
+int
+gui_nicklist_keycmp_cb (struct t_hashtable *hashtable,
+                        const void *key1, const void *key2)
+{
+    /* make C compiler happy */
+    (void) hashtable;
+
+    return string_strcasecmp_range ((const char *)key1, (const char *)key2,
+                                    30);
+}
+
+/*
+ * Compares two nicks to sort them in a group: name without case, then name
+ * with case (so that the order does not depend on the order of insertion).
+ *
+ * Returns:
+ *   -1: nick1 < nick2
+ *    0: nick1 == nick2
+ *    1: nick1 > nick2
+ */
+
+int
+gui_nicklist_nick_cmp_cb (void *data, struct t_arraylist *arraylist,
+                          void *pointer1, void *pointer2)
+{
+    struct t_gui_nick *nick1, *nick2;
+    int rc;
+
+    /* make C compiler happy */
+    (void) data;
+    (void) arraylist;
+
+    nick1 = (struct t_gui_nick *)pointer1;
+    nick2 = (struct t_gui_nick *)pointer2;
+
+    rc = string_strcasecmp (nick1->name, nick2->name);
+    if (rc != 0)
+        return rc;
+
+    rc = strcmp (nick1->name, nick2->name);
+    if (rc != 0)
+        return (rc < 0) ? -1 : 1;
+
+    return (nick1 < nick2) ? -1 : ((nick1 > nick2) ? 1 : 0);
+}
+
+/*
+ * Compares two pointers to nicks (callback used by qsort).
+ */
+
+int
+gui_nicklist_nick_qsort_cb (const void *pointer1, const void *pointer2)
+{
+    return gui_nicklist_nick_cmp_cb (NULL, NULL,
+                                     *((struct t_gui_nick **)pointer1),
+                                     *((struct t_gui_nick **)pointer2));
+}
+
+/*
+ * Adds a nick at the end of list of nicks in group.
+ */
+
+void
+gui_nicklist_append_nick (struct t_gui_nick_group *group,
+                          struct t_gui_nick *nick)
+{
+    nick->prev_nick = group->last_nick;
+    nick->next_nick = NULL;
+    if (group->last_nick)
+        group->last_nick->next_nick = nick;
+    else
+        group->nicks = nick;
+    group->last_nick = nick;
+
+    hdata_list_add_pointer (&group->nicks, nick);
 }
 
 /*
  * Inserts nick into sorted list.
+ *
+ * The position of nick is found with a binary search in the sorted array of
+ * nicks in group.  If nicks are added in bulk in buffer, the nick is added at
+ * the end of list, and it will be sorted when the bulk add ends (see function
+ * gui_nicklist_set_bulk_add).
  */
 
 void
-gui_nicklist_insert_nick_sorted (struct t_gui_nick_group *group,
+gui_nicklist_insert_nick_sorted (struct t_gui_buffer *buffer,
+                                 struct t_gui_nick_group *group,
                                  struct t_gui_nick *nick)
 {
     struct t_gui_nick *pos_nick;
+    int index;
+
+    if (buffer->nicklist_bulk_add)
+    {
+        gui_nicklist_append_nick (group, nick);
+        group->nicks_unsorted++;
+        return;
+    }
+
+    if (!group->nicks_sorted)
+    {
+        group->nicks_sorted = arraylist_new (32, 1, 0,
+                                             &gui_nicklist_nick_cmp_cb, NULL,
+                                             NULL, NULL);
+    }
+
+    index = arraylist_add (group->nicks_sorted, nick);
+    pos_nick = (index >= 0) ?
+        (struct t_gui_nick *)arraylist_get (group->nicks_sorted, index + 1) :
+        NULL;
+
+    if (pos_nick)
+    {
+        /* insert nick into the list (before nick found) */
+        nick->prev_nick = pos_nick->prev_nick;
+        nick->next_nick = pos_nick;
+        if (pos_nick->prev_nick)
+            (pos_nick->prev_nick)->next_nick = nick;
+        else
+            group->nicks = nick;
+        pos_nick->prev_nick = nick;
+        hdata_list_add_pointer (&group->nicks, nick);
+    }
+    else
+    {
+        /* add nick to the end */
+        gui_nicklist_append_nick (group, nick);
+    }
+}
+
+/*
+ * Sorts nicks added in bulk in a group and its child groups.
+ *
+ * The nicks added in bulk (at the end of list) are sorted, then merged with
+ * the nicks already sorted, so the cost is O(n + p*log(p)) for n nicks in
+ * group and p nicks added in bulk.
+ */
+
+void
+gui_nicklist_sort_group_nicks (struct t_gui_nick_group *group)
+{
+    struct t_gui_nick_group *ptr_group;
+    struct t_gui_nick **unsorted, **merged, *ptr_nick;
+    int i, num_sorted, num_unsorted, index_sorted, index_unsorted, index;
+
+    for (ptr_group = group->children; ptr_group;
+         ptr_group = ptr_group->next_group)
+    {
+        gui_nicklist_sort_group_nicks (ptr_group);
+    }
 
-    if (group->nicks)
+    if (group->nicks_unsorted <= 0)
+        return;
+
+    num_unsorted = group->nicks_unsorted;
+    num_sorted = arraylist_size (group->nicks_sorted);
+
+    unsorted = malloc (num_unsorted * sizeof (*unsorted));
+    merged = malloc ((num_sorted + num_unsorted) * sizeof (*merged));
+    if (!group->nicks_sorted)
+    {
+        group->nicks_sorted = arraylist_new (num_sorted + num_unsorted, 1, 0,
+                                             &gui_nicklist_nick_cmp_cb, NULL,
+                                             NULL, NULL);
+    }
+    if (!unsorted || !merged || !group->nicks_sorted)
     {
-        pos_nick = gui_nicklist_find_pos_nick (group, nick);
+        if (unsorted)
+            free (unsorted);
+        if (merged)
+            free (merged);
+        return;
+    }
 
-        if (pos_nick)
+    /* nicks added in bulk are at the end of list */
+    ptr_nick = group->last_nick;
+    for (i = num_unsorted - 1; i >= 0; i--)
+    {
+        unsorted[i] = ptr_nick;
+        ptr_nick = ptr_nick->prev_nick;
+    }
+    qsort (unsorted, num_unsorted, sizeof (*unsorted),
+           &gui_nicklist_nick_qsort_cb);
+
+    /* merge sorted nicks and nicks added in bulk */
+    index_sorted = 0;
+    index_unsorted = 0;
+    index = 0;
+    while ((index_sorted < num_sorted) || (index_unsorted < num_unsorted))
+    {
+        if ((index_unsorted >= num_unsorted)
+            || ((index_sorted < num_sorted)
+                && (gui_nicklist_nick_cmp_cb (
+                        NULL, NULL,
+                        arraylist_get (group->nicks_sorted, index_sorted),
+                        unsorted[index_unsorted]) < 0)))
         {
-            /* insert nick into the list (before nick found) */
-            nick->prev_nick = pos_nick->prev_nick;
-            nick->next_nick = pos_nick;
-            if (pos_nick->prev_nick)
-                (pos_nick->prev_nick)->next_nick = nick;
-            else
-                group->nicks = nick;
-            pos_nick->prev_nick = nick;
+            merged[index++] = arraylist_get (group->nicks_sorted,
+                                             index_sorted++);
         }
         else
         {
-            /* add nick to the end */
-            nick->prev_nick = group->last_nick;
-            nick->next_nick = NULL;
-            group->last_nick->next_nick = nick;
-            group->last_nick = nick;
+            merged[index++] = unsorted[index_unsorted++];
         }
     }
-    else
+
+    /* rebuild the sorted array and the list of nicks */
+    arraylist_clear (group->nicks_sorted);
+    group->nicks = NULL;
+    group->last_nick = NULL;
+    for (i = 0; i < index; i++)
     {
-        nick->prev_nick = NULL;
-        nick->next_nick = NULL;
-        group->nicks = nick;
-        group->last_nick = nick;
+        arraylist_add (group->nicks_sorted, merged[i]);
+        gui_nicklist_append_nick (group, merged[i]);
+    }
+    group->nicks_unsorted = 0;
+
+    free (unsorted);
+    free (merged);
+}
+
+/*
+ * Starts or ends a bulk add of nicks in buffer.
+ *
+ * During a bulk add, new nicks are added at the end of their group, and they
+ * are sorted once when the bulk add ends (this is faster than a sorted insert
+ * for each nick, for example when a big list of nicks is received).
+ */
+
+void
+gui_nicklist_set_bulk_add (struct t_gui_buffer *buffer, int bulk_add)
+{
+    if (!buffer)
+        return;
+
+    bulk_add = (bulk_add) ? 1 : 0;
+    if (bulk_add == buffer->nicklist_bulk_add)
+        return;
+
+    buffer->nicklist_bulk_add = bulk_add;
+
+    if (!bulk_add && buffer->nicklist_root)
+    {
+        gui_nicklist_sort_group_nicks (buffer->nicklist_root);
+        gui_nicklist_set_updated (buffer);
+    }
+}
+
+/*
+ * Sends signal "nicklist_updated" for each buffer with nicklist changed since
+ * last call to this function.
+ *
+ * This function is called once in each iteration of main loop, so that bar
+ * items and plugins (like relay) can handle many changes in nicklist at once
+ * (for example on a netsplit).
+ */
+
+void
+gui_nicklist_send_updated ()
+{
+    struct t_gui_buffer *ptr_buffer, *ptr_next_buffer;
+
+    if (!gui_nicklist_updated)
+        return;
+
+    gui_nicklist_updated = 0;
+
+    ptr_buffer = gui_buffers;
+    while (ptr_buffer)
+    {
+        ptr_next_buffer = ptr_buffer->next_buffer;
+        if (ptr_buffer->nicklist_updated)
+        {
+            ptr_buffer->nicklist_updated = 0;
+            (void) hook_signal_send ("nicklist_updated",
+                                     WEECHAT_HOOK_SIGNAL_POINTER, ptr_buffer);
+            /*
+             * buffers may have been closed by a callback: if the next buffer
+             * does not exist any more, start again with first buffer (flags
+             * of buffers already done have been reset)
+             */
+            if (ptr_next_buffer && !gui_buffer_valid (ptr_next_buffer))
+                ptr_next_buffer = gui_buffers;
+        }
+        ptr_buffer = ptr_next_buffer;
+    }
+}
+
+/*
+ * Checks if a nick name matches a name, using the callback "nickcmp" of
+ * buffer (if set).
+ *
+ * Returns:
+ *   1: nick name matches name
+ *   0: nick name does not match name
+ */
+
+int
+gui_nicklist_nick_name_match (struct t_gui_buffer *buffer,
+                              const char *nick_name, const char *name)
+{
+    if (buffer->nickcmp_callback)
+    {
+        return ((buffer->nickcmp_callback) (buffer->nickcmp_callback_pointer,
+                                            buffer->nickcmp_callback_data,
+                                            buffer,
+                                            nick_name,
+                                            name) == 0) ? 1 : 0;
     }
+
+    return (strcmp (nick_name, name) == 0) ? 1 : 0;
+}
+
+/*
+ * Searches for a nick in nicklist, with a walk in all groups (this function
+ * must not be called directly).
+ *
+ * Returns pointer to nick found, NULL if not found.
+ */
+
+struct t_gui_nick *
+gui_nicklist_search_nick_internal (struct t_gui_buffer *buffer,
+                                   struct t_gui_nick_group *from_group,
+                                   const char *name)
+{
+    struct t_gui_nick *ptr_nick;
+    struct t_gui_nick_group *ptr_group;
+
+    for (ptr_nick = from_group->nicks; ptr_nick;
+         ptr_nick = ptr_nick->next_nick)
+    {
+        if (gui_nicklist_nick_name_match (buffer, ptr_nick->name, name))
+            return ptr_nick;
+    }
+
+    /* search nick in child groups */
+    for (ptr_group = from_group->children; ptr_group;
+         ptr_group = ptr_group->next_group)
+    {
+        ptr_nick = gui_nicklist_search_nick_internal (buffer, ptr_group, name);
+        if (ptr_nick)
+            return ptr_nick;
+    }
+
+    /* nick not found */
+    return NULL;
 }
 
 /*
  * Searches for a nick in nicklist.
  *
+ * The nick is searched in the hashtable of buffer; the groups are walked only
+ * if some nicks have the same key in hashtable (for example "nick" and "Nick"
+ * in a buffer without callback "nickcmp").
+ *
  * Returns pointer to nick found, NULL if not found.
  */
 
@@ -385,44 +727,141 @@ gui_nicklist_search_nick (struct t_gui_buffer *buffer,
     struct t_gui_nick *ptr_nick;
     struct t_gui_nick_group *ptr_group;
 
-    if (!buffer && !from_group)
+    if (!buffer || !name)
         return NULL;
 
-    if (!from_group && !buffer->nicklist_root)
+    if (!from_group)
+        from_group = buffer->nicklist_root;
+
+    if (!from_group || !buffer->nicklist_nicks_hashtable)
         return NULL;
 
-    for (ptr_nick = (from_group) ? from_group->nicks : buffer->nicklist_root->nicks;
-         ptr_nick; ptr_nick = ptr_nick->next_nick)
+    ptr_nick = hashtable_get (buffer->nicklist_nicks_hashtable, name);
+    if (ptr_nick && gui_nicklist_nick_name_match (buffer, ptr_nick->name, name))
     {
-        if (buffer->nickcmp_callback)
+        /* nick found, check that it is in from_group or its child groups */
+        for (ptr_group = ptr_nick->group; ptr_group;
+             ptr_group = ptr_group->parent)
         {
-            if ((buffer->nickcmp_callback) (buffer->nickcmp_callback_pointer,
-                                            buffer->nickcmp_callback_data,
-                                            buffer,
-                                            ptr_nick->name,
-                                            name) == 0)
+            if (ptr_group == from_group)
                 return ptr_nick;
         }
-        else
+        return NULL;
+    }
+
+    if (buffer->nicklist_nicks_key_collisions > 0)
+        return gui_nicklist_search_nick_internal (buffer, from_group, name);
+
+    /* nick not found */
+    return NULL;
+}
+
+/*
+ * Adds a nick in hashtable of buffer.
+ */
+
+void
+gui_nicklist_hashtable_add (struct t_gui_buffer *buffer,
+                            struct t_gui_nick *nick)
+{
+    if (!buffer->nicklist_nicks_hashtable)
+    {
+        buffer->nicklist_nicks_hashtable = hashtable_new (
+            64,
+            WEECHAT_HASHTABLE_POINTER,
+            WEECHAT_HASHTABLE_POINTER,
+            &gui_nicklist_hash_key_cb,
+            &gui_nicklist_keycmp_cb);
+        if (!buffer->nicklist_nicks_hashtable)
+            return;
+    }
+
+    /* another nick has same key: keep it in hashtable */
+    if (hashtable_has_key (buffer->nicklist_nicks_hashtable, nick->name))
+    {
+        buffer->nicklist_nicks_key_collisions++;
+        return;
+    }
+
+    hashtable_set (buffer->nicklist_nicks_hashtable, nick->name, nick);
+}
+
+/*
+ * Searches for another nick with same key as a nick (in hashtable of buffer),
+ * with a walk in all groups.
+ *
+ * Returns pointer to nick found, NULL if not found.
+ */
+
+struct t_gui_nick *
+gui_nicklist_search_same_key (struct t_gui_buffer *buffer,
+                              struct t_gui_nick_group *group,
+                              struct t_gui_nick *nick)
+{
+    struct t_gui_nick *ptr_nick;
+    struct t_gui_nick_group *ptr_group;
+
+    for (ptr_nick = group->nicks; ptr_nick; ptr_nick = ptr_nick->next_nick)
+    {
+        if ((ptr_nick != nick)
+            && (gui_nicklist_keycmp_cb (NULL, ptr_nick->name, nick->name) == 0))
         {
-            if (strcmp (ptr_nick->name, name) == 0)
-                return ptr_nick;
+            return ptr_nick;
         }
     }
 
-    /* search nick in child groups */
-    for (ptr_group = (from_group) ? from_group->children : buffer->nicklist_root->children;
-         ptr_group; ptr_group = ptr_group->next_group)
+    for (ptr_group = group->children; ptr_group;
+         ptr_group = ptr_group->next_group)
     {
-        ptr_nick = gui_nicklist_search_nick (buffer, ptr_group, name);
+        ptr_nick = gui_nicklist_search_same_key (buffer, ptr_group, nick);
         if (ptr_nick)
             return ptr_nick;
     }
 
-    /* nick not found */
     return NULL;
 }
 
+/*
+ * Removes a nick from hashtable of buffer.
+ *
+ * This must be called before the name of nick is freed (the name is used as
+ * key in the hashtable).
+ */
+
+void
+gui_nicklist_hashtable_remove (struct t_gui_buffer *buffer,
+                               struct t_gui_nick *nick)
+{
+    struct t_gui_nick *ptr_nick;
+
+    if (!buffer->nicklist_nicks_hashtable || !nick->name)
+        return;
+
+    if (hashtable_get (buffer->nicklist_nicks_hashtable, nick->name) != nick)
+    {
+        /* nick was not in hashtable (another nick has same key) */
+        if (buffer->nicklist_nicks_key_collisions > 0)
+            buffer->nicklist_nicks_key_collisions--;
+        return;
+    }
+
+    hashtable_remove (buffer->nicklist_nicks_hashtable, nick->name);
+
+    if ((buffer->nicklist_nicks_key_collisions > 0) && buffer->nicklist_root)
+    {
+        /* replace nick by another one with same key (if found) */
+        ptr_nick = gui_nicklist_search_same_key (buffer,
+                                                 buffer->nicklist_root,
+                                                 nick);
+        if (ptr_nick)
+        {
+            hashtable_set (buffer->nicklist_nicks_hashtable,
+                           ptr_nick->name, ptr_nick);
+            buffer->nicklist_nicks_key_collisions--;
+        }
+    }
+}
+
 /*
  * Adds a nick to nicklist.
  *
@@ -452,7 +891,8 @@ gui_nicklist_add_nick (struct t_gui_buffer *buffer,
     new_nick->prefix_color = (prefix_color) ? (char *)string_shared_get (prefix_color) : NULL;
     new_nick->visible = visible;
 
-    gui_nicklist_insert_nick_sorted (new_nick->group, new_nick);
+    gui_nicklist_insert_nick_sorted (buffer, new_nick->group, new_nick);
+    gui_nicklist_hashtable_add (buffer, new_nick);
 
     buffer->nicklist_count++;
     buffer->nicklist_nicks_count++;
@@ -481,6 +921,7 @@ gui_nicklist_remove_nick (struct t_gui_buffer *buffer,
                           struct t_gui_nick *nick)
 {
     char *nick_removed;
+    int index;
 
     if (!buffer || !nick)
         return;
@@ -490,6 +931,14 @@ gui_nicklist_remove_nick (struct t_gui_buffer *buffer,
     gui_nicklist_send_signal ("nicklist_nick_removing", buffer, nick_removed);
     gui_nicklist_send_hsignal ("nicklist_nick_removing", buffer, NULL, nick);
 
+    /* remove nick from hashtable and sorted array (or from nicks unsorted) */
+    gui_nicklist_hashtable_remove (buffer, nick);
+    (void) arraylist_search ((nick->group)->nicks_sorted, nick, &index, NULL);
+    if (index >= 0)
+        arraylist_remove ((nick->group)->nicks_sorted, index);
+    else if ((nick->group)->nicks_unsorted > 0)
+        (nick->group)->nicks_unsorted--;
+
     /* remove nick from list */
     if (nick->prev_nick)
         (nick->prev_nick)->next_nick = nick->next_nick;
@@ -499,6 +948,7 @@ gui_nicklist_remove_nick (struct t_gui_buffer *buffer,
         (nick->group)->nicks = nick->next_nick;
     if ((nick->group)->last_nick == nick)
         (nick->group)->last_nick = nick->prev_nick;
+    hdata_list_remove_pointer (&(nick->group)->nicks, nick);
 
     /* free data */
     if (nick->name)
@@ -553,7 +1003,9 @@ gui_nicklist_remove_group (struct t_gui_buffer *buffer,
         gui_nicklist_remove_group (buffer, group->children);
     }
 
-    /* remove nicks from group */
+    /* remove nicks from group (sorted array is not needed any more) */
+    arraylist_clear (group->nicks_sorted);
+    group->nicks_unsorted = 0;
     while (group->nicks)
     {
         gui_nicklist_remove_nick (buffer, group->nicks);
@@ -573,6 +1025,7 @@ gui_nicklist_remove_group (struct t_gui_buffer *buffer,
             (group->parent)->children = group->next_group;
         if ((group->parent)->last_child == group)
             (group->parent)->last_child = group->prev_group;
+        hdata_list_remove_pointer (&(group->parent)->children, group);
 
         buffer->nicklist_count--;
         buffer->nicklist_groups_count--;
@@ -587,6 +1040,10 @@ gui_nicklist_remove_group (struct t_gui_buffer *buffer,
         string_shared_free (group->name);
     if (group->color)
         string_shared_free (group->color);
+    if (group->nicks_sorted)
+        arraylist_free (group->nicks_sorted);
+    hdata_list_index_free (&group->children);
+    hdata_list_index_free (&group->nicks);
 
     if (buffer->nicklist_display_groups && group->visible)
     {
@@ -613,6 +1070,11 @@ gui_nicklist_remove_all (struct t_gui_buffer *buffer)
 {
     if (buffer && buffer->nicklist_root)
     {
+        /* all nicks are removed, so the hashtable is not needed any more */
+        if (buffer->nicklist_nicks_hashtable)
+            hashtable_remove_all (buffer->nicklist_nicks_hashtable);
+        buffer->nicklist_nicks_key_collisions = 0;
+
         /* remove children of root group */
         while (buffer->nicklist_root->children)
         {
@@ -620,6 +1082,8 @@ gui_nicklist_remove_all (struct t_gui_buffer *buffer)
         }
 
         /* remove nicks of root group */
+        arraylist_clear (buffer->nicklist_root->nicks_sorted);
+        buffer->nicklist_root->nicks_unsorted = 0;
         while (buffer->nicklist_root->nicks)
         {
             gui_nicklist_remove_nick (buffer, buffer->nicklist_root->nicks);
@@ -1299,6 +1763,14 @@ gui_nicklist_print_log (struct t_gui_nick_group *group, int indent)
               "%%-%dslast_nick . : 0x%%lx",
               (indent * 2) + 6);
     log_printf (format, " ", group->last_nick);
+    snprintf (format, sizeof (format),
+              "%%-%dsnicks_sorted: 0x%%lx",
+              (indent * 2) + 6);
+    log_printf (format, " ", group->nicks_sorted);
+    snprintf (format, sizeof (format),
+              "%%-%dsnicks_unsort: %%d",
+              (indent * 2) + 6);
+    log_printf (format, " ", group->nicks_unsorted);
     snprintf (format, sizeof (format),
               "%%-%dsprev_group. : 0x%%lx",
               (indent * 2) + 6);
@@ -22,6 +22,7 @@
 
 struct t_gui_buffer;
 struct t_infolist;
+struct t_arraylist;
 
 struct t_gui_nick_group
 {
@@ -34,6 +35,11 @@ struct t_gui_nick_group
     struct t_gui_nick_group *last_child; /* last child                      */
     struct t_gui_nick *nicks;          /* nicks for group                   */
     struct t_gui_nick *last_nick;      /* last nick for group               */
+    struct t_arraylist *nicks_sorted;  /* nicks sorted by name (same order  */
+                                       /* as list, to find position of new  */
+                                       /* nicks with a binary search)       */
+    int nicks_unsorted;                /* number of nicks at end of list,   */
+                                       /* added in bulk, not yet sorted     */
     struct t_gui_nick_group *prev_group; /* link to previous group          */
     struct t_gui_nick_group *next_group; /* link to next group              */
 };
@@ -81,6 +87,9 @@ extern void gui_nicklist_get_next_item (struct t_gui_buffer *buffer,
 extern const char *gui_nicklist_get_group_start (const char *name);
 extern void gui_nicklist_compute_visible_count (struct t_gui_buffer *buffer,
                                                 struct t_gui_nick_group *group);
+extern void gui_nicklist_set_bulk_add (struct t_gui_buffer *buffer,
+                                       int bulk_add);
+extern void gui_nicklist_send_updated ();
 
 
 
@@ -1221,6 +1221,8 @@ gui_window_scroll (struct t_gui_window *window, char *scroll)
     }
     else
     {
+        if (!window->scroll->start_line)
+            gui_line_uncompress_all (window->buffer);
         ptr_line = (window->scroll->start_line) ?
             window->scroll->start_line : window->buffer->lines->first_line;
         while (ptr_line
@@ -1359,7 +1361,8 @@ gui_window_scroll (struct t_gui_window *window, char *scroll)
                 window->scroll->start_line = ptr_line;
                 window->scroll->start_line_pos = 0;
                 window->scroll->first_line_displayed =
-                    (window->scroll->start_line == gui_line_get_first_displayed (window->buffer));
+                    gui_line_is_first_displayed (window->buffer,
+                                                 window->scroll->start_line);
                 gui_buffer_ask_chat_refresh (window->buffer, 2);
                 return;
             }
@@ -1552,7 +1555,8 @@ gui_window_scroll_unread (struct t_gui_window *window)
             }
             window->scroll->start_line_pos = 0;
             window->scroll->first_line_displayed =
-                (window->scroll->start_line == gui_line_get_first_displayed (window->buffer));
+                gui_line_is_first_displayed (window->buffer,
+                                             window->scroll->start_line);
             gui_buffer_ask_chat_refresh (window->buffer, 2);
         }
     }
@@ -1589,7 +1593,8 @@ gui_window_search_text (struct t_gui_window *window)
                     window->scroll->start_line = ptr_line;
                     window->scroll->start_line_pos = 0;
                     window->scroll->first_line_displayed =
-                        (window->scroll->start_line == gui_line_get_first_displayed (window->buffer));
+                        gui_line_is_first_displayed (window->buffer,
+                                                     window->scroll->start_line);
                     gui_buffer_ask_chat_refresh (window->buffer, 2);
                     return 1;
                 }
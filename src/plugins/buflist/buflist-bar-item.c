@@ -36,6 +36,8 @@ struct t_hashtable *buflist_hashtable_extra_vars = NULL;
 struct t_hashtable *buflist_hashtable_options_conditions = NULL;
 struct t_arraylist *buflist_list_buffers[BUFLIST_BAR_NUM_ITEMS] =
 { NULL, NULL, NULL };
+struct t_hashtable *buflist_bar_item_cache[BUFLIST_BAR_NUM_ITEMS] =
+{ NULL, NULL, NULL };
 
 int old_line_number_current_buffer[BUFLIST_BAR_NUM_ITEMS] = { -1, -1, -1 };
 
@@ -101,15 +103,164 @@ buflist_bar_item_get_index_with_pointer (struct t_gui_bar_item *item)
     return -1;
 }
 
+/*
+ * Frees a line in cache.
+ */
+
+void
+buflist_bar_item_cache_free_value_cb (struct t_hashtable *hashtable,
+                                      const void *key, void *value)
+{
+    struct t_buflist_bar_item_cache *ptr_cache;
+
+    /* make C compiler happy */
+    (void) hashtable;
+    (void) key;
+
+    ptr_cache = (struct t_buflist_bar_item_cache *)value;
+    if (!ptr_cache)
+        return;
+
+    if (ptr_cache->signature)
+        free (ptr_cache->signature);
+    if (ptr_cache->line)
+        free (ptr_cache->line);
+
+    free (ptr_cache);
+}
+
+/*
+ * Removes line of a buffer from cache of all bar items, so that it is
+ * evaluated again on next refresh.
+ *
+ * If buffer is NULL, all lines are removed from cache.
+ */
+
+void
+buflist_bar_item_cache_invalidate (struct t_gui_buffer *buffer)
+{
+    int i;
+
+    for (i = 0; i < BUFLIST_BAR_NUM_ITEMS; i++)
+    {
+        if (!buflist_bar_item_cache[i])
+            continue;
+        if (buffer)
+            weechat_hashtable_remove (buflist_bar_item_cache[i], buffer);
+        else
+            weechat_hashtable_remove_all (buflist_bar_item_cache[i]);
+    }
+}
+
+/*
+ * Builds the signature of a buffer line: values of all variables that can
+ * change the result of conditions or line, except the buffer (key of cache)
+ * and options (a change in options clears the cache).
+ *
+ * Returns 1 if OK, 0 if error.
+ */
+
+int
+buflist_bar_item_cache_signature (char **signature)
+{
+    const char *extra_vars[] = { "current_buffer", "number_displayed",
+                                 "number", "number2", "merged", "nick_prefix",
+                                 "color_nick_prefix", "indent", "name",
+                                 "color_hotlist", "hotlist_priority",
+                                 "hotlist", "format_lag", NULL };
+    const char *ptr_value;
+    char str_pointers[128];
+    int i;
+
+    snprintf (str_pointers, sizeof (str_pointers),
+              "%p,%p,%p",
+              weechat_hashtable_get (buflist_hashtable_pointers, "window"),
+              weechat_hashtable_get (buflist_hashtable_pointers, "irc_server"),
+              weechat_hashtable_get (buflist_hashtable_pointers,
+                                     "irc_channel"));
+    if (!weechat_string_dyn_copy (signature, str_pointers))
+        return 0;
+
+    for (i = 0; extra_vars[i]; i++)
+    {
+        ptr_value = weechat_hashtable_get (buflist_hashtable_extra_vars,
+                                           extra_vars[i]);
+        if (!weechat_string_dyn_concat (signature, "\x01")
+            || !weechat_string_dyn_concat (signature, ptr_value))
+        {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/*
+ * Evaluates conditions and line of a buffer and stores them in cache of
+ * bar item.
+ *
+ * Returns pointer to line in cache, NULL if error.
+ */
+
+struct t_buflist_bar_item_cache *
+buflist_bar_item_cache_eval (int item_index, struct t_gui_buffer *buffer,
+                             const char *signature, const char *format)
+{
+    struct t_buflist_bar_item_cache *new_cache;
+    char *condition;
+
+    new_cache = malloc (sizeof (*new_cache));
+    if (!new_cache)
+        return NULL;
+
+    new_cache->signature = strdup (signature);
+    new_cache->displayed = 0;
+    new_cache->line = NULL;
+
+    /* check condition: if false, the buffer is not displayed */
+    condition = weechat_string_eval_expression (
+        weechat_config_string (buflist_config_look_display_conditions),
+        buflist_hashtable_pointers,
+        buflist_hashtable_extra_vars,
+        buflist_hashtable_options_conditions);
+    new_cache->displayed = (condition && (strcmp (condition, "1") == 0));
+    if (condition)
+        free (condition);
+
+    /* build string */
+    if (new_cache->displayed)
+    {
+        new_cache->line = weechat_string_eval_expression (
+            format,
+            buflist_hashtable_pointers,
+            buflist_hashtable_extra_vars,
+            NULL);
+    }
+
+    if (!weechat_hashtable_set (buflist_bar_item_cache[item_index],
+                                buffer, new_cache))
+    {
+        buflist_bar_item_cache_free_value_cb (NULL, NULL, new_cache);
+        return NULL;
+    }
+
+    return new_cache;
+}
+
 /*
  * Updates buflist bar item if buflist is enabled (or if force argument is 1).
+ *
+ * If buffer is not NULL, only the line of this buffer is evaluated again,
+ * otherwise all lines are evaluated again.
  */
 
 void
-buflist_bar_item_update (int force)
+buflist_bar_item_update (struct t_gui_buffer *buffer, int force)
 {
     int i;
 
+    buflist_bar_item_cache_invalidate (buffer);
+
     if (force || weechat_config_boolean (buflist_config_look_enabled))
     {
         for (i = 0; i < BUFLIST_BAR_NUM_ITEMS; i++)
@@ -293,10 +444,11 @@ buflist_bar_item_buflist_cb (const void *pointer, void *data,
     struct t_gui_nick *ptr_gui_nick;
     struct t_gui_hotlist *ptr_hotlist;
     void *ptr_server, *ptr_channel;
-    char **buflist, *str_buflist, *condition;
+    struct t_buflist_bar_item_cache *ptr_cache;
+    char **buflist, *str_buflist, **signature;
     char str_format_number[32], str_format_number_empty[32];
     char str_nick_prefix[32], str_color_nick_prefix[32];
-    char str_number[32], str_number2[32], *line, **hotlist, *str_hotlist;
+    char str_number[32], str_number2[32], **hotlist, *str_hotlist;
     char str_hotlist_count[32];
     const char *ptr_format, *ptr_format_current, *ptr_format_indent;
     const char *ptr_name, *ptr_type, *ptr_nick, *ptr_nick_prefix;
@@ -308,7 +460,7 @@ buflist_bar_item_buflist_cb (const void *pointer, void *data,
     const char *ptr_lag, *ptr_item_name;
     int item_index, num_buffers, is_channel, is_private;
     int i, j, length_max_number, current_buffer, number, prev_number, priority;
-    int rc, count, line_number, line_number_current_buffer;
+    int count, line_number, line_number_current_buffer;
 
     /* make C compiler happy */
     (void) data;
@@ -323,6 +475,7 @@ buflist_bar_item_buflist_cb (const void *pointer, void *data,
     line_number_current_buffer = 0;
 
     buflist = weechat_string_dyn_alloc (256);
+    signature = weechat_string_dyn_alloc (256);
 
     item_index = (int)((unsigned long)pointer);
 
@@ -582,16 +735,28 @@ buflist_bar_item_buflist_cb (const void *pointer, void *data,
                                    "format_lag", "");
         }
 
-        /* check condition: if false, the buffer is not displayed */
-        condition = weechat_string_eval_expression (
-            weechat_config_string (buflist_config_look_display_conditions),
-            buflist_hashtable_pointers,
-            buflist_hashtable_extra_vars,
-            buflist_hashtable_options_conditions);
-        rc = (condition && (strcmp (condition, "1") == 0));
-        if (condition)
-            free (condition);
-        if (!rc)
+        /*
+         * evaluate condition and line, unless they are in cache and
+         * variables have not changed since last evaluation
+         */
+        if (!buflist_bar_item_cache_signature (signature))
+            goto error;
+        ptr_cache = weechat_hashtable_get (buflist_bar_item_cache[item_index],
+                                           ptr_buffer);
+        if (!ptr_cache || !ptr_cache->signature
+            || (strcmp (ptr_cache->signature, *signature) != 0))
+        {
+            ptr_cache = buflist_bar_item_cache_eval (
+                item_index,
+                ptr_buffer,
+                *signature,
+                (current_buffer) ? ptr_format_current : ptr_format);
+            if (!ptr_cache)
+                goto error;
+        }
+
+        /* if condition is false, the buffer is not displayed */
+        if (!ptr_cache->displayed)
             continue;
 
         /* add buffer in list */
@@ -610,17 +775,8 @@ buflist_bar_item_buflist_cb (const void *pointer, void *data,
                 goto error;
         }
 
-        /* build string */
-        line = weechat_string_eval_expression (
-            (current_buffer) ? ptr_format_current : ptr_format,
-            buflist_hashtable_pointers,
-            buflist_hashtable_extra_vars,
-            NULL);
-
         /* concatenate string */
-        rc = weechat_string_dyn_concat (buflist, line);
-        free (line);
-        if (!rc)
+        if (!weechat_string_dyn_concat (buflist, ptr_cache->line))
             goto error;
 
         line_number++;
@@ -635,6 +791,7 @@ error:
 
 end:
     weechat_string_dyn_free (buflist, 0);
+    weechat_string_dyn_free (signature, 1);
     weechat_arraylist_free (buffers);
 
     if ((line_number_current_buffer != old_line_number_current_buffer[item_index])
@@ -699,6 +856,24 @@ buflist_bar_item_init ()
     weechat_hashtable_set (buflist_hashtable_options_conditions,
                            "type", "condition");
 
+    /* cache of lines displayed, for each bar item */
+    for (i = 0; i < BUFLIST_BAR_NUM_ITEMS; i++)
+    {
+        buflist_bar_item_cache[i] = weechat_hashtable_new (
+            128,
+            WEECHAT_HASHTABLE_POINTER,
+            WEECHAT_HASHTABLE_POINTER,
+            NULL,
+            NULL);
+        if (buflist_bar_item_cache[i])
+        {
+            weechat_hashtable_set_pointer (
+                buflist_bar_item_cache[i],
+                "callback_free_value",
+                &buflist_bar_item_cache_free_value_cb);
+        }
+    }
+
     /* bar items */
     for (i = 0; i < BUFLIST_BAR_NUM_ITEMS; i++)
     {
@@ -743,5 +918,10 @@ buflist_bar_item_end ()
             weechat_arraylist_free (buflist_list_buffers[i]);
             buflist_list_buffers[i] = NULL;
         }
+        if (buflist_bar_item_cache[i])
+        {
+            weechat_hashtable_free (buflist_bar_item_cache[i]);
+            buflist_bar_item_cache[i] = NULL;
+        }
     }
 }
@@ -25,14 +25,26 @@
 #define BUFLIST_BAR_NUM_ITEMS 3
 
 struct t_gui_bar_item;
+struct t_gui_buffer;
+
+/* line of a buffer in buflist, kept until buffer or variables change */
+
+struct t_buflist_bar_item_cache
+{
+    char *signature;                   /* variables used to build the line  */
+    int displayed;                     /* 1 if conditions are true          */
+    char *line;                        /* evaluated line (if displayed)     */
+};
 
 extern struct t_gui_bar_item *buflist_bar_item_buflist[BUFLIST_BAR_NUM_ITEMS];
 extern struct t_arraylist *buflist_list_buffers[BUFLIST_BAR_NUM_ITEMS];
+extern struct t_hashtable *buflist_bar_item_cache[BUFLIST_BAR_NUM_ITEMS];
 
 extern const char *buflist_bar_item_get_name (int index);
 extern int buflist_bar_item_get_index (const char *item_name);
 extern int buflist_bar_item_get_index_with_pointer (struct t_gui_bar_item *item);
-extern void buflist_bar_item_update (int force);
+extern void buflist_bar_item_cache_invalidate (struct t_gui_buffer *buffer);
+extern void buflist_bar_item_update (struct t_gui_buffer *buffer, int force);
 extern int buflist_bar_item_init ();
 extern void buflist_bar_item_end ();
 
@@ -72,7 +72,7 @@ buflist_command_buflist (const void *pointer, void *data,
 
     if (weechat_strcasecmp (argv[1], "refresh") == 0)
     {
-        buflist_bar_item_update (0);
+        buflist_bar_item_update (NULL, 0);
         return WEECHAT_RC_OK;
     }
 
@@ -113,6 +113,10 @@ buflist_config_compare_signals (void *data, struct t_arraylist *arraylist,
 
 /*
  * Callback for a signal on a buffer.
+ *
+ * If the signal is about a single buffer (signal data is the buffer pointer,
+ * or "0x123,nick" for nicklist signals), only the line of this buffer is
+ * evaluated again, otherwise all lines are evaluated again.
  */
 
 int
@@ -120,14 +124,46 @@ buflist_config_signal_buffer_cb (const void *pointer, void *data,
                                  const char *signal, const char *type_data,
                                  void *signal_data)
 {
+    struct t_gui_buffer *ptr_buffer;
+    unsigned long value;
+    int rc;
+
     /* make C compiler happy */
     (void) pointer;
     (void) data;
-    (void) signal;
-    (void) type_data;
-    (void) signal_data;
 
-    buflist_bar_item_update (0);
+    ptr_buffer = NULL;
+
+    if (strcmp (type_data, WEECHAT_HOOK_SIGNAL_POINTER) == 0)
+    {
+        ptr_buffer = signal_data;
+    }
+    else if ((strcmp (type_data, WEECHAT_HOOK_SIGNAL_STRING) == 0)
+             && (strncmp (signal, "nicklist_nick_", 14) == 0)
+             && signal_data
+             && (strncmp ((const char *)signal_data, "0x", 2) == 0))
+    {
+        rc = sscanf ((const char *)signal_data + 2, "%lx", &value);
+        if ((rc != EOF) && (rc >= 1))
+            ptr_buffer = (struct t_gui_buffer *)value;
+    }
+
+    /*
+     * a closed buffer is not in list of buffers any more: its pointer is
+     * only used to remove its line from cache; for other signals, the
+     * pointer must be a buffer (signal "window_switch" has a window pointer)
+     */
+    if (ptr_buffer
+        && (strcmp (signal, "buffer_closed") != 0)
+        && !weechat_hdata_check_pointer (
+            buflist_hdata_buffer,
+            weechat_hdata_get_list (buflist_hdata_buffer, "gui_buffers"),
+            ptr_buffer))
+    {
+        ptr_buffer = NULL;
+    }
+
+    buflist_bar_item_update (ptr_buffer, 0);
 
     return WEECHAT_RC_OK;
 }
@@ -228,13 +264,13 @@ buflist_config_change_enabled (const void *pointer, void *data,
         /* buflist enabled */
         buflist_config_hook_signals_refresh ();
         weechat_command (NULL, "/mute /bar show buflist");
-        buflist_bar_item_update (0);
+        buflist_bar_item_update (NULL, 0);
     }
     else
     {
         /* buflist disabled */
         weechat_command (NULL, "/mute /bar hide buflist");
-        buflist_bar_item_update (1);
+        buflist_bar_item_update (NULL, 1);
     }
 }
 
@@ -299,7 +335,7 @@ buflist_config_change_sort (const void *pointer, void *data,
             free (sort);
     }
 
-    buflist_bar_item_update (0);
+    buflist_bar_item_update (NULL, 0);
 }
 
 /*
@@ -333,7 +369,7 @@ buflist_config_change_nick_prefix (const void *pointer, void *data,
     (void) option;
 
     buflist_config_change_signals_refresh (NULL, NULL, NULL);
-    buflist_bar_item_update (0);
+    buflist_bar_item_update (NULL, 0);
 }
 
 /*
@@ -349,7 +385,7 @@ buflist_config_change_buflist (const void *pointer, void *data,
     (void) data;
     (void) option;
 
-    buflist_bar_item_update (0);
+    buflist_bar_item_update (NULL, 0);
 }
 
 /*
@@ -410,7 +446,7 @@ buflist_config_change_format (const void *pointer, void *data,
     buflist_config_format_hotlist_eval = buflist_config_add_eval_for_formats (
         weechat_config_string (buflist_config_format_hotlist));
 
-    buflist_bar_item_update (0);
+    buflist_bar_item_update (NULL, 0);
 }
 
 /*
@@ -155,6 +155,83 @@ irc_channel_move_near_server (struct t_irc_server *server, int channel_type,
     }
 }
 
+/*
+ * Adds a channel in hashtable "channels_hashtable" of server (creates the
+ * hashtable if needed).
+ */
+
+void
+irc_channel_hashtable_add (struct t_irc_server *server,
+                           struct t_irc_channel *channel)
+{
+    if (!server->channels_hashtable)
+    {
+        server->channels_hashtable = irc_server_hashtable_new_casemapping (
+            server, 32,
+            WEECHAT_HASHTABLE_POINTER,
+            WEECHAT_HASHTABLE_POINTER);
+        if (!server->channels_hashtable)
+            return;
+    }
+
+    /* keep the first channel if many channels have same name */
+    if (!weechat_hashtable_has_key (server->channels_hashtable, channel->name))
+        weechat_hashtable_set (server->channels_hashtable, channel->name, channel);
+}
+
+/*
+ * Removes a channel from hashtable "channels_hashtable" of server.
+ *
+ * This must be called before the name of channel is freed (the name is used
+ * as key in the hashtable).
+ */
+
+void
+irc_channel_hashtable_remove (struct t_irc_server *server,
+                              struct t_irc_channel *channel)
+{
+    struct t_irc_channel *ptr_channel;
+
+    if (!server->channels_hashtable || !channel->name)
+        return;
+
+    if (weechat_hashtable_get (server->channels_hashtable,
+                               channel->name) != channel)
+        return;
+
+    weechat_hashtable_remove (server->channels_hashtable, channel->name);
+
+    /* index another channel with same name, if any */
+    for (ptr_channel = server->channels; ptr_channel;
+         ptr_channel = ptr_channel->next_channel)
+    {
+        if ((ptr_channel != channel)
+            && (irc_server_strcasecmp (server, ptr_channel->name,
+                                       channel->name) == 0))
+        {
+            weechat_hashtable_set (server->channels_hashtable,
+                                   ptr_channel->name, ptr_channel);
+            break;
+        }
+    }
+}
+
+/*
+ * Renames a channel (used for private buffers, when remote nick changes).
+ */
+
+void
+irc_channel_rename (struct t_irc_server *server,
+                    struct t_irc_channel *channel,
+                    const char *new_name)
+{
+    irc_channel_hashtable_remove (server, channel);
+    if (channel->name)
+        free (channel->name);
+    channel->name = strdup (new_name);
+    irc_channel_hashtable_add (server, channel);
+}
+
 /*
  * Searches for a channel by name.
  *
@@ -169,6 +246,10 @@ irc_channel_search (struct t_irc_server *server, const char *channel_name)
     if (!server || !channel_name)
         return NULL;
 
+    if (server->channels_hashtable)
+        return weechat_hashtable_get (server->channels_hashtable, channel_name);
+
+    /* no hashtable (memory error): search in list of channels */
     for (ptr_channel = server->channels; ptr_channel;
          ptr_channel = ptr_channel->next_channel)
     {
@@ -495,6 +576,7 @@ irc_channel_new (struct t_irc_server *server, int channel_type,
     new_channel->nicks_count = 0;
     new_channel->nicks = NULL;
     new_channel->last_nick = NULL;
+    new_channel->nicks_hashtable = NULL;
     new_channel->nicks_speaking[0] = NULL;
     new_channel->nicks_speaking[1] = NULL;
     new_channel->nicks_speaking_time = NULL;
@@ -520,6 +602,8 @@ irc_channel_new (struct t_irc_server *server, int channel_type,
         server->channels = new_channel;
     server->last_channel = new_channel;
 
+    irc_channel_hashtable_add (server, new_channel);
+
     (void) weechat_hook_signal_send (
         (channel_type == IRC_CHANNEL_TYPE_CHANNEL) ?
         "irc_channel_opened" : "irc_pv_opened",
@@ -1474,6 +1558,8 @@ irc_channel_free (struct t_irc_server *server, struct t_irc_channel *channel)
     if (!server || !channel)
         return;
 
+    irc_channel_hashtable_remove (server, channel);
+
     /* remove channel from channels list */
     if (server->last_channel == channel)
         server->last_channel = channel->prev_channel;
@@ -1531,6 +1617,13 @@ irc_channel_free (struct t_irc_server *server, struct t_irc_channel *channel)
 void
 irc_channel_free_all (struct t_irc_server *server)
 {
+    /* all channels are removed, no need to update the hashtable */
+    if (server->channels_hashtable)
+    {
+        weechat_hashtable_free (server->channels_hashtable);
+        server->channels_hashtable = NULL;
+    }
+
     while (server->channels)
     {
         irc_channel_free (server, server->channels);
@@ -1573,6 +1666,7 @@ irc_channel_hdata_channel_cb (const void *pointer, void *data,
         WEECHAT_HDATA_VAR(struct t_irc_channel, nicks_count, INTEGER, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_irc_channel, nicks, POINTER, 0, NULL, "irc_nick");
         WEECHAT_HDATA_VAR(struct t_irc_channel, last_nick, POINTER, 0, NULL, "irc_nick");
+        WEECHAT_HDATA_VAR(struct t_irc_channel, nicks_hashtable, HASHTABLE, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_irc_channel, nicks_speaking, POINTER, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_irc_channel, nicks_speaking_time, POINTER, 0, NULL, "irc_channel_speaking");
         WEECHAT_HDATA_VAR(struct t_irc_channel, last_nick_speaking_time, POINTER, 0, NULL, "irc_channel_speaking");
@@ -1759,6 +1853,7 @@ irc_channel_print_log (struct t_irc_channel *channel)
     weechat_log_printf ("       nicks_count. . . . . . . : %d",    channel->nicks_count);
     weechat_log_printf ("       nicks. . . . . . . . . . : 0x%lx", channel->nicks);
     weechat_log_printf ("       last_nick. . . . . . . . : 0x%lx", channel->last_nick);
+    weechat_log_printf ("       nicks_hashtable. . . . . : 0x%lx", channel->nicks_hashtable);
     weechat_log_printf ("       nicks_speaking[0]. . . . : 0x%lx", channel->nicks_speaking[0]);
     weechat_log_printf ("       nicks_speaking[1]. . . . : 0x%lx", channel->nicks_speaking[1]);
     weechat_log_printf ("       nicks_speaking_time. . . : 0x%lx", channel->nicks_speaking_time);
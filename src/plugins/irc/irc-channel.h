@@ -64,6 +64,8 @@ struct t_irc_channel
     int nicks_count;                   /* # nicks on channel (0 if pv)      */
     struct t_irc_nick *nicks;          /* nicks on the channel              */
     struct t_irc_nick *last_nick;      /* last nick on the channel          */
+    struct t_hashtable *nicks_hashtable; /* nicks indexed by name (with     */
+                                       /* casemapping of server)            */
     struct t_weelist *nicks_speaking[2]; /* for smart completion: first     */
                                        /* list is nick speaking, second is  */
                                        /* speaking to me (highlight)        */
@@ -83,6 +85,11 @@ extern char *irc_channel_default_chantypes;
 
 extern int irc_channel_valid (struct t_irc_server *server,
                               struct t_irc_channel *channel);
+extern void irc_channel_hashtable_add (struct t_irc_server *server,
+                                       struct t_irc_channel *channel);
+extern void irc_channel_rename (struct t_irc_server *server,
+                                struct t_irc_channel *channel,
+                                const char *new_name);
 extern struct t_irc_channel *irc_channel_search (struct t_irc_server *server,
                                                  const char *channel_name);
 extern struct t_gui_buffer *irc_channel_search_buffer (struct t_irc_server *server,
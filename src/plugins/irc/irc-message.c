@@ -28,79 +28,57 @@
 #include "irc.h"
 #include "irc-channel.h"
 #include "irc-config.h"
+#include "irc-message.h"
 #include "irc-server.h"
 
 
 /*
- * Parses an IRC message and returns:
- *   - tags (string)
- *   - message without tags (string)
- *   - nick (string)
- *   - host (string)
- *   - command (string)
- *   - channel (string)
- *   - arguments (string)
- *   - text (string)
- *   - pos_command (integer: command index in message)
- *   - pos_arguments (integer: arguments index in message)
- *   - pos_channel (integer: channel index in message)
- *   - pos_text (integer: text index in message)
+ * Parses an IRC message without any copy: parts of message are returned as
+ * positions (index in message) and lengths, in structure "parsed".
+ *
+ * Positions are -1 if the part is not found in message; arguments and text
+ * go until the end of message (they have no length).
  *
  * Example:
  *   @time=2015-06-27T16:40:35.000Z :nick!user@host PRIVMSG #weechat :hello!
  *
  * Result:
- *               tags: "time=2015-06-27T16:40:35.000Z"
- *   msg_without_tags: ":nick!user@host PRIVMSG #weechat :hello!"
- *               nick: "nick"
- *               user: "user"
- *               host: "nick!user@host"
- *            command: "PRIVMSG"
- *            channel: "#weechat"
- *          arguments: "#weechat :hello!"
- *               text: "hello!"
- *        pos_command: 47
- *      pos_arguments: 55
- *        pos_channel: 55
- *           pos_text: 65
+ *                   pos_tags: 1 (length: 29)
+ *   pos_message_without_tags: 31
+ *                   pos_nick: 32 (length: 4)
+ *                   pos_user: 37 (length: 4)
+ *                   pos_host: 32 (length: 14)
+ *                pos_command: 47 (length: 7)
+ *              pos_arguments: 55
+ *                pos_channel: 55 (length: 8)
+ *                   pos_text: 65
  */
 
 void
-irc_message_parse (struct t_irc_server *server, const char *message,
-                   char **tags, char **message_without_tags, char **nick,
-                   char **user, char **host, char **command, char **channel,
-                   char **arguments, char **text,
-                   int *pos_command, int *pos_arguments, int *pos_channel,
-                   int *pos_text)
+irc_message_parse_positions (struct t_irc_server *server, const char *message,
+                             struct t_irc_message_parsed *parsed)
 {
     const char *ptr_message, *pos, *pos2, *pos3, *pos4;
 
-    if (tags)
-        *tags = NULL;
-    if (message_without_tags)
-        *message_without_tags = NULL;
-    if (nick)
-        *nick = NULL;
-    if (user)
-        *user = NULL;
-    if (host)
-        *host = NULL;
-    if (command)
-        *command = NULL;
-    if (channel)
-        *channel = NULL;
-    if (arguments)
-        *arguments = NULL;
-    if (text)
-        *text = NULL;
-    if (pos_command)
-        *pos_command = -1;
-    if (pos_arguments)
-        *pos_arguments = -1;
-    if (pos_channel)
-        *pos_channel = -1;
-    if (pos_text)
-        *pos_text = -1;
+    if (!parsed)
+        return;
+
+    parsed->message = message;
+    parsed->pos_tags = -1;
+    parsed->length_tags = 0;
+    parsed->pos_message_without_tags = -1;
+    parsed->pos_nick = -1;
+    parsed->length_nick = 0;
+    parsed->pos_user = -1;
+    parsed->length_user = 0;
+    parsed->pos_host = -1;
+    parsed->length_host = 0;
+    parsed->pos_command = -1;
+    parsed->length_command = 0;
+    parsed->pos_arguments = -1;
+    parsed->pos_channel = -1;
+    parsed->length_channel = 0;
+    parsed->pos_text = -1;
 
     if (!message)
         return;
@@ -123,11 +101,8 @@ irc_message_parse (struct t_irc_server *server, const char *message,
         pos = strchr (ptr_message, ' ');
         if (pos)
         {
-            if (tags)
-            {
-                *tags = weechat_strndup (ptr_message + 1,
-                                         pos - (ptr_message + 1));
-            }
+            parsed->pos_tags = 1;
+            parsed->length_tags = pos - (ptr_message + 1);
             ptr_message = pos + 1;
             while (ptr_message[0] == ' ')
             {
@@ -136,8 +111,7 @@ irc_message_parse (struct t_irc_server *server, const char *message,
         }
     }
 
-    if (message_without_tags)
-        *message_without_tags = strdup (ptr_message);
+    parsed->pos_message_without_tags = ptr_message - message;
 
     /* now we have: ptr_message --> ":nick!user@host PRIVMSG #weechat :hello!" */
     if (ptr_message[0] == ':')
@@ -151,23 +125,23 @@ irc_message_parse (struct t_irc_server *server, const char *message,
             pos2 = pos3;
         if (pos2 && pos3 && (pos3 > pos2))
         {
-            if (user)
-                *user = weechat_strndup (pos2 + 1, pos3 - pos2 - 1);
+            parsed->pos_user = pos2 + 1 - message;
+            parsed->length_user = pos3 - pos2 - 1;
         }
         if (pos2 && (!pos || pos > pos2))
         {
-            if (nick)
-                *nick = weechat_strndup (ptr_message + 1, pos2 - (ptr_message + 1));
+            parsed->pos_nick = ptr_message + 1 - message;
+            parsed->length_nick = pos2 - (ptr_message + 1);
         }
         else if (pos)
         {
-            if (nick)
-                *nick = weechat_strndup (ptr_message + 1, pos - (ptr_message + 1));
+            parsed->pos_nick = ptr_message + 1 - message;
+            parsed->length_nick = pos - (ptr_message + 1);
         }
+        parsed->pos_host = ptr_message + 1 - message;
         if (pos)
         {
-            if (host)
-                *host = weechat_strndup (ptr_message + 1, pos - (ptr_message + 1));
+            parsed->length_host = pos - (ptr_message + 1);
             ptr_message = pos + 1;
             while (ptr_message[0] == ' ')
             {
@@ -176,152 +150,233 @@ irc_message_parse (struct t_irc_server *server, const char *message,
         }
         else
         {
-            if (host)
-                *host = strdup (ptr_message + 1);
+            parsed->length_host = strlen (ptr_message + 1);
             ptr_message += strlen (ptr_message);
         }
     }
 
     /* now we have: ptr_message --> "PRIVMSG #weechat :hello!" */
-    if (ptr_message[0])
+    if (!ptr_message[0])
+        return;
+
+    parsed->pos_command = ptr_message - message;
+    pos = strchr (ptr_message, ' ');
+    if (!pos)
     {
-        pos = strchr (ptr_message, ' ');
-        if (pos)
+        parsed->length_command = strlen (ptr_message);
+        return;
+    }
+    parsed->length_command = pos - ptr_message;
+    pos++;
+    while (pos[0] == ' ')
+    {
+        pos++;
+    }
+
+    /* now we have: pos --> "#weechat :hello!" */
+    parsed->pos_arguments = pos - message;
+    if ((pos[0] == ':')
+        && ((strncmp (ptr_message, "JOIN ", 5) == 0)
+            || (strncmp (ptr_message, "PART ", 5) == 0)))
+    {
+        pos++;
+    }
+    if (pos[0] == ':')
+    {
+        parsed->pos_text = pos - message + 1;
+        return;
+    }
+
+    pos2 = strchr (pos, ' ');
+    if (irc_channel_is_channel (server, pos))
+    {
+        parsed->pos_channel = pos - message;
+        parsed->length_channel = (pos2) ? pos2 - pos : (int)strlen (pos);
+        if (pos2)
         {
-            if (command)
-                *command = weechat_strndup (ptr_message, pos - ptr_message);
-            if (pos_command)
-                *pos_command = ptr_message - message;
-            pos++;
-            while (pos[0] == ' ')
-            {
-                pos++;
-            }
-            /* now we have: pos --> "#weechat :hello!" */
-            if (arguments)
-                *arguments = strdup (pos);
-            if (pos_arguments)
-                *pos_arguments = pos - message;
-            if ((pos[0] == ':')
-                && ((strncmp (ptr_message, "JOIN ", 5) == 0)
-                    || (strncmp (ptr_message, "PART ", 5) == 0)))
-            {
-                pos++;
-            }
-            if (pos[0] == ':')
-            {
-                if (text)
-                    *text = strdup (pos + 1);
-                if (pos_text)
-                    *pos_text = pos - message + 1;
-            }
-            else
+            while (pos2[0] == ' ')
             {
-                if (irc_channel_is_channel (server, pos))
-                {
-                    pos2 = strchr (pos, ' ');
-                    if (channel)
-                    {
-                        if (pos2)
-                            *channel = weechat_strndup (pos, pos2 - pos);
-                        else
-                            *channel = strdup (pos);
-                    }
-                    if (pos_channel)
-                        *pos_channel = pos - message;
-                    if (pos2)
-                    {
-                        while (pos2[0] == ' ')
-                        {
-                            pos2++;
-                        }
-                        if (pos2[0] == ':')
-                            pos2++;
-                        if (text)
-                            *text = strdup (pos2);
-                        if (pos_text)
-                            *pos_text = pos2 - message;
-                    }
-                }
-                else
-                {
-                    pos2 = strchr (pos, ' ');
-                    if (nick && !*nick)
-                    {
-                        if (pos2)
-                            *nick = weechat_strndup (pos, pos2 - pos);
-                        else
-                            *nick = strdup (pos);
-                    }
-                    if (pos2)
-                    {
-                        pos3 = pos2;
-                        pos2++;
-                        while (pos2[0] == ' ')
-                        {
-                            pos2++;
-                        }
-                        if (irc_channel_is_channel (server, pos2))
-                        {
-                            pos4 = strchr (pos2, ' ');
-                            if (channel)
-                            {
-                                if (pos4)
-                                    *channel = weechat_strndup (pos2, pos4 - pos2);
-                                else
-                                    *channel = strdup (pos2);
-                            }
-                            if (pos_channel)
-                                *pos_channel = pos2 - message;
-                            if (pos4)
-                            {
-                                while (pos4[0] == ' ')
-                                {
-                                    pos4++;
-                                }
-                                if (pos4[0] == ':')
-                                    pos4++;
-                                if (text)
-                                    *text = strdup (pos4);
-                                if (pos_text)
-                                    *pos_text = pos4 - message;
-                            }
-                        }
-                        else
-                        {
-                            if (channel)
-                                *channel = weechat_strndup (pos, pos3 - pos);
-                            if (pos_channel)
-                                *pos_channel = pos - message;
-                            pos4 = strchr (pos3, ' ');
-                            if (pos4)
-                            {
-                                while (pos4[0] == ' ')
-                                {
-                                    pos4++;
-                                }
-                                if (pos4[0] == ':')
-                                    pos4++;
-                                if (text)
-                                    *text = strdup (pos4);
-                                if (pos_text)
-                                    *pos_text = pos4 - message;
-                            }
-                        }
-                    }
-                }
+                pos2++;
             }
+            if (pos2[0] == ':')
+                pos2++;
+            parsed->pos_text = pos2 - message;
         }
-        else
+        return;
+    }
+
+    /* first argument is a nick (if there was no nick in prefix) */
+    if (parsed->pos_nick < 0)
+    {
+        parsed->pos_nick = pos - message;
+        parsed->length_nick = (pos2) ? pos2 - pos : (int)strlen (pos);
+    }
+    if (!pos2)
+        return;
+
+    pos3 = pos2;
+    pos2++;
+    while (pos2[0] == ' ')
+    {
+        pos2++;
+    }
+    if (irc_channel_is_channel (server, pos2))
+    {
+        pos4 = strchr (pos2, ' ');
+        parsed->pos_channel = pos2 - message;
+        parsed->length_channel = (pos4) ? pos4 - pos2 : (int)strlen (pos2);
+    }
+    else
+    {
+        parsed->pos_channel = pos - message;
+        parsed->length_channel = pos3 - pos;
+        pos4 = strchr (pos3, ' ');
+    }
+    if (pos4)
+    {
+        while (pos4[0] == ' ')
         {
-            if (command)
-                *command = strdup (ptr_message);
-            if (pos_command)
-                *pos_command = ptr_message - message;
+            pos4++;
         }
+        if (pos4[0] == ':')
+            pos4++;
+        parsed->pos_text = pos4 - message;
     }
 }
 
+/*
+ * Returns a copy of a part of a message parsed with function
+ * irc_message_parse_positions, NULL if the part is not set.
+ *
+ * Note: result must be freed after use.
+ */
+
+char *
+irc_message_parsed_dup (struct t_irc_message_parsed *parsed, int pos,
+                        int length)
+{
+    if (!parsed || !parsed->message || (pos < 0))
+        return NULL;
+
+    return weechat_strndup (parsed->message + pos, length);
+}
+
+/*
+ * Gets a part of a message parsed with function irc_message_parse_positions,
+ * as a null-terminated string: the part is copied in "buffer" if it fits,
+ * otherwise it is copied in a newly allocated string.
+ *
+ * Returns pointer to buffer or to the allocated string (which must be freed
+ * after use if different from buffer), NULL if the part is not set.
+ */
+
+char *
+irc_message_parsed_get (struct t_irc_message_parsed *parsed, int pos,
+                        int length, char *buffer, int size)
+{
+    if (!parsed || !parsed->message || (pos < 0))
+        return NULL;
+
+    if (length >= size)
+        return weechat_strndup (parsed->message + pos, length);
+
+    memcpy (buffer, parsed->message + pos, length);
+    buffer[length] = '\0';
+    return buffer;
+}
+
+/*
+ * Parses an IRC message and returns:
+ *   - tags (string)
+ *   - message without tags (string)
+ *   - nick (string)
+ *   - host (string)
+ *   - command (string)
+ *   - channel (string)
+ *   - arguments (string)
+ *   - text (string)
+ *   - pos_command (integer: command index in message)
+ *   - pos_arguments (integer: arguments index in message)
+ *   - pos_channel (integer: channel index in message)
+ *   - pos_text (integer: text index in message)
+ *
+ * Example:
+ *   @time=2015-06-27T16:40:35.000Z :nick!user@host PRIVMSG #weechat :hello!
+ *
+ * Result:
+ *               tags: "time=2015-06-27T16:40:35.000Z"
+ *   msg_without_tags: ":nick!user@host PRIVMSG #weechat :hello!"
+ *               nick: "nick"
+ *               user: "user"
+ *               host: "nick!user@host"
+ *            command: "PRIVMSG"
+ *            channel: "#weechat"
+ *          arguments: "#weechat :hello!"
+ *               text: "hello!"
+ *        pos_command: 47
+ *      pos_arguments: 55
+ *        pos_channel: 55
+ *           pos_text: 65
+ *
+ * Note: strings returned must be freed after use; to parse a message without
+ * any allocation, use function irc_message_parse_positions.
+ */
+
+void
+irc_message_parse (struct t_irc_server *server, const char *message,
+                   char **tags, char **message_without_tags, char **nick,
+                   char **user, char **host, char **command, char **channel,
+                   char **arguments, char **text,
+                   int *pos_command, int *pos_arguments, int *pos_channel,
+                   int *pos_text)
+{
+    struct t_irc_message_parsed parsed;
+
+    irc_message_parse_positions (server, message, &parsed);
+
+    if (tags)
+        *tags = irc_message_parsed_dup (&parsed, parsed.pos_tags,
+                                        parsed.length_tags);
+    if (message_without_tags)
+    {
+        *message_without_tags = (parsed.pos_message_without_tags >= 0) ?
+            strdup (message + parsed.pos_message_without_tags) : NULL;
+    }
+    if (nick)
+        *nick = irc_message_parsed_dup (&parsed, parsed.pos_nick,
+                                        parsed.length_nick);
+    if (user)
+        *user = irc_message_parsed_dup (&parsed, parsed.pos_user,
+                                        parsed.length_user);
+    if (host)
+        *host = irc_message_parsed_dup (&parsed, parsed.pos_host,
+                                        parsed.length_host);
+    if (command)
+        *command = irc_message_parsed_dup (&parsed, parsed.pos_command,
+                                           parsed.length_command);
+    if (channel)
+        *channel = irc_message_parsed_dup (&parsed, parsed.pos_channel,
+                                           parsed.length_channel);
+    if (arguments)
+    {
+        *arguments = (parsed.pos_arguments >= 0) ?
+            strdup (message + parsed.pos_arguments) : NULL;
+    }
+    if (text)
+    {
+        *text = (parsed.pos_text >= 0) ?
+            strdup (message + parsed.pos_text) : NULL;
+    }
+    if (pos_command)
+        *pos_command = parsed.pos_command;
+    if (pos_arguments)
+        *pos_arguments = parsed.pos_arguments;
+    if (pos_channel)
+        *pos_channel = parsed.pos_channel;
+    if (pos_text)
+        *pos_text = parsed.pos_text;
+}
+
 /*
  * Parses an IRC message and returns hashtable with keys:
  *   - tags
@@ -23,6 +23,36 @@
 struct t_irc_server;
 struct t_irc_channel;
 
+/* message parsed (positions/lengths of parts in message, -1 if not found) */
+
+struct t_irc_message_parsed
+{
+    const char *message;               /* IRC message (not a copy)          */
+    int pos_tags;                      /* tags (without "@")                */
+    int length_tags;
+    int pos_message_without_tags;      /* message without tags (until end)  */
+    int pos_nick;                      /* nick                              */
+    int length_nick;
+    int pos_user;                      /* user                              */
+    int length_user;
+    int pos_host;                      /* host (for ex: "nick!user@host")   */
+    int length_host;
+    int pos_command;                   /* command                           */
+    int length_command;
+    int pos_arguments;                 /* arguments (until end)             */
+    int pos_channel;                   /* channel                           */
+    int length_channel;
+    int pos_text;                      /* text (until end)                  */
+};
+
+extern void irc_message_parse_positions (struct t_irc_server *server,
+                                         const char *message,
+                                         struct t_irc_message_parsed *parsed);
+extern char *irc_message_parsed_dup (struct t_irc_message_parsed *parsed,
+                                     int pos, int length);
+extern char *irc_message_parsed_get (struct t_irc_message_parsed *parsed,
+                                     int pos, int length,
+                                     char *buffer, int size);
 extern void irc_message_parse (struct t_irc_server *server, const char *message,
                                char **tags, char **message_without_tags,
                                char **nick, char **user, char **host,
@@ -522,6 +522,217 @@ irc_nick_nicklist_set_color_all ()
     }
 }
 
+/*
+ * Frees the arraylist of channels in hashtable "nicks_channels" of server.
+ */
+
+void
+irc_nick_channels_free_value_cb (struct t_hashtable *hashtable,
+                                 const void *key, void *value)
+{
+    /* make C compiler happy */
+    (void) hashtable;
+    (void) key;
+
+    weechat_arraylist_free ((struct t_arraylist *)value);
+}
+
+/*
+ * Adds a channel in the list of channels of a nick, in hashtable
+ * "nicks_channels" of server (creates the hashtable if needed).
+ */
+
+void
+irc_nick_channels_add (struct t_irc_server *server,
+                       struct t_irc_channel *channel,
+                       const char *nickname)
+{
+    struct t_arraylist *ptr_channels;
+
+    if (!server->nicks_channels)
+    {
+        server->nicks_channels = irc_server_hashtable_new_casemapping (
+            server, 256,
+            WEECHAT_HASHTABLE_STRING,
+            WEECHAT_HASHTABLE_POINTER);
+        if (!server->nicks_channels)
+            return;
+        weechat_hashtable_set_pointer (server->nicks_channels,
+                                       "callback_free_value",
+                                       &irc_nick_channels_free_value_cb);
+    }
+
+    ptr_channels = weechat_hashtable_get (server->nicks_channels, nickname);
+    if (!ptr_channels)
+    {
+        ptr_channels = weechat_arraylist_new (4, 0, 0,
+                                              NULL, NULL, NULL, NULL);
+        if (!ptr_channels)
+            return;
+        weechat_hashtable_set (server->nicks_channels, nickname, ptr_channels);
+    }
+
+    if (!weechat_arraylist_search (ptr_channels, channel, NULL, NULL))
+        weechat_arraylist_add (ptr_channels, channel);
+}
+
+/*
+ * Removes a channel from the list of channels of a nick, in hashtable
+ * "nicks_channels" of server.
+ */
+
+void
+irc_nick_channels_remove (struct t_irc_server *server,
+                          struct t_irc_channel *channel,
+                          const char *nickname)
+{
+    struct t_arraylist *ptr_channels;
+    int index;
+
+    if (!server->nicks_channels)
+        return;
+
+    ptr_channels = weechat_hashtable_get (server->nicks_channels, nickname);
+    if (!ptr_channels)
+        return;
+
+    if (weechat_arraylist_search (ptr_channels, channel, &index, NULL))
+        weechat_arraylist_remove (ptr_channels, index);
+
+    if (weechat_arraylist_size (ptr_channels) == 0)
+        weechat_hashtable_remove (server->nicks_channels, nickname);
+}
+
+/*
+ * Gets channels where a nick is: channels with this nick in nicklist and,
+ * if "with_private" is 1, the private buffer with this nick.
+ *
+ * Note: result must be freed after use.
+ *
+ * Returns a NULL-terminated array of channels, NULL if error.
+ */
+
+struct t_irc_channel **
+irc_nick_get_channels (struct t_irc_server *server, const char *nickname,
+                       int with_private)
+{
+    struct t_arraylist *ptr_channels;
+    struct t_irc_channel **channels, *ptr_channel;
+    int i, size, count;
+
+    if (!server || !nickname)
+        return NULL;
+
+    ptr_channels = (server->nicks_channels) ?
+        weechat_hashtable_get (server->nicks_channels, nickname) : NULL;
+    size = (ptr_channels) ? weechat_arraylist_size (ptr_channels) : 0;
+
+    channels = malloc ((size + 2) * sizeof (*channels));
+    if (!channels)
+        return NULL;
+
+    count = 0;
+    for (i = 0; i < size; i++)
+    {
+        channels[count++] = weechat_arraylist_get (ptr_channels, i);
+    }
+    if (with_private)
+    {
+        ptr_channel = irc_channel_search (server, nickname);
+        if (ptr_channel && (ptr_channel->type == IRC_CHANNEL_TYPE_PRIVATE))
+            channels[count++] = ptr_channel;
+    }
+    channels[count] = NULL;
+
+    return channels;
+}
+
+/*
+ * Adds a nick in hashtable "nicks_hashtable" of channel (creates the
+ * hashtable if needed) and in hashtable "nicks_channels" of server.
+ */
+
+void
+irc_nick_hashtable_add (struct t_irc_server *server,
+                        struct t_irc_channel *channel,
+                        struct t_irc_nick *nick)
+{
+    struct t_irc_nick *ptr_nick;
+
+    if (!channel->nicks_hashtable)
+    {
+        channel->nicks_hashtable = irc_server_hashtable_new_casemapping (
+            server, 64,
+            WEECHAT_HASHTABLE_POINTER,
+            WEECHAT_HASHTABLE_POINTER);
+        if (!channel->nicks_hashtable)
+            return;
+    }
+
+    /*
+     * the key is the name of nick (not duplicated by hashtable): if another
+     * nick has same name, its entry is removed first, so that the key is not
+     * kept with the name of the other nick (which may be freed before)
+     */
+    ptr_nick = weechat_hashtable_get (channel->nicks_hashtable, nick->name);
+    if (ptr_nick && (ptr_nick != nick))
+        weechat_hashtable_remove (channel->nicks_hashtable, nick->name);
+
+    weechat_hashtable_set (channel->nicks_hashtable, nick->name, nick);
+
+    if (server)
+        irc_nick_channels_add (server, channel, nick->name);
+}
+
+/*
+ * Removes a nick from hashtable "nicks_hashtable" of channel and from
+ * hashtable "nicks_channels" of server.
+ *
+ * This must be called before the name of nick is freed (the name is used as
+ * key in the hashtable).
+ */
+
+void
+irc_nick_hashtable_remove (struct t_irc_server *server,
+                           struct t_irc_channel *channel,
+                           struct t_irc_nick *nick)
+{
+    if (!channel->nicks_hashtable || !nick->name)
+        return;
+
+    /* remove key only if it points to this nick (should always be true) */
+    if (weechat_hashtable_get (channel->nicks_hashtable, nick->name) == nick)
+    {
+        weechat_hashtable_remove (channel->nicks_hashtable, nick->name);
+        if (server)
+            irc_nick_channels_remove (server, channel, nick->name);
+    }
+}
+
+/*
+ * Rebuilds hashtable "nicks_hashtable" of channel (called when the
+ * casemapping of server changes, hashtable "nicks_channels" of server must
+ * have been freed before).
+ */
+
+void
+irc_nick_hashtable_rebuild (struct t_irc_server *server,
+                            struct t_irc_channel *channel)
+{
+    struct t_irc_nick *ptr_nick;
+
+    if (channel->nicks_hashtable)
+    {
+        weechat_hashtable_free (channel->nicks_hashtable);
+        channel->nicks_hashtable = NULL;
+    }
+
+    for (ptr_nick = channel->nicks; ptr_nick; ptr_nick = ptr_nick->next_nick)
+    {
+        irc_nick_hashtable_add (server, channel, ptr_nick);
+    }
+}
+
 /*
  * Adds a new nick in channel.
  *
@@ -609,6 +820,8 @@ irc_nick_new (struct t_irc_server *server, struct t_irc_channel *channel,
 
     channel->nicks_count++;
 
+    irc_nick_hashtable_add (server, channel, new_nick);
+
     channel->nick_completion_reset = 1;
 
     /* add nick to buffer nicklist */
@@ -626,8 +839,18 @@ void
 irc_nick_change (struct t_irc_server *server, struct t_irc_channel *channel,
                  struct t_irc_nick *nick, const char *new_nick)
 {
+    struct t_irc_nick *ptr_nick;
     int nick_is_me;
 
+    /*
+     * another nick with the new name in channel is obsolete (nicks are
+     * unique on server): it is removed, so that indexes of nicks in channel
+     * and server are not shared by two nicks
+     */
+    ptr_nick = irc_nick_search (server, channel, new_nick);
+    if (ptr_nick && (ptr_nick != nick))
+        irc_nick_free (server, channel, ptr_nick);
+
     /* remove nick from nicklist */
     irc_nick_nicklist_remove (server, channel, nick);
 
@@ -637,9 +860,11 @@ irc_nick_change (struct t_irc_server *server, struct t_irc_channel *channel,
         irc_channel_nick_speaking_rename (channel, nick->name, new_nick);
 
     /* change nickname */
+    irc_nick_hashtable_remove (server, channel, nick);
     if (nick->name)
         free (nick->name);
     nick->name = strdup (new_nick);
+    irc_nick_hashtable_add (server, channel, nick);
     if (nick->color)
         free (nick->color);
     if (nick_is_me)
@@ -763,6 +988,8 @@ irc_nick_free (struct t_irc_server *server, struct t_irc_channel *channel,
 
     channel->nicks_count--;
 
+    irc_nick_hashtable_remove (server, channel, nick);
+
     /* free data */
     if (nick->name)
         free (nick->name);
@@ -806,6 +1033,12 @@ irc_nick_free_all (struct t_irc_server *server, struct t_irc_channel *channel)
 
     /* should be zero, but prevent any bug :D */
     channel->nicks_count = 0;
+
+    if (channel->nicks_hashtable)
+    {
+        weechat_hashtable_free (channel->nicks_hashtable);
+        channel->nicks_hashtable = NULL;
+    }
 }
 
 /*
@@ -823,6 +1056,10 @@ irc_nick_search (struct t_irc_server *server, struct t_irc_channel *channel,
     if (!channel || !nickname)
         return NULL;
 
+    if (channel->nicks_hashtable)
+        return weechat_hashtable_get (channel->nicks_hashtable, nickname);
+
+    /* no hashtable (memory error): search in list of nicks */
     for (ptr_nick = channel->nicks; ptr_nick;
          ptr_nick = ptr_nick->next_nick)
     {
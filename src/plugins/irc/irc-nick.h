@@ -61,6 +61,11 @@ extern const char *irc_nick_get_prefix_color_name (struct t_irc_server *server,
                                                    char prefix);
 extern void irc_nick_nicklist_set_prefix_color_all ();
 extern void irc_nick_nicklist_set_color_all ();
+extern struct t_irc_channel **irc_nick_get_channels (struct t_irc_server *server,
+                                                     const char *nickname,
+                                                     int with_private);
+extern void irc_nick_hashtable_rebuild (struct t_irc_server *server,
+                                       struct t_irc_channel *channel);
 extern struct t_irc_nick *irc_nick_new (struct t_irc_server *server,
                                         struct t_irc_channel *channel,
                                         const char *nickname,
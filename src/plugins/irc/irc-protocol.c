@@ -329,11 +329,11 @@ irc_protocol_parse_time (const char *time)
 
 IRC_PROTOCOL_CALLBACK(account)
 {
-    struct t_irc_channel *ptr_channel;
+    struct t_irc_channel *ptr_channel, **ptr_channels;
     struct t_irc_nick *ptr_nick;
     struct t_irc_channel_speaking *ptr_nick_speaking;
     char *pos_account, str_account[512];
-    int cap_account_notify, local_account, smart_filter;
+    int i, cap_account_notify, local_account, smart_filter;
 
     IRC_PROTOCOL_MIN_ARGS(3);
 
@@ -355,9 +355,10 @@ IRC_PROTOCOL_CALLBACK(account)
     cap_account_notify = weechat_hashtable_has_key (server->cap_list,
                                                     "account-notify");
 
-    for (ptr_channel = server->channels; ptr_channel;
-         ptr_channel = ptr_channel->next_channel)
+    ptr_channels = irc_nick_get_channels (server, nick, 0);
+    for (i = 0; ptr_channels && ptr_channels[i]; i++)
     {
+        ptr_channel = ptr_channels[i];
         ptr_nick = irc_nick_search (server, ptr_channel, nick);
         if (ptr_nick)
         {
@@ -394,6 +395,9 @@ IRC_PROTOCOL_CALLBACK(account)
         }
     }
 
+    if (ptr_channels)
+        free (ptr_channels);
+
     return WEECHAT_RC_OK;
 }
 
@@ -482,19 +486,24 @@ IRC_PROTOCOL_CALLBACK(authenticate)
 
 IRC_PROTOCOL_CALLBACK(away)
 {
-    struct t_irc_channel *ptr_channel;
+    struct t_irc_channel *ptr_channel, **ptr_channels;
     struct t_irc_nick *ptr_nick;
+    int i;
 
     IRC_PROTOCOL_MIN_ARGS(2);
 
-    for (ptr_channel = server->channels; ptr_channel;
-         ptr_channel = ptr_channel->next_channel)
+    ptr_channels = irc_nick_get_channels (server, nick, 0);
+    for (i = 0; ptr_channels && ptr_channels[i]; i++)
     {
+        ptr_channel = ptr_channels[i];
         ptr_nick = irc_nick_search (server, ptr_channel, nick);
         if (ptr_nick)
             irc_nick_set_away (server, ptr_channel, ptr_nick, (argc > 2));
     }
 
+    if (ptr_channels)
+        free (ptr_channels);
+
     return WEECHAT_RC_OK;
 }
 
@@ -1019,9 +1028,9 @@ IRC_PROTOCOL_CALLBACK(cap)
 
 IRC_PROTOCOL_CALLBACK(chghost)
 {
-    int length, local_chghost, smart_filter;
+    int i, length, local_chghost, smart_filter;
     char *str_host, *pos_new_host;
-    struct t_irc_channel *ptr_channel;
+    struct t_irc_channel *ptr_channel, **ptr_channels;
     struct t_irc_nick *ptr_nick;
     struct t_irc_channel_speaking *ptr_nick_speaking;
 
@@ -1047,9 +1056,10 @@ IRC_PROTOCOL_CALLBACK(chghost)
     if (local_chghost)
         irc_server_set_host (server, str_host);
 
-    for (ptr_channel = server->channels; ptr_channel;
-         ptr_channel = ptr_channel->next_channel)
+    ptr_channels = irc_nick_get_channels (server, nick, 0);
+    for (i = 0; ptr_channels && ptr_channels[i]; i++)
     {
+        ptr_channel = ptr_channels[i];
         ptr_nick = irc_nick_search (server, ptr_channel, nick);
         if (ptr_nick)
         {
@@ -1087,6 +1097,9 @@ IRC_PROTOCOL_CALLBACK(chghost)
         }
     }
 
+    if (ptr_channels)
+        free (ptr_channels);
+
     free (str_host);
 
     return WEECHAT_RC_OK;
@@ -1723,11 +1736,11 @@ IRC_PROTOCOL_CALLBACK(mode)
 
 IRC_PROTOCOL_CALLBACK(nick)
 {
-    struct t_irc_channel *ptr_channel;
+    struct t_irc_channel *ptr_channel, **ptr_channels;
     struct t_irc_nick *ptr_nick, *ptr_nick_found;
     char *new_nick, *old_color, str_tags[512];
     const char *buffer_name;
-    int local_nick, smart_filter;
+    int i, local_nick, smart_filter;
     struct t_irc_channel_speaking *ptr_nick_speaking;
 
     IRC_PROTOCOL_MIN_ARGS(3);
@@ -1769,9 +1782,10 @@ IRC_PROTOCOL_CALLBACK(nick)
         weechat_buffer_set (NULL, "hotlist", "+");
     }
 
-    for (ptr_channel = server->channels; ptr_channel;
-         ptr_channel = ptr_channel->next_channel)
+    ptr_channels = irc_nick_get_channels (server, nick, 1);
+    for (i = 0; ptr_channels && ptr_channels[i]; i++)
     {
+        ptr_channel = ptr_channels[i];
         switch (ptr_channel->type)
         {
             case IRC_CHANNEL_TYPE_PRIVATE:
@@ -1779,8 +1793,7 @@ IRC_PROTOCOL_CALLBACK(nick)
                 if ((irc_server_strcasecmp (server, ptr_channel->name, nick) == 0)
                     && !irc_channel_search (server, new_nick))
                 {
-                    free (ptr_channel->name);
-                    ptr_channel->name = strdup (new_nick);
+                    irc_channel_rename (server, ptr_channel, new_nick);
                     if (ptr_channel->pv_remote_nick_color)
                     {
                         free (ptr_channel->pv_remote_nick_color);
@@ -1884,6 +1897,9 @@ IRC_PROTOCOL_CALLBACK(nick)
         }
     }
 
+    if (ptr_channels)
+        free (ptr_channels);
+
     if (!local_nick)
     {
         irc_channel_display_nick_back_in_pv (server, ptr_nick_found, new_nick);
@@ -2612,10 +2628,10 @@ IRC_PROTOCOL_CALLBACK(privmsg)
 IRC_PROTOCOL_CALLBACK(quit)
 {
     char *pos_comment;
-    struct t_irc_channel *ptr_channel;
+    struct t_irc_channel *ptr_channel, **ptr_channels;
     struct t_irc_nick *ptr_nick;
     struct t_irc_channel_speaking *ptr_nick_speaking;
-    int local_quit, display_host;
+    int i, local_quit, display_host;
 
     IRC_PROTOCOL_MIN_ARGS(2);
     IRC_PROTOCOL_CHECK_HOST;
@@ -2623,9 +2639,10 @@ IRC_PROTOCOL_CALLBACK(quit)
     pos_comment = (argc > 2) ?
         ((argv_eol[2][0] == ':') ? argv_eol[2] + 1 : argv_eol[2]) : NULL;
 
-    for (ptr_channel = server->channels; ptr_channel;
-         ptr_channel = ptr_channel->next_channel)
+    ptr_channels = irc_nick_get_channels (server, nick, 1);
+    for (i = 0; ptr_channels && ptr_channels[i]; i++)
     {
+        ptr_channel = ptr_channels[i];
         if (ptr_channel->type == IRC_CHANNEL_TYPE_PRIVATE)
             ptr_nick = NULL;
         else
@@ -2721,6 +2738,9 @@ IRC_PROTOCOL_CALLBACK(quit)
         }
     }
 
+    if (ptr_channels)
+        free (ptr_channels);
+
     return WEECHAT_RC_OK;
 }
 
@@ -3176,7 +3196,7 @@ IRC_PROTOCOL_CALLBACK(005)
             pos2[0] = '\0';
         casemapping = irc_server_search_casemapping (pos);
         if (casemapping >= 0)
-            server->casemapping = casemapping;
+            irc_server_set_casemapping (server, casemapping);
         if (pos2)
             pos2[0] = ' ';
     }
@@ -5008,6 +5028,10 @@ IRC_PROTOCOL_CALLBACK(353)
             str_nicks[0] = '\0';
     }
 
+    /* add nicks in bulk in nicklist (they are sorted after the loop) */
+    if (ptr_channel && ptr_channel->buffer)
+        weechat_buffer_set (ptr_channel->buffer, "nicklist_bulk_add", "1");
+
     for (i = args; i < argc; i++)
     {
         pos_nick = (argv[i][0] == ':') ? argv[i] + 1 : argv[i];
@@ -5084,6 +5108,9 @@ IRC_PROTOCOL_CALLBACK(353)
             free (prefixes);
     }
 
+    if (ptr_channel && ptr_channel->buffer)
+        weechat_buffer_set (ptr_channel->buffer, "nicklist_bulk_add", "0");
+
     if (!ptr_channel)
     {
         weechat_printf_date_tags (
@@ -6411,6 +6438,258 @@ IRC_PROTOCOL_CALLBACK(sasl_end_fail)
     return WEECHAT_RC_OK;
 }
 
+/*
+ * IRC messages with callbacks.
+ *
+ * The table must be sorted: first commands (alphabetical order, lower case),
+ * then numeric commands (ascending order).
+ */
+
+struct t_irc_protocol_msg irc_protocol_messages[] =
+{ { "account", /* account (cap account-notify) */ 1, 0, &irc_protocol_cb_account },
+  { "authenticate", /* authenticate */ 1, 0, &irc_protocol_cb_authenticate },
+  { "away", /* away (cap away-notify) */ 1, 0, &irc_protocol_cb_away },
+  { "cap", /* client capability */ 1, 0, &irc_protocol_cb_cap },
+  { "chghost", /* user/host change (cap chghost) */ 1, 0, &irc_protocol_cb_chghost },
+  { "error", /* error received from IRC server */ 1, 0, &irc_protocol_cb_error },
+  { "invite", /* invite a nick on a channel */ 1, 0, &irc_protocol_cb_invite },
+  { "join", /* join a channel */ 1, 0, &irc_protocol_cb_join },
+  { "kick", /* forcibly remove a user from a channel */ 1, 1, &irc_protocol_cb_kick },
+  { "kill", /* close client-server connection */ 1, 1, &irc_protocol_cb_kill },
+  { "mode", /* change channel or user mode */ 1, 0, &irc_protocol_cb_mode },
+  { "nick", /* change current nickname */ 1, 0, &irc_protocol_cb_nick },
+  { "notice", /* send notice message to user */ 1, 1, &irc_protocol_cb_notice },
+  { "part", /* leave a channel */ 1, 1, &irc_protocol_cb_part },
+  { "ping", /* ping server */ 1, 0, &irc_protocol_cb_ping },
+  { "pong", /* answer to a ping message */ 1, 0, &irc_protocol_cb_pong },
+  { "privmsg", /* message received */ 1, 1, &irc_protocol_cb_privmsg },
+  { "quit", /* close all connections and quit */ 1, 1, &irc_protocol_cb_quit },
+  { "topic", /* get/set channel topic */ 0, 1, &irc_protocol_cb_topic },
+  { "wallops", /* send a message to all currently connected users who have "
+                  "set the 'w' user mode "
+                  "for themselves */ 1, 1, &irc_protocol_cb_wallops },
+  { "001", /* a server message */ 1, 0, &irc_protocol_cb_001 },
+  { "005", /* a server message */ 1, 0, &irc_protocol_cb_005 },
+  { "008", /* server notice mask */ 1, 0, &irc_protocol_cb_008 },
+  { "221", /* user mode string */ 1, 0, &irc_protocol_cb_221 },
+  { "223", /* whois (charset is) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
+  { "264", /* whois (is using encrypted connection) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
+  { "275", /* whois (secure connection) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
+  { "276", /* whois (has client certificate fingerprint) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
+  { "301", /* away message */ 1, 1, &irc_protocol_cb_301 },
+  { "303", /* ison */ 1, 0, &irc_protocol_cb_303 },
+  { "305", /* unaway */ 1, 0, &irc_protocol_cb_305 },
+  { "306", /* now away */ 1, 0, &irc_protocol_cb_306 },
+  { "307", /* whois (registered nick) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
+  { "310", /* whois (help mode) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
+  { "311", /* whois (user) */ 1, 0, &irc_protocol_cb_311 },
+  { "312", /* whois (server) */ 1, 0, &irc_protocol_cb_312 },
+  { "313", /* whois (operator) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
+  { "314", /* whowas */ 1, 0, &irc_protocol_cb_314 },
+  { "315", /* end of /who list */ 1, 0, &irc_protocol_cb_315 },
+  { "317", /* whois (idle) */ 1, 0, &irc_protocol_cb_317 },
+  { "318", /* whois (end) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
+  { "319", /* whois (channels) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
+  { "320", /* whois (identified user) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
+  { "321", /* /list start */ 1, 0, &irc_protocol_cb_321 },
+  { "322", /* channel (for /list) */ 1, 0, &irc_protocol_cb_322 },
+  { "323", /* end of /list */ 1, 0, &irc_protocol_cb_323 },
+  { "324", /* channel mode */ 1, 0, &irc_protocol_cb_324 },
+  { "326", /* whois (has oper privs) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
+  { "327", /* whois (host) */ 1, 0, &irc_protocol_cb_327 },
+  { "328", /* channel url */ 1, 0, &irc_protocol_cb_328 },
+  { "329", /* channel creation date */ 1, 0, &irc_protocol_cb_329 },
+  { "330", /* is logged in as */ 1, 0, &irc_protocol_cb_330_343 },
+  { "331", /* no topic for channel */ 1, 0, &irc_protocol_cb_331 },
+  { "332", /* topic of channel */ 0, 1, &irc_protocol_cb_332 },
+  { "333", /* infos about topic (nick and date changed) */ 1, 0, &irc_protocol_cb_333 },
+  { "335", /* is a bot on */ 1, 0, &irc_protocol_cb_whois_nick_msg },
+  { "338", /* whois (host) */ 1, 0, &irc_protocol_cb_338 },
+  { "341", /* inviting */ 1, 0, &irc_protocol_cb_341 },
+  { "343", /* is opered as */ 1, 0, &irc_protocol_cb_330_343 },
+  { "344", /* channel reop */ 1, 0, &irc_protocol_cb_344 },
+  { "345", /* end of channel reop list */ 1, 0, &irc_protocol_cb_345 },
+  { "346", /* invite list */ 1, 0, &irc_protocol_cb_346 },
+  { "347", /* end of invite list */ 1, 0, &irc_protocol_cb_347 },
+  { "348", /* channel exception list */ 1, 0, &irc_protocol_cb_348 },
+  { "349", /* end of channel exception list */ 1, 0, &irc_protocol_cb_349 },
+  { "351", /* server version */ 1, 0, &irc_protocol_cb_351 },
+  { "352", /* who */ 1, 0, &irc_protocol_cb_352 },
+  { "353", /* list of nicks on channel */ 1, 0, &irc_protocol_cb_353 },
+  { "354", /* whox */ 1, 0, &irc_protocol_cb_354 },
+  { "366", /* end of /names list */ 1, 0, &irc_protocol_cb_366 },
+  { "367", /* banlist */ 1, 0, &irc_protocol_cb_367 },
+  { "368", /* end of banlist */ 1, 0, &irc_protocol_cb_368 },
+  { "369", /* whowas (end) */ 1, 0, &irc_protocol_cb_whowas_nick_msg },
+  { "378", /* whois (connecting from) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
+  { "379", /* whois (using modes) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
+  { "401", /* no such nick/channel */ 1, 0, &irc_protocol_cb_generic_error },
+  { "402", /* no such server */ 1, 0, &irc_protocol_cb_generic_error },
+  { "403", /* no such channel */ 1, 0, &irc_protocol_cb_generic_error },
+  { "404", /* cannot send to channel */ 1, 0, &irc_protocol_cb_generic_error },
+  { "405", /* too many channels */ 1, 0, &irc_protocol_cb_generic_error },
+  { "406", /* was no such nick */ 1, 0, &irc_protocol_cb_generic_error },
+  { "407", /* was no such nick */ 1, 0, &irc_protocol_cb_generic_error },
+  { "409", /* no origin */ 1, 0, &irc_protocol_cb_generic_error },
+  { "410", /* no services */ 1, 0, &irc_protocol_cb_generic_error },
+  { "411", /* no recipient */ 1, 0, &irc_protocol_cb_generic_error },
+  { "412", /* no text to send */ 1, 0, &irc_protocol_cb_generic_error },
+  { "413", /* no toplevel */ 1, 0, &irc_protocol_cb_generic_error },
+  { "414", /* wilcard in toplevel domain */ 1, 0, &irc_protocol_cb_generic_error },
+  { "421", /* unknown command */ 1, 0, &irc_protocol_cb_generic_error },
+  { "422", /* MOTD is missing */ 1, 0, &irc_protocol_cb_generic_error },
+  { "423", /* no administrative info */ 1, 0, &irc_protocol_cb_generic_error },
+  { "424", /* file error */ 1, 0, &irc_protocol_cb_generic_error },
+  { "431", /* no nickname given */ 1, 0, &irc_protocol_cb_generic_error },
+  { "432", /* erroneous nickname */ 1, 0, &irc_protocol_cb_432 },
+  { "433", /* nickname already in use */ 1, 0, &irc_protocol_cb_433 },
+  { "436", /* nickname collision */ 1, 0, &irc_protocol_cb_generic_error },
+  { "437", /* nick/channel unavailable */ 1, 0, &irc_protocol_cb_437 },
+  { "438", /* not authorized to change nickname */ 1, 0, &irc_protocol_cb_438 },
+  { "441", /* user not in channel */ 1, 0, &irc_protocol_cb_generic_error },
+  { "442", /* not on channel */ 1, 0, &irc_protocol_cb_generic_error },
+  { "443", /* user already on channel */ 1, 0, &irc_protocol_cb_generic_error },
+  { "444", /* user not logged in */ 1, 0, &irc_protocol_cb_generic_error },
+  { "445", /* summon has been disabled */ 1, 0, &irc_protocol_cb_generic_error },
+  { "446", /* users has been disabled */ 1, 0, &irc_protocol_cb_generic_error },
+  { "451", /* you are not registered */ 1, 0, &irc_protocol_cb_generic_error },
+  { "461", /* not enough parameters */ 1, 0, &irc_protocol_cb_generic_error },
+  { "462", /* you may not register */ 1, 0, &irc_protocol_cb_generic_error },
+  { "463", /* your host isn't among the privileged */ 1, 0, &irc_protocol_cb_generic_error },
+  { "464", /* password incorrect */ 1, 0, &irc_protocol_cb_generic_error },
+  { "465", /* you are banned from this server */ 1, 0, &irc_protocol_cb_generic_error },
+  { "467", /* channel key already set */ 1, 0, &irc_protocol_cb_generic_error },
+  { "470", /* forwarding to another channel */ 1, 0, &irc_protocol_cb_470 },
+  { "471", /* channel is already full */ 1, 0, &irc_protocol_cb_generic_error },
+  { "472", /* unknown mode char to me */ 1, 0, &irc_protocol_cb_generic_error },
+  { "473", /* cannot join channel (invite only) */ 1, 0, &irc_protocol_cb_generic_error },
+  { "474", /* cannot join channel (banned from channel) */ 1, 0, &irc_protocol_cb_generic_error },
+  { "475", /* cannot join channel (bad channel key) */ 1, 0, &irc_protocol_cb_generic_error },
+  { "476", /* bad channel mask */ 1, 0, &irc_protocol_cb_generic_error },
+  { "477", /* channel doesn't support modes */ 1, 0, &irc_protocol_cb_generic_error },
+  { "481", /* you're not an IRC operator */ 1, 0, &irc_protocol_cb_generic_error },
+  { "482", /* you're not channel operator */ 1, 0, &irc_protocol_cb_generic_error },
+  { "483", /* you can't kill a server! */ 1, 0, &irc_protocol_cb_generic_error },
+  { "484", /* your connection is restricted! */ 1, 0, &irc_protocol_cb_generic_error },
+  { "485", /* user is immune from kick/deop */ 1, 0, &irc_protocol_cb_generic_error },
+  { "487", /* network split */ 1, 0, &irc_protocol_cb_generic_error },
+  { "491", /* no O-lines for your host */ 1, 0, &irc_protocol_cb_generic_error },
+  { "501", /* unknown mode flag */ 1, 0, &irc_protocol_cb_generic_error },
+  { "502", /* can't change mode for other users */ 1, 0, &irc_protocol_cb_generic_error },
+  { "671", /* whois (secure connection) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
+  { "728", /* quietlist */ 1, 0, &irc_protocol_cb_728 },
+  { "729", /* end of quietlist */ 1, 0, &irc_protocol_cb_729 },
+  { "730", /* monitored nicks online */ 1, 0, &irc_protocol_cb_730 },
+  { "731", /* monitored nicks offline */ 1, 0, &irc_protocol_cb_731 },
+  { "732", /* list of monitored nicks */ 1, 0, &irc_protocol_cb_732 },
+  { "733", /* end of monitor list */ 1, 0, &irc_protocol_cb_733 },
+  { "734", /* monitor list is full */ 1, 0, &irc_protocol_cb_734 },
+  { "900", /* logged in as (SASL) */ 1, 0, &irc_protocol_cb_900 },
+  { "901", /* you are now logged in */ 1, 0, &irc_protocol_cb_901 },
+  { "902", /* SASL authentication failed (account locked/held) */ 1, 0, &irc_protocol_cb_sasl_end_fail },
+  { "903", /* SASL authentication successful */ 1, 0, &irc_protocol_cb_sasl_end_ok },
+  { "904", /* SASL authentication failed */ 1, 0, &irc_protocol_cb_sasl_end_fail },
+  { "905", /* SASL message too long */ 1, 0, &irc_protocol_cb_sasl_end_fail },
+  { "906", /* SASL authentication aborted */ 1, 0, &irc_protocol_cb_sasl_end_fail },
+  { "907", /* You have already completed SASL authentication */ 1, 0, &irc_protocol_cb_sasl_end_ok },
+  { "936", /* censored word */ 1, 0, &irc_protocol_cb_generic_error },
+  { "973", /* whois (secure connection) */ 1, 0, &irc_protocol_cb_server_mode_reason },
+  { "974", /* whois (secure connection) */ 1, 0, &irc_protocol_cb_server_mode_reason },
+  { "975", /* whois (secure connection) */ 1, 0, &irc_protocol_cb_server_mode_reason },
+  { NULL, 0, 0, NULL }
+};
+
+/* index of numeric commands "000" to "999" in table irc_protocol_messages */
+int irc_protocol_messages_numeric[1000];
+/* number of non-numeric commands in table, -1 if index is not built */
+int irc_protocol_messages_count_commands = -1;
+
+
+/*
+ * Builds the index of commands in table "irc_protocol_messages".
+ */
+
+void
+irc_protocol_messages_build_index ()
+{
+    int i, number;
+
+    for (i = 0; i < 1000; i++)
+    {
+        irc_protocol_messages_numeric[i] = -1;
+    }
+
+    irc_protocol_messages_count_commands = 0;
+    for (i = 0; irc_protocol_messages[i].name; i++)
+    {
+        if (irc_protocol_is_numeric_command (irc_protocol_messages[i].name))
+        {
+            number = atoi (irc_protocol_messages[i].name);
+            if ((number >= 0) && (number < 1000)
+                && (strlen (irc_protocol_messages[i].name) == 3))
+            {
+                irc_protocol_messages_numeric[number] = i;
+            }
+        }
+        else
+        {
+            irc_protocol_messages_count_commands = i + 1;
+        }
+    }
+}
+
+/*
+ * Searches for an IRC message in table "irc_protocol_messages".
+ *
+ * Numeric commands (3 digits) are found with a direct index, other commands
+ * with a binary search (case insensitive).
+ *
+ * Returns pointer to message found, NULL if not found.
+ */
+
+struct t_irc_protocol_msg *
+irc_protocol_search_message (const char *command)
+{
+    int start, end, middle, rc;
+
+    if (!command || !command[0])
+        return NULL;
+
+    if (irc_protocol_messages_count_commands < 0)
+        irc_protocol_messages_build_index ();
+
+    if (isdigit ((unsigned char)command[0]))
+    {
+        if (isdigit ((unsigned char)command[1])
+            && isdigit ((unsigned char)command[2])
+            && !command[3])
+        {
+            middle = irc_protocol_messages_numeric[
+                ((command[0] - '0') * 100)
+                + ((command[1] - '0') * 10)
+                + (command[2] - '0')];
+            return (middle >= 0) ? &irc_protocol_messages[middle] : NULL;
+        }
+        return NULL;
+    }
+
+    start = 0;
+    end = irc_protocol_messages_count_commands - 1;
+    while (start <= end)
+    {
+        middle = (start + end) / 2;
+        rc = weechat_strcasecmp (command, irc_protocol_messages[middle].name);
+        if (rc == 0)
+            return &irc_protocol_messages[middle];
+        if (rc < 0)
+            end = middle - 1;
+        else
+            start = middle + 1;
+    }
+
+    return NULL;
+}
+
 /*
  * Executes action when an IRC message is received.
  *
@@ -6423,7 +6702,7 @@ irc_protocol_recv_command (struct t_irc_server *server,
                            const char *msg_command,
                            const char *msg_channel)
 {
-    int i, cmd_found, return_code, argc, decode_color, keep_trailing_spaces;
+    int return_code, argc, decode_color, keep_trailing_spaces;
     int message_ignored, flags;
     char *message_colors_decoded, *pos_space, *tags;
     struct t_irc_channel *ptr_channel;
@@ -6434,159 +6713,7 @@ irc_protocol_recv_command (struct t_irc_server *server,
     char *nick, *address, *address_color, *host, *host_no_color, *host_color;
     char **argv, **argv_eol;
     struct t_hashtable *hash_tags;
-    struct t_irc_protocol_msg irc_protocol_messages[] =
-        { { "account", /* account (cap account-notify) */ 1, 0, &irc_protocol_cb_account },
-          { "authenticate", /* authenticate */ 1, 0, &irc_protocol_cb_authenticate },
-          { "away", /* away (cap away-notify) */ 1, 0, &irc_protocol_cb_away },
-          { "cap", /* client capability */ 1, 0, &irc_protocol_cb_cap },
-          { "chghost", /* user/host change (cap chghost) */ 1, 0, &irc_protocol_cb_chghost },
-          { "error", /* error received from IRC server */ 1, 0, &irc_protocol_cb_error },
-          { "invite", /* invite a nick on a channel */ 1, 0, &irc_protocol_cb_invite },
-          { "join", /* join a channel */ 1, 0, &irc_protocol_cb_join },
-          { "kick", /* forcibly remove a user from a channel */ 1, 1, &irc_protocol_cb_kick },
-          { "kill", /* close client-server connection */ 1, 1, &irc_protocol_cb_kill },
-          { "mode", /* change channel or user mode */ 1, 0, &irc_protocol_cb_mode },
-          { "nick", /* change current nickname */ 1, 0, &irc_protocol_cb_nick },
-          { "notice", /* send notice message to user */ 1, 1, &irc_protocol_cb_notice },
-          { "part", /* leave a channel */ 1, 1, &irc_protocol_cb_part },
-          { "ping", /* ping server */ 1, 0, &irc_protocol_cb_ping },
-          { "pong", /* answer to a ping message */ 1, 0, &irc_protocol_cb_pong },
-          { "privmsg", /* message received */ 1, 1, &irc_protocol_cb_privmsg },
-          { "quit", /* close all connections and quit */ 1, 1, &irc_protocol_cb_quit },
-          { "topic", /* get/set channel topic */ 0, 1, &irc_protocol_cb_topic },
-          { "wallops", /* send a message to all currently connected users who have "
-                          "set the 'w' user mode "
-                          "for themselves */ 1, 1, &irc_protocol_cb_wallops },
-          { "001", /* a server message */ 1, 0, &irc_protocol_cb_001 },
-          { "005", /* a server message */ 1, 0, &irc_protocol_cb_005 },
-          { "008", /* server notice mask */ 1, 0, &irc_protocol_cb_008 },
-          { "221", /* user mode string */ 1, 0, &irc_protocol_cb_221 },
-          { "223", /* whois (charset is) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
-          { "264", /* whois (is using encrypted connection) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
-          { "275", /* whois (secure connection) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
-          { "276", /* whois (has client certificate fingerprint) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
-          { "301", /* away message */ 1, 1, &irc_protocol_cb_301 },
-          { "303", /* ison */ 1, 0, &irc_protocol_cb_303 },
-          { "305", /* unaway */ 1, 0, &irc_protocol_cb_305 },
-          { "306", /* now away */ 1, 0, &irc_protocol_cb_306 },
-          { "307", /* whois (registered nick) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
-          { "310", /* whois (help mode) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
-          { "311", /* whois (user) */ 1, 0, &irc_protocol_cb_311 },
-          { "312", /* whois (server) */ 1, 0, &irc_protocol_cb_312 },
-          { "313", /* whois (operator) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
-          { "314", /* whowas */ 1, 0, &irc_protocol_cb_314 },
-          { "315", /* end of /who list */ 1, 0, &irc_protocol_cb_315 },
-          { "317", /* whois (idle) */ 1, 0, &irc_protocol_cb_317 },
-          { "318", /* whois (end) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
-          { "319", /* whois (channels) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
-          { "320", /* whois (identified user) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
-          { "321", /* /list start */ 1, 0, &irc_protocol_cb_321 },
-          { "322", /* channel (for /list) */ 1, 0, &irc_protocol_cb_322 },
-          { "323", /* end of /list */ 1, 0, &irc_protocol_cb_323 },
-          { "324", /* channel mode */ 1, 0, &irc_protocol_cb_324 },
-          { "326", /* whois (has oper privs) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
-          { "327", /* whois (host) */ 1, 0, &irc_protocol_cb_327 },
-          { "328", /* channel url */ 1, 0, &irc_protocol_cb_328 },
-          { "329", /* channel creation date */ 1, 0, &irc_protocol_cb_329 },
-          { "330", /* is logged in as */ 1, 0, &irc_protocol_cb_330_343 },
-          { "331", /* no topic for channel */ 1, 0, &irc_protocol_cb_331 },
-          { "332", /* topic of channel */ 0, 1, &irc_protocol_cb_332 },
-          { "333", /* infos about topic (nick and date changed) */ 1, 0, &irc_protocol_cb_333 },
-          { "335", /* is a bot on */ 1, 0, &irc_protocol_cb_whois_nick_msg },
-          { "338", /* whois (host) */ 1, 0, &irc_protocol_cb_338 },
-          { "341", /* inviting */ 1, 0, &irc_protocol_cb_341 },
-          { "343", /* is opered as */ 1, 0, &irc_protocol_cb_330_343 },
-          { "344", /* channel reop */ 1, 0, &irc_protocol_cb_344 },
-          { "345", /* end of channel reop list */ 1, 0, &irc_protocol_cb_345 },
-          { "346", /* invite list */ 1, 0, &irc_protocol_cb_346 },
-          { "347", /* end of invite list */ 1, 0, &irc_protocol_cb_347 },
-          { "348", /* channel exception list */ 1, 0, &irc_protocol_cb_348 },
-          { "349", /* end of channel exception list */ 1, 0, &irc_protocol_cb_349 },
-          { "351", /* server version */ 1, 0, &irc_protocol_cb_351 },
-          { "352", /* who */ 1, 0, &irc_protocol_cb_352 },
-          { "353", /* list of nicks on channel */ 1, 0, &irc_protocol_cb_353 },
-          { "354", /* whox */ 1, 0, &irc_protocol_cb_354 },
-          { "366", /* end of /names list */ 1, 0, &irc_protocol_cb_366 },
-          { "367", /* banlist */ 1, 0, &irc_protocol_cb_367 },
-          { "368", /* end of banlist */ 1, 0, &irc_protocol_cb_368 },
-          { "369", /* whowas (end) */ 1, 0, &irc_protocol_cb_whowas_nick_msg },
-          { "378", /* whois (connecting from) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
-          { "379", /* whois (using modes) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
-          { "401", /* no such nick/channel */ 1, 0, &irc_protocol_cb_generic_error },
-          { "402", /* no such server */ 1, 0, &irc_protocol_cb_generic_error },
-          { "403", /* no such channel */ 1, 0, &irc_protocol_cb_generic_error },
-          { "404", /* cannot send to channel */ 1, 0, &irc_protocol_cb_generic_error },
-          { "405", /* too many channels */ 1, 0, &irc_protocol_cb_generic_error },
-          { "406", /* was no such nick */ 1, 0, &irc_protocol_cb_generic_error },
-          { "407", /* was no such nick */ 1, 0, &irc_protocol_cb_generic_error },
-          { "409", /* no origin */ 1, 0, &irc_protocol_cb_generic_error },
-          { "410", /* no services */ 1, 0, &irc_protocol_cb_generic_error },
-          { "411", /* no recipient */ 1, 0, &irc_protocol_cb_generic_error },
-          { "412", /* no text to send */ 1, 0, &irc_protocol_cb_generic_error },
-          { "413", /* no toplevel */ 1, 0, &irc_protocol_cb_generic_error },
-          { "414", /* wilcard in toplevel domain */ 1, 0, &irc_protocol_cb_generic_error },
-          { "421", /* unknown command */ 1, 0, &irc_protocol_cb_generic_error },
-          { "422", /* MOTD is missing */ 1, 0, &irc_protocol_cb_generic_error },
-          { "423", /* no administrative info */ 1, 0, &irc_protocol_cb_generic_error },
-          { "424", /* file error */ 1, 0, &irc_protocol_cb_generic_error },
-          { "431", /* no nickname given */ 1, 0, &irc_protocol_cb_generic_error },
-          { "432", /* erroneous nickname */ 1, 0, &irc_protocol_cb_432 },
-          { "433", /* nickname already in use */ 1, 0, &irc_protocol_cb_433 },
-          { "436", /* nickname collision */ 1, 0, &irc_protocol_cb_generic_error },
-          { "437", /* nick/channel unavailable */ 1, 0, &irc_protocol_cb_437 },
-          { "438", /* not authorized to change nickname */ 1, 0, &irc_protocol_cb_438 },
-          { "441", /* user not in channel */ 1, 0, &irc_protocol_cb_generic_error },
-          { "442", /* not on channel */ 1, 0, &irc_protocol_cb_generic_error },
-          { "443", /* user already on channel */ 1, 0, &irc_protocol_cb_generic_error },
-          { "444", /* user not logged in */ 1, 0, &irc_protocol_cb_generic_error },
-          { "445", /* summon has been disabled */ 1, 0, &irc_protocol_cb_generic_error },
-          { "446", /* users has been disabled */ 1, 0, &irc_protocol_cb_generic_error },
-          { "451", /* you are not registered */ 1, 0, &irc_protocol_cb_generic_error },
-          { "461", /* not enough parameters */ 1, 0, &irc_protocol_cb_generic_error },
-          { "462", /* you may not register */ 1, 0, &irc_protocol_cb_generic_error },
-          { "463", /* your host isn't among the privileged */ 1, 0, &irc_protocol_cb_generic_error },
-          { "464", /* password incorrect */ 1, 0, &irc_protocol_cb_generic_error },
-          { "465", /* you are banned from this server */ 1, 0, &irc_protocol_cb_generic_error },
-          { "467", /* channel key already set */ 1, 0, &irc_protocol_cb_generic_error },
-          { "470", /* forwarding to another channel */ 1, 0, &irc_protocol_cb_470 },
-          { "471", /* channel is already full */ 1, 0, &irc_protocol_cb_generic_error },
-          { "472", /* unknown mode char to me */ 1, 0, &irc_protocol_cb_generic_error },
-          { "473", /* cannot join channel (invite only) */ 1, 0, &irc_protocol_cb_generic_error },
-          { "474", /* cannot join channel (banned from channel) */ 1, 0, &irc_protocol_cb_generic_error },
-          { "475", /* cannot join channel (bad channel key) */ 1, 0, &irc_protocol_cb_generic_error },
-          { "476", /* bad channel mask */ 1, 0, &irc_protocol_cb_generic_error },
-          { "477", /* channel doesn't support modes */ 1, 0, &irc_protocol_cb_generic_error },
-          { "481", /* you're not an IRC operator */ 1, 0, &irc_protocol_cb_generic_error },
-          { "482", /* you're not channel operator */ 1, 0, &irc_protocol_cb_generic_error },
-          { "483", /* you can't kill a server! */ 1, 0, &irc_protocol_cb_generic_error },
-          { "484", /* your connection is restricted! */ 1, 0, &irc_protocol_cb_generic_error },
-          { "485", /* user is immune from kick/deop */ 1, 0, &irc_protocol_cb_generic_error },
-          { "487", /* network split */ 1, 0, &irc_protocol_cb_generic_error },
-          { "491", /* no O-lines for your host */ 1, 0, &irc_protocol_cb_generic_error },
-          { "501", /* unknown mode flag */ 1, 0, &irc_protocol_cb_generic_error },
-          { "502", /* can't change mode for other users */ 1, 0, &irc_protocol_cb_generic_error },
-          { "671", /* whois (secure connection) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
-          { "728", /* quietlist */ 1, 0, &irc_protocol_cb_728 },
-          { "729", /* end of quietlist */ 1, 0, &irc_protocol_cb_729 },
-          { "730", /* monitored nicks online */ 1, 0, &irc_protocol_cb_730 },
-          { "731", /* monitored nicks offline */ 1, 0, &irc_protocol_cb_731 },
-          { "732", /* list of monitored nicks */ 1, 0, &irc_protocol_cb_732 },
-          { "733", /* end of monitor list */ 1, 0, &irc_protocol_cb_733 },
-          { "734", /* monitor list is full */ 1, 0, &irc_protocol_cb_734 },
-          { "900", /* logged in as (SASL) */ 1, 0, &irc_protocol_cb_900 },
-          { "901", /* you are now logged in */ 1, 0, &irc_protocol_cb_901 },
-          { "902", /* SASL authentication failed (account locked/held) */ 1, 0, &irc_protocol_cb_sasl_end_fail },
-          { "903", /* SASL authentication successful */ 1, 0, &irc_protocol_cb_sasl_end_ok },
-          { "904", /* SASL authentication failed */ 1, 0, &irc_protocol_cb_sasl_end_fail },
-          { "905", /* SASL message too long */ 1, 0, &irc_protocol_cb_sasl_end_fail },
-          { "906", /* SASL authentication aborted */ 1, 0, &irc_protocol_cb_sasl_end_fail },
-          { "907", /* You have already completed SASL authentication */ 1, 0, &irc_protocol_cb_sasl_end_ok },
-          { "936", /* censored word */ 1, 0, &irc_protocol_cb_generic_error },
-          { "973", /* whois (secure connection) */ 1, 0, &irc_protocol_cb_server_mode_reason },
-          { "974", /* whois (secure connection) */ 1, 0, &irc_protocol_cb_server_mode_reason },
-          { "975", /* whois (secure connection) */ 1, 0, &irc_protocol_cb_server_mode_reason },
-          { NULL, 0, 0, NULL }
-        };
+    struct t_irc_protocol_msg *ptr_msg;
 
     if (!msg_command)
         return;
@@ -6679,19 +6806,10 @@ irc_protocol_recv_command (struct t_irc_server *server,
     }
 
     /* look for IRC command */
-    cmd_found = -1;
-    for (i = 0; irc_protocol_messages[i].name; i++)
-    {
-        if (weechat_strcasecmp (irc_protocol_messages[i].name,
-                                msg_command) == 0)
-        {
-            cmd_found = i;
-            break;
-        }
-    }
+    ptr_msg = irc_protocol_search_message (msg_command);
 
     /* command not found */
-    if (cmd_found < 0)
+    if (!ptr_msg)
     {
         /* for numeric commands, we use default recv function */
         if (irc_protocol_is_numeric_command (msg_command))
@@ -6715,10 +6833,10 @@ irc_protocol_recv_command (struct t_irc_server *server,
     }
     else
     {
-        cmd_name = irc_protocol_messages[cmd_found].name;
-        decode_color = irc_protocol_messages[cmd_found].decode_color;
-        keep_trailing_spaces = irc_protocol_messages[cmd_found].keep_trailing_spaces;
-        cmd_recv_func = irc_protocol_messages[cmd_found].recv_function;
+        cmd_name = ptr_msg->name;
+        decode_color = ptr_msg->decode_color;
+        keep_trailing_spaces = ptr_msg->keep_trailing_spaces;
+        cmd_recv_func = ptr_msg->recv_function;
     }
 
     if (cmd_recv_func != NULL)
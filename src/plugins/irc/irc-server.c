@@ -361,6 +361,189 @@ irc_server_strncasecmp (struct t_irc_server *server,
     return rc;
 }
 
+/*
+ * Hashes a string, with a range of chars converted from upper to lower case
+ * (same conversion as function weechat_strcasecmp_range), so that two
+ * strings which are equal for a casemapping have the same hash.
+ *
+ * Returns the hash of the string (variant of djb2).
+ */
+
+unsigned long long
+irc_server_hash_key_range (const char *string, int range)
+{
+    unsigned long long hash;
+    unsigned char c;
+
+    hash = 5381;
+    while (string[0])
+    {
+        c = (unsigned char)string[0];
+        if ((c >= 'A') && (c < 'A' + range))
+            c += ('a' - 'A');
+        hash ^= (hash << 5) + (hash >> 2) + c;
+        string++;
+    }
+
+    return hash;
+}
+
+/*
+ * Callbacks to hash and compare keys of hashtables indexed with a string,
+ * for each casemapping (the keys are pointers to strings, which are not
+ * duplicated in the hashtable).
+ */
+
+unsigned long long
+irc_server_hash_key_rfc1459_cb (struct t_hashtable *hashtable,
+                                const void *key)
+{
+    /* make C compiler happy */
+    (void) hashtable;
+
+    return irc_server_hash_key_range ((const char *)key, 30);
+}
+
+int
+irc_server_keycmp_rfc1459_cb (struct t_hashtable *hashtable,
+                              const void *key1, const void *key2)
+{
+    /* make C compiler happy */
+    (void) hashtable;
+
+    return weechat_strcasecmp_range ((const char *)key1,
+                                     (const char *)key2, 30);
+}
+
+unsigned long long
+irc_server_hash_key_strict_rfc1459_cb (struct t_hashtable *hashtable,
+                                       const void *key)
+{
+    /* make C compiler happy */
+    (void) hashtable;
+
+    return irc_server_hash_key_range ((const char *)key, 29);
+}
+
+int
+irc_server_keycmp_strict_rfc1459_cb (struct t_hashtable *hashtable,
+                                     const void *key1, const void *key2)
+{
+    /* make C compiler happy */
+    (void) hashtable;
+
+    return weechat_strcasecmp_range ((const char *)key1,
+                                     (const char *)key2, 29);
+}
+
+unsigned long long
+irc_server_hash_key_ascii_cb (struct t_hashtable *hashtable, const void *key)
+{
+    /* make C compiler happy */
+    (void) hashtable;
+
+    return irc_server_hash_key_range ((const char *)key, 26);
+}
+
+int
+irc_server_keycmp_ascii_cb (struct t_hashtable *hashtable,
+                            const void *key1, const void *key2)
+{
+    /* make C compiler happy */
+    (void) hashtable;
+
+    return weechat_strcasecmp ((const char *)key1, (const char *)key2);
+}
+
+/*
+ * Creates a hashtable to index objects by name on server (nicks, channels):
+ * keys are strings compared with the casemapping of server.
+ *
+ * The type of keys is "string" (keys are duplicated in the hashtable) or
+ * "pointer" (key is a pointer to a string, which must remain valid while it
+ * is in the hashtable).
+ *
+ * The hashtable must be rebuilt if the casemapping of server changes.
+ *
+ * Returns pointer to new hashtable, NULL if error.
+ */
+
+struct t_hashtable *
+irc_server_hashtable_new_casemapping (struct t_irc_server *server, int size,
+                                      const char *type_keys,
+                                      const char *type_values)
+{
+    int casemapping;
+
+    casemapping = (server) ? server->casemapping : IRC_SERVER_CASEMAPPING_RFC1459;
+    switch (casemapping)
+    {
+        case IRC_SERVER_CASEMAPPING_STRICT_RFC1459:
+            return weechat_hashtable_new (
+                size,
+                type_keys,
+                type_values,
+                &irc_server_hash_key_strict_rfc1459_cb,
+                &irc_server_keycmp_strict_rfc1459_cb);
+        case IRC_SERVER_CASEMAPPING_ASCII:
+            return weechat_hashtable_new (
+                size,
+                type_keys,
+                type_values,
+                &irc_server_hash_key_ascii_cb,
+                &irc_server_keycmp_ascii_cb);
+        default:
+            break;
+    }
+
+    return weechat_hashtable_new (
+        size,
+        type_keys,
+        type_values,
+        &irc_server_hash_key_rfc1459_cb,
+        &irc_server_keycmp_rfc1459_cb);
+}
+
+/*
+ * Sets casemapping of server.
+ *
+ * If casemapping is changed, the hashtables indexing channels and nicks are
+ * rebuilt.
+ */
+
+void
+irc_server_set_casemapping (struct t_irc_server *server, int casemapping)
+{
+    struct t_irc_channel *ptr_channel;
+
+    if (!server || (casemapping < 0)
+        || (casemapping >= IRC_SERVER_NUM_CASEMAPPING)
+        || (casemapping == server->casemapping))
+    {
+        return;
+    }
+
+    server->casemapping = casemapping;
+
+    if (server->channels_hashtable)
+    {
+        weechat_hashtable_free (server->channels_hashtable);
+        server->channels_hashtable = NULL;
+    }
+    if (server->nicks_channels)
+    {
+        weechat_hashtable_free (server->nicks_channels);
+        server->nicks_channels = NULL;
+    }
+
+    for (ptr_channel = server->channels; ptr_channel;
+         ptr_channel = ptr_channel->next_channel)
+    {
+        irc_channel_hashtable_add (server, ptr_channel);
+        irc_nick_hashtable_rebuild (server, ptr_channel);
+    }
+}
+
 /*
  * Evaluates a string using the server as context:
  * ${irc_server.xxx} and ${server} are replaced by a server option and the
@@ -1493,6 +1676,8 @@ irc_server_alloc (const char *name)
     new_server->buffer_as_string = NULL;
     new_server->channels = NULL;
     new_server->last_channel = NULL;
+    new_server->channels_hashtable = NULL;
+    new_server->nicks_channels = NULL;
 
     /* create options with null value */
     for (i = 0; i < IRC_SERVER_NUM_OPTIONS; i++)
@@ -1911,6 +2096,16 @@ irc_server_free_data (struct t_irc_server *server)
     irc_channel_free_all (server);
 
     /* free hashtables */
+    if (server->channels_hashtable)
+    {
+        weechat_hashtable_free (server->channels_hashtable);
+        server->channels_hashtable = NULL;
+    }
+    if (server->nicks_channels)
+    {
+        weechat_hashtable_free (server->nicks_channels);
+        server->nicks_channels = NULL;
+    }
     weechat_hashtable_free (server->join_manual);
     weechat_hashtable_free (server->join_channel_key);
     weechat_hashtable_free (server->join_noswitch);
@@ -2994,10 +3189,13 @@ irc_server_msgq_flush ()
 {
     struct t_irc_message *next;
     char *ptr_data, *new_msg, *new_msg2, *ptr_msg, *ptr_msg2, *pos;
-    char *nick, *host, *command, *channel, *arguments;
+    char *command, *channel;
+    const char *arguments;
     char *msg_decoded, *msg_decoded_without_color;
     char str_modifier[128], modifier_data[256];
-    int pos_channel, pos_text, pos_decode;
+    char str_command[128], str_channel[256];
+    int pos_decode;
+    struct t_irc_message_parsed parsed;
 
     while (irc_recv_msgq)
     {
@@ -3021,19 +3219,28 @@ irc_server_msgq_flush ()
                     irc_raw_print (irc_recv_msgq->server, IRC_RAW_FLAG_RECV,
                                    ptr_data);
 
-                    irc_message_parse (irc_recv_msgq->server,
-                                       ptr_data, NULL, NULL, NULL, NULL, NULL,
-                                       &command, NULL, NULL, NULL, NULL, NULL,
-                                       NULL, NULL);
-                    snprintf (str_modifier, sizeof (str_modifier),
-                              "irc_in_%s",
-                              (command) ? command : "unknown");
+                    /*
+                     * parse message once (without any copy), the result is
+                     * used again below if message is not changed by modifier
+                     */
+                    irc_message_parse_positions (irc_recv_msgq->server,
+                                                 ptr_data, &parsed);
+                    if (parsed.pos_command >= 0)
+                    {
+                        snprintf (str_modifier, sizeof (str_modifier),
+                                  "irc_in_%.*s",
+                                  parsed.length_command,
+                                  ptr_data + parsed.pos_command);
+                    }
+                    else
+                    {
+                        snprintf (str_modifier, sizeof (str_modifier),
+                                  "irc_in_unknown");
+                    }
                     new_msg = weechat_hook_modifier_exec (
                         str_modifier,
                         irc_recv_msgq->server->name,
                         ptr_data);
-                    if (command)
-                        free (command);
 
                     /* no changes in new message */
                     if (new_msg && (strcmp (ptr_data, new_msg) == 0))
@@ -3062,11 +3269,21 @@ irc_server_msgq_flush ()
                                     ptr_msg);
                             }
 
-                            irc_message_parse (irc_recv_msgq->server, ptr_msg,
-                                               NULL, NULL, &nick, NULL, &host,
-                                               &command, &channel, &arguments,
-                                               NULL, NULL, NULL,
-                                               &pos_channel, &pos_text);
+                            if ((ptr_msg != ptr_data) || pos)
+                            {
+                                irc_message_parse_positions (
+                                    irc_recv_msgq->server, ptr_msg, &parsed);
+                            }
+                            command = irc_message_parsed_get (
+                                &parsed,
+                                parsed.pos_command, parsed.length_command,
+                                str_command, sizeof (str_command));
+                            channel = irc_message_parsed_get (
+                                &parsed,
+                                parsed.pos_channel, parsed.length_channel,
+                                str_channel, sizeof (str_channel));
+                            arguments = (parsed.pos_arguments >= 0) ?
+                                ptr_msg + parsed.pos_arguments : NULL;
 
                             msg_decoded = NULL;
 
@@ -3077,10 +3294,11 @@ irc_server_msgq_flush ()
                                     pos_decode = 0;
                                     break;
                                 case IRC_SERVER_CHARSET_MESSAGE_CHANNEL:
-                                    pos_decode = (pos_channel >= 0) ? pos_channel : pos_text;
+                                    pos_decode = (parsed.pos_channel >= 0) ?
+                                        parsed.pos_channel : parsed.pos_text;
                                     break;
                                 case IRC_SERVER_CHARSET_MESSAGE_TEXT:
-                                    pos_decode = pos_text;
+                                    pos_decode = parsed.pos_text;
                                     break;
                                 default:
                                     pos_decode = 0;
@@ -3101,14 +3319,20 @@ irc_server_msgq_flush ()
                                 }
                                 else
                                 {
-                                    if (nick && (!host || (strcmp (nick, host) != 0)))
+                                    if ((parsed.pos_nick >= 0)
+                                        && ((parsed.pos_host < 0)
+                                            || (parsed.length_nick != parsed.length_host)
+                                            || (strncmp (ptr_msg + parsed.pos_nick,
+                                                         ptr_msg + parsed.pos_host,
+                                                         parsed.length_nick) != 0)))
                                     {
                                         snprintf (modifier_data,
                                                   sizeof (modifier_data),
-                                                  "%s.%s.%s",
+                                                  "%s.%s.%.*s",
                                                   weechat_plugin->name,
                                                   irc_recv_msgq->server->name,
-                                                  nick);
+                                                  parsed.length_nick,
+                                                  ptr_msg + parsed.pos_nick);
                                     }
                                     else
                                     {
@@ -3173,16 +3397,10 @@ irc_server_msgq_flush ()
 
                             if (new_msg2)
                                 free (new_msg2);
-                            if (nick)
-                                free (nick);
-                            if (host)
-                                free (host);
-                            if (command)
+                            if (command && (command != str_command))
                                 free (command);
-                            if (channel)
+                            if (channel && (channel != str_channel))
                                 free (channel);
-                            if (arguments)
-                                free (arguments);
                             if (msg_decoded)
                                 free (msg_decoded);
                             if (msg_decoded_without_color)
@@ -5805,6 +6023,8 @@ irc_server_hdata_server_cb (const void *pointer, void *data,
         WEECHAT_HDATA_VAR(struct t_irc_server, buffer_as_string, STRING, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_irc_server, channels, POINTER, 0, NULL, "irc_channel");
         WEECHAT_HDATA_VAR(struct t_irc_server, last_channel, POINTER, 0, NULL, "irc_channel");
+        WEECHAT_HDATA_VAR(struct t_irc_server, channels_hashtable, HASHTABLE, 0, NULL, NULL);
+        WEECHAT_HDATA_VAR(struct t_irc_server, nicks_channels, HASHTABLE, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_irc_server, prev_server, POINTER, 0, NULL, hdata_name);
         WEECHAT_HDATA_VAR(struct t_irc_server, next_server, POINTER, 0, NULL, hdata_name);
         WEECHAT_HDATA_LIST(irc_servers, WEECHAT_HDATA_LIST_CHECK_POINTERS);
@@ -6458,6 +6678,8 @@ irc_server_print_log ()
         weechat_log_printf ("  buffer_as_string . . : 0x%lx", ptr_server->buffer_as_string);
         weechat_log_printf ("  channels . . . . . . : 0x%lx", ptr_server->channels);
         weechat_log_printf ("  last_channel . . . . : 0x%lx", ptr_server->last_channel);
+        weechat_log_printf ("  channels_hashtable . : 0x%lx", ptr_server->channels_hashtable);
+        weechat_log_printf ("  nicks_channels . . . : 0x%lx", ptr_server->nicks_channels);
         weechat_log_printf ("  prev_server. . . . . : 0x%lx", ptr_server->prev_server);
         weechat_log_printf ("  next_server. . . . . : 0x%lx", ptr_server->next_server);
 
@@ -258,6 +258,9 @@ struct t_irc_server
     char *buffer_as_string;               /* used to return buffer info      */
     struct t_irc_channel *channels;       /* opened channels on server       */
     struct t_irc_channel *last_channel;   /* last opened channel on server   */
+    struct t_hashtable *channels_hashtable; /* channels indexed by name      */
+    struct t_hashtable *nicks_channels;   /* channels where nicks are:       */
+                                          /* nick -> arraylist of channels   */
     struct t_irc_server *prev_server;     /* link to previous server         */
     struct t_irc_server *next_server;     /* link to next server             */
 };
@@ -303,6 +306,12 @@ extern int irc_server_strcasecmp (struct t_irc_server *server,
 extern int irc_server_strncasecmp (struct t_irc_server *server,
                                    const char *string1, const char *string2,
                                    int max);
+extern struct t_hashtable *irc_server_hashtable_new_casemapping (struct t_irc_server *server,
+                                                                 int size,
+                                                                 const char *type_keys,
+                                                                 const char *type_values);
+extern void irc_server_set_casemapping (struct t_irc_server *server,
+                                        int casemapping);
 extern char *irc_server_eval_expression (struct t_irc_server *server,
                                          const char *string);
 extern int irc_server_sasl_enabled (struct t_irc_server *server);
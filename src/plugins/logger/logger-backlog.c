@@ -42,10 +42,14 @@
 #include "logger-buffer.h"
 #include "logger-command.h"
 #include "logger-config.h"
+#include "logger-index.h"
 #include "logger-info.h"
 #include "logger-tail.h"
 
 
+#define LOGGER_BACKLOG_SEARCH_LINE_SIZE (16 * 1024)
+
+
 /*
  * Checks conditions to display the backlog.
  *
@@ -102,6 +106,95 @@ logger_backlog_check_conditions (struct t_gui_buffer *buffer)
     return condition_ok;
 }
 
+/*
+ * Gets date of a line read in log file (date at beginning of line, with format
+ * of option logger.file.time_format).
+ *
+ * Returns date of line, 0 if not found.
+ */
+
+time_t
+logger_backlog_get_line_date (char *line)
+{
+    char *pos_message, *error;
+    time_t datetime, time_now;
+    struct tm tm_line;
+
+    datetime = 0;
+    pos_message = strchr (line, '\t');
+    if (pos_message)
+    {
+        /* initialize structure, because strptime does not do it */
+        memset (&tm_line, 0, sizeof (struct tm));
+        /*
+         * we get current time to initialize daylight saving time in
+         * structure tm_line, otherwise printed time will be shifted
+         * and will not use DST used on machine
+         */
+        time_now = time (NULL);
+        localtime_r (&time_now, &tm_line);
+        pos_message[0] = '\0';
+        error = strptime (line,
+                          weechat_config_string (logger_config_file_time_format),
+                          &tm_line);
+        if (error && !error[0] && (tm_line.tm_year > 0))
+            datetime = mktime (&tm_line);
+        pos_message[0] = '\t';
+    }
+
+    return datetime;
+}
+
+/*
+ * Displays a line read in log file in a buffer.
+ *
+ * Returns date of line, 0 if not found.
+ */
+
+time_t
+logger_backlog_display_line (struct t_gui_buffer *buffer, char *line,
+                             const char *tags)
+{
+    char *pos_message, *pos_tab, *message, *message2;
+    time_t datetime;
+    int color_lines;
+
+    color_lines = weechat_config_boolean (logger_config_file_color_lines);
+
+    datetime = logger_backlog_get_line_date (line);
+    pos_message = (datetime != 0) ? strchr (line, '\t') + 1 : line;
+    message = weechat_hook_modifier_exec (
+        "color_decode_ansi",
+        (color_lines) ? "1" : "0",
+        pos_message);
+    if (message)
+    {
+        message2 = (logger_charset) ?
+            weechat_iconv_to_internal (logger_charset, message) :
+            strdup (message);
+        if (message2)
+        {
+            pos_tab = strchr (message2, '\t');
+            if (pos_tab)
+                pos_tab[0] = '\0';
+            weechat_printf_date_tags (
+                buffer, datetime, tags,
+                "%s%s%s%s%s",
+                (color_lines) ? "" : weechat_color (weechat_config_string (logger_config_color_backlog_line)),
+                message2,
+                (pos_tab) ? "\t" : "",
+                (pos_tab && !color_lines) ? weechat_color (weechat_config_string (logger_config_color_backlog_line)) : "",
+                (pos_tab) ? pos_tab + 1 : "");
+            if (pos_tab)
+                pos_tab[0] = '\t';
+            free (message2);
+        }
+        free (message);
+    }
+
+    return datetime;
+}
+
 /*
  * Displays backlog for a buffer (by reading end of log file).
  */
@@ -110,74 +203,20 @@ void
 logger_backlog (struct t_gui_buffer *buffer, const char *filename, int lines)
 {
     struct t_logger_line *last_lines, *ptr_lines;
-    char *charset, *pos_message, *pos_tab, *error, *message, *message2;
-    time_t datetime, time_now;
-    struct tm tm_line;
-    int color_lines, num_lines;
+    time_t datetime;
+    int num_lines;
 
     weechat_buffer_set (buffer, "print_hooks_enabled", "0");
 
-    color_lines = weechat_config_boolean (logger_config_file_color_lines);
-
     num_lines = 0;
+    datetime = 0;
     last_lines = logger_tail_file (filename, lines);
     ptr_lines = last_lines;
     while (ptr_lines)
     {
-        datetime = 0;
-        pos_message = strchr (ptr_lines->data, '\t');
-        if (pos_message)
-        {
-            /* initialize structure, because strptime does not do it */
-            memset (&tm_line, 0, sizeof (struct tm));
-            /*
-             * we get current time to initialize daylight saving time in
-             * structure tm_line, otherwise printed time will be shifted
-             * and will not use DST used on machine
-             */
-            time_now = time (NULL);
-            localtime_r (&time_now, &tm_line);
-            pos_message[0] = '\0';
-            error = strptime (ptr_lines->data,
-                              weechat_config_string (logger_config_file_time_format),
-                              &tm_line);
-            if (error && !error[0] && (tm_line.tm_year > 0))
-                datetime = mktime (&tm_line);
-            pos_message[0] = '\t';
-        }
-        pos_message = (pos_message && (datetime != 0)) ?
-            pos_message + 1 : ptr_lines->data;
-        message = weechat_hook_modifier_exec (
-            "color_decode_ansi",
-            (color_lines) ? "1" : "0",
-            pos_message);
-        if (message)
-        {
-            charset = weechat_info_get ("charset_terminal", "");
-            message2 = (charset) ?
-                weechat_iconv_to_internal (charset, message) : strdup (message);
-            if (charset)
-                free (charset);
-            if (message2)
-            {
-                pos_tab = strchr (message2, '\t');
-                if (pos_tab)
-                    pos_tab[0] = '\0';
-                weechat_printf_date_tags (
-                    buffer, datetime,
-                    "no_highlight,notify_none,logger_backlog",
-                    "%s%s%s%s%s",
-                    (color_lines) ? "" : weechat_color (weechat_config_string (logger_config_color_backlog_line)),
-                    message2,
-                    (pos_tab) ? "\t" : "",
-                    (pos_tab && !color_lines) ? weechat_color (weechat_config_string (logger_config_color_backlog_line)) : "",
-                    (pos_tab) ? pos_tab + 1 : "");
-                if (pos_tab)
-                    pos_tab[0] = '\t';
-                free (message2);
-            }
-            free (message);
-        }
+        datetime = logger_backlog_display_line (
+            buffer, ptr_lines->data,
+            "no_highlight,notify_none,logger_backlog");
         num_lines++;
         ptr_lines = ptr_lines->next_line;
     }
@@ -196,6 +235,122 @@ logger_backlog (struct t_gui_buffer *buffer, const char *filename, int lines)
     weechat_buffer_set (buffer, "print_hooks_enabled", "1");
 }
 
+/*
+ * Parses a date given to command /logger search, with one of these formats:
+ * "YYYY-MM-DD", "YYYY-MM-DDTHH:MM", "YYYY-MM-DDTHH:MM:SS" (local time).
+ *
+ * Returns date, 0 if the date is invalid.
+ */
+
+time_t
+logger_backlog_parse_date (const char *string)
+{
+    const char *formats[] = { "%Y-%m-%dT%H:%M:%S", "%Y-%m-%dT%H:%M",
+                              "%Y-%m-%d", NULL };
+    struct tm tm_date;
+    char *error;
+    int i;
+
+    if (!string)
+        return 0;
+
+    for (i = 0; formats[i]; i++)
+    {
+        memset (&tm_date, 0, sizeof (struct tm));
+        error = strptime (string, formats[i], &tm_date);
+        if (error && !error[0])
+        {
+            tm_date.tm_isdst = -1;
+            return mktime (&tm_date);
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * Displays lines of a log file in a buffer: lines displayed since a date
+ * (if "since" > 0) and containing a text (if "text" is not NULL or empty),
+ * at most "max_lines" lines.
+ *
+ * The index of log file (if it exists) is used to seek directly to the lines
+ * displayed since the date.
+ */
+
+void
+logger_backlog_search (struct t_gui_buffer *buffer, const char *filename,
+                       time_t since, const char *text, int max_lines)
+{
+    FILE *file;
+    char line[LOGGER_BACKLOG_SEARCH_LINE_SIZE];
+    off_t offset;
+    time_t datetime;
+    int length, c, since_found, num_lines;
+
+    offset = (since > 0) ? logger_index_search_date (filename, since) : 0;
+
+    file = fopen (filename, "r");
+    if (!file)
+    {
+        weechat_printf (NULL,
+                        _("%s%s: unable to read log file \"%s\""),
+                        weechat_prefix ("error"), LOGGER_PLUGIN_NAME,
+                        filename);
+        return;
+    }
+    if ((offset > 0) && (fseeko (file, offset, SEEK_SET) != 0))
+        rewind (file);
+
+    weechat_buffer_set (buffer, "print_hooks_enabled", "0");
+
+    since_found = (since <= 0);
+    num_lines = 0;
+    datetime = 0;
+    while ((num_lines < max_lines)
+           && fgets (line, sizeof (line), file))
+    {
+        length = strlen (line);
+        if ((length > 0) && (line[length - 1] == '\n'))
+        {
+            line[--length] = '\0';
+            if ((length > 0) && (line[length - 1] == '\r'))
+                line[--length] = '\0';
+        }
+        else
+        {
+            /* line too long: skip the end of line */
+            while (((c = fgetc (file)) != EOF) && (c != '\n'))
+            {
+            }
+        }
+        if (!line[0])
+            continue;
+        if (!since_found)
+        {
+            if (logger_backlog_get_line_date (line) < since)
+                continue;
+            /* lines are sorted by date: no need to check next lines */
+            since_found = 1;
+        }
+        if (text && text[0] && !weechat_strcasestr (line, text))
+            continue;
+        datetime = logger_backlog_display_line (
+            buffer, line, "no_highlight,notify_none,logger_search");
+        num_lines++;
+    }
+
+    fclose (file);
+
+    weechat_printf_date_tags (buffer, datetime,
+                              "no_highlight,notify_none,logger_search_end",
+                              _("%s===\t%s========== End of search (%d lines) =========="),
+                              weechat_color (weechat_config_string (logger_config_color_backlog_end)),
+                              weechat_color (weechat_config_string (logger_config_color_backlog_end)),
+                              num_lines);
+
+    weechat_buffer_set (buffer, "print_hooks_enabled", "1");
+}
+
 /*
  * Callback for signal "logger_backlog".
  */
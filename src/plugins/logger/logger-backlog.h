@@ -20,9 +20,15 @@
 #ifndef WEECHAT_PLUGIN_LOGGER_BACKLOG_H
 #define WEECHAT_PLUGIN_LOGGER_BACKLOG_H
 
+#include <time.h>
+
 extern int logger_backlog_check_conditions (struct t_gui_buffer *buffer);
 extern void logger_backlog (struct t_gui_buffer *buffer, const char *filename,
                             int lines);
+extern time_t logger_backlog_parse_date (const char *string);
+extern void logger_backlog_search (struct t_gui_buffer *buffer,
+                                   const char *filename, time_t since,
+                                   const char *text, int max_lines);
 extern int logger_backlog_signal_cb (const void *pointer, void *data,
                                      const char *signal,
                                      const char *type_data, void *signal_data);
@@ -26,10 +26,13 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#include <errno.h>
+#include <sys/uio.h>
 
 #include "../weechat-plugin.h"
 #include "logger.h"
 #include "logger-buffer.h"
+#include "logger-index.h"
 
 
 struct t_logger_buffer *logger_buffers = NULL;
@@ -92,10 +95,16 @@ logger_buffer_add (struct t_gui_buffer *buffer, int log_level)
         new_logger_buffer->log_filename = NULL;
         new_logger_buffer->log_file = NULL;
         new_logger_buffer->log_file_inode = 0;
+        new_logger_buffer->log_file_size = 0;
+        new_logger_buffer->index_file = NULL;
+        new_logger_buffer->index_lines = 0;
         new_logger_buffer->log_enabled = 1;
         new_logger_buffer->log_level = log_level;
         new_logger_buffer->write_start_info_line = 1;
         new_logger_buffer->flush_needed = 0;
+        new_logger_buffer->write_buffer = NULL;
+        new_logger_buffer->write_buffer_size = 0;
+        new_logger_buffer->write_buffer_length = 0;
 
         new_logger_buffer->prev_buffer = last_logger_buffer;
         new_logger_buffer->next_buffer = NULL;
@@ -159,6 +168,149 @@ logger_buffer_search_log_filename (const char *log_filename)
     return NULL;
 }
 
+/*
+ * Writes all data of an array of iovec in a file descriptor (a single system
+ * call is made unless the write is partial).
+ *
+ * Returns:
+ *   1: OK
+ *   0: error
+ */
+
+int
+logger_buffer_writev (int fd, struct iovec *iov, int iovcnt)
+{
+    ssize_t num_written;
+
+    while (iovcnt > 0)
+    {
+        num_written = writev (fd, iov, iovcnt);
+        if (num_written < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return 0;
+        }
+        /* skip data written (the write may be partial) */
+        while ((iovcnt > 0) && ((size_t)num_written >= iov->iov_len))
+        {
+            num_written -= iov->iov_len;
+            iov++;
+            iovcnt--;
+        }
+        if (iovcnt > 0)
+        {
+            iov->iov_base = (char *)iov->iov_base + num_written;
+            iov->iov_len -= num_written;
+        }
+    }
+
+    return 1;
+}
+
+/*
+ * Writes a string (followed by a new line) in log file of a logger buffer.
+ *
+ * The string is kept in the write buffer, which is written in file (with the
+ * string) if "flush" is 1 or if it is full: data is written with a single
+ * system call (writev).
+ *
+ * Returns:
+ *   1: OK
+ *   0: error
+ */
+
+int
+logger_buffer_write (struct t_logger_buffer *logger_buffer,
+                     const char *string, int flush)
+{
+    struct iovec iov[3];
+    char *new_write_buffer;
+    int length, new_size, rc;
+
+    if (!logger_buffer || !logger_buffer->log_file || !string)
+        return 0;
+
+    length = strlen (string);
+
+    logger_buffer->flush_needed = 1;
+    logger_buffer->log_file_size += length + 1;
+
+    if (!flush
+        && (logger_buffer->write_buffer_length + length + 1
+            <= LOGGER_BUFFER_WRITE_SIZE))
+    {
+        /* keep string in write buffer (grow it if needed) */
+        if (logger_buffer->write_buffer_length + length + 1
+            > logger_buffer->write_buffer_size)
+        {
+            new_size = (logger_buffer->write_buffer_size > 0) ?
+                logger_buffer->write_buffer_size : 1024;
+            while (new_size < logger_buffer->write_buffer_length + length + 1)
+            {
+                new_size *= 2;
+            }
+            if (new_size > LOGGER_BUFFER_WRITE_SIZE)
+                new_size = LOGGER_BUFFER_WRITE_SIZE;
+            new_write_buffer = realloc (logger_buffer->write_buffer,
+                                        new_size);
+            if (!new_write_buffer)
+                return 0;
+            logger_buffer->write_buffer = new_write_buffer;
+            logger_buffer->write_buffer_size = new_size;
+        }
+        memcpy (logger_buffer->write_buffer
+                + logger_buffer->write_buffer_length,
+                string, length);
+        logger_buffer->write_buffer[logger_buffer->write_buffer_length
+                                    + length] = '\n';
+        logger_buffer->write_buffer_length += length + 1;
+        return 1;
+    }
+
+    /* write pending data + string + new line */
+    iov[0].iov_base = logger_buffer->write_buffer;
+    iov[0].iov_len = logger_buffer->write_buffer_length;
+    iov[1].iov_base = (char *)string;
+    iov[1].iov_len = length;
+    iov[2].iov_base = "\n";
+    iov[2].iov_len = 1;
+    rc = (logger_buffer->write_buffer_length > 0) ?
+        logger_buffer_writev (fileno (logger_buffer->log_file), iov, 3) :
+        logger_buffer_writev (fileno (logger_buffer->log_file), iov + 1, 2);
+    logger_buffer->write_buffer_length = 0;
+
+    return rc;
+}
+
+/*
+ * Writes pending data of write buffer in log file.
+ *
+ * Returns:
+ *   1: OK
+ *   0: error
+ */
+
+int
+logger_buffer_flush (struct t_logger_buffer *logger_buffer)
+{
+    struct iovec iov[1];
+    int rc;
+
+    if (!logger_buffer || !logger_buffer->log_file
+        || (logger_buffer->write_buffer_length == 0))
+    {
+        return 1;
+    }
+
+    iov[0].iov_base = logger_buffer->write_buffer;
+    iov[0].iov_len = logger_buffer->write_buffer_length;
+    rc = logger_buffer_writev (fileno (logger_buffer->log_file), iov, 1);
+    logger_buffer->write_buffer_length = 0;
+
+    return rc;
+}
+
 /*
  * Removes a logger buffer from list.
  */
@@ -192,7 +344,13 @@ logger_buffer_free (struct t_logger_buffer *logger_buffer)
     if (logger_buffer->log_filename)
         free (logger_buffer->log_filename);
     if (logger_buffer->log_file)
+    {
+        logger_buffer_flush (logger_buffer);
         fclose (logger_buffer->log_file);
+    }
+    logger_index_close (logger_buffer);
+    if (logger_buffer->write_buffer)
+        free (logger_buffer->write_buffer);
 
     free (logger_buffer);
 
@@ -25,6 +25,9 @@
 #include <sys/stat.h>
 #include <unistd.h>
 
+/* max size of data kept in memory before writing it in log file */
+#define LOGGER_BUFFER_WRITE_SIZE (32 * 1024)
+
 struct t_infolist;
 
 struct t_logger_buffer
@@ -33,11 +36,19 @@ struct t_logger_buffer
     char *log_filename;                   /* log filename                   */
     FILE *log_file;                       /* log file                       */
     ino_t log_file_inode;                 /* inode of log file              */
+    off_t log_file_size;                  /* size of log file (with data in */
+                                          /* write buffer)                  */
+    FILE *index_file;                     /* index of log file              */
+    int index_lines;                      /* lines written since last entry */
+                                          /* in index                       */
     int log_enabled;                      /* log enabled ?                  */
     int log_level;                        /* log level (0..9)               */
     int write_start_info_line;            /* 1 if start info line must be   */
                                           /* written in file                */
     int flush_needed;                     /* flush needed?                  */
+    char *write_buffer;                   /* data not yet written in file   */
+    int write_buffer_size;                /* allocated size of write buffer */
+    int write_buffer_length;              /* length of data in write buffer */
     struct t_logger_buffer *prev_buffer;  /* link to previous buffer        */
     struct t_logger_buffer *next_buffer;  /* link to next buffer            */
 };
@@ -50,6 +61,9 @@ extern struct t_logger_buffer *logger_buffer_add (struct t_gui_buffer *,
                                                   int log_level);
 extern struct t_logger_buffer *logger_buffer_search_buffer (struct t_gui_buffer *buffer);
 extern struct t_logger_buffer *logger_buffer_search_log_filename (const char *log_filename);
+extern int logger_buffer_write (struct t_logger_buffer *logger_buffer,
+                                const char *string, int flush);
+extern int logger_buffer_flush (struct t_logger_buffer *logger_buffer);
 extern void logger_buffer_free (struct t_logger_buffer *logger_buffer);
 extern int logger_buffer_add_to_infolist (struct t_infolist *infolist,
                                           struct t_logger_buffer *logger_buffer);
@@ -24,7 +24,9 @@
 
 #include "../weechat-plugin.h"
 #include "logger.h"
+#include "logger-backlog.h"
 #include "logger-buffer.h"
+#include "logger-command.h"
 #include "logger-config.h"
 
 
@@ -122,10 +124,16 @@ logger_command_cb (const void *pointer, void *data,
                    struct t_gui_buffer *buffer,
                    int argc, char **argv, char **argv_eol)
 {
+    struct t_logger_buffer *ptr_logger_buffer;
+    time_t since;
+    long number;
+    char *error;
+    const char *ptr_text;
+    int i, max_lines;
+
     /* make C compiler happy */
     (void) pointer;
     (void) data;
-    (void) argv_eol;
 
     if ((argc == 1)
         || ((argc == 2) && (weechat_strcasecmp (argv[1], "list") == 0)))
@@ -153,6 +161,61 @@ logger_command_cb (const void *pointer, void *data,
         return WEECHAT_RC_OK;
     }
 
+    if (weechat_strcasecmp (argv[1], "search") == 0)
+    {
+        since = 0;
+        max_lines = LOGGER_COMMAND_SEARCH_LINES;
+        ptr_text = NULL;
+        for (i = 2; i < argc; i++)
+        {
+            if (weechat_strcasecmp (argv[i], "-since") == 0)
+            {
+                if (i + 1 >= argc)
+                    WEECHAT_COMMAND_ERROR;
+                since = logger_backlog_parse_date (argv[++i]);
+                if (since <= 0)
+                {
+                    weechat_printf (NULL,
+                                    _("%s%s: invalid date: \"%s\""),
+                                    weechat_prefix ("error"),
+                                    LOGGER_PLUGIN_NAME, argv[i]);
+                    return WEECHAT_RC_OK;
+                }
+            }
+            else if (weechat_strcasecmp (argv[i], "-limit") == 0)
+            {
+                if (i + 1 >= argc)
+                    WEECHAT_COMMAND_ERROR;
+                error = NULL;
+                number = strtol (argv[++i], &error, 10);
+                if (!error || error[0] || (number <= 0))
+                    WEECHAT_COMMAND_ERROR;
+                max_lines = (int)number;
+            }
+            else
+            {
+                ptr_text = argv_eol[i];
+                break;
+            }
+        }
+        ptr_logger_buffer = logger_buffer_search_buffer (buffer);
+        if (ptr_logger_buffer && !ptr_logger_buffer->log_filename)
+            logger_set_log_filename (ptr_logger_buffer);
+        if (!ptr_logger_buffer || !ptr_logger_buffer->log_filename)
+        {
+            weechat_printf (NULL,
+                            _("%s%s: buffer \"%s\" is not logged"),
+                            weechat_prefix ("error"), LOGGER_PLUGIN_NAME,
+                            weechat_buffer_get_string (buffer, "name"));
+            return WEECHAT_RC_OK;
+        }
+        /* write data pending in memory before reading the file */
+        logger_buffer_flush (ptr_logger_buffer);
+        logger_backlog_search (buffer, ptr_logger_buffer->log_filename,
+                               since, ptr_text, max_lines);
+        return WEECHAT_RC_OK;
+    }
+
     WEECHAT_COMMAND_ERROR;
 }
 
@@ -169,13 +232,21 @@ logger_command_init ()
         N_("list"
            " || set <level>"
            " || flush"
-           " || disable"),
+           " || disable"
+           " || search [-since <date>] [-limit <n>] [<text>]"),
         N_("   list: show logging status for opened buffers\n"
            "    set: set logging level on current buffer\n"
            "  level: level for messages to be logged (0 = logging disabled, "
            "1 = a few messages (most important) .. 9 = all messages)\n"
            "  flush: write all log files now\n"
            "disable: disable logging on current buffer (set level to 0)\n"
+           " search: display lines of log file of current buffer\n"
+           " -since: display lines since this date (format: \"YYYY-MM-DD\", "
+           "\"YYYY-MM-DDTHH:MM\" or \"YYYY-MM-DDTHH:MM:SS\"); the index of "
+           "log file is used if it exists (see option logger.file.index)\n"
+           " -limit: display at most this number of lines (default: 100)\n"
+           "   text: display only lines containing this text (case "
+           "insensitive)\n"
            "\n"
            "Options \"logger.level.*\" and \"logger.mask.*\" can be used to set "
            "level or mask for a buffer, or buffers beginning with name.\n"
@@ -198,10 +269,13 @@ logger_command_init ()
            "  disable logging for main WeeChat buffer:\n"
            "    /set logger.level.core.weechat 0\n"
            "  use a directory per IRC server and a file per channel inside:\n"
-           "    /set logger.mask.irc \"$server/$channel.weechatlog\""),
+           "    /set logger.mask.irc \"$server/$channel.weechatlog\"\n"
+           "  display lines containing \"weechat\" since 2020-06-01:\n"
+           "    /logger search -since 2020-06-01 weechat"),
         "list"
         " || set 1|2|3|4|5|6|7|8|9"
         " || flush"
-        " || disable",
+        " || disable"
+        " || search -since|-limit",
         &logger_command_cb, NULL, NULL);
 }
@@ -20,6 +20,9 @@
 #ifndef WEECHAT_PLUGIN_LOGGER_COMMAND_H
 #define WEECHAT_PLUGIN_LOGGER_COMMAND_H
 
+/* default max number of lines displayed by /logger search */
+#define LOGGER_COMMAND_SEARCH_LINES 100
+
 extern void logger_command_init ();
 
 #endif /* WEECHAT_PLUGIN_LOGGER_COMMAND_H */
@@ -24,7 +24,9 @@
 
 #include "../weechat-plugin.h"
 #include "logger.h"
+#include "logger-buffer.h"
 #include "logger-config.h"
+#include "logger-index.h"
 
 
 struct t_config_file *logger_config_file = NULL;
@@ -49,6 +51,7 @@ struct t_config_option *logger_config_file_auto_log;
 struct t_config_option *logger_config_file_color_lines;
 struct t_config_option *logger_config_file_flush_delay;
 struct t_config_option *logger_config_file_fsync;
+struct t_config_option *logger_config_file_index;
 struct t_config_option *logger_config_file_info_lines;
 struct t_config_option *logger_config_file_mask;
 struct t_config_option *logger_config_file_name_lower_case;
@@ -128,6 +131,8 @@ logger_config_flush_delay_change (const void *pointer, void *data,
         }
         weechat_unhook (logger_hook_timer);
         logger_hook_timer = NULL;
+        /* write data pending in memory */
+        logger_flush ();
     }
 
     if (weechat_config_integer (logger_config_file_flush_delay) > 0)
@@ -147,6 +152,29 @@ logger_config_flush_delay_change (const void *pointer, void *data,
     }
 }
 
+/*
+ * Callback for changes on option "logger.file.index".
+ */
+
+void
+logger_config_index_change (const void *pointer, void *data,
+                            struct t_config_option *option)
+{
+    struct t_logger_buffer *ptr_logger_buffer;
+
+    /* make C compiler happy */
+    (void) pointer;
+    (void) data;
+    (void) option;
+
+    for (ptr_logger_buffer = logger_buffers; ptr_logger_buffer;
+         ptr_logger_buffer = ptr_logger_buffer->next_buffer)
+    {
+        if (ptr_logger_buffer->log_file)
+            logger_index_open (ptr_logger_buffer);
+    }
+}
+
 /*
  * Callback for changes on a level option.
  */
@@ -516,6 +544,16 @@ logger_config_init ()
            "log file"),
         NULL, 0, 0, "off", NULL, 0,
         NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+    logger_config_file_index = weechat_config_new_option (
+        logger_config_file, ptr_section,
+        "index", "boolean",
+        N_("write an index of each log file (file with same name and suffix "
+           "\".idx\"), with offset and date of lines, used to quickly find "
+           "lines by date with command /logger search"),
+        NULL, 0, 0, "off", NULL, 0,
+        NULL, NULL, NULL,
+        &logger_config_index_change, NULL, NULL,
+        NULL, NULL, NULL);
     logger_config_file_info_lines = weechat_config_new_option (
         logger_config_file, ptr_section,
         "info_lines", "boolean",
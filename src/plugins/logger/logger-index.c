@@ -0,0 +1,195 @@
+/*
+ * logger-index.c - index of log files (offset and date of lines)
+ *
+ * Copyright (C) 2020 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * The index of a log file is a text file (log filename + ".idx") with one
+ * line "offset date" every LOGGER_INDEX_LINES lines written in log file (and
+ * for the first line written after the log file is opened).
+ *
+ * It is used to seek directly in log file to the lines displayed since a date,
+ * instead of reading the whole file.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+#include "../weechat-plugin.h"
+#include "logger.h"
+#include "logger-index.h"
+#include "logger-buffer.h"
+#include "logger-config.h"
+
+
+/*
+ * Opens index of log file for a logger buffer (if option logger.file.index
+ * is enabled).
+ *
+ * If the log file is empty, the index is cleared.
+ */
+
+void
+logger_index_open (struct t_logger_buffer *logger_buffer)
+{
+    char *filename;
+    int length;
+
+    logger_index_close (logger_buffer);
+
+    if (!weechat_config_boolean (logger_config_file_index)
+        || !logger_buffer->log_filename)
+    {
+        return;
+    }
+
+    length = strlen (logger_buffer->log_filename)
+        + strlen (LOGGER_INDEX_SUFFIX) + 1;
+    filename = malloc (length);
+    if (!filename)
+        return;
+    snprintf (filename, length, "%s%s",
+              logger_buffer->log_filename, LOGGER_INDEX_SUFFIX);
+
+    logger_buffer->index_file = fopen (
+        filename,
+        (logger_buffer->log_file_size == 0) ? "w" : "a");
+    if (!logger_buffer->index_file)
+    {
+        weechat_printf_date_tags (
+            NULL, 0, "no_log",
+            _("%s%s: unable to write index file \"%s\""),
+            weechat_prefix ("error"), LOGGER_PLUGIN_NAME, filename);
+    }
+
+    free (filename);
+}
+
+/*
+ * Adds an entry in index for the next line written in log file, if needed
+ * (first line written or every LOGGER_INDEX_LINES lines).
+ */
+
+void
+logger_index_add (struct t_logger_buffer *logger_buffer, time_t date)
+{
+    if (!logger_buffer->index_file)
+        return;
+
+    if (logger_buffer->index_lines == 0)
+    {
+        /* flushed immediately: entries are rare */
+        fprintf (logger_buffer->index_file, "%lld %lld\n",
+                 (long long)logger_buffer->log_file_size,
+                 (long long)date);
+        fflush (logger_buffer->index_file);
+    }
+
+    logger_buffer->index_lines++;
+    if (logger_buffer->index_lines >= LOGGER_INDEX_LINES)
+        logger_buffer->index_lines = 0;
+}
+
+/*
+ * Closes index of log file for a logger buffer.
+ */
+
+void
+logger_index_close (struct t_logger_buffer *logger_buffer)
+{
+    if (logger_buffer->index_file)
+    {
+        fclose (logger_buffer->index_file);
+        logger_buffer->index_file = NULL;
+    }
+    logger_buffer->index_lines = 0;
+}
+
+/*
+ * Searches in index of a log file the offset where to start reading to find
+ * lines displayed since a date.
+ *
+ * Returns offset of the last line indexed before this date, 0 if the index
+ * does not exist or is not valid for this log file (then the whole file must
+ * be read).
+ */
+
+off_t
+logger_index_search_date (const char *log_filename, time_t date)
+{
+    FILE *file;
+    char *filename, line[128], *ptr_line, char_before;
+    long long entry_offset, entry_date;
+    off_t offset, file_length;
+    int length, fd;
+
+    if (!log_filename)
+        return 0;
+
+    length = strlen (log_filename) + strlen (LOGGER_INDEX_SUFFIX) + 1;
+    filename = malloc (length);
+    if (!filename)
+        return 0;
+    snprintf (filename, length, "%s%s", log_filename, LOGGER_INDEX_SUFFIX);
+    file = fopen (filename, "r");
+    free (filename);
+    if (!file)
+        return 0;
+
+    offset = 0;
+    while (!feof (file))
+    {
+        ptr_line = fgets (line, sizeof (line) - 1, file);
+        if (!ptr_line)
+            break;
+        if (sscanf (ptr_line, "%lld %lld", &entry_offset, &entry_date) != 2)
+            break;
+        /* next lines are displayed after the date */
+        if ((time_t)entry_date >= date)
+            break;
+        offset = (off_t)entry_offset;
+    }
+
+    fclose (file);
+
+    if (offset <= 0)
+        return 0;
+
+    /* check that offset is the beginning of a line in log file */
+    fd = open (log_filename, O_RDONLY);
+    if (fd == -1)
+        return 0;
+    file_length = lseek (fd, (off_t)0, SEEK_END);
+    if ((offset >= file_length)
+        || (pread (fd, &char_before, 1, offset - 1) != 1)
+        || (char_before != '\n'))
+    {
+        offset = 0;
+    }
+    close (fd);
+
+    return offset;
+}
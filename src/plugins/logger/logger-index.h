@@ -0,0 +1,41 @@
+/*
+ * Copyright (C) 2020 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef WEECHAT_PLUGIN_LOGGER_INDEX_H
+#define WEECHAT_PLUGIN_LOGGER_INDEX_H
+
+#include <time.h>
+#include <sys/types.h>
+
+/* suffix added to log filename to build index filename */
+#define LOGGER_INDEX_SUFFIX ".idx"
+
+/* number of lines in log file between two entries of index */
+#define LOGGER_INDEX_LINES 1000
+
+struct t_logger_buffer;
+
+extern void logger_index_open (struct t_logger_buffer *logger_buffer);
+extern void logger_index_add (struct t_logger_buffer *logger_buffer,
+                              time_t date);
+extern void logger_index_close (struct t_logger_buffer *logger_buffer);
+extern off_t logger_index_search_date (const char *log_filename,
+                                       time_t date);
+
+#endif /* WEECHAT_PLUGIN_LOGGER_INDEX_H */
@@ -31,6 +31,8 @@
 #include <sys/time.h>
 #include <fcntl.h>
 #include <time.h>
+#include <signal.h>
+#include <pthread.h>
 
 #include "../weechat-plugin.h"
 #include "logger.h"
@@ -38,6 +40,7 @@
 #include "logger-buffer.h"
 #include "logger-command.h"
 #include "logger-config.h"
+#include "logger-index.h"
 #include "logger-info.h"
 #include "logger-tail.h"
 
@@ -54,6 +57,19 @@ struct t_weechat_plugin *weechat_logger_plugin = NULL;
 struct t_hook *logger_hook_timer = NULL;    /* timer to flush log files     */
 struct t_hook *logger_hook_print = NULL;
 
+/* thread synchronizing log files with the storage device */
+pthread_mutex_t logger_fsync_mutex = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t logger_fsync_cond = PTHREAD_COND_INITIALIZER;
+pthread_t logger_fsync_thread;
+int logger_fsync_thread_running = 0;        /* 1 if thread is created       */
+int logger_fsync_quit = 0;                  /* 1 if thread must exit        */
+int *logger_fsync_fds = NULL;               /* files to sync (duplicated)   */
+int logger_fsync_fds_count = 0;             /* number of files to sync      */
+int logger_fsync_fds_size = 0;              /* size of array "fds"          */
+
+char *logger_charset = NULL;                /* charset of log files         */
+int logger_charset_is_utf8 = 0;             /* 1 if charset is UTF-8        */
+
 
 /*
  * Gets logger file path option.
@@ -515,6 +531,28 @@ logger_set_log_filename (struct t_logger_buffer *logger_buffer)
     logger_buffer->log_filename = log_filename;
 }
 
+/*
+ * Converts a string from internal charset (UTF-8) to charset of log files.
+ *
+ * Returns NULL if the string can be written as-is, otherwise the converted
+ * string.
+ *
+ * Note: result must be freed after use.
+ */
+
+char *
+logger_iconv_from_internal (const char *string)
+{
+    if (!logger_charset)
+        return NULL;
+
+    /* no conversion needed for a valid UTF-8 string if charset is UTF-8 */
+    if (logger_charset_is_utf8 && weechat_utf8_is_valid (string, -1, NULL))
+        return NULL;
+
+    return weechat_iconv_from_internal (logger_charset, string);
+}
+
 /*
  * Creates a log file.
  *
@@ -526,7 +564,7 @@ logger_set_log_filename (struct t_logger_buffer *logger_buffer)
 int
 logger_create_log_file (struct t_logger_buffer *logger_buffer)
 {
-    char *charset, *message, buf_time[256], buf_beginning[1024];
+    char *message, buf_time[256], buf_beginning[1024];
     int log_level, rc;
     time_t seconds;
     struct tm *date_tmp;
@@ -534,6 +572,13 @@ logger_create_log_file (struct t_logger_buffer *logger_buffer)
 
     if (logger_buffer->log_file)
     {
+        /*
+         * pending data in write buffer will be written in this file, so the
+         * inode is checked only for the first line written after a flush
+         */
+        if (logger_buffer->write_buffer_length > 0)
+            return 1;
+
         /*
          * check that the inode has not changed, otherwise that means the file
          * was deleted, and we must reopen it
@@ -598,6 +643,9 @@ logger_create_log_file (struct t_logger_buffer *logger_buffer)
         return 0;
     }
     logger_buffer->log_file_inode = statbuf.st_ino;
+    logger_buffer->log_file_size = statbuf.st_size;
+
+    logger_index_open (logger_buffer);
 
     /* write info line */
     if (weechat_config_boolean (logger_config_file_info_lines)
@@ -616,16 +664,13 @@ logger_create_log_file (struct t_logger_buffer *logger_buffer)
         snprintf (buf_beginning, sizeof (buf_beginning),
                   _("%s\t****  Beginning of log  ****"),
                   buf_time);
-        charset = weechat_info_get ("charset_terminal", "");
-        message = (charset) ?
-            weechat_iconv_from_internal (charset, buf_beginning) : NULL;
-        fprintf (logger_buffer->log_file,
-                 "%s\n", (message) ? message : buf_beginning);
-        if (charset)
-            free (charset);
+        message = logger_iconv_from_internal (buf_beginning);
+        logger_index_add (logger_buffer, seconds);
+        logger_buffer_write (logger_buffer,
+                             (message) ? message : buf_beginning,
+                             0);
         if (message)
             free (message);
-        logger_buffer->flush_needed = 1;
     }
     logger_buffer->write_start_info_line = 0;
 
@@ -633,14 +678,14 @@ logger_create_log_file (struct t_logger_buffer *logger_buffer)
 }
 
 /*
- * Writes a line to log file.
+ * Writes a line to log file ("date" is the date of line, used in index).
  */
 
 void
-logger_write_line (struct t_logger_buffer *logger_buffer,
+logger_write_line (struct t_logger_buffer *logger_buffer, time_t date,
                    const char *format, ...)
 {
-    char *charset, *message;
+    char *message;
 
     if (!logger_create_log_file (logger_buffer))
         return;
@@ -651,19 +696,16 @@ logger_write_line (struct t_logger_buffer *logger_buffer,
     weechat_va_format (format);
     if (vbuffer)
     {
-        charset = weechat_info_get ("charset_terminal", "");
-        message = (charset) ?
-            weechat_iconv_from_internal (charset, vbuffer) : NULL;
-        fprintf (logger_buffer->log_file,
-                 "%s\n", (message) ? message : vbuffer);
-        if (charset)
-            free (charset);
+        message = logger_iconv_from_internal (vbuffer);
+        logger_index_add (logger_buffer, date);
+        /* without timer, the line is written immediately in file */
+        logger_buffer_write (logger_buffer,
+                             (message) ? message : vbuffer,
+                             (logger_hook_timer) ? 0 : 1);
         if (message)
             free (message);
-        logger_buffer->flush_needed = 1;
         if (!logger_hook_timer)
         {
-            fflush (logger_buffer->log_file);
             if (weechat_config_boolean (logger_config_file_fsync))
                 fsync (fileno (logger_buffer->log_file));
             logger_buffer->flush_needed = 0;
@@ -700,7 +742,7 @@ logger_stop (struct t_logger_buffer *logger_buffer, int write_info_line)
                               date_tmp) == 0)
                     buf_time[0] = '\0';
             }
-            logger_write_line (logger_buffer,
+            logger_write_line (logger_buffer, seconds,
                                _("%s\t****  End of log  ****"),
                                buf_time);
         }
@@ -797,8 +839,167 @@ logger_start_buffer_all (int write_info_line)
     }
 }
 
+/*
+ * Thread synchronizing log files with the storage device (so that the main
+ * loop is not blocked by disk I/O).
+ *
+ * File descriptors to sync are duplicated by the main thread (so that a log
+ * file can be closed while it is synchronized), they are closed by this
+ * thread after fsync.
+ *
+ * WARNING: no WeeChat function can be called in this thread.
+ */
+
+void *
+logger_fsync_thread_run (void *arg)
+{
+    int i, *fds, fds_count;
+
+    /* make C compiler happy */
+    (void) arg;
+
+    pthread_mutex_lock (&logger_fsync_mutex);
+
+    while (1)
+    {
+        while (!logger_fsync_quit && (logger_fsync_fds_count == 0))
+        {
+            pthread_cond_wait (&logger_fsync_cond, &logger_fsync_mutex);
+        }
+        /* files queued are synchronized before the thread exits */
+        if (logger_fsync_fds_count == 0)
+            break;
+
+        fds = logger_fsync_fds;
+        fds_count = logger_fsync_fds_count;
+        logger_fsync_fds = NULL;
+        logger_fsync_fds_count = 0;
+        logger_fsync_fds_size = 0;
+
+        pthread_mutex_unlock (&logger_fsync_mutex);
+
+        for (i = 0; i < fds_count; i++)
+        {
+            fsync (fds[i]);
+            close (fds[i]);
+        }
+        free (fds);
+
+        pthread_mutex_lock (&logger_fsync_mutex);
+    }
+
+    pthread_mutex_unlock (&logger_fsync_mutex);
+
+    return NULL;
+}
+
+/*
+ * Starts the thread synchronizing log files (if not already started).
+ *
+ * Returns:
+ *   1: OK
+ *   0: error
+ */
+
+int
+logger_fsync_thread_start ()
+{
+    sigset_t set, old_set;
+    int rc;
+
+    if (logger_fsync_thread_running)
+        return 1;
+
+    logger_fsync_quit = 0;
+
+    /* signals are blocked in thread (they are handled by main thread) */
+    sigfillset (&set);
+    pthread_sigmask (SIG_SETMASK, &set, &old_set);
+    rc = pthread_create (&logger_fsync_thread, NULL,
+                         &logger_fsync_thread_run, NULL);
+    pthread_sigmask (SIG_SETMASK, &old_set, NULL);
+    if (rc != 0)
+        return 0;
+
+    logger_fsync_thread_running = 1;
+
+    return 1;
+}
+
+/*
+ * Stops the thread synchronizing log files: files queued are synchronized,
+ * then the thread exits (this function waits for the end of thread).
+ */
+
+void
+logger_fsync_thread_stop ()
+{
+    if (!logger_fsync_thread_running)
+        return;
+
+    pthread_mutex_lock (&logger_fsync_mutex);
+    logger_fsync_quit = 1;
+    pthread_cond_signal (&logger_fsync_cond);
+    pthread_mutex_unlock (&logger_fsync_mutex);
+
+    pthread_join (logger_fsync_thread, NULL);
+
+    logger_fsync_thread_running = 0;
+}
+
+/*
+ * Synchronizes a log file with the storage device, in the thread (or directly
+ * if the thread can not be used).
+ */
+
+void
+logger_fsync (struct t_logger_buffer *logger_buffer)
+{
+    int fd, *new_fds, new_size;
+
+    fd = dup (fileno (logger_buffer->log_file));
+    if (fd < 0)
+    {
+        fsync (fileno (logger_buffer->log_file));
+        return;
+    }
+
+    if (!logger_fsync_thread_start ())
+    {
+        fsync (fd);
+        close (fd);
+        return;
+    }
+
+    pthread_mutex_lock (&logger_fsync_mutex);
+
+    if (logger_fsync_fds_count >= logger_fsync_fds_size)
+    {
+        new_size = (logger_fsync_fds_size > 0) ?
+            logger_fsync_fds_size * 2 : 16;
+        new_fds = realloc (logger_fsync_fds, new_size * sizeof (new_fds[0]));
+        if (!new_fds)
+        {
+            pthread_mutex_unlock (&logger_fsync_mutex);
+            fsync (fd);
+            close (fd);
+            return;
+        }
+        logger_fsync_fds = new_fds;
+        logger_fsync_fds_size = new_size;
+    }
+    logger_fsync_fds[logger_fsync_fds_count++] = fd;
+
+    pthread_cond_signal (&logger_fsync_cond);
+
+    pthread_mutex_unlock (&logger_fsync_mutex);
+}
+
 /*
  * Flushes all log files.
+ *
+ * If option logger.file.fsync is enabled, files flushed are synchronized with
+ * the storage device in a thread.
  */
 
 void
@@ -818,10 +1019,10 @@ logger_flush ()
                                           LOGGER_PLUGIN_NAME,
                                           ptr_logger_buffer->log_filename);
             }
-            fflush (ptr_logger_buffer->log_file);
-            if (weechat_config_boolean (logger_config_file_fsync))
-                fsync (fileno (ptr_logger_buffer->log_file));
+            logger_buffer_flush (ptr_logger_buffer);
             ptr_logger_buffer->flush_needed = 0;
+            if (weechat_config_boolean (logger_config_file_fsync))
+                logger_fsync (ptr_logger_buffer);
         }
     }
 }
@@ -1107,7 +1308,7 @@ logger_print_cb (const void *pointer, void *data,
         }
 
         logger_write_line (
-            ptr_logger_buffer,
+            ptr_logger_buffer, date,
             "%s\t%s%s%s\t%s%s",
             buf_time,
             (ptr_prefix && prefix_is_nick) ? weechat_config_string (logger_config_file_nick_prefix) : "",
@@ -1155,6 +1356,11 @@ weechat_plugin_init (struct t_weechat_plugin *plugin, int argc, char *argv[])
 
     weechat_plugin = plugin;
 
+    logger_charset = weechat_info_get ("charset_terminal", "");
+    logger_charset_is_utf8 = (logger_charset
+                              && (weechat_strcasecmp (logger_charset,
+                                                      "UTF-8") == 0));
+
     if (!logger_config_init ())
         return WEECHAT_RC_ERROR;
 
@@ -1212,7 +1418,15 @@ weechat_plugin_end (struct t_weechat_plugin *plugin)
 
     logger_stop_all (1);
 
+    logger_fsync_thread_stop ();
+
     logger_config_free ();
 
+    if (logger_charset)
+    {
+        free (logger_charset);
+        logger_charset = NULL;
+    }
+
     return WEECHAT_RC_OK;
 }
@@ -32,6 +32,7 @@ extern struct t_weechat_plugin *weechat_logger_plugin;
 
 extern struct t_hook *logger_hook_timer;
 extern struct t_hook *logger_hook_print;
+extern char *logger_charset;
 
 extern char *logger_build_option_name (struct t_gui_buffer *buffer);
 extern void logger_set_log_filename (struct t_logger_buffer *logger_buffer);
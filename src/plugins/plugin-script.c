@@ -360,7 +360,7 @@ plugin_script_str2ptr (struct t_weechat_plugin *weechat_plugin,
                        const char *str_pointer)
 {
     unsigned long value;
-    int rc;
+    char *error;
     struct t_gui_buffer *ptr_buffer;
 
     if (!str_pointer || !str_pointer[0])
@@ -369,8 +369,9 @@ plugin_script_str2ptr (struct t_weechat_plugin *weechat_plugin,
     if ((str_pointer[0] != '0') || (str_pointer[1] != 'x'))
         goto invalid;
 
-    rc = sscanf (str_pointer + 2, "%lx", &value);
-    if ((rc != EOF) && (rc >= 1))
+    error = NULL;
+    value = strtoul (str_pointer + 2, &error, 16);
+    if (error && (error != str_pointer + 2))
         return (void *)value;
 
 invalid:
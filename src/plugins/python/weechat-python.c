@@ -76,6 +76,13 @@ PyThreadState *python_current_interpreter = NULL;
 char *python2_bin = NULL;
 char **python_buffer_output = NULL;
 
+/*
+ * functions called in scripts (key: interpreter of script, value: hashtable
+ * with function name -> Python callable object); functions are searched in
+ * module "__main__" on first call only
+ */
+struct t_hashtable *python_functions = NULL;
+
 /* outputs subroutines */
 static PyObject *weechat_python_output (PyObject *self, PyObject *args);
 static PyMethodDef weechat_python_output_funcs[] = {
@@ -201,6 +208,19 @@ weechat_python_get_python2_bin ()
 char *
 weechat_python_unicode_to_string (PyObject *obj)
 {
+#if PY_VERSION_HEX >= 0x03030000
+    const char *ptr_utf8;
+
+    /* UTF-8 representation is cached in the object (no copy) */
+    ptr_utf8 = PyUnicode_AsUTF8 (obj);
+    if (!ptr_utf8)
+    {
+        PyErr_Clear ();
+        return NULL;
+    }
+
+    return strdup (ptr_utf8);
+#else
     PyObject *utf8string;
     char *str;
 
@@ -215,6 +235,7 @@ weechat_python_unicode_to_string (PyObject *obj)
     }
 
     return str;
+#endif /* PY_VERSION_HEX >= 0x03030000 */
 }
 
 /*
@@ -457,6 +478,177 @@ weechat_python_output (PyObject *self, PyObject *args)
     return Py_None;
 }
 
+/*
+ * Frees a Python function (callable object).
+ */
+
+void
+weechat_python_functions_free_function_cb (struct t_hashtable *hashtable,
+                                           const void *key, void *value)
+{
+    /* make C compiler happy */
+    (void) hashtable;
+    (void) key;
+
+    Py_XDECREF((PyObject *)value);
+}
+
+/*
+ * Frees functions of an interpreter.
+ */
+
+void
+weechat_python_functions_free_cb (struct t_hashtable *hashtable,
+                                  const void *key, void *value)
+{
+    /* make C compiler happy */
+    (void) hashtable;
+    (void) key;
+
+    weechat_hashtable_free ((struct t_hashtable *)value);
+}
+
+/*
+ * Gets a Python function by name: it is searched in dict of module "__main__"
+ * on first call only, then kept (with a reference) for this interpreter, until
+ * the end of interpreter (script unloaded or reloaded).
+ *
+ * The current interpreter must be the given interpreter.
+ *
+ * Returns a borrowed reference, NULL if function is not found or not callable.
+ */
+
+PyObject *
+weechat_python_functions_get (void *interpreter, const char *function)
+{
+    struct t_hashtable *ptr_functions;
+    PyObject *func;
+
+    if (!interpreter || !function)
+        return NULL;
+
+    if (!python_functions)
+    {
+        python_functions = weechat_hashtable_new (32,
+                                                  WEECHAT_HASHTABLE_POINTER,
+                                                  WEECHAT_HASHTABLE_POINTER,
+                                                  NULL, NULL);
+        if (!python_functions)
+            return NULL;
+        weechat_hashtable_set_pointer (python_functions,
+                                       "callback_free_value",
+                                       &weechat_python_functions_free_cb);
+    }
+
+    ptr_functions = weechat_hashtable_get (python_functions, interpreter);
+    if (!ptr_functions)
+    {
+        ptr_functions = weechat_hashtable_new (32,
+                                               WEECHAT_HASHTABLE_STRING,
+                                               WEECHAT_HASHTABLE_POINTER,
+                                               NULL, NULL);
+        if (!ptr_functions)
+            return NULL;
+        weechat_hashtable_set_pointer (ptr_functions,
+                                       "callback_free_value",
+                                       &weechat_python_functions_free_function_cb);
+        if (!weechat_hashtable_set (python_functions, interpreter,
+                                    ptr_functions))
+        {
+            weechat_hashtable_free (ptr_functions);
+            return NULL;
+        }
+    }
+
+    func = weechat_hashtable_get (ptr_functions, function);
+    if (func)
+        return func;
+
+    func = PyDict_GetItemString (
+        PyModule_GetDict (PyImport_AddModule ((char *) "__main__")),
+        function);
+    if (!func || !PyCallable_Check (func))
+        return NULL;
+
+    Py_INCREF(func);
+    if (!weechat_hashtable_set (ptr_functions, function, func))
+        Py_DECREF(func);
+
+    return func;
+}
+
+/*
+ * Frees functions of an interpreter (must be called before the end of
+ * interpreter, with this interpreter as current one).
+ */
+
+void
+weechat_python_functions_free (void *interpreter)
+{
+    if (python_functions && interpreter)
+        weechat_hashtable_remove (python_functions, interpreter);
+}
+
+/*
+ * Builds a tuple with arguments for a Python function.
+ *
+ * Strings are sent as "str" if they are valid UTF-8, otherwise as "bytes"
+ * (Python 3 only); other formats are converted with Py_BuildValue.
+ *
+ * Returns a new reference, NULL if error.
+ */
+
+PyObject *
+weechat_python_build_args (const char *format, void **argv)
+{
+    PyObject *args, *arg;
+    char format_arg[2];
+    int i, argc;
+
+    argc = strlen (format);
+    if (argc > 16)
+        argc = 16;
+
+    args = PyTuple_New (argc);
+    if (!args)
+        return NULL;
+
+    format_arg[1] = '\0';
+    for (i = 0; i < argc; i++)
+    {
+        if ((format[i] == 's') && argv[i])
+        {
+#if PY_MAJOR_VERSION >= 3
+            /* Python 3: str if valid UTF-8, otherwise bytes */
+            arg = PyUnicode_DecodeUTF8 ((const char *)argv[i],
+                                        strlen ((const char *)argv[i]),
+                                        NULL);
+            if (!arg)
+            {
+                PyErr_Clear ();
+                arg = PyBytes_FromString ((const char *)argv[i]);
+            }
+#else
+            /* Python 2: str */
+            arg = PyString_FromString ((const char *)argv[i]);
+#endif /* PY_MAJOR_VERSION >= 3 */
+        }
+        else
+        {
+            format_arg[0] = format[i];
+            arg = Py_BuildValue (format_arg, argv[i]);
+        }
+        if (!arg)
+        {
+            Py_DECREF(args);
+            return NULL;
+        }
+        PyTuple_SET_ITEM(args, i, arg);
+    }
+
+    return args;
+}
+
 /*
  * Executes a python function.
  */
@@ -468,10 +660,9 @@ weechat_python_exec (struct t_plugin_script *script,
 {
     struct t_plugin_script *old_python_current_script;
     PyThreadState *old_interpreter;
-    PyObject *evMain, *evDict, *evFunc, *rc;
-    void *argv2[16], *ret_value, *ret_temp;
-    char format2[17];
-    int i, argc, *ret_int;
+    PyObject *evMain, *evDict, *evFunc, *evArgs, *rc;
+    void *ret_value, *ret_temp;
+    int *ret_int;
 
     ret_value = NULL;
 
@@ -486,9 +677,17 @@ weechat_python_exec (struct t_plugin_script *script,
         PyThreadState_Swap (script->interpreter);
     }
 
-    evMain = PyImport_AddModule ((char *) "__main__");
-    evDict = PyModule_GetDict (evMain);
-    evFunc = PyDict_GetItemString (evDict, function);
+    if (script == python_script_eval)
+    {
+        /* functions of eval can be redefined by the user: never kept */
+        evMain = PyImport_AddModule ((char *) "__main__");
+        evDict = PyModule_GetDict (evMain);
+        evFunc = PyDict_GetItemString (evDict, function);
+    }
+    else
+    {
+        evFunc = weechat_python_functions_get (script->interpreter, function);
+    }
 
     if ( !(evFunc && PyCallable_Check (evFunc)) )
     {
@@ -501,48 +700,13 @@ weechat_python_exec (struct t_plugin_script *script,
 
     if (argv && argv[0])
     {
-        argc = strlen (format);
-        for (i = 0; i < 16; i++)
-        {
-            if (i < argc)
-            {
-                argv2[i] = argv[i];
-                if (format[i] == 's')
-                {
-#if PY_MAJOR_VERSION >= 3
-                    if (weechat_utf8_is_valid (argv2[i], -1, NULL))
-                        format2[i] = 's';  /* Python 3: str */
-                    else
-                        format2[i] = 'y';  /* Python 3: bytes */
-#else
-                    format2[i] = 's';  /* Python 2: str */
-#endif
-                }
-                else
-                {
-                    format2[i] = format[i];
-                }
-            }
-            else
-            {
-                argv2[i] = NULL;
-            }
-        }
-        format2[argc] = '\0';
-
-        rc = PyObject_CallFunction (evFunc, format2,
-                                    argv2[0], argv2[1],
-                                    argv2[2], argv2[3],
-                                    argv2[4], argv2[5],
-                                    argv2[6], argv2[7],
-                                    argv2[8], argv2[9],
-                                    argv2[10], argv2[11],
-                                    argv2[12], argv2[13],
-                                    argv2[14], argv2[15]);
+        evArgs = weechat_python_build_args (format, argv);
+        rc = (evArgs) ? PyObject_Call (evFunc, evArgs, NULL) : NULL;
+        Py_XDECREF(evArgs);
     }
     else
     {
-        rc = PyObject_CallFunction (evFunc, NULL);
+        rc = PyObject_CallObject (evFunc, NULL);
     }
 
     weechat_python_output_flush ();
@@ -945,6 +1109,7 @@ weechat_python_load (const char *filename, const char *code)
                 python_current_script = NULL;
             }
 
+            weechat_python_functions_free (python_current_interpreter);
             Py_EndInterpreter (python_current_interpreter);
             /* PyEval_ReleaseLock (); */
 
@@ -975,6 +1140,7 @@ weechat_python_load (const char *filename, const char *code)
                 python_current_script = NULL;
             }
 
+            weechat_python_functions_free (python_current_interpreter);
             Py_EndInterpreter (python_current_interpreter);
             /* PyEval_ReleaseLock (); */
 
@@ -995,6 +1161,7 @@ weechat_python_load (const char *filename, const char *code)
 
         if (PyErr_Occurred ())
             PyErr_Print ();
+        weechat_python_functions_free (python_current_interpreter);
         Py_EndInterpreter (python_current_interpreter);
         /* PyEval_ReleaseLock (); */
 
@@ -1075,6 +1242,7 @@ weechat_python_unload (struct t_plugin_script *script)
     if (interpreter)
     {
         PyThreadState_Swap (interpreter);
+        weechat_python_functions_free (interpreter);
         Py_EndInterpreter (interpreter);
     }
 
@@ -1703,6 +1871,12 @@ weechat_plugin_end (struct t_weechat_plugin *plugin)
     plugin_script_end (plugin, &python_data);
     python_quiet = 0;
 
+    if (python_functions)
+    {
+        weechat_hashtable_free (python_functions);
+        python_functions = NULL;
+    }
+
     /* free python interpreter */
     if (python_mainThreadState != NULL)
     {
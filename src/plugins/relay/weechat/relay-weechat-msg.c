@@ -65,6 +65,10 @@ relay_weechat_msg_new (const char *id)
     }
     new_msg->data_alloc = RELAY_WEECHAT_MSG_INITIAL_ALLOC;
     new_msg->data_size = 0;
+    new_msg->data_compressed = NULL;
+    new_msg->data_compressed_size = 0;
+    new_msg->compression_level = 0;
+    new_msg->compression_time = 0;
 
     /* add size and compression flag (they will be set later) */
     relay_weechat_msg_add_int (new_msg, 0);
@@ -89,6 +93,18 @@ relay_weechat_msg_add_bytes (struct t_relay_weechat_msg *msg,
     if (!msg || !msg->data)
         return;
 
+    /* message is changed: compressed message is not valid any more */
+    if (msg->compression_level > 0)
+    {
+        if (msg->data_compressed)
+        {
+            free (msg->data_compressed);
+            msg->data_compressed = NULL;
+        }
+        msg->data_compressed_size = 0;
+        msg->compression_level = 0;
+    }
+
     while (msg->data_size + size > msg->data_alloc)
     {
         msg->data_alloc *= 2;
@@ -1027,61 +1043,101 @@ relay_weechat_msg_add_nicklist (struct t_relay_weechat_msg *msg,
 }
 
 /*
- * Sends a message.
+ * Compresses a message with zlib, using the given compression level.
+ *
+ * The compressed message (with size and compression flag) is kept in the
+ * message, so that it can be sent to many clients with a single compression.
+ * If the compression fails or if the compressed message is not smaller than
+ * the message, "data_compressed" is set to NULL.
  */
 
 void
-relay_weechat_msg_send (struct t_relay_client *client,
-                        struct t_relay_weechat_msg *msg)
+relay_weechat_msg_compress (struct t_relay_weechat_msg *msg, int level)
 {
     uint32_t size32;
-    char compression, raw_message[1024];
     int rc;
     Bytef *dest;
     uLongf dest_size;
     struct timeval tv1, tv2;
-    long long time_diff;
 
-    if (weechat_config_integer (relay_config_network_compression_level) > 0)
+    if (!msg || !msg->data)
+        return;
+
+    if (msg->data_compressed)
+    {
+        free (msg->data_compressed);
+        msg->data_compressed = NULL;
+    }
+    msg->data_compressed_size = 0;
+    msg->compression_level = level;
+    msg->compression_time = 0;
+
+    dest_size = compressBound (msg->data_size - 5);
+    dest = malloc (dest_size + 5);
+    if (!dest)
+        return;
+
+    gettimeofday (&tv1, NULL);
+    rc = compress2 (dest + 5, &dest_size,
+                    (Bytef *)(msg->data + 5), msg->data_size - 5,
+                    level);
+    gettimeofday (&tv2, NULL);
+    msg->compression_time = weechat_util_timeval_diff (&tv1, &tv2);
+    if ((rc != Z_OK) || ((int)dest_size + 5 >= msg->data_size))
+    {
+        free (dest);
+        return;
+    }
+
+    /* set size and compression flag */
+    size32 = htonl ((uint32_t)(dest_size + 5));
+    memcpy (dest, &size32, 4);
+    dest[4] = RELAY_WEECHAT_COMPRESSION_ZLIB;
+
+    msg->data_compressed = (char *)dest;
+    msg->data_compressed_size = dest_size + 5;
+}
+
+/*
+ * Sends a message.
+ *
+ * The message can be sent to many clients: it is compressed only once (on
+ * first send to a client using compression).
+ */
+
+void
+relay_weechat_msg_send (struct t_relay_client *client,
+                        struct t_relay_weechat_msg *msg)
+{
+    uint32_t size32;
+    char compression, raw_message[1024];
+    int level;
+
+    level = weechat_config_integer (relay_config_network_compression_level);
+    if (level > 0)
     {
         switch (RELAY_WEECHAT_DATA(client, compression))
         {
             case RELAY_WEECHAT_COMPRESSION_ZLIB:
-                dest_size = compressBound (msg->data_size - 5);
-                dest = malloc (dest_size + 5);
-                if (dest)
+                if (msg->compression_level != level)
+                    relay_weechat_msg_compress (msg, level);
+                if (msg->data_compressed)
                 {
-                    gettimeofday (&tv1, NULL);
-                    rc = compress2 (dest + 5, &dest_size,
-                                    (Bytef *)(msg->data + 5), msg->data_size - 5,
-                                    weechat_config_integer (relay_config_network_compression_level));
-                    gettimeofday (&tv2, NULL);
-                    time_diff = weechat_util_timeval_diff (&tv1, &tv2);
-                    if ((rc == Z_OK) && ((int)dest_size + 5 < msg->data_size))
-                    {
-                        /* set size and compression flag */
-                        size32 = htonl ((uint32_t)(dest_size + 5));
-                        memcpy (dest, &size32, 4);
-                        dest[4] = RELAY_WEECHAT_COMPRESSION_ZLIB;
-
-                        /* display message in raw buffer */
-                        snprintf (raw_message, sizeof (raw_message),
-                                  "obj: %d/%d bytes (%d%%, %.2fms), id: %s",
-                                  (int)dest_size + 5,
-                                  msg->data_size,
-                                  100 - ((((int)dest_size + 5) * 100) / msg->data_size),
-                                  ((float)time_diff) / 1000,
-                                  msg->id);
-
-                        /* send compressed data */
-                        relay_client_send (client, RELAY_CLIENT_MSG_STANDARD,
-                                           (const char *)dest, dest_size + 5,
-                                           raw_message);
-
-                        free (dest);
-                        return;
-                    }
-                    free (dest);
+                    /* display message in raw buffer */
+                    snprintf (raw_message, sizeof (raw_message),
+                              "obj: %d/%d bytes (%d%%, %.2fms), id: %s",
+                              msg->data_compressed_size,
+                              msg->data_size,
+                              100 - ((msg->data_compressed_size * 100) / msg->data_size),
+                              ((float)msg->compression_time) / 1000,
+                              msg->id);
+
+                    /* send compressed data */
+                    relay_client_send (client, RELAY_CLIENT_MSG_STANDARD,
+                                       msg->data_compressed,
+                                       msg->data_compressed_size,
+                                       raw_message);
+                    return;
                 }
                 break;
             default:
@@ -1118,6 +1174,8 @@ relay_weechat_msg_free (struct t_relay_weechat_msg *msg)
         free (msg->id);
     if (msg->data)
         free (msg->data);
+    if (msg->data_compressed)
+        free (msg->data_compressed);
 
     free (msg);
 }
@@ -46,6 +46,12 @@ struct t_relay_weechat_msg
     char *data;                        /* binary buffer                     */
     int data_alloc;                    /* currently allocated size          */
     int data_size;                     /* current size of buffer            */
+    char *data_compressed;             /* compressed message (zlib), NULL   */
+                                       /* if compression failed or useless  */
+    int data_compressed_size;          /* size of compressed message        */
+    int compression_level;             /* level used for data_compressed    */
+                                       /* (0 = message not compressed yet)  */
+    long long compression_time;        /* time spent to compress (in µs)    */
 };
 
 extern struct t_relay_weechat_msg *relay_weechat_msg_new (const char *id);
@@ -81,6 +87,8 @@ extern void relay_weechat_msg_add_infolist (struct t_relay_weechat_msg *msg,
 extern void relay_weechat_msg_add_nicklist (struct t_relay_weechat_msg *msg,
                                             struct t_gui_buffer *buffer,
                                             struct t_relay_weechat_nicklist *nicklist);
+extern void relay_weechat_msg_compress (struct t_relay_weechat_msg *msg,
+                                        int level);
 extern void relay_weechat_msg_send (struct t_relay_client *client,
                                     struct t_relay_weechat_msg *msg);
 extern void relay_weechat_msg_free (struct t_relay_weechat_msg *msg);
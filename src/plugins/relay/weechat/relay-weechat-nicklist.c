@@ -45,6 +45,7 @@ relay_weechat_nicklist_new ()
 
     new_nicklist->nicklist_count = 0;
     new_nicklist->items_count = 0;
+    new_nicklist->items_size = 0;
     new_nicklist->items = NULL;
 
     return new_nicklist;
@@ -62,7 +63,7 @@ relay_weechat_nicklist_add_item (struct t_relay_weechat_nicklist *nicklist,
     struct t_relay_weechat_nicklist_item *new_items, *ptr_item;
     struct t_hdata *hdata;
     const char *str;
-    int i;
+    int i, new_size;
 
     /*
      * check if the last "parent_group" (with diff = '^') of items is the same
@@ -82,12 +83,17 @@ relay_weechat_nicklist_add_item (struct t_relay_weechat_nicklist *nicklist,
         }
     }
 
-    new_items = realloc (nicklist->items,
-                         (nicklist->items_count + 1) * sizeof (new_items[0]));
-    if (!new_items)
-        return;
+    /* grow array of items (size is doubled, for many diffs at once) */
+    if (nicklist->items_count >= nicklist->items_size)
+    {
+        new_size = (nicklist->items_size < 16) ? 16 : nicklist->items_size * 2;
+        new_items = realloc (nicklist->items, new_size * sizeof (new_items[0]));
+        if (!new_items)
+            return;
+        nicklist->items = new_items;
+        nicklist->items_size = new_size;
+    }
 
-    nicklist->items = new_items;
     ptr_item = &(nicklist->items[nicklist->items_count]);
     if (group)
     {
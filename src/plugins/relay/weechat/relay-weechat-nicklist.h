@@ -44,6 +44,7 @@ struct t_relay_weechat_nicklist
     int nicklist_count;                /* number of nicks in nicklist       */
                                        /* before receiving first diff       */
     int items_count;                   /* number of nicklist items          */
+    int items_size;                    /* number of items allocated         */
     struct t_relay_weechat_nicklist_item *items; /* nicklist items          */
 };
 
@@ -841,7 +841,67 @@ error:
 }
 
 /*
- * Callback for signals "buffer_*".
+ * Checks if a client receives signals "buffer_*".
+ *
+ * Returns:
+ *   1: client receives signals "buffer_*"
+ *   0: client does not receive signals "buffer_*"
+ */
+
+int
+relay_weechat_protocol_client_signal_buffer (struct t_relay_client *client)
+{
+    return ((client->protocol == RELAY_PROTOCOL_WEECHAT)
+            && client->protocol_data
+            && RELAY_WEECHAT_DATA(client, signal_buffer)) ? 1 : 0;
+}
+
+/*
+ * Sends a message for a signal "buffer_*" to all clients synchronized with
+ * the buffer (with at least one of the flags given).
+ *
+ * The message is built only once (and compressed at most once) for all
+ * clients.
+ */
+
+void
+relay_weechat_protocol_signal_buffer_send (const char *signal,
+                                           struct t_gui_buffer *buffer,
+                                           int flags,
+                                           const char *hdata_path,
+                                           const char *hdata_keys)
+{
+    struct t_relay_client *ptr_client;
+    struct t_relay_weechat_msg *msg;
+    char str_signal[128];
+
+    msg = NULL;
+
+    for (ptr_client = relay_clients; ptr_client;
+         ptr_client = ptr_client->next_client)
+    {
+        if (!relay_weechat_protocol_client_signal_buffer (ptr_client)
+            || !relay_weechat_protocol_is_sync (ptr_client, buffer, flags))
+        {
+            continue;
+        }
+        if (!msg)
+        {
+            snprintf (str_signal, sizeof (str_signal), "_%s", signal);
+            msg = relay_weechat_msg_new (str_signal);
+            if (!msg)
+                return;
+            relay_weechat_msg_add_hdata (msg, hdata_path, hdata_keys);
+        }
+        relay_weechat_msg_send (ptr_client, msg);
+    }
+
+    if (msg)
+        relay_weechat_msg_free (msg);
+}
+
+/*
+ * Callback for signals "buffer_*" (hook shared by all clients).
  */
 
 int
@@ -855,21 +915,15 @@ relay_weechat_protocol_signal_buffer_cb (const void *pointer, void *data,
     struct t_hdata *ptr_hdata_line, *ptr_hdata_line_data;
     struct t_gui_line_data *ptr_line_data;
     struct t_gui_buffer *ptr_buffer;
-    struct t_relay_weechat_msg *msg;
-    char cmd_hdata[64], str_signal[128];
+    char cmd_hdata[64];
     const char *ptr_old_full_name;
     int *ptr_old_flags, flags;
 
     /* make C compiler happy */
+    (void) pointer;
     (void) data;
     (void) type_data;
 
-    ptr_client = (struct t_relay_client *)pointer;
-    if (!ptr_client || !relay_client_valid (ptr_client))
-        return WEECHAT_RC_OK;
-
-    snprintf (str_signal, sizeof (str_signal), "_%s", signal);
-
     if (strcmp (signal, "buffer_opened") == 0)
     {
         ptr_buffer = (struct t_gui_buffer *)signal_data;
@@ -877,23 +931,15 @@ relay_weechat_protocol_signal_buffer_cb (const void *pointer, void *data,
             return WEECHAT_RC_OK;
 
         /* send signal only if sync with flag "buffers" or "buffer" */
-        if (relay_weechat_protocol_is_sync (ptr_client, ptr_buffer,
-                                            RELAY_WEECHAT_PROTOCOL_SYNC_BUFFERS |
-                                            RELAY_WEECHAT_PROTOCOL_SYNC_BUFFER))
-        {
-            msg = relay_weechat_msg_new (str_signal);
-            if (msg)
-            {
-                snprintf (cmd_hdata, sizeof (cmd_hdata),
-                          "buffer:0x%lx", (unsigned long)ptr_buffer);
-                relay_weechat_msg_add_hdata (msg, cmd_hdata,
-                                             "number,full_name,short_name,"
-                                             "nicklist,title,local_variables,"
-                                             "prev_buffer,next_buffer");
-                relay_weechat_msg_send (ptr_client, msg);
-                relay_weechat_msg_free (msg);
-            }
-        }
+        snprintf (cmd_hdata, sizeof (cmd_hdata),
+                  "buffer:0x%lx", (unsigned long)ptr_buffer);
+        relay_weechat_protocol_signal_buffer_send (
+            signal, ptr_buffer,
+            RELAY_WEECHAT_PROTOCOL_SYNC_BUFFERS |
+            RELAY_WEECHAT_PROTOCOL_SYNC_BUFFER,
+            cmd_hdata,
+            "number,full_name,short_name,nicklist,title,local_variables,"
+            "prev_buffer,next_buffer");
     }
     else if (strcmp (signal, "buffer_type_changed") == 0)
     {
@@ -902,72 +948,19 @@ relay_weechat_protocol_signal_buffer_cb (const void *pointer, void *data,
             return WEECHAT_RC_OK;
 
         /* send signal only if sync with flag "buffers" or "buffer" */
-        if (relay_weechat_protocol_is_sync (ptr_client, ptr_buffer,
-                                            RELAY_WEECHAT_PROTOCOL_SYNC_BUFFERS |
-                                            RELAY_WEECHAT_PROTOCOL_SYNC_BUFFER))
-        {
-            msg = relay_weechat_msg_new (str_signal);
-            if (msg)
-            {
-                snprintf (cmd_hdata, sizeof (cmd_hdata),
-                          "buffer:0x%lx", (unsigned long)ptr_buffer);
-                relay_weechat_msg_add_hdata (msg, cmd_hdata,
-                                             "number,full_name,type");
-                relay_weechat_msg_send (ptr_client, msg);
-                relay_weechat_msg_free (msg);
-            }
-        }
-    }
-    else if (strcmp (signal, "buffer_moved") == 0)
-    {
-        ptr_buffer = (struct t_gui_buffer *)signal_data;
-        if (!ptr_buffer)
-            return WEECHAT_RC_OK;
-
-        /* send signal only if sync with flag "buffers" or "buffer" */
-        if (relay_weechat_protocol_is_sync (ptr_client, ptr_buffer,
-                                            RELAY_WEECHAT_PROTOCOL_SYNC_BUFFERS |
-                                            RELAY_WEECHAT_PROTOCOL_SYNC_BUFFER))
-        {
-            msg = relay_weechat_msg_new (str_signal);
-            if (msg)
-            {
-                snprintf (cmd_hdata, sizeof (cmd_hdata),
-                          "buffer:0x%lx", (unsigned long)ptr_buffer);
-                relay_weechat_msg_add_hdata (msg, cmd_hdata,
-                                             "number,full_name,"
-                                             "prev_buffer,next_buffer");
-                relay_weechat_msg_send (ptr_client, msg);
-                relay_weechat_msg_free (msg);
-            }
-        }
-    }
-    else if ((strcmp (signal, "buffer_merged") == 0)
-             || (strcmp (signal, "buffer_unmerged") == 0))
-    {
-        ptr_buffer = (struct t_gui_buffer *)signal_data;
-        if (!ptr_buffer)
-            return WEECHAT_RC_OK;
-
-        /* send signal only if sync with flag "buffers" or "buffer" */
-        if (relay_weechat_protocol_is_sync (ptr_client, ptr_buffer,
-                                            RELAY_WEECHAT_PROTOCOL_SYNC_BUFFERS |
-                                            RELAY_WEECHAT_PROTOCOL_SYNC_BUFFER))
-        {
-            msg = relay_weechat_msg_new (str_signal);
-            if (msg)
-            {
-                snprintf (cmd_hdata, sizeof (cmd_hdata),
-                          "buffer:0x%lx", (unsigned long)ptr_buffer);
-                relay_weechat_msg_add_hdata (msg, cmd_hdata,
-                                             "number,full_name,"
-                                             "prev_buffer,next_buffer");
-                relay_weechat_msg_send (ptr_client, msg);
-                relay_weechat_msg_free (msg);
-            }
-        }
+        snprintf (cmd_hdata, sizeof (cmd_hdata),
+                  "buffer:0x%lx", (unsigned long)ptr_buffer);
+        relay_weechat_protocol_signal_buffer_send (
+            signal, ptr_buffer,
+            RELAY_WEECHAT_PROTOCOL_SYNC_BUFFERS |
+            RELAY_WEECHAT_PROTOCOL_SYNC_BUFFER,
+            cmd_hdata,
+            "number,full_name,type");
     }
-    else if ((strcmp (signal, "buffer_hidden") == 0)
+    else if ((strcmp (signal, "buffer_moved") == 0)
+             || (strcmp (signal, "buffer_merged") == 0)
+             || (strcmp (signal, "buffer_unmerged") == 0)
+             || (strcmp (signal, "buffer_hidden") == 0)
              || (strcmp (signal, "buffer_unhidden") == 0))
     {
         ptr_buffer = (struct t_gui_buffer *)signal_data;
@@ -975,22 +968,14 @@ relay_weechat_protocol_signal_buffer_cb (const void *pointer, void *data,
             return WEECHAT_RC_OK;
 
         /* send signal only if sync with flag "buffers" or "buffer" */
-        if (relay_weechat_protocol_is_sync (ptr_client, ptr_buffer,
-                                            RELAY_WEECHAT_PROTOCOL_SYNC_BUFFERS |
-                                            RELAY_WEECHAT_PROTOCOL_SYNC_BUFFER))
-        {
-            msg = relay_weechat_msg_new (str_signal);
-            if (msg)
-            {
-                snprintf (cmd_hdata, sizeof (cmd_hdata),
-                          "buffer:0x%lx", (unsigned long)ptr_buffer);
-                relay_weechat_msg_add_hdata (msg, cmd_hdata,
-                                             "number,full_name,"
-                                             "prev_buffer,next_buffer");
-                relay_weechat_msg_send (ptr_client, msg);
-                relay_weechat_msg_free (msg);
-            }
-        }
+        snprintf (cmd_hdata, sizeof (cmd_hdata),
+                  "buffer:0x%lx", (unsigned long)ptr_buffer);
+        relay_weechat_protocol_signal_buffer_send (
+            signal, ptr_buffer,
+            RELAY_WEECHAT_PROTOCOL_SYNC_BUFFERS |
+            RELAY_WEECHAT_PROTOCOL_SYNC_BUFFER,
+            cmd_hdata,
+            "number,full_name,prev_buffer,next_buffer");
     }
     else if (strcmp (signal, "buffer_renamed") == 0)
     {
@@ -1003,39 +988,37 @@ relay_weechat_protocol_signal_buffer_cb (const void *pointer, void *data,
                                                        "old_full_name");
         if (ptr_old_full_name && ptr_old_full_name[0])
         {
-            ptr_old_flags = weechat_hashtable_get (
-                RELAY_WEECHAT_DATA(ptr_client, buffers_sync),
-                ptr_old_full_name);
-            if (ptr_old_flags)
+            for (ptr_client = relay_clients; ptr_client;
+                 ptr_client = ptr_client->next_client)
             {
-                flags = *ptr_old_flags;
-                weechat_hashtable_remove (
+                if (!relay_weechat_protocol_client_signal_buffer (ptr_client))
+                    continue;
+                ptr_old_flags = weechat_hashtable_get (
                     RELAY_WEECHAT_DATA(ptr_client, buffers_sync),
                     ptr_old_full_name);
-                weechat_hashtable_set (
-                    RELAY_WEECHAT_DATA(ptr_client, buffers_sync),
-                    weechat_buffer_get_string (ptr_buffer, "full_name"),
-                    &flags);
+                if (ptr_old_flags)
+                {
+                    flags = *ptr_old_flags;
+                    weechat_hashtable_remove (
+                        RELAY_WEECHAT_DATA(ptr_client, buffers_sync),
+                        ptr_old_full_name);
+                    weechat_hashtable_set (
+                        RELAY_WEECHAT_DATA(ptr_client, buffers_sync),
+                        weechat_buffer_get_string (ptr_buffer, "full_name"),
+                        &flags);
+                }
             }
         }
 
         /* send signal only if sync with flag "buffers" or "buffer" */
-        if (relay_weechat_protocol_is_sync (ptr_client, ptr_buffer,
-                                            RELAY_WEECHAT_PROTOCOL_SYNC_BUFFERS |
-                                            RELAY_WEECHAT_PROTOCOL_SYNC_BUFFER))
-        {
-            msg = relay_weechat_msg_new (str_signal);
-            if (msg)
-            {
-                snprintf (cmd_hdata, sizeof (cmd_hdata),
-                          "buffer:0x%lx", (unsigned long)ptr_buffer);
-                relay_weechat_msg_add_hdata (msg, cmd_hdata,
-                                             "number,full_name,short_name,"
-                                             "local_variables");
-                relay_weechat_msg_send (ptr_client, msg);
-                relay_weechat_msg_free (msg);
-            }
-        }
+        snprintf (cmd_hdata, sizeof (cmd_hdata),
+                  "buffer:0x%lx", (unsigned long)ptr_buffer);
+        relay_weechat_protocol_signal_buffer_send (
+            signal, ptr_buffer,
+            RELAY_WEECHAT_PROTOCOL_SYNC_BUFFERS |
+            RELAY_WEECHAT_PROTOCOL_SYNC_BUFFER,
+            cmd_hdata,
+            "number,full_name,short_name,local_variables");
     }
     else if (strcmp (signal, "buffer_title_changed") == 0)
     {
@@ -1044,21 +1027,14 @@ relay_weechat_protocol_signal_buffer_cb (const void *pointer, void *data,
             return WEECHAT_RC_OK;
 
         /* send signal only if sync with flag "buffers" or "buffer" */
-        if (relay_weechat_protocol_is_sync (ptr_client, ptr_buffer,
-                                            RELAY_WEECHAT_PROTOCOL_SYNC_BUFFERS |
-                                            RELAY_WEECHAT_PROTOCOL_SYNC_BUFFER))
-        {
-            msg = relay_weechat_msg_new (str_signal);
-            if (msg)
-            {
-                snprintf (cmd_hdata, sizeof (cmd_hdata),
-                          "buffer:0x%lx", (unsigned long)ptr_buffer);
-                relay_weechat_msg_add_hdata (msg, cmd_hdata,
-                                             "number,full_name,title");
-                relay_weechat_msg_send (ptr_client, msg);
-                relay_weechat_msg_free (msg);
-            }
-        }
+        snprintf (cmd_hdata, sizeof (cmd_hdata),
+                  "buffer:0x%lx", (unsigned long)ptr_buffer);
+        relay_weechat_protocol_signal_buffer_send (
+            signal, ptr_buffer,
+            RELAY_WEECHAT_PROTOCOL_SYNC_BUFFERS |
+            RELAY_WEECHAT_PROTOCOL_SYNC_BUFFER,
+            cmd_hdata,
+            "number,full_name,title");
     }
     else if (strncmp (signal, "buffer_localvar_", 16) == 0)
     {
@@ -1067,21 +1043,14 @@ relay_weechat_protocol_signal_buffer_cb (const void *pointer, void *data,
             return WEECHAT_RC_OK;
 
         /* send signal only if sync with flag "buffers" or "buffer" */
-        if (relay_weechat_protocol_is_sync (ptr_client, ptr_buffer,
-                                            RELAY_WEECHAT_PROTOCOL_SYNC_BUFFERS |
-                                            RELAY_WEECHAT_PROTOCOL_SYNC_BUFFER))
-        {
-            msg = relay_weechat_msg_new (str_signal);
-            if (msg)
-            {
-                snprintf (cmd_hdata, sizeof (cmd_hdata),
-                          "buffer:0x%lx", (unsigned long)ptr_buffer);
-                relay_weechat_msg_add_hdata (msg, cmd_hdata,
-                                             "number,full_name,local_variables");
-                relay_weechat_msg_send (ptr_client, msg);
-                relay_weechat_msg_free (msg);
-            }
-        }
+        snprintf (cmd_hdata, sizeof (cmd_hdata),
+                  "buffer:0x%lx", (unsigned long)ptr_buffer);
+        relay_weechat_protocol_signal_buffer_send (
+            signal, ptr_buffer,
+            RELAY_WEECHAT_PROTOCOL_SYNC_BUFFERS |
+            RELAY_WEECHAT_PROTOCOL_SYNC_BUFFER,
+            cmd_hdata,
+            "number,full_name,local_variables");
     }
     else if (strcmp (signal, "buffer_cleared") == 0)
     {
@@ -1090,20 +1059,13 @@ relay_weechat_protocol_signal_buffer_cb (const void *pointer, void *data,
             return WEECHAT_RC_OK;
 
         /* send signal only if sync with flag "buffer" */
-        if (relay_weechat_protocol_is_sync (ptr_client, ptr_buffer,
-                                            RELAY_WEECHAT_PROTOCOL_SYNC_BUFFER))
-        {
-            msg = relay_weechat_msg_new (str_signal);
-            if (msg)
-            {
-                snprintf (cmd_hdata, sizeof (cmd_hdata),
-                          "buffer:0x%lx", (unsigned long)ptr_buffer);
-                relay_weechat_msg_add_hdata (msg, cmd_hdata,
-                                             "number,full_name");
-                relay_weechat_msg_send (ptr_client, msg);
-                relay_weechat_msg_free (msg);
-            }
-        }
+        snprintf (cmd_hdata, sizeof (cmd_hdata),
+                  "buffer:0x%lx", (unsigned long)ptr_buffer);
+        relay_weechat_protocol_signal_buffer_send (
+            signal, ptr_buffer,
+            RELAY_WEECHAT_PROTOCOL_SYNC_BUFFER,
+            cmd_hdata,
+            "number,full_name");
     }
     else if (strcmp (signal, "buffer_line_added") == 0)
     {
@@ -1129,24 +1091,15 @@ relay_weechat_protocol_signal_buffer_cb (const void *pointer, void *data,
             return WEECHAT_RC_OK;
 
         /* send signal only if sync with flag "buffer" */
-        if (relay_weechat_protocol_is_sync (ptr_client, ptr_buffer,
-                                            RELAY_WEECHAT_PROTOCOL_SYNC_BUFFER))
-        {
-            msg = relay_weechat_msg_new (str_signal);
-            if (msg)
-            {
-                snprintf (cmd_hdata, sizeof (cmd_hdata),
-                          "line_data:0x%lx",
-                          (unsigned long)ptr_line_data);
-                relay_weechat_msg_add_hdata (msg, cmd_hdata,
-                                             "buffer,date,date_printed,"
-                                             "displayed,notify_level,"
-                                             "highlight,tags_array,prefix,"
-                                             "message");
-                relay_weechat_msg_send (ptr_client, msg);
-                relay_weechat_msg_free (msg);
-            }
-        }
+        snprintf (cmd_hdata, sizeof (cmd_hdata),
+                  "line_data:0x%lx",
+                  (unsigned long)ptr_line_data);
+        relay_weechat_protocol_signal_buffer_send (
+            signal, ptr_buffer,
+            RELAY_WEECHAT_PROTOCOL_SYNC_BUFFER,
+            cmd_hdata,
+            "buffer,date,date_printed,displayed,notify_level,highlight,"
+            "tags_array,prefix,message");
     }
     else if (strcmp (signal, "buffer_closing") == 0)
     {
@@ -1155,119 +1108,65 @@ relay_weechat_protocol_signal_buffer_cb (const void *pointer, void *data,
             return WEECHAT_RC_OK;
 
         /* send signal only if sync with flag "buffers" or "buffer" */
-        if (relay_weechat_protocol_is_sync (ptr_client, ptr_buffer,
-                                            RELAY_WEECHAT_PROTOCOL_SYNC_BUFFERS |
-                                            RELAY_WEECHAT_PROTOCOL_SYNC_BUFFER))
-        {
-            msg = relay_weechat_msg_new (str_signal);
-            if (msg)
-            {
-                snprintf (cmd_hdata, sizeof (cmd_hdata),
-                          "buffer:0x%lx", (unsigned long)ptr_buffer);
-                relay_weechat_msg_add_hdata (msg, cmd_hdata,
-                                             "number,full_name");
-                relay_weechat_msg_send (ptr_client, msg);
-                relay_weechat_msg_free (msg);
-            }
-        }
+        snprintf (cmd_hdata, sizeof (cmd_hdata),
+                  "buffer:0x%lx", (unsigned long)ptr_buffer);
+        relay_weechat_protocol_signal_buffer_send (
+            signal, ptr_buffer,
+            RELAY_WEECHAT_PROTOCOL_SYNC_BUFFERS |
+            RELAY_WEECHAT_PROTOCOL_SYNC_BUFFER,
+            cmd_hdata,
+            "number,full_name");
 
         /* remove buffer from hashtables */
-        weechat_hashtable_remove (
-            RELAY_WEECHAT_DATA(ptr_client, buffers_sync),
-            weechat_buffer_get_string (ptr_buffer, "full_name"));
-        weechat_hashtable_remove (
-            RELAY_WEECHAT_DATA(ptr_client, buffers_nicklist),
-            ptr_buffer);
+        for (ptr_client = relay_clients; ptr_client;
+             ptr_client = ptr_client->next_client)
+        {
+            if (!relay_weechat_protocol_client_signal_buffer (ptr_client))
+                continue;
+            weechat_hashtable_remove (
+                RELAY_WEECHAT_DATA(ptr_client, buffers_sync),
+                weechat_buffer_get_string (ptr_buffer, "full_name"));
+        }
+        if (relay_weechat_buffers_nicklist)
+            weechat_hashtable_remove (relay_weechat_buffers_nicklist,
+                                      ptr_buffer);
     }
 
     return WEECHAT_RC_OK;
 }
 
 /*
- * Callback for entries in hashtable "buffers_nicklist" of client (sends
- * nicklist for each buffer in this hashtable).
+ * Checks if at least one client is synchronized with nicklist of a buffer.
+ *
+ * Returns:
+ *   1: at least one client is synchronized with nicklist of buffer
+ *   0: no client is synchronized with nicklist of buffer
  */
 
-void
-relay_weechat_protocol_nicklist_map_cb (void *data,
-                                        struct t_hashtable *hashtable,
-                                        const void *key,
-                                        const void *value)
+int
+relay_weechat_protocol_nicklist_is_sync (struct t_gui_buffer *buffer)
 {
     struct t_relay_client *ptr_client;
-    struct t_gui_buffer *ptr_buffer;
-    struct t_relay_weechat_nicklist *ptr_nicklist;
-    struct t_hdata *ptr_hdata;
-    struct t_relay_weechat_msg *msg;
-
-    /* make C compiler happy */
-    (void) hashtable;
 
-    ptr_client = (struct t_relay_client *)data;
-    ptr_buffer = (struct t_gui_buffer *)key;
-    ptr_nicklist = (struct t_relay_weechat_nicklist *)value;
-
-    ptr_hdata = weechat_hdata_get ("buffer");
-    if (ptr_hdata)
+    for (ptr_client = relay_clients; ptr_client;
+         ptr_client = ptr_client->next_client)
     {
-        if (weechat_hdata_check_pointer (ptr_hdata,
-                                         weechat_hdata_get_list (ptr_hdata, "gui_buffers"),
-                                         ptr_buffer))
+        if (relay_weechat_protocol_client_signal_buffer (ptr_client)
+            && relay_weechat_protocol_is_sync (
+                ptr_client, buffer, RELAY_WEECHAT_PROTOCOL_SYNC_NICKLIST))
         {
-            /*
-             * if no diff at all, or if diffs are bigger than nicklist:
-             * send whole nicklist
-             */
-            if (ptr_nicklist
-                && ((ptr_nicklist->items_count == 0)
-                    || (ptr_nicklist->items_count >= weechat_buffer_get_integer (ptr_buffer, "nicklist_count") + 1)))
-            {
-                ptr_nicklist = NULL;
-            }
-
-            /* send nicklist diffs or full nicklist */
-            msg = relay_weechat_msg_new ((ptr_nicklist) ? "_nicklist_diff" : "_nicklist");
-            if (msg)
-            {
-                relay_weechat_msg_add_nicklist (msg, ptr_buffer, ptr_nicklist);
-                relay_weechat_msg_send (ptr_client, msg);
-                relay_weechat_msg_free (msg);
-            }
+            return 1;
         }
     }
-}
-
-/*
- * Callback for nicklist timer.
- */
-
-int
-relay_weechat_protocol_timer_nicklist_cb (const void *pointer, void *data,
-                                          int remaining_calls)
-{
-    struct t_relay_client *ptr_client;
 
-    /* make C compiler happy */
-    (void) data;
-    (void) remaining_calls;
-
-    ptr_client = (struct t_relay_client *)pointer;
-    if (!ptr_client || !relay_client_valid (ptr_client))
-        return WEECHAT_RC_OK;
-
-    weechat_hashtable_map (RELAY_WEECHAT_DATA(ptr_client, buffers_nicklist),
-                           &relay_weechat_protocol_nicklist_map_cb,
-                           ptr_client);
-
-    weechat_hashtable_remove_all (RELAY_WEECHAT_DATA(ptr_client, buffers_nicklist));
-
-    RELAY_WEECHAT_DATA(ptr_client, hook_timer_nicklist) = NULL;
-
-    return WEECHAT_RC_OK;
+    return 0;
 }
 
 /*
- * Callback for hsignals "nicklist_*".
+ * Callback for hsignals "nicklist_*" (hook shared by all clients).
+ *
+ * The changes are stored in a nicklist diff for the buffer, which is sent to
+ * clients on signal "nicklist_updated".
  */
 
 int
@@ -1275,7 +1174,6 @@ relay_weechat_protocol_hsignal_nicklist_cb (const void *pointer, void *data,
                                             const char *signal,
                                             struct t_hashtable *hashtable)
 {
-    struct t_relay_client *ptr_client;
     struct t_gui_nick_group *parent_group, *group;
     struct t_gui_nick *nick;
     struct t_gui_buffer *ptr_buffer;
@@ -1283,16 +1181,10 @@ relay_weechat_protocol_hsignal_nicklist_cb (const void *pointer, void *data,
     char diff;
 
     /* make C compiler happy */
+    (void) pointer;
     (void) data;
 
-    ptr_client = (struct t_relay_client *)pointer;
-    if (!ptr_client || !relay_client_valid (ptr_client))
-        return WEECHAT_RC_OK;
-
-    /* check if buffer is synchronized with flag "nicklist" */
-    ptr_buffer = weechat_hashtable_get (hashtable, "buffer");
-    if (!relay_weechat_protocol_is_sync (ptr_client, ptr_buffer,
-                                         RELAY_WEECHAT_PROTOCOL_SYNC_NICKLIST))
+    if (!relay_weechat_buffers_nicklist)
         return WEECHAT_RC_OK;
 
     parent_group = weechat_hashtable_get (hashtable, "parent_group");
@@ -1303,21 +1195,6 @@ relay_weechat_protocol_hsignal_nicklist_cb (const void *pointer, void *data,
     if (!parent_group)
         return WEECHAT_RC_OK;
 
-    ptr_nicklist = weechat_hashtable_get (RELAY_WEECHAT_DATA(ptr_client,
-                                                             buffers_nicklist),
-                                          ptr_buffer);
-    if (!ptr_nicklist)
-    {
-        ptr_nicklist = relay_weechat_nicklist_new ();
-        if (!ptr_nicklist)
-            return WEECHAT_RC_OK;
-        ptr_nicklist->nicklist_count = weechat_buffer_get_integer (ptr_buffer,
-                                                                   "nicklist_count");
-        weechat_hashtable_set (RELAY_WEECHAT_DATA(ptr_client, buffers_nicklist),
-                               ptr_buffer,
-                               ptr_nicklist);
-    }
-
     /* set diff type */
     diff = RELAY_WEECHAT_NICKLIST_DIFF_UNKNOWN;
     if ((strcmp (signal, "nicklist_group_added") == 0)
@@ -1336,30 +1213,118 @@ relay_weechat_protocol_hsignal_nicklist_cb (const void *pointer, void *data,
         diff = RELAY_WEECHAT_NICKLIST_DIFF_CHANGED;
     }
 
-    if (diff != RELAY_WEECHAT_NICKLIST_DIFF_UNKNOWN)
+    if (diff == RELAY_WEECHAT_NICKLIST_DIFF_UNKNOWN)
+        return WEECHAT_RC_OK;
+
+    ptr_buffer = weechat_hashtable_get (hashtable, "buffer");
+
+    ptr_nicklist = weechat_hashtable_get (relay_weechat_buffers_nicklist,
+                                          ptr_buffer);
+    if (!ptr_nicklist)
     {
-        /*
-         * add items if nicklist was not empty or very small (otherwise we will
-         * send full nicklist)
-         */
-        if (ptr_nicklist->nicklist_count > 1)
-        {
-            /* add nicklist item for parent group and group/nick */
-            relay_weechat_nicklist_add_item (ptr_nicklist,
-                                             RELAY_WEECHAT_NICKLIST_DIFF_PARENT,
-                                             parent_group, NULL);
-            relay_weechat_nicklist_add_item (ptr_nicklist, diff, group, nick);
-        }
+        /* check if buffer is synchronized with flag "nicklist" */
+        if (!relay_weechat_protocol_nicklist_is_sync (ptr_buffer))
+            return WEECHAT_RC_OK;
+
+        ptr_nicklist = relay_weechat_nicklist_new ();
+        if (!ptr_nicklist)
+            return WEECHAT_RC_OK;
+        ptr_nicklist->nicklist_count = weechat_buffer_get_integer (ptr_buffer,
+                                                                   "nicklist_count");
+        weechat_hashtable_set (relay_weechat_buffers_nicklist,
+                               ptr_buffer,
+                               ptr_nicklist);
+    }
 
-        /* add timer to send nicklist */
-        if (RELAY_WEECHAT_DATA(ptr_client, hook_timer_nicklist))
+    /*
+     * add items if nicklist was not empty or very small (otherwise we will
+     * send full nicklist)
+     */
+    if (ptr_nicklist->nicklist_count > 1)
+    {
+        /* add nicklist item for parent group and group/nick */
+        relay_weechat_nicklist_add_item (ptr_nicklist,
+                                         RELAY_WEECHAT_NICKLIST_DIFF_PARENT,
+                                         parent_group, NULL);
+        relay_weechat_nicklist_add_item (ptr_nicklist, diff, group, nick);
+    }
+
+    return WEECHAT_RC_OK;
+}
+
+/*
+ * Callback for signal "nicklist_updated" (hook shared by all clients).
+ *
+ * Sends the nicklist diff (or the whole nicklist) of buffer to all clients
+ * synchronized with nicklist of buffer; the message is built only once for
+ * all clients.
+ */
+
+int
+relay_weechat_protocol_signal_nicklist_cb (const void *pointer, void *data,
+                                           const char *signal,
+                                           const char *type_data,
+                                           void *signal_data)
+{
+    struct t_relay_client *ptr_client;
+    struct t_gui_buffer *ptr_buffer;
+    struct t_relay_weechat_nicklist *ptr_nicklist;
+    struct t_relay_weechat_msg *msg;
+
+    /* make C compiler happy */
+    (void) pointer;
+    (void) data;
+    (void) signal;
+    (void) type_data;
+
+    if (!relay_weechat_buffers_nicklist)
+        return WEECHAT_RC_OK;
+
+    ptr_buffer = (struct t_gui_buffer *)signal_data;
+
+    ptr_nicklist = weechat_hashtable_get (relay_weechat_buffers_nicklist,
+                                          ptr_buffer);
+    if (!ptr_nicklist)
+        return WEECHAT_RC_OK;
+
+    /*
+     * if no diff at all, or if diffs are bigger than nicklist:
+     * send whole nicklist
+     */
+    msg = NULL;
+    if ((ptr_nicklist->items_count == 0)
+        || (ptr_nicklist->items_count >= weechat_buffer_get_integer (ptr_buffer, "nicklist_count") + 1))
+    {
+        msg = relay_weechat_msg_new ("_nicklist");
+        if (msg)
+            relay_weechat_msg_add_nicklist (msg, ptr_buffer, NULL);
+    }
+    else
+    {
+        msg = relay_weechat_msg_new ("_nicklist_diff");
+        if (msg)
+            relay_weechat_msg_add_nicklist (msg, ptr_buffer, ptr_nicklist);
+    }
+
+    /* send nicklist diffs or full nicklist */
+    if (msg)
+    {
+        for (ptr_client = relay_clients; ptr_client;
+             ptr_client = ptr_client->next_client)
         {
-            weechat_unhook (RELAY_WEECHAT_DATA(ptr_client, hook_timer_nicklist));
-            RELAY_WEECHAT_DATA(ptr_client, hook_timer_nicklist) = NULL;
+            if (relay_weechat_protocol_client_signal_buffer (ptr_client)
+                && relay_weechat_protocol_is_sync (
+                    ptr_client, ptr_buffer,
+                    RELAY_WEECHAT_PROTOCOL_SYNC_NICKLIST))
+            {
+                relay_weechat_msg_send (ptr_client, msg);
+            }
         }
-        relay_weechat_hook_timer_nicklist (ptr_client);
+        relay_weechat_msg_free (msg);
     }
 
+    weechat_hashtable_remove (relay_weechat_buffers_nicklist, ptr_buffer);
+
     return WEECHAT_RC_OK;
 }
 
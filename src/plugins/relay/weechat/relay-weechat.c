@@ -43,6 +43,14 @@
 char *relay_weechat_compression_string[] = /* strings for compression       */
 { "off", "zlib" };
 
+/* hooks for signals "buffer_*" and nicklist, shared by all clients */
+struct t_hook *relay_weechat_hook_signal_buffer = NULL;
+struct t_hook *relay_weechat_hook_hsignal_nicklist = NULL;
+struct t_hook *relay_weechat_hook_signal_nicklist = NULL;
+
+/* nicklist diffs to send (key: buffer, value: nicklist) */
+struct t_hashtable *relay_weechat_buffers_nicklist = NULL;
+
 
 /*
  * Searches for a compression.
@@ -66,21 +74,65 @@ relay_weechat_compression_search (const char *compression)
     return -1;
 }
 
+/*
+ * Frees a value of hashtable "relay_weechat_buffers_nicklist".
+ */
+
+void
+relay_weechat_free_buffers_nicklist (struct t_hashtable *hashtable,
+                                     const void *key, void *value)
+{
+    /* make C compiler happy */
+    (void) hashtable;
+    (void) key;
+
+    relay_weechat_nicklist_free ((struct t_relay_weechat_nicklist *)value);
+}
+
 /*
  * Hooks signals for a client.
+ *
+ * The hooks for signals "buffer_*" and nicklist are shared by all clients, so
+ * that a message is built only once for all clients synchronized with the
+ * buffer.
  */
 
 void
 relay_weechat_hook_signals (struct t_relay_client *client)
 {
-    RELAY_WEECHAT_DATA(client, hook_signal_buffer) =
-        weechat_hook_signal ("buffer_*",
-                             &relay_weechat_protocol_signal_buffer_cb,
-                             client, NULL);
-    RELAY_WEECHAT_DATA(client, hook_hsignal_nicklist) =
-        weechat_hook_hsignal ("nicklist_*",
-                              &relay_weechat_protocol_hsignal_nicklist_cb,
-                              client, NULL);
+    if (!relay_weechat_hook_signal_buffer)
+    {
+        relay_weechat_hook_signal_buffer =
+            weechat_hook_signal ("buffer_*",
+                                 &relay_weechat_protocol_signal_buffer_cb,
+                                 NULL, NULL);
+    }
+    if (!relay_weechat_buffers_nicklist)
+    {
+        relay_weechat_buffers_nicklist = weechat_hashtable_new (
+            32,
+            WEECHAT_HASHTABLE_POINTER,
+            WEECHAT_HASHTABLE_POINTER,
+            NULL, NULL);
+        weechat_hashtable_set_pointer (relay_weechat_buffers_nicklist,
+                                       "callback_free_value",
+                                       &relay_weechat_free_buffers_nicklist);
+    }
+    if (!relay_weechat_hook_hsignal_nicklist)
+    {
+        relay_weechat_hook_hsignal_nicklist =
+            weechat_hook_hsignal ("nicklist_*",
+                                  &relay_weechat_protocol_hsignal_nicklist_cb,
+                                  NULL, NULL);
+    }
+    if (!relay_weechat_hook_signal_nicklist)
+    {
+        relay_weechat_hook_signal_nicklist =
+            weechat_hook_signal ("nicklist_updated",
+                                 &relay_weechat_protocol_signal_nicklist_cb,
+                                 NULL, NULL);
+    }
+    RELAY_WEECHAT_DATA(client, signal_buffer) = 1;
     RELAY_WEECHAT_DATA(client, hook_signal_upgrade) =
         weechat_hook_signal ("upgrade*",
                              &relay_weechat_protocol_signal_upgrade_cb,
@@ -88,40 +140,66 @@ relay_weechat_hook_signals (struct t_relay_client *client)
 }
 
 /*
- * Unhooks signals for a client.
+ * Stops sending signals "buffer_*" and nicklist to a client, and removes the
+ * shared hooks if no other client needs them.
  */
 
 void
-relay_weechat_unhook_signals (struct t_relay_client *client)
+relay_weechat_unhook_signal_buffer (struct t_relay_client *client)
 {
-    if (RELAY_WEECHAT_DATA(client, hook_signal_buffer))
+    struct t_relay_client *ptr_client;
+
+    if (!RELAY_WEECHAT_DATA(client, signal_buffer))
+        return;
+
+    RELAY_WEECHAT_DATA(client, signal_buffer) = 0;
+
+    for (ptr_client = relay_clients; ptr_client;
+         ptr_client = ptr_client->next_client)
     {
-        weechat_unhook (RELAY_WEECHAT_DATA(client, hook_signal_buffer));
-        RELAY_WEECHAT_DATA(client, hook_signal_buffer) = NULL;
+        if ((ptr_client->protocol == RELAY_PROTOCOL_WEECHAT)
+            && ptr_client->protocol_data
+            && RELAY_WEECHAT_DATA(ptr_client, signal_buffer))
+        {
+            return;
+        }
     }
-    if (RELAY_WEECHAT_DATA(client, hook_hsignal_nicklist))
+
+    if (relay_weechat_hook_signal_buffer)
     {
-        weechat_unhook (RELAY_WEECHAT_DATA(client, hook_hsignal_nicklist));
-        RELAY_WEECHAT_DATA(client, hook_hsignal_nicklist) = NULL;
+        weechat_unhook (relay_weechat_hook_signal_buffer);
+        relay_weechat_hook_signal_buffer = NULL;
     }
-    if (RELAY_WEECHAT_DATA(client, hook_signal_upgrade))
+    if (relay_weechat_hook_hsignal_nicklist)
     {
-        weechat_unhook (RELAY_WEECHAT_DATA(client, hook_signal_upgrade));
-        RELAY_WEECHAT_DATA(client, hook_signal_upgrade) = NULL;
+        weechat_unhook (relay_weechat_hook_hsignal_nicklist);
+        relay_weechat_hook_hsignal_nicklist = NULL;
+    }
+    if (relay_weechat_hook_signal_nicklist)
+    {
+        weechat_unhook (relay_weechat_hook_signal_nicklist);
+        relay_weechat_hook_signal_nicklist = NULL;
+    }
+    if (relay_weechat_buffers_nicklist)
+    {
+        weechat_hashtable_free (relay_weechat_buffers_nicklist);
+        relay_weechat_buffers_nicklist = NULL;
     }
 }
 
 /*
- * Hooks timer to update nicklist.
+ * Unhooks signals for a client.
  */
 
 void
-relay_weechat_hook_timer_nicklist (struct t_relay_client *client)
+relay_weechat_unhook_signals (struct t_relay_client *client)
 {
-    RELAY_WEECHAT_DATA(client, hook_timer_nicklist) =
-        weechat_hook_timer (100, 0, 1,
-                            &relay_weechat_protocol_timer_nicklist_cb,
-                            client, NULL);
+    relay_weechat_unhook_signal_buffer (client);
+    if (RELAY_WEECHAT_DATA(client, hook_signal_upgrade))
+    {
+        weechat_unhook (RELAY_WEECHAT_DATA(client, hook_signal_upgrade));
+        RELAY_WEECHAT_DATA(client, hook_signal_upgrade) = NULL;
+    }
 }
 
 /*
@@ -144,21 +222,6 @@ relay_weechat_close_connection (struct t_relay_client *client)
     relay_weechat_unhook_signals (client);
 }
 
-/*
- * Frees a value of hashtable "buffers_nicklist".
- */
-
-void
-relay_weechat_free_buffers_nicklist (struct t_hashtable *hashtable,
-                                     const void *key, void *value)
-{
-    /* make C compiler happy */
-    (void) hashtable;
-    (void) key;
-
-    relay_weechat_nicklist_free ((struct t_relay_weechat_nicklist *)value);
-}
-
 /*
  * Initializes relay data specific to WeeChat protocol.
  */
@@ -179,18 +242,8 @@ relay_weechat_alloc (struct t_relay_client *client)
                                WEECHAT_HASHTABLE_STRING,
                                WEECHAT_HASHTABLE_INTEGER,
                                NULL, NULL);
-    RELAY_WEECHAT_DATA(client, hook_signal_buffer) = NULL;
-    RELAY_WEECHAT_DATA(client, hook_hsignal_nicklist) = NULL;
+    RELAY_WEECHAT_DATA(client, signal_buffer) = 0;
     RELAY_WEECHAT_DATA(client, hook_signal_upgrade) = NULL;
-    RELAY_WEECHAT_DATA(client, buffers_nicklist) =
-        weechat_hashtable_new (32,
-                               WEECHAT_HASHTABLE_POINTER,
-                               WEECHAT_HASHTABLE_POINTER,
-                               NULL, NULL);
-    weechat_hashtable_set_pointer (RELAY_WEECHAT_DATA(client, buffers_nicklist),
-                                   "callback_free_value",
-                                   &relay_weechat_free_buffers_nicklist);
-    RELAY_WEECHAT_DATA(client, hook_timer_nicklist) = NULL;
 
     relay_weechat_hook_signals (client);
 }
@@ -248,23 +301,12 @@ relay_weechat_alloc_with_infolist (struct t_relay_client *client,
                                    &value);
             index++;
         }
-        RELAY_WEECHAT_DATA(client, hook_signal_buffer) = NULL;
-        RELAY_WEECHAT_DATA(client, hook_hsignal_nicklist) = NULL;
+        RELAY_WEECHAT_DATA(client, signal_buffer) = 0;
         RELAY_WEECHAT_DATA(client, hook_signal_upgrade) = NULL;
-        RELAY_WEECHAT_DATA(client, buffers_nicklist) =
-            weechat_hashtable_new (32,
-                                   WEECHAT_HASHTABLE_POINTER,
-                                   WEECHAT_HASHTABLE_POINTER,
-                                   NULL, NULL);
-        weechat_hashtable_set_pointer (RELAY_WEECHAT_DATA(client, buffers_nicklist),
-                                       "callback_free_value",
-                                       &relay_weechat_free_buffers_nicklist);
-        RELAY_WEECHAT_DATA(client, hook_timer_nicklist) = NULL;
 
         if (RELAY_CLIENT_HAS_ENDED(client))
         {
-            RELAY_WEECHAT_DATA(client, hook_signal_buffer) = NULL;
-            RELAY_WEECHAT_DATA(client, hook_hsignal_nicklist) = NULL;
+            RELAY_WEECHAT_DATA(client, signal_buffer) = 0;
             RELAY_WEECHAT_DATA(client, hook_signal_upgrade) = NULL;
         }
         else
@@ -301,14 +343,9 @@ relay_weechat_free (struct t_relay_client *client)
     {
         if (RELAY_WEECHAT_DATA(client, buffers_sync))
             weechat_hashtable_free (RELAY_WEECHAT_DATA(client, buffers_sync));
-        if (RELAY_WEECHAT_DATA(client, hook_signal_buffer))
-            weechat_unhook (RELAY_WEECHAT_DATA(client, hook_signal_buffer));
-        if (RELAY_WEECHAT_DATA(client, hook_hsignal_nicklist))
-            weechat_unhook (RELAY_WEECHAT_DATA(client, hook_hsignal_nicklist));
+        relay_weechat_unhook_signal_buffer (client);
         if (RELAY_WEECHAT_DATA(client, hook_signal_upgrade))
             weechat_unhook (RELAY_WEECHAT_DATA(client, hook_signal_upgrade));
-        if (RELAY_WEECHAT_DATA(client, buffers_nicklist))
-            weechat_hashtable_free (RELAY_WEECHAT_DATA(client, buffers_nicklist));
 
         free (client->protocol_data);
 
@@ -362,13 +399,7 @@ relay_weechat_print_log (struct t_relay_client *client)
                             RELAY_WEECHAT_DATA(client, buffers_sync),
                             weechat_hashtable_get_string (RELAY_WEECHAT_DATA(client, buffers_sync),
                                                           "keys_values"));
-        weechat_log_printf ("    hook_signal_buffer. . . : 0x%lx", RELAY_WEECHAT_DATA(client, hook_signal_buffer));
-        weechat_log_printf ("    hook_hsignal_nicklist . : 0x%lx", RELAY_WEECHAT_DATA(client, hook_hsignal_nicklist));
+        weechat_log_printf ("    signal_buffer . . . . . : %d",   RELAY_WEECHAT_DATA(client, signal_buffer));
         weechat_log_printf ("    hook_signal_upgrade . . : 0x%lx", RELAY_WEECHAT_DATA(client, hook_signal_upgrade));
-        weechat_log_printf ("    buffers_nicklist. . . . : 0x%lx (hashtable: '%s')",
-                            RELAY_WEECHAT_DATA(client, buffers_nicklist),
-                            weechat_hashtable_get_string (RELAY_WEECHAT_DATA(client, buffers_nicklist),
-                                                          "keys_values"));
-        weechat_log_printf ("    hook_timer_nicklist . . : 0x%lx", RELAY_WEECHAT_DATA(client, hook_timer_nicklist));
     }
 }
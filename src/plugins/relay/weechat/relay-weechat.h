@@ -53,19 +53,21 @@ struct t_relay_weechat_data
     /* sync of buffers */
     struct t_hashtable *buffers_sync;  /* buffers synchronized (events      */
                                        /* received for these buffers)       */
-    struct t_hook *hook_signal_buffer;    /* hook for signals "buffer_*"    */
-    struct t_hook *hook_hsignal_nicklist; /* hook for hsignals "nicklist_*" */
+    int signal_buffer;                    /* 1 if client gets "buffer_*"    */
+                                          /* and "nicklist_*"               */
     struct t_hook *hook_signal_upgrade;   /* hook for signals "upgrade*"    */
-    struct t_hashtable *buffers_nicklist; /* send nicklist for these buffers*/
-    struct t_hook *hook_timer_nicklist;   /* timer for sending nicklist     */
 };
 
 extern char *relay_weechat_compression_string[];
+extern struct t_hook *relay_weechat_hook_signal_buffer;
+extern struct t_hook *relay_weechat_hook_hsignal_nicklist;
+extern struct t_hook *relay_weechat_hook_signal_nicklist;
+extern struct t_hashtable *relay_weechat_buffers_nicklist;
 
 extern int relay_weechat_compression_search (const char *compression);
 extern void relay_weechat_hook_signals (struct t_relay_client *client);
+extern void relay_weechat_unhook_signal_buffer (struct t_relay_client *client);
 extern void relay_weechat_unhook_signals (struct t_relay_client *client);
-extern void relay_weechat_hook_timer_nicklist (struct t_relay_client *client);
 extern void relay_weechat_recv (struct t_relay_client *client,
                                 const char *data);
 extern void relay_weechat_close_connection (struct t_relay_client *client);
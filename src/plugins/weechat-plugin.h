@@ -55,6 +55,7 @@ struct t_weelist_item;
 struct t_arraylist;
 struct t_hashtable;
 struct t_hdata;
+struct t_eval_compiled;
 struct timeval;
 
 /*
@@ -67,7 +68,7 @@ struct timeval;
  * please change the date with current one; for a second change at same
  * date, increment the 01, otherwise please keep 01.
  */
-#define WEECHAT_PLUGIN_API_VERSION "20200621-01"
+#define WEECHAT_PLUGIN_API_VERSION "20261017-01"
 
 /* macros for defining plugin infos */
 #define WEECHAT_PLUGIN_NAME(__name)                                     \
@@ -347,6 +348,13 @@ struct t_weechat_plugin
                                      struct t_hashtable *pointers,
                                      struct t_hashtable *extra_vars,
                                      struct t_hashtable *options);
+    struct t_eval_compiled *(*string_eval_compile) (const char *expr,
+                                                    struct t_hashtable *options);
+    char *(*string_eval_compiled_exec) (struct t_eval_compiled *compiled,
+                                        struct t_hashtable *pointers,
+                                        struct t_hashtable *extra_vars,
+                                        struct t_hashtable *options);
+    void (*string_eval_compiled_free) (struct t_eval_compiled *compiled);
     char **(*string_dyn_alloc) (int size_alloc);
     int (*string_dyn_copy) (char **string, const char *new_string);
     int (*string_dyn_concat) (char **string, const char *add);
@@ -1285,6 +1293,15 @@ extern int weechat_plugin_end (struct t_weechat_plugin *plugin);
                                        __extra_vars, __options)         \
     (weechat_plugin->string_eval_expression)(__expr, __pointers,        \
                                              __extra_vars, __options)
+#define weechat_string_eval_compile(__expr, __options)                  \
+    (weechat_plugin->string_eval_compile)(__expr, __options)
+#define weechat_string_eval_compiled_exec(__compiled, __pointers,       \
+                                          __extra_vars, __options)      \
+    (weechat_plugin->string_eval_compiled_exec)(__compiled, __pointers, \
+                                                __extra_vars,           \
+                                                __options)
+#define weechat_string_eval_compiled_free(__compiled)                   \
+    (weechat_plugin->string_eval_compiled_free)(__compiled)
 #define weechat_string_dyn_alloc(__size_alloc)                          \
     (weechat_plugin->string_dyn_alloc)(__size_alloc)
 #define weechat_string_dyn_copy(__string, __new_string)                 \
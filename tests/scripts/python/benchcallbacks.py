@@ -0,0 +1,102 @@
+# -*- coding: utf-8 -*-
+#
+# Copyright (C) 2026 Sébastien Helleu <flashcode@flashtux.org>
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#
+
+"""
+Benchmark of calls to Python callbacks (signals and modifiers).
+
+Load the script in WeeChat and run:
+
+    /benchcallbacks [hooks [calls]]
+
+The number of callbacks called per second is displayed in core buffer
+(default: 100 hooks of each type, each one called 5000 times).
+"""
+
+import time
+
+import weechat  # pylint: disable=import-error
+
+SCRIPT_NAME = 'benchcallbacks'
+SCRIPT_AUTHOR = 'Sébastien Helleu <flashcode@flashtux.org>'
+SCRIPT_VERSION = '0.1'
+SCRIPT_LICENSE = 'GPL3'
+SCRIPT_DESC = 'Benchmark of calls to Python callbacks'
+
+MESSAGE = 'some message text with a few words, like on IRC été'
+
+
+def bench_signal_cb(data, signal, signal_data):
+    """Callback for signal."""
+    return weechat.WEECHAT_RC_OK
+
+
+def bench_modifier_cb(data, modifier, modifier_data, string):
+    """Callback for modifier."""
+    return string
+
+
+def bench_run(hooks, calls):
+    """Run the benchmark and display the result."""
+    ptr_hooks = []
+    for _ in range(hooks):
+        ptr_hooks.append(
+            weechat.hook_signal('benchcallbacks_signal',
+                                'bench_signal_cb', ''))
+        ptr_hooks.append(
+            weechat.hook_modifier('benchcallbacks_modifier',
+                                  'bench_modifier_cb', ''))
+    time1 = time.perf_counter()
+    for _ in range(calls):
+        weechat.hook_signal_send('benchcallbacks_signal',
+                                 weechat.WEECHAT_HOOK_SIGNAL_STRING, MESSAGE)
+    time2 = time.perf_counter()
+    for _ in range(calls):
+        weechat.hook_modifier_exec('benchcallbacks_modifier', 'data', MESSAGE)
+    time3 = time.perf_counter()
+    for ptr_hook in ptr_hooks:
+        weechat.unhook(ptr_hook)
+    weechat.prnt('',
+                 '%s: %d hooks, %d calls: signal: %.0f callbacks/s, '
+                 'modifier: %.0f callbacks/s'
+                 % (SCRIPT_NAME, hooks, calls,
+                    (hooks * calls) / (time2 - time1),
+                    (hooks * calls) / (time3 - time2)))
+
+
+def bench_cmd_cb(data, buffer, args):
+    """Callback for command /benchcallbacks."""
+    argv = args.split()
+    try:
+        hooks = int(argv[0]) if argv else 100
+        calls = int(argv[1]) if len(argv) > 1 else 5000
+    except ValueError:
+        return weechat.WEECHAT_RC_ERROR
+    bench_run(hooks, calls)
+    return weechat.WEECHAT_RC_OK
+
+
+if __name__ == '__main__':
+    if weechat.register(SCRIPT_NAME, SCRIPT_AUTHOR, SCRIPT_VERSION,
+                        SCRIPT_LICENSE, SCRIPT_DESC, '', ''):
+        weechat.hook_command(SCRIPT_NAME, SCRIPT_DESC,
+                             '[<hooks> [<calls>]]',
+                             '  hooks: number of hooks of each type '
+                             '(default: 100)\n'
+                             '  calls: number of calls of each hook '
+                             '(default: 5000)',
+                             '', 'bench_cmd_cb', '')
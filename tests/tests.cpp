@@ -61,6 +61,7 @@ extern "C"
 /* core */
 IMPORT_TEST_GROUP(CoreArraylist);
 IMPORT_TEST_GROUP(CoreCalc);
+IMPORT_TEST_GROUP(CoreConfigFile);
 IMPORT_TEST_GROUP(CoreCrypto);
 IMPORT_TEST_GROUP(CoreEval);
 IMPORT_TEST_GROUP(CoreHashtable);
@@ -68,7 +69,9 @@ IMPORT_TEST_GROUP(CoreHdata);
 IMPORT_TEST_GROUP(CoreHook);
 IMPORT_TEST_GROUP(CoreInfolist);
 IMPORT_TEST_GROUP(CoreList);
+IMPORT_TEST_GROUP(CoreNetwork);
 IMPORT_TEST_GROUP(CoreSecure);
+IMPORT_TEST_GROUP(CoreSlab);
 IMPORT_TEST_GROUP(CoreString);
 IMPORT_TEST_GROUP(CoreUrl);
 IMPORT_TEST_GROUP(CoreUtf8);
@@ -77,6 +80,7 @@ IMPORT_TEST_GROUP(CoreUtil);
 IMPORT_TEST_GROUP(GuiColor);
 IMPORT_TEST_GROUP(GuiLine);
 IMPORT_TEST_GROUP(GuiNick);
+IMPORT_TEST_GROUP(GuiNicklist);
 /* scripts */
 IMPORT_TEST_GROUP(Scripts);
 
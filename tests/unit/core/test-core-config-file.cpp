@@ -0,0 +1,286 @@
+/*
+ * test-core-config-file.cpp - test configuration file functions
+ *
+ * Copyright (C) 2020 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "CppUTest/TestHarness.h"
+
+extern "C"
+{
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include "src/core/weechat.h"
+#include "src/core/wee-config-file.h"
+#include "src/core/wee-hashtable.h"
+#include "src/core/wee-util.h"
+#include "src/plugins/plugin.h"
+}
+
+#define TEST_CONFIG_NAME "test_config"
+#define TEST_CONFIG_NUM_OPTIONS 50000
+
+TEST_GROUP(CoreConfigFile)
+{
+};
+
+/*
+ * Creates a string option in a section (with default value "").
+ */
+
+struct t_config_option *
+test_config_new_option (struct t_config_file *config_file,
+                        struct t_config_section *section,
+                        const char *name, const char *value)
+{
+    return config_file_new_option (config_file, section, name, "string",
+                                   NULL, NULL, 0, 0, "", value, 0,
+                                   NULL, NULL, NULL,
+                                   NULL, NULL, NULL,
+                                   NULL, NULL, NULL);
+}
+
+/*
+ * Creates a section (without callbacks).
+ */
+
+struct t_config_section *
+test_config_new_section (struct t_config_file *config_file, const char *name)
+{
+    return config_file_new_section (config_file, name, 0, 0,
+                                    NULL, NULL, NULL,
+                                    NULL, NULL, NULL,
+                                    NULL, NULL, NULL,
+                                    NULL, NULL, NULL,
+                                    NULL, NULL, NULL);
+}
+
+/*
+ * Tests functions:
+ *   config_file_new_section
+ *   config_file_search_section
+ *   config_file_section_free
+ */
+
+TEST(CoreConfigFile, SearchSection)
+{
+    struct t_config_file *config_file;
+    struct t_config_section *section1, *section2;
+
+    config_file = config_file_new (NULL, TEST_CONFIG_NAME, NULL, NULL, NULL);
+    CHECK(config_file);
+    CHECK(config_file->sections_hashtable);
+
+    section1 = test_config_new_section (config_file, "section1");
+    CHECK(section1);
+    CHECK(section1->options_hashtable);
+    section2 = test_config_new_section (config_file, "section2");
+    CHECK(section2);
+    LONGS_EQUAL(2, config_file->sections_hashtable->items_count);
+
+    /* two sections can not have same name (case is ignored) */
+    POINTERS_EQUAL(NULL, test_config_new_section (config_file, "SECTION1"));
+
+    POINTERS_EQUAL(NULL, config_file_search_section (NULL, NULL));
+    POINTERS_EQUAL(NULL, config_file_search_section (config_file, NULL));
+    POINTERS_EQUAL(NULL, config_file_search_section (NULL, "section1"));
+    POINTERS_EQUAL(NULL, config_file_search_section (config_file, "xxx"));
+    POINTERS_EQUAL(section1,
+                   config_file_search_section (config_file, "section1"));
+    POINTERS_EQUAL(section1,
+                   config_file_search_section (config_file, "Section1"));
+    POINTERS_EQUAL(section2,
+                   config_file_search_section (config_file, "SECTION2"));
+
+    config_file_section_free (section1);
+    LONGS_EQUAL(1, config_file->sections_hashtable->items_count);
+    POINTERS_EQUAL(NULL, config_file_search_section (config_file, "section1"));
+    POINTERS_EQUAL(section2,
+                   config_file_search_section (config_file, "section2"));
+
+    config_file_free (config_file);
+}
+
+/*
+ * Tests functions:
+ *   config_file_new_option
+ *   config_file_search_option
+ *   config_file_search_section_option
+ *   config_file_option_rename
+ *   config_file_option_free
+ */
+
+TEST(CoreConfigFile, SearchOption)
+{
+    struct t_config_file *config_file;
+    struct t_config_section *section1, *section2, *ptr_section;
+    struct t_config_option *option_a, *option_b, *option_c, *ptr_option;
+
+    config_file = config_file_new (NULL, TEST_CONFIG_NAME, NULL, NULL, NULL);
+    CHECK(config_file);
+    section1 = test_config_new_section (config_file, "section1");
+    CHECK(section1);
+    section2 = test_config_new_section (config_file, "section2");
+    CHECK(section2);
+
+    option_b = test_config_new_option (config_file, section1, "opt_b", "b");
+    CHECK(option_b);
+    option_a = test_config_new_option (config_file, section1, "opt_a", "a");
+    CHECK(option_a);
+    option_c = test_config_new_option (config_file, section2, "opt_c", "c");
+    CHECK(option_c);
+    LONGS_EQUAL(2, section1->options_hashtable->items_count);
+    LONGS_EQUAL(1, section2->options_hashtable->items_count);
+
+    /* options are still sorted in section */
+    POINTERS_EQUAL(option_a, section1->options);
+    POINTERS_EQUAL(option_b, section1->last_option);
+
+    /* two options can not have same name in a section (case is ignored) */
+    POINTERS_EQUAL(NULL,
+                   test_config_new_option (config_file, section1, "OPT_A",
+                                           "x"));
+
+    /* search in a section */
+    POINTERS_EQUAL(NULL, config_file_search_option (config_file, section1,
+                                                    NULL));
+    POINTERS_EQUAL(NULL, config_file_search_option (config_file, section1,
+                                                    "xxx"));
+    POINTERS_EQUAL(option_a, config_file_search_option (config_file, section1,
+                                                        "opt_a"));
+    POINTERS_EQUAL(option_b, config_file_search_option (config_file, section1,
+                                                        "Opt_B"));
+    POINTERS_EQUAL(NULL, config_file_search_option (config_file, section1,
+                                                    "opt_c"));
+
+    /* search in all sections of file */
+    POINTERS_EQUAL(option_a, config_file_search_option (config_file, NULL,
+                                                        "OPT_A"));
+    POINTERS_EQUAL(option_c, config_file_search_option (config_file, NULL,
+                                                        "opt_c"));
+    config_file_search_section_option (config_file, NULL, "opt_c",
+                                       &ptr_section, &ptr_option);
+    POINTERS_EQUAL(section2, ptr_section);
+    POINTERS_EQUAL(option_c, ptr_option);
+    config_file_search_section_option (config_file, section1, "opt_c",
+                                       &ptr_section, &ptr_option);
+    POINTERS_EQUAL(NULL, ptr_section);
+    POINTERS_EQUAL(NULL, ptr_option);
+
+    /* rename option */
+    config_file_option_rename (option_a, "opt_z");
+    STRCMP_EQUAL("opt_z", option_a->name);
+    LONGS_EQUAL(2, section1->options_hashtable->items_count);
+    POINTERS_EQUAL(NULL, config_file_search_option (config_file, section1,
+                                                    "opt_a"));
+    POINTERS_EQUAL(option_a, config_file_search_option (config_file, section1,
+                                                        "opt_z"));
+    POINTERS_EQUAL(option_b, section1->options);
+    POINTERS_EQUAL(option_a, section1->last_option);
+
+    /* rename to an existing name is not allowed */
+    config_file_option_rename (option_a, "OPT_B");
+    STRCMP_EQUAL("opt_z", option_a->name);
+
+    /* free option */
+    config_file_option_free (option_b, 0);
+    LONGS_EQUAL(1, section1->options_hashtable->items_count);
+    POINTERS_EQUAL(NULL, config_file_search_option (config_file, section1,
+                                                    "opt_b"));
+    POINTERS_EQUAL(option_a, config_file_search_option (config_file, section1,
+                                                        "opt_z"));
+
+    config_file_free (config_file);
+}
+
+/*
+ * Tests functions:
+ *   config_file_write
+ *   config_file_read
+ *
+ * Benchmark: reads a configuration file with TEST_CONFIG_NUM_OPTIONS options
+ * in a section (duration is displayed, it is not checked).
+ */
+
+TEST(CoreConfigFile, ReadManyOptions)
+{
+    struct t_config_file *config_file;
+    struct t_config_section *section;
+    struct t_config_option *ptr_option;
+    struct timeval tv_start, tv_end;
+    char name[64], value[64], *filename;
+    int i, length;
+
+    config_file = config_file_new (NULL, TEST_CONFIG_NAME, NULL, NULL, NULL);
+    CHECK(config_file);
+    section = test_config_new_section (config_file, "section");
+    CHECK(section);
+
+    gettimeofday (&tv_start, NULL);
+    for (i = 0; i < TEST_CONFIG_NUM_OPTIONS; i++)
+    {
+        snprintf (name, sizeof (name), "option%d", i);
+        snprintf (value, sizeof (value), "value%d", i);
+        CHECK(test_config_new_option (config_file, section, name, value));
+    }
+    gettimeofday (&tv_end, NULL);
+    printf ("Create %d options: %.3f ms\n",
+            TEST_CONFIG_NUM_OPTIONS,
+            ((float)util_timeval_diff (&tv_start, &tv_end)) / 1000);
+    LONGS_EQUAL(TEST_CONFIG_NUM_OPTIONS,
+                section->options_hashtable->items_count);
+
+    LONGS_EQUAL(WEECHAT_CONFIG_WRITE_OK, config_file_write (config_file));
+
+    /* reset all options, then read them from file */
+    for (ptr_option = section->options; ptr_option;
+         ptr_option = ptr_option->next_option)
+    {
+        config_file_option_reset (ptr_option, 0);
+    }
+    gettimeofday (&tv_start, NULL);
+    LONGS_EQUAL(WEECHAT_CONFIG_READ_OK, config_file_read (config_file));
+    gettimeofday (&tv_end, NULL);
+    printf ("Read %d options: %.3f ms\n",
+            TEST_CONFIG_NUM_OPTIONS,
+            ((float)util_timeval_diff (&tv_start, &tv_end)) / 1000);
+
+    for (i = 0; i < TEST_CONFIG_NUM_OPTIONS; i++)
+    {
+        snprintf (name, sizeof (name), "OPTION%d", i);
+        snprintf (value, sizeof (value), "value%d", i);
+        ptr_option = config_file_search_option (config_file, section, name);
+        CHECK(ptr_option);
+        STRCMP_EQUAL(value, CONFIG_STRING(ptr_option));
+    }
+
+    /* remove the file */
+    length = strlen (weechat_home) + strlen (config_file->filename) + 2;
+    filename = (char *)malloc (length);
+    CHECK(filename);
+    snprintf (filename, length,
+              "%s%s%s",
+              weechat_home, DIR_SEPARATOR, config_file->filename);
+    unlink (filename);
+    free (filename);
+
+    config_file_free (config_file);
+}
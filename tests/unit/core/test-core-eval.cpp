@@ -809,3 +809,101 @@ TEST(CoreEval, EvalReplaceRegex)
     hashtable_free (extra_vars);
     hashtable_free (options);
 }
+
+/*
+ * Tests functions:
+ *   eval_compile
+ *   eval_compiled_exec
+ *   eval_compiled_free
+ */
+
+TEST(CoreEval, EvalCompiled)
+{
+    struct t_hashtable *extra_vars, *options;
+    struct t_eval_compiled *compiled;
+    char *value, str_expr[128];
+    int i;
+
+    extra_vars = hashtable_new (32,
+                                WEECHAT_HASHTABLE_STRING,
+                                WEECHAT_HASHTABLE_STRING,
+                                NULL, NULL);
+    CHECK(extra_vars);
+    hashtable_set (extra_vars, "test", "value");
+
+    options = hashtable_new (32,
+                             WEECHAT_HASHTABLE_STRING,
+                             WEECHAT_HASHTABLE_STRING,
+                             NULL, NULL);
+    CHECK(options);
+    hashtable_set (options, "type", "condition");
+
+    POINTERS_EQUAL(NULL, eval_compile (NULL, options));
+    POINTERS_EQUAL(NULL, eval_compiled_exec (NULL, NULL, extra_vars, NULL));
+    eval_compiled_free (NULL);
+
+    /* condition evaluated many times, with different variables */
+    compiled = eval_compile ("${test} == value && abc =~ ^a", options);
+    CHECK(compiled);
+    for (i = 0; i < 3; i++)
+    {
+        value = eval_compiled_exec (compiled, NULL, extra_vars, NULL);
+        STRCMP_EQUAL("1", value);
+        free (value);
+    }
+    hashtable_set (extra_vars, "test", "other");
+    value = eval_compiled_exec (compiled, NULL, extra_vars, NULL);
+    STRCMP_EQUAL("0", value);
+    free (value);
+    hashtable_set (extra_vars, "test", "value");
+    eval_compiled_free (compiled);
+
+    /* regex with variable, compiled on each evaluation */
+    compiled = eval_compile ("abc =~ ${test}", options);
+    CHECK(compiled);
+    value = eval_compiled_exec (compiled, NULL, extra_vars, NULL);
+    STRCMP_EQUAL("0", value);
+    free (value);
+    hashtable_set (extra_vars, "test", "^ab");
+    value = eval_compiled_exec (compiled, NULL, extra_vars, NULL);
+    STRCMP_EQUAL("1", value);
+    free (value);
+    hashtable_set (extra_vars, "test", "value");
+    eval_compiled_free (compiled);
+
+    /* expression (not a condition) */
+    compiled = eval_compile ("test: ${test}", NULL);
+    CHECK(compiled);
+    value = eval_compiled_exec (compiled, NULL, extra_vars, NULL);
+    STRCMP_EQUAL("test: value", value);
+    free (value);
+    eval_compiled_free (compiled);
+
+    /* custom prefix/suffix */
+    hashtable_set (options, "prefix", "%(");
+    hashtable_set (options, "suffix", ")");
+    compiled = eval_compile ("%(test) == value", options);
+    CHECK(compiled);
+    value = eval_compiled_exec (compiled, NULL, extra_vars, NULL);
+    STRCMP_EQUAL("1", value);
+    free (value);
+    eval_compiled_free (compiled);
+    hashtable_remove (options, "prefix");
+    hashtable_remove (options, "suffix");
+
+    /* cache of conditions: size is limited */
+    for (i = 0; i < EVAL_CACHE_MAX_SIZE + 16; i++)
+    {
+        snprintf (str_expr, sizeof (str_expr), "%d == %d", i, i);
+        value = eval_expression (str_expr, NULL, NULL, options);
+        STRCMP_EQUAL("1", value);
+        free (value);
+    }
+    LONGS_EQUAL(EVAL_CACHE_MAX_SIZE, eval_cache_count);
+    value = eval_expression ("0 == 0", NULL, NULL, options);
+    STRCMP_EQUAL("1", value);
+    free (value);
+
+    hashtable_free (extra_vars);
+    hashtable_free (options);
+}
@@ -23,8 +23,11 @@
 
 extern "C"
 {
+#include <stdio.h>
 #include <string.h>
+#include <sys/time.h>
 #include "src/core/wee-hashtable.h"
+#include "src/core/wee-util.h"
 #include "src/plugins/plugin.h"
 }
 
@@ -33,6 +36,11 @@ extern "C"
 #define HASHTABLE_TEST_KEY_LONG      "abcdefghijklmnopqrstuvwxyz"
 #define HASHTABLE_TEST_KEY_LONG_HASH 11232856562070989738ULL
 #define HASHTABLE_TEST_VALUE         "this is a value"
+#define HASHTABLE_TEST_KEY_XXH64           5754696928334414137ULL
+#define HASHTABLE_TEST_KEY_LONG_XXH64      14979520437024293724ULL
+#define HASHTABLE_TEST_KEY_LONGER          \
+    "abcdefghijklmnopqrstuvwxyz0123456789ABCDEFGHIJ"
+#define HASHTABLE_TEST_KEY_LONGER_XXH64    5691905764868313233ULL
 
 TEST_GROUP(CoreHashtable)
 {
@@ -54,6 +62,27 @@ TEST(CoreHashtable, HashDbj2)
     CHECK(hash == HASHTABLE_TEST_KEY_LONG_HASH);
 }
 
+/*
+ * Tests functions:
+ *   hashtable_hash_key_xxh64
+ */
+
+TEST(CoreHashtable, HashXxh64)
+{
+    CHECK(hashtable_hash_key_xxh64 ("", 0) == 17241709254077376921ULL);
+    CHECK(hashtable_hash_key_xxh64 (NULL, 0) == 17241709254077376921ULL);
+    CHECK(hashtable_hash_key_xxh64 ("abc", 3) == 4952883123889572249ULL);
+    CHECK(hashtable_hash_key_xxh64 (HASHTABLE_TEST_KEY,
+                                    strlen (HASHTABLE_TEST_KEY))
+          == HASHTABLE_TEST_KEY_XXH64);
+    CHECK(hashtable_hash_key_xxh64 (HASHTABLE_TEST_KEY_LONG,
+                                    strlen (HASHTABLE_TEST_KEY_LONG))
+          == HASHTABLE_TEST_KEY_LONG_XXH64);
+    CHECK(hashtable_hash_key_xxh64 (HASHTABLE_TEST_KEY_LONGER,
+                                    strlen (HASHTABLE_TEST_KEY_LONGER))
+          == HASHTABLE_TEST_KEY_LONGER_XXH64);
+}
+
 /*
  * Test callback hashing a key.
  *
@@ -337,6 +366,247 @@ TEST(CoreHashtable, SetGetRemove)
     hashtable_free (hashtable);
 }
 
+/*
+ * Tests functions:
+ *   hashtable_hash_key_fast_cb
+ */
+
+TEST(CoreHashtable, HashFast)
+{
+    struct t_hashtable *hashtable;
+    int i, value;
+    char key[32];
+
+    hashtable = hashtable_new (32,
+                               WEECHAT_HASHTABLE_STRING,
+                               WEECHAT_HASHTABLE_INTEGER,
+                               &hashtable_hash_key_fast_cb,
+                               NULL);
+    CHECK(hashtable);
+    CHECK(hashtable_hash_key_fast_cb (hashtable, HASHTABLE_TEST_KEY)
+          == HASHTABLE_TEST_KEY_XXH64);
+    for (i = 0; i < 1000; i++)
+    {
+        snprintf (key, sizeof (key), "key%d", i);
+        hashtable_set (hashtable, key, &i);
+    }
+    LONGS_EQUAL(1000, hashtable->items_count);
+    for (i = 0; i < 1000; i++)
+    {
+        snprintf (key, sizeof (key), "key%d", i);
+        value = *((int *)hashtable_get (hashtable, key));
+        LONGS_EQUAL(i, value);
+    }
+    hashtable_free (hashtable);
+
+    /* integer keys */
+    hashtable = hashtable_new (32,
+                               WEECHAT_HASHTABLE_INTEGER,
+                               WEECHAT_HASHTABLE_STRING,
+                               &hashtable_hash_key_fast_cb,
+                               NULL);
+    CHECK(hashtable);
+    for (i = 0; i < 100; i++)
+    {
+        hashtable_set (hashtable, &i, HASHTABLE_TEST_VALUE);
+    }
+    LONGS_EQUAL(100, hashtable->items_count);
+    for (i = 0; i < 100; i++)
+    {
+        LONGS_EQUAL(1, hashtable_has_key (hashtable, &i));
+    }
+    i = 100;
+    LONGS_EQUAL(0, hashtable_has_key (hashtable, &i));
+    hashtable_free (hashtable);
+}
+
+/*
+ * Test callback for map: removes one key out of two.
+ */
+
+void
+test_hashtable_map_remove_cb (void *data,
+                              struct t_hashtable *hashtable,
+                              const void *key, const void *value)
+{
+    int *count;
+
+    /* make C++ compiler happy */
+    (void) value;
+
+    count = (int *)data;
+    if ((*count)++ % 2 == 0)
+        hashtable_remove (hashtable, key);
+}
+
+/*
+ * Tests functions:
+ *   hashtable_set (with growth of hashtable)
+ *   hashtable_get (during incremental rehash)
+ *   hashtable_remove (during incremental rehash)
+ */
+
+TEST(CoreHashtable, Rehash)
+{
+    struct t_hashtable *hashtable;
+    struct t_hashtable_item *ptr_item;
+    int i, count, *ptr_value;
+    char key[32];
+
+    hashtable = hashtable_new (8,
+                               WEECHAT_HASHTABLE_STRING,
+                               WEECHAT_HASHTABLE_INTEGER,
+                               NULL,
+                               NULL);
+    CHECK(hashtable);
+
+    /* no growth until load factor is reached */
+    for (i = 0; i < 8 * HASHTABLE_MAX_LOAD_FACTOR; i++)
+    {
+        snprintf (key, sizeof (key), "key%d", i);
+        hashtable_set (hashtable, key, &i);
+    }
+    LONGS_EQUAL(8, hashtable->size);
+    POINTERS_EQUAL(NULL, hashtable->htable_old);
+
+    /* one more item: the hashtable grows, rehash is incremental */
+    hashtable_set (hashtable, "key_grow", &i);
+    LONGS_EQUAL(16, hashtable->size);
+    CHECK(hashtable->htable_old);
+    LONGS_EQUAL(8, hashtable->size_old);
+
+    /* all keys are found during the rehash (in old or new htable) */
+    snprintf (key, sizeof (key), "key%d", 0);
+    CHECK(hashtable_get (hashtable, key));
+    for (i = 0; i < 8 * HASHTABLE_MAX_LOAD_FACTOR; i++)
+    {
+        snprintf (key, sizeof (key), "key%d", i);
+        ptr_value = (int *)hashtable_get (hashtable, key);
+        CHECK(ptr_value);
+        LONGS_EQUAL(i, *ptr_value);
+    }
+    POINTERS_EQUAL(NULL, hashtable->htable_old);
+    LONGS_EQUAL(8 * HASHTABLE_MAX_LOAD_FACTOR + 1, hashtable->items_count);
+
+    /* add many items, remove half of them */
+    for (i = 0; i < 10000; i++)
+    {
+        snprintf (key, sizeof (key), "key%d", i);
+        hashtable_set (hashtable, key, &i);
+        if (i % 2 == 1)
+        {
+            snprintf (key, sizeof (key), "key%d", i - 1);
+            hashtable_remove (hashtable, key);
+        }
+    }
+    LONGS_EQUAL(5001, hashtable->items_count);
+    CHECK(hashtable->size >= 5001 / HASHTABLE_MAX_LOAD_FACTOR);
+    for (i = 0; i < 10000; i++)
+    {
+        snprintf (key, sizeof (key), "key%d", i);
+        LONGS_EQUAL((i % 2 == 1) ? 1 : 0, hashtable_has_key (hashtable, key));
+    }
+
+    /* linked lists are still sorted */
+    for (i = 0; i < hashtable->size; i++)
+    {
+        for (ptr_item = hashtable->htable[i]; ptr_item && ptr_item->next_item;
+             ptr_item = ptr_item->next_item)
+        {
+            CHECK(strcmp ((const char *)ptr_item->key,
+                          (const char *)ptr_item->next_item->key) < 0);
+            POINTERS_EQUAL(ptr_item, ptr_item->next_item->prev_item);
+        }
+    }
+
+    /* map during a rehash: all items are visited exactly once */
+    hashtable_remove_all (hashtable);
+    for (i = 0; i < 8 * hashtable->size; i++)
+    {
+        snprintf (key, sizeof (key), "key%d", i);
+        hashtable_set (hashtable, key, &i);
+        if (hashtable->htable_old)
+            break;
+    }
+    CHECK(hashtable->htable_old);
+    count = 0;
+    hashtable_map (hashtable, &test_hashtable_map_remove_cb, &count);
+    LONGS_EQUAL(i + 1, count);
+    LONGS_EQUAL((i + 1) / 2, hashtable->items_count);
+    POINTERS_EQUAL(NULL, hashtable->htable_old);
+
+    hashtable_free (hashtable);
+}
+
+/*
+ * Runs insert/lookup benchmark on a hashtable with "count" string keys and
+ * displays the throughput.
+ */
+
+void
+test_hashtable_benchmark (int count, t_hashtable_hash_key *callback_hash_key,
+                          const char *hash_name)
+{
+    struct t_hashtable *hashtable;
+    struct timeval tv1, tv2, tv3;
+    long long diff_insert, diff_lookup;
+    char key[32];
+    int i, found;
+
+    hashtable = hashtable_new (32,
+                               WEECHAT_HASHTABLE_STRING,
+                               WEECHAT_HASHTABLE_INTEGER,
+                               callback_hash_key,
+                               NULL);
+    CHECK(hashtable);
+
+    gettimeofday (&tv1, NULL);
+    for (i = 0; i < count; i++)
+    {
+        snprintf (key, sizeof (key), "nick_%d", i);
+        hashtable_set (hashtable, key, &i);
+    }
+    gettimeofday (&tv2, NULL);
+    found = 0;
+    for (i = 0; i < count; i++)
+    {
+        snprintf (key, sizeof (key), "nick_%d", i);
+        if (hashtable_get (hashtable, key))
+            found++;
+    }
+    gettimeofday (&tv3, NULL);
+
+    LONGS_EQUAL(count, hashtable->items_count);
+    LONGS_EQUAL(count, found);
+
+    diff_insert = util_timeval_diff (&tv1, &tv2);
+    diff_lookup = util_timeval_diff (&tv2, &tv3);
+    printf ("\nhashtable %-5s %7d keys (size %7d): "
+            "insert: %6.1f Mops/s, lookup: %6.1f Mops/s",
+            hash_name, count, hashtable->size,
+            (diff_insert > 0) ? (double)count / diff_insert : 0,
+            (diff_lookup > 0) ? (double)count / diff_lookup : 0);
+
+    hashtable_free (hashtable);
+}
+
+/*
+ * Tests functions:
+ *   hashtable_set (benchmark)
+ *   hashtable_get (benchmark)
+ */
+
+TEST(CoreHashtable, Benchmark)
+{
+    test_hashtable_benchmark (1000, NULL, "djb2");
+    test_hashtable_benchmark (1000, &hashtable_hash_key_fast_cb, "xxh64");
+    test_hashtable_benchmark (100000, NULL, "djb2");
+    test_hashtable_benchmark (100000, &hashtable_hash_key_fast_cb, "xxh64");
+    test_hashtable_benchmark (1000000, NULL, "djb2");
+    test_hashtable_benchmark (1000000, &hashtable_hash_key_fast_cb, "xxh64");
+    printf ("\n");
+}
+
 /*
  * Tests functions:
  *   hashtable_map
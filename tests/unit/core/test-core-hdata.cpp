@@ -24,6 +24,11 @@
 extern "C"
 {
 #include "src/core/wee-hdata.h"
+#include "src/core/wee-hook.h"
+#include "src/gui/gui-buffer.h"
+#include "src/gui/gui-chat.h"
+#include "src/gui/gui-line.h"
+#include "src/gui/gui-nicklist.h"
 }
 
 TEST_GROUP(CoreHdata)
@@ -62,12 +67,109 @@ TEST(CoreHdata, Get)
 
 /*
  * Tests functions:
+ *   hdata_list_add_pointer
+ *   hdata_list_remove_pointer
+ *   hdata_list_search_pointer
+ *   hdata_list_index_new
+ *   hdata_list_index_reset
+ *   hdata_list_index_free
  *   hdata_check_pointer
  */
 
 TEST(CoreHdata, Check)
 {
-    /* TODO: write tests */
+    struct t_hdata *hdata, *hdata_line, *hdata_group, *hdata_nick;
+    struct t_gui_buffer *buffer;
+    struct t_gui_line *line1, *line3;
+    struct t_gui_nick_group *group;
+    struct t_gui_nick *nick1, *nick2;
+    static int value1, value2;
+
+    /* index of pointers for a list */
+    LONGS_EQUAL(-1, hdata_list_search_pointer (NULL, NULL));
+    LONGS_EQUAL(-1, hdata_list_search_pointer (&value1, &value2));
+    hdata_list_add_pointer (NULL, NULL);
+    hdata_list_add_pointer (&value1, NULL);
+    LONGS_EQUAL(-1, hdata_list_search_pointer (&value1, &value2));
+    hdata_list_add_pointer (&value1, &value2);
+    LONGS_EQUAL(1, hdata_list_search_pointer (&value1, &value2));
+    LONGS_EQUAL(0, hdata_list_search_pointer (&value1, &value1));
+    LONGS_EQUAL(0, hdata_list_search_pointer (&value1, NULL));
+    hdata_list_remove_pointer (&value1, &value2);
+    LONGS_EQUAL(0, hdata_list_search_pointer (&value1, &value2));
+    hdata_list_remove_pointer (NULL, NULL);
+
+    hdata = hook_hdata_get (NULL, "buffer");
+    CHECK(hdata);
+
+    LONGS_EQUAL(0, hdata_check_pointer (NULL, NULL, NULL));
+    LONGS_EQUAL(0, hdata_check_pointer (hdata, NULL, NULL));
+
+    /* buffers are in index of pointers */
+    LONGS_EQUAL(1, hdata_list_search_pointer (&gui_buffers, gui_buffers));
+
+    buffer = gui_buffer_new (NULL, "test-check", NULL, NULL, NULL,
+                             NULL, NULL, NULL);
+    CHECK(buffer);
+    LONGS_EQUAL(1, hdata_list_search_pointer (&gui_buffers, buffer));
+    LONGS_EQUAL(1, hdata_check_pointer (hdata, NULL, gui_buffers));
+    LONGS_EQUAL(1, hdata_check_pointer (hdata, NULL, buffer));
+    LONGS_EQUAL(1, hdata_check_pointer (hdata, gui_buffers, buffer));
+    LONGS_EQUAL(1, hdata_check_pointer (hdata, buffer, buffer));
+    LONGS_EQUAL(0, hdata_check_pointer (hdata, NULL, &value1));
+    LONGS_EQUAL(0, hdata_check_pointer (hdata, gui_buffers, &value1));
+    LONGS_EQUAL(1, gui_buffer_valid (buffer));
+
+    /* lines of buffer are indexed on demand */
+    hdata_line = hook_hdata_get (NULL, "line");
+    CHECK(hdata_line);
+    gui_chat_printf (buffer, "line 1");
+    gui_chat_printf (buffer, "line 2");
+    line1 = buffer->own_lines->first_line;
+    LONGS_EQUAL(1, hdata_check_pointer (hdata_line, line1,
+                                        buffer->own_lines->last_line));
+    LONGS_EQUAL(0, hdata_check_pointer (hdata_line, line1, &value1));
+    gui_chat_printf (buffer, "line 3");
+    line3 = buffer->own_lines->last_line;
+    LONGS_EQUAL(1, hdata_check_pointer (hdata_line, line1, line3));
+    gui_line_free (buffer, line3);
+    LONGS_EQUAL(0, hdata_check_pointer (hdata_line, line1, line3));
+    gui_line_free (buffer, line1);
+    LONGS_EQUAL(1, hdata_check_pointer (hdata_line,
+                                        buffer->own_lines->first_line,
+                                        buffer->own_lines->last_line));
+    LONGS_EQUAL(0, hdata_check_pointer (hdata_line,
+                                        buffer->own_lines->first_line,
+                                        line1));
+
+    /* nicklist of buffer is indexed on demand */
+    hdata_group = hook_hdata_get (NULL, "nick_group");
+    CHECK(hdata_group);
+    hdata_nick = hook_hdata_get (NULL, "nick");
+    CHECK(hdata_nick);
+    group = gui_nicklist_add_group (buffer, NULL, "group", NULL, 1);
+    CHECK(group);
+    nick1 = gui_nicklist_add_nick (buffer, group, "nick1", NULL, NULL, NULL,
+                                   1);
+    CHECK(nick1);
+    nick2 = gui_nicklist_add_nick (buffer, group, "nick2", NULL, NULL, NULL,
+                                   1);
+    CHECK(nick2);
+    LONGS_EQUAL(1, hdata_check_pointer (hdata_group,
+                                        buffer->nicklist_root->children,
+                                        group));
+    LONGS_EQUAL(1, hdata_check_pointer (hdata_nick, group->nicks, nick2));
+    LONGS_EQUAL(0, hdata_check_pointer (hdata_nick, group->nicks, &value1));
+    gui_nicklist_remove_nick (buffer, nick1);
+    LONGS_EQUAL(0, hdata_check_pointer (hdata_nick, group->nicks, nick1));
+    LONGS_EQUAL(1, hdata_check_pointer (hdata_nick, group->nicks, nick2));
+    gui_nicklist_remove_all (buffer);
+
+    gui_buffer_close (buffer);
+    LONGS_EQUAL(0, hdata_list_search_pointer (&gui_buffers, buffer));
+    LONGS_EQUAL(0, hdata_check_pointer (hdata, NULL, buffer));
+    LONGS_EQUAL(0, hdata_check_pointer (hdata, gui_buffers, buffer));
+    LONGS_EQUAL(0, gui_buffer_valid (buffer));
 }
 
 /*
@@ -23,7 +23,13 @@
 
 extern "C"
 {
+#include <errno.h>
 #include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
 #include "src/core/wee-hook.h"
 #include "src/core/wee-string.h"
 #include "src/gui/gui-buffer.h"
@@ -78,6 +84,90 @@ TEST(CoreHook, Config)
     /* TODO: write tests */
 }
 
+int test_hook_connect_calls;
+int test_hook_connect_calls_cancelled;
+int test_hook_connect_status;
+int test_hook_connect_sock;
+char test_hook_connect_error[256];
+char test_hook_connect_ip_address[256];
+
+int
+test_hook_connect_cb (const void *pointer, void *data,
+                      int status, int gnutls_rc, int sock,
+                      const char *error, const char *ip_address)
+{
+    /* make C++ compiler happy */
+    (void) data;
+    (void) gnutls_rc;
+
+    /* the pointer is set to a non-NULL value for a cancelled hook */
+    if (pointer)
+    {
+        test_hook_connect_calls_cancelled++;
+        return WEECHAT_RC_OK;
+    }
+
+    test_hook_connect_calls++;
+    test_hook_connect_status = status;
+    test_hook_connect_sock = sock;
+    snprintf (test_hook_connect_error, sizeof (test_hook_connect_error),
+              "%s", (error) ? error : "");
+    snprintf (test_hook_connect_ip_address,
+              sizeof (test_hook_connect_ip_address),
+              "%s", (ip_address) ? ip_address : "");
+
+    return WEECHAT_RC_OK;
+}
+
+/*
+ * Runs timer and fd hooks until the connect callback is called (or 10
+ * seconds have elapsed).
+ */
+
+void
+test_hook_connect_run ()
+{
+    time_t time_start;
+
+    time_start = time (NULL);
+    while ((test_hook_connect_calls == 0)
+           && (time (NULL) - time_start < 10))
+    {
+        hook_timer_exec ();
+        hook_fd_exec ();
+    }
+}
+
+/*
+ * Creates a socket bound to a port on 127.0.0.1 and returns it (the port is
+ * stored in "port").
+ */
+
+int
+test_hook_connect_socket (int *port)
+{
+    struct sockaddr_in addr;
+    socklen_t length;
+    int sock;
+
+    sock = socket (AF_INET, SOCK_STREAM, 0);
+    if (sock < 0)
+        return -1;
+    memset (&addr, 0, sizeof (addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl (INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    length = sizeof (addr);
+    if ((bind (sock, (struct sockaddr *)&addr, sizeof (addr)) < 0)
+        || (getsockname (sock, (struct sockaddr *)&addr, &length) < 0))
+    {
+        close (sock);
+        return -1;
+    }
+    *port = ntohs (addr.sin_port);
+    return sock;
+}
+
 /*
  * Tests functions:
  *   hook_connect
@@ -85,7 +175,78 @@ TEST(CoreHook, Config)
 
 TEST(CoreHook, Connect)
 {
-    /* TODO: write tests */
+    struct t_hook *hook;
+    int sock_listen, sock_closed, port_listen, port_closed;
+    static int cancelled;
+
+    POINTERS_EQUAL(NULL, hook_connect (NULL, NULL, NULL, 1, 0, 0,
+                                       NULL, NULL, 0, NULL, NULL,
+                                       &test_hook_connect_cb, NULL, NULL));
+    POINTERS_EQUAL(NULL, hook_connect (NULL, NULL, "127.0.0.1", 0, 0, 0,
+                                       NULL, NULL, 0, NULL, NULL,
+                                       &test_hook_connect_cb, NULL, NULL));
+    POINTERS_EQUAL(NULL, hook_connect (NULL, NULL, "127.0.0.1", 1, 0, 0,
+                                       NULL, NULL, 0, NULL, NULL,
+                                       NULL, NULL, NULL));
+
+    sock_listen = test_hook_connect_socket (&port_listen);
+    CHECK(sock_listen >= 0);
+    LONGS_EQUAL(0, listen (sock_listen, 16));
+
+    /* port of a socket closed (nothing listening on it) */
+    sock_closed = test_hook_connect_socket (&port_closed);
+    CHECK(sock_closed >= 0);
+    close (sock_closed);
+
+    /* connection OK */
+    test_hook_connect_calls = 0;
+    hook = hook_connect (NULL, NULL, "127.0.0.1", port_listen, 0, 0,
+                         NULL, NULL, 0, NULL, NULL,
+                         &test_hook_connect_cb, NULL, NULL);
+    CHECK(hook);
+    test_hook_connect_run ();
+    LONGS_EQUAL(1, test_hook_connect_calls);
+    LONGS_EQUAL(WEECHAT_HOOK_CONNECT_OK, test_hook_connect_status);
+    CHECK(test_hook_connect_sock >= 0);
+    STRCMP_EQUAL("127.0.0.1", test_hook_connect_ip_address);
+    close (test_hook_connect_sock);
+
+    /* connection refused */
+    test_hook_connect_calls = 0;
+    hook = hook_connect (NULL, NULL, "127.0.0.1", port_closed, 0, 0,
+                         NULL, NULL, 0, NULL, NULL,
+                         &test_hook_connect_cb, NULL, NULL);
+    CHECK(hook);
+    test_hook_connect_run ();
+    LONGS_EQUAL(1, test_hook_connect_calls);
+    LONGS_EQUAL(WEECHAT_HOOK_CONNECT_CONNECTION_REFUSED,
+                test_hook_connect_status);
+    LONGS_EQUAL(-1, test_hook_connect_sock);
+    STRCMP_EQUAL(strerror (ECONNREFUSED), test_hook_connect_error);
+
+    /*
+     * hook removed while the name resolution is pending: the resolution is
+     * freed (or ignored when it's done) and the callback is not called
+     */
+    test_hook_connect_calls = 0;
+    test_hook_connect_calls_cancelled = 0;
+    hook = hook_connect (NULL, NULL, "127.0.0.1", port_listen, 0, 0,
+                         NULL, NULL, 0, NULL, NULL,
+                         &test_hook_connect_cb, &cancelled, NULL);
+    CHECK(hook);
+    CHECK(HOOK_CONNECT(hook, resolve));
+    unhook (hook);
+    hook = hook_connect (NULL, NULL, "127.0.0.1", port_listen, 0, 0,
+                         NULL, NULL, 0, NULL, NULL,
+                         &test_hook_connect_cb, NULL, NULL);
+    CHECK(hook);
+    test_hook_connect_run ();
+    LONGS_EQUAL(1, test_hook_connect_calls);
+    LONGS_EQUAL(WEECHAT_HOOK_CONNECT_OK, test_hook_connect_status);
+    LONGS_EQUAL(0, test_hook_connect_calls_cancelled);
+    close (test_hook_connect_sock);
+
+    close (sock_listen);
 }
 
 /*
@@ -0,0 +1,163 @@
+/*
+ * test-core-network.cpp - test network functions
+ *
+ * Copyright (C) 2020 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "CppUTest/TestHarness.h"
+
+extern "C"
+{
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <netdb.h>
+#include "src/core/wee-network.h"
+}
+
+#define TEST_NETWORK_NUM_ADDRESSES 7
+
+/* families of addresses, as returned by getaddrinfo: 3 groups */
+int test_network_families[TEST_NETWORK_NUM_ADDRESSES] =
+{ AF_INET6, AF_INET6, AF_INET, AF_INET, AF_INET, AF_INET6, AF_INET6 };
+
+struct addrinfo test_network_res[TEST_NETWORK_NUM_ADDRESSES];
+
+TEST_GROUP(CoreNetwork)
+{
+};
+
+/*
+ * Initializes the list of addresses (like a result of getaddrinfo).
+ */
+
+void
+test_network_init_addresses ()
+{
+    int i;
+
+    memset (test_network_res, 0, sizeof (test_network_res));
+    for (i = 0; i < TEST_NETWORK_NUM_ADDRESSES; i++)
+    {
+        test_network_res[i].ai_family = test_network_families[i];
+        test_network_res[i].ai_next = (i < TEST_NETWORK_NUM_ADDRESSES - 1) ?
+            &test_network_res[i + 1] : NULL;
+    }
+}
+
+/*
+ * Tests functions:
+ *   network_sort_addresses
+ */
+
+TEST(CoreNetwork, SortAddresses)
+{
+    struct addrinfo **addresses;
+    int i, j, count;
+
+    test_network_init_addresses ();
+
+    /* no IP address */
+    test_network_res[0].ai_family = AF_UNSPEC;
+    test_network_res[0].ai_next = NULL;
+    LONGS_EQUAL(0, network_sort_addresses (test_network_res, 0, &addresses));
+    POINTERS_EQUAL(NULL, addresses);
+    test_network_init_addresses ();
+
+    /* retry 0: first group first, addresses shuffled in groups */
+    LONGS_EQUAL(TEST_NETWORK_NUM_ADDRESSES,
+                network_sort_addresses (test_network_res, 0, &addresses));
+    CHECK(addresses);
+    for (i = 0; i < TEST_NETWORK_NUM_ADDRESSES; i++)
+    {
+        LONGS_EQUAL(test_network_families[i], addresses[i]->ai_family);
+    }
+    CHECK((addresses[0] == &test_network_res[0]) || (addresses[0] == &test_network_res[1]));
+    CHECK((addresses[5] == &test_network_res[5]) || (addresses[5] == &test_network_res[6]));
+    free (addresses);
+
+    /* retry 1: start with second group (IPv4), first group at the end */
+    LONGS_EQUAL(TEST_NETWORK_NUM_ADDRESSES,
+                network_sort_addresses (test_network_res, 1, &addresses));
+    LONGS_EQUAL(AF_INET, addresses[0]->ai_family);
+    LONGS_EQUAL(AF_INET, addresses[2]->ai_family);
+    LONGS_EQUAL(AF_INET6, addresses[3]->ai_family);
+    CHECK((addresses[3] == &test_network_res[5]) || (addresses[3] == &test_network_res[6]));
+    CHECK((addresses[5] == &test_network_res[0]) || (addresses[5] == &test_network_res[1]));
+    free (addresses);
+
+    /* retry 3 is the same as retry 0 (3 groups) */
+    LONGS_EQUAL(TEST_NETWORK_NUM_ADDRESSES,
+                network_sort_addresses (test_network_res, 3, &addresses));
+    LONGS_EQUAL(AF_INET6, addresses[0]->ai_family);
+    CHECK((addresses[0] == &test_network_res[0]) || (addresses[0] == &test_network_res[1]));
+
+    /* each address is present once */
+    for (i = 0; i < TEST_NETWORK_NUM_ADDRESSES; i++)
+    {
+        count = 0;
+        for (j = 0; j < TEST_NETWORK_NUM_ADDRESSES; j++)
+        {
+            if (addresses[j] == &test_network_res[i])
+                count++;
+        }
+        LONGS_EQUAL(1, count);
+    }
+    free (addresses);
+}
+
+/*
+ * Tests functions:
+ *   network_interleave_addresses
+ */
+
+TEST(CoreNetwork, InterleaveAddresses)
+{
+    struct addrinfo *addresses[TEST_NETWORK_NUM_ADDRESSES];
+    int i;
+
+    test_network_init_addresses ();
+
+    for (i = 0; i < TEST_NETWORK_NUM_ADDRESSES; i++)
+    {
+        addresses[i] = &test_network_res[i];
+    }
+
+    network_interleave_addresses (NULL, 0);
+    network_interleave_addresses (addresses, 0);
+
+    /* families are alternated, order is kept in each family */
+    network_interleave_addresses (addresses, TEST_NETWORK_NUM_ADDRESSES);
+    POINTERS_EQUAL(&test_network_res[0], addresses[0]);
+    POINTERS_EQUAL(&test_network_res[2], addresses[1]);
+    POINTERS_EQUAL(&test_network_res[1], addresses[2]);
+    POINTERS_EQUAL(&test_network_res[3], addresses[3]);
+    POINTERS_EQUAL(&test_network_res[5], addresses[4]);
+    POINTERS_EQUAL(&test_network_res[4], addresses[5]);
+    POINTERS_EQUAL(&test_network_res[6], addresses[6]);
+
+    /* only one family: order is not changed */
+    for (i = 0; i < 3; i++)
+    {
+        addresses[i] = &test_network_res[2 + i];
+    }
+    network_interleave_addresses (addresses, 3);
+    POINTERS_EQUAL(&test_network_res[2], addresses[0]);
+    POINTERS_EQUAL(&test_network_res[3], addresses[1]);
+    POINTERS_EQUAL(&test_network_res[4], addresses[2]);
+}
@@ -0,0 +1,143 @@
+/*
+ * test-core-slab.cpp - test slab functions
+ *
+ * Copyright (C) 2020 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "CppUTest/TestHarness.h"
+
+extern "C"
+{
+#include <stdlib.h>
+#include <string.h>
+#include "src/core/wee-slab.h"
+}
+
+TEST_GROUP(CoreSlab)
+{
+};
+
+/*
+ * Tests functions:
+ *   slab_new
+ *   slab_free
+ */
+
+TEST(CoreSlab, New)
+{
+    struct t_slab *slab;
+
+    POINTERS_EQUAL(NULL, slab_new (-1));
+    POINTERS_EQUAL(NULL, slab_new (0));
+    POINTERS_EQUAL(NULL, slab_new (SLAB_CHUNK_SIZE));
+
+    slab = slab_new (1);
+    CHECK(slab);
+    LONGS_EQUAL(sizeof (void *), slab->object_size);
+    CHECK(slab->objects_per_chunk >= SLAB_MIN_OBJECTS_PER_CHUNK);
+    LONGS_EQUAL(0, slab->objects_count);
+    LONGS_EQUAL(0, slab->chunks_count);
+    POINTERS_EQUAL(NULL, slab->chunks);
+    POINTERS_EQUAL(NULL, slab->last_chunk);
+    slab_free (slab);
+
+    slab = slab_new (sizeof (void *) + 1);
+    CHECK(slab);
+    LONGS_EQUAL(2 * sizeof (void *), slab->object_size);
+    slab_free (slab);
+
+    /* test free of NULL slab */
+    slab_free (NULL);
+}
+
+/*
+ * Tests functions:
+ *   slab_alloc
+ *   slab_free_object
+ */
+
+TEST(CoreSlab, AllocFree)
+{
+    struct t_slab *slab;
+    char **objects;
+    int i, count;
+
+    POINTERS_EQUAL(NULL, slab_alloc (NULL));
+    slab_free_object (NULL, NULL);
+
+    slab = slab_new (40);
+    CHECK(slab);
+
+    /* allocate objects in 3 chunks */
+    count = (slab->objects_per_chunk * 2) + 10;
+    objects = (char **)malloc (count * sizeof (*objects));
+    CHECK(objects);
+    for (i = 0; i < count; i++)
+    {
+        objects[i] = (char *)slab_alloc (slab);
+        CHECK(objects[i]);
+        memset (objects[i], i % 256, 40);
+    }
+    LONGS_EQUAL(count, slab->objects_count);
+    LONGS_EQUAL(3, slab->chunks_count);
+
+    /* objects are distinct and content is not changed */
+    for (i = 0; i < count; i++)
+    {
+        LONGS_EQUAL(i % 256, (unsigned char)objects[i][0]);
+        LONGS_EQUAL(i % 256, (unsigned char)objects[i][39]);
+    }
+
+    /* free objects of first chunk: chunk is empty and kept (first in list) */
+    for (i = 0; i < slab->objects_per_chunk; i++)
+    {
+        slab_free_object (slab, objects[i]);
+    }
+    LONGS_EQUAL(count - slab->objects_per_chunk, slab->objects_count);
+    LONGS_EQUAL(3, slab->chunks_count);
+
+    /*
+     * free an object in a full chunk: this chunk becomes first in list and
+     * the empty chunk is freed; then the object is used again
+     */
+    slab_free_object (slab, objects[count - 20]);
+    LONGS_EQUAL(2, slab->chunks_count);
+    POINTERS_EQUAL(objects[count - 20], slab_alloc (slab));
+
+    /* free all objects: only one chunk is kept */
+    for (i = slab->objects_per_chunk; i < count; i++)
+    {
+        slab_free_object (slab, objects[i]);
+    }
+    LONGS_EQUAL(0, slab->objects_count);
+    LONGS_EQUAL(1, slab->chunks_count);
+
+    /* allocate again */
+    for (i = 0; i < count; i++)
+    {
+        objects[i] = (char *)slab_alloc (slab);
+        CHECK(objects[i]);
+    }
+    LONGS_EQUAL(count, slab->objects_count);
+    LONGS_EQUAL(3, slab->chunks_count);
+
+    /* free slab with objects allocated */
+    slab_free (slab);
+
+    free (objects);
+}
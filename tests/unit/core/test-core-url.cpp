@@ -23,13 +23,39 @@
 
 extern "C"
 {
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "src/core/weechat.h"
+#include "src/core/wee-hashtable.h"
 #include "src/core/wee-url.h"
+#include "src/plugins/plugin.h"
 }
 
+#define TEST_URL_CONTENT "test content"
+
 TEST_GROUP(CoreUrl)
 {
 };
 
+/*
+ * Builds path of a file in WeeChat home (result must be freed after use).
+ */
+
+char *
+test_url_filename (const char *name)
+{
+    char *filename;
+    int length;
+
+    length = strlen (weechat_home) + strlen (name) + 2;
+    filename = (char *)malloc (length);
+    if (filename)
+        snprintf (filename, length, "%s/%s", weechat_home, name);
+    return filename;
+}
+
 /*
  * Tests functions:
  *   weeurl_download
@@ -37,7 +63,100 @@ TEST_GROUP(CoreUrl)
 
 TEST(CoreUrl, Download)
 {
-    /* TODO: write tests */
+    struct t_hashtable *options;
+    char *file_src, *file_dst, url[4096], content[256];
+    FILE *file;
+    size_t num_read;
+
+    /* invalid URL */
+    LONGS_EQUAL(1, weeurl_download (NULL, NULL));
+    LONGS_EQUAL(1, weeurl_download ("", NULL));
+
+    options = hashtable_new (32,
+                             WEECHAT_HASHTABLE_STRING,
+                             WEECHAT_HASHTABLE_STRING,
+                             NULL, NULL);
+    CHECK(options);
+
+    /* file error */
+    hashtable_set (options, "file_in", "/nonexistent/dir/file");
+    LONGS_EQUAL(4, weeurl_download ("file:///dev/null", options));
+    hashtable_remove_all (options);
+
+    /* download of a local file in another file */
+    file_src = test_url_filename ("test_url_src.txt");
+    CHECK(file_src);
+    file_dst = test_url_filename ("test_url_dst.txt");
+    CHECK(file_dst);
+    file = fopen (file_src, "w");
+    CHECK(file);
+    fputs (TEST_URL_CONTENT, file);
+    fclose (file);
+    snprintf (url, sizeof (url), "file://%s", file_src);
+    hashtable_set (options, "file_out", file_dst);
+    LONGS_EQUAL(0, weeurl_download (url, options));
+    file = fopen (file_dst, "r");
+    CHECK(file);
+    num_read = fread (content, 1, sizeof (content) - 1, file);
+    content[num_read] = '\0';
+    fclose (file);
+    STRCMP_EQUAL(TEST_URL_CONTENT, content);
+
+    unlink (file_src);
+    unlink (file_dst);
+    free (file_src);
+    free (file_dst);
+    hashtable_free (options);
+}
+
+/*
+ * Tests functions:
+ *   weeurl_transfer_start
+ *   weeurl_transfer_free
+ */
+
+TEST(CoreUrl, Transfer)
+{
+    struct t_hashtable *options;
+    struct t_url_transfer *transfer;
+    int rc;
+
+    if (!weeurl_transfer_available ())
+        return;
+
+    /* invalid URL */
+    rc = -1;
+    POINTERS_EQUAL(NULL, weeurl_transfer_start (NULL, NULL, NULL, NULL, NULL,
+                                                &rc));
+    LONGS_EQUAL(1, rc);
+    rc = -1;
+    POINTERS_EQUAL(NULL, weeurl_transfer_start ("", NULL, NULL, NULL, NULL,
+                                                &rc));
+    LONGS_EQUAL(1, rc);
+
+    /* file error */
+    options = hashtable_new (32,
+                             WEECHAT_HASHTABLE_STRING,
+                             WEECHAT_HASHTABLE_STRING,
+                             NULL, NULL);
+    CHECK(options);
+    hashtable_set (options, "file_out", "/nonexistent/dir/file");
+    rc = -1;
+    POINTERS_EQUAL(NULL, weeurl_transfer_start ("file:///dev/null", options,
+                                                NULL, NULL, NULL, &rc));
+    LONGS_EQUAL(4, rc);
+    hashtable_free (options);
+
+    /* start a transfer, then cancel it */
+    rc = -1;
+    transfer = weeurl_transfer_start ("file:///dev/null", NULL,
+                                      NULL, NULL, NULL, &rc);
+    CHECK(transfer);
+    LONGS_EQUAL(0, rc);
+    LONGS_EQUAL(1, transfer->running);
+    LONGS_EQUAL(0, transfer->pending);
+    STRCMP_EQUAL("file:///dev/null", transfer->url);
+    weeurl_transfer_free (transfer);
 }
 
 /*
@@ -23,7 +23,13 @@
 
 extern "C"
 {
+#include <stdlib.h>
+#include <string.h>
+#include "src/core/wee-config.h"
+#include "src/core/wee-config-file.h"
 #include "src/core/wee-string.h"
+#include "src/gui/gui-buffer.h"
+#include "src/gui/gui-chat.h"
 #include "src/gui/gui-line.h"
 }
 
@@ -33,7 +39,9 @@ extern "C"
     LONGS_EQUAL(__result, gui_line_match_tags (&line_data, tags_count,  \
                                                tags_array));            \
     gui_line_tags_free (&line_data);                                    \
-    string_free_split_tags (tags_array);
+    string_free_split_tags (tags_array);                                \
+    free (line_data.message);                                           \
+    line_data.message = NULL;
 
 TEST_GROUP(GuiLine)
 {
@@ -50,6 +58,8 @@ TEST(GuiLine, LineMatchTags)
     char ***tags_array;
     int tags_count;
 
+    memset (&line_data, 0, sizeof (line_data));
+
     /* line without tags */
     WEE_LINE_MATCH_TAGS(0, NULL, NULL);
     WEE_LINE_MATCH_TAGS(0, NULL, "irc_join");
@@ -79,3 +89,151 @@ TEST(GuiLine, LineMatchTags)
     WEE_LINE_MATCH_TAGS(1, "irc_join,nick_test", "!irc_quit,!irc_302,!irc_notice");
     WEE_LINE_MATCH_TAGS(1, "irc_join,nick_test", "!irc_quit+!irc_302+!irc_notice");
 }
+
+/*
+ * Tests functions:
+ *   gui_line_set_strings
+ *   gui_line_set_str_time
+ *   gui_line_set_message
+ *   gui_line_tags_alloc
+ *   gui_line_tags_free
+ */
+
+TEST(GuiLine, SetStrings)
+{
+    struct t_gui_line_data line_data;
+    char **tags;
+    int count;
+
+    memset (&line_data, 0, sizeof (line_data));
+
+    LONGS_EQUAL(1, gui_line_set_strings (&line_data, NULL, 0, NULL, NULL));
+    STRCMP_EQUAL("", line_data.message);
+    POINTERS_EQUAL(NULL, line_data.str_time);
+    LONGS_EQUAL(0, line_data.tags_count);
+    POINTERS_EQUAL(NULL, line_data.tags_array);
+
+    tags = string_split_shared ("irc_privmsg,nick_test", ",", NULL, 0, 0,
+                                &count);
+    LONGS_EQUAL(1, gui_line_set_strings (&line_data, "12:34", count, tags,
+                                         "hello"));
+    free (tags);
+    STRCMP_EQUAL("hello", line_data.message);
+    STRCMP_EQUAL("12:34", line_data.str_time);
+    LONGS_EQUAL(2, line_data.tags_count);
+    STRCMP_EQUAL("irc_privmsg", line_data.tags_array[0]);
+    STRCMP_EQUAL("nick_test", line_data.tags_array[1]);
+    POINTERS_EQUAL(NULL, line_data.tags_array[2]);
+
+    /* change message, other strings are kept */
+    gui_line_set_message (&line_data, "a longer message in the line");
+    STRCMP_EQUAL("a longer message in the line", line_data.message);
+    STRCMP_EQUAL("12:34", line_data.str_time);
+    LONGS_EQUAL(2, line_data.tags_count);
+    STRCMP_EQUAL("irc_privmsg", line_data.tags_array[0]);
+    STRCMP_EQUAL("nick_test", line_data.tags_array[1]);
+
+    /* change time, other strings are kept */
+    gui_line_set_str_time (&line_data, "12:34:56");
+    STRCMP_EQUAL("a longer message in the line", line_data.message);
+    STRCMP_EQUAL("12:34:56", line_data.str_time);
+    LONGS_EQUAL(2, line_data.tags_count);
+    gui_line_set_str_time (&line_data, NULL);
+    POINTERS_EQUAL(NULL, line_data.str_time);
+    STRCMP_EQUAL("a longer message in the line", line_data.message);
+
+    /* change tags, other strings are kept */
+    gui_line_tags_free (&line_data);
+    LONGS_EQUAL(0, line_data.tags_count);
+    POINTERS_EQUAL(NULL, line_data.tags_array);
+    gui_line_tags_alloc (&line_data, "irc_join");
+    LONGS_EQUAL(1, line_data.tags_count);
+    STRCMP_EQUAL("irc_join", line_data.tags_array[0]);
+    POINTERS_EQUAL(NULL, line_data.tags_array[1]);
+    STRCMP_EQUAL("a longer message in the line", line_data.message);
+
+    gui_line_tags_free (&line_data);
+    free (line_data.message);
+}
+
+/*
+ * Tests functions:
+ *   gui_line_compress_block
+ *   gui_line_uncompress_block
+ *   gui_line_uncompress_all
+ */
+
+TEST(GuiLine, CompressBlock)
+{
+    struct t_gui_buffer *buffer;
+    struct t_gui_line *ptr_line;
+    char message[64];
+    int i;
+
+    config_file_option_set (config_history_max_buffer_lines_uncompressed,
+                            "10", 1);
+
+    buffer = gui_buffer_new (NULL, "test-compress",
+                             NULL, NULL, NULL,
+                             NULL, NULL, NULL);
+    CHECK(buffer);
+
+    for (i = 0; i < GUI_LINE_BLOCK_LINES + 10; i++)
+    {
+        gui_chat_printf_date_tags (buffer, 1600000000 + i,
+                                   (i % 2 == 0) ? "tag1,tag2" : NULL,
+                                   "nick%d\tmessage %d", i % 3, i);
+    }
+
+    /* oldest lines are compressed */
+    LONGS_EQUAL(10, buffer->own_lines->lines_count);
+    LONGS_EQUAL(GUI_LINE_BLOCK_LINES,
+                buffer->own_lines->compressed_lines_count);
+    CHECK(buffer->own_lines->first_block);
+    POINTERS_EQUAL(buffer->own_lines->first_block,
+                   buffer->own_lines->last_block);
+    STRCMP_EQUAL("message 256", buffer->own_lines->first_line->data->message);
+    LONGS_EQUAL(0, gui_line_compress_block (buffer));
+
+    /* uncompress lines by moving to the previous line */
+    ptr_line = gui_line_get_prev_displayed (buffer->own_lines->first_line);
+    CHECK(ptr_line);
+    STRCMP_EQUAL("message 255", ptr_line->data->message);
+    LONGS_EQUAL(GUI_LINE_BLOCK_LINES + 10, buffer->own_lines->lines_count);
+    LONGS_EQUAL(0, buffer->own_lines->compressed_lines_count);
+    POINTERS_EQUAL(NULL, buffer->own_lines->first_block);
+    POINTERS_EQUAL(NULL, buffer->own_lines->last_block);
+
+    /* check content of uncompressed lines */
+    i = 0;
+    for (ptr_line = buffer->own_lines->first_line; ptr_line;
+         ptr_line = ptr_line->next_line)
+    {
+        snprintf (message, sizeof (message), "message %d", i);
+        STRCMP_EQUAL(message, ptr_line->data->message);
+        snprintf (message, sizeof (message), "nick%d", i % 3);
+        STRCMP_EQUAL(message, ptr_line->data->prefix);
+        LONGS_EQUAL(1600000000 + i, ptr_line->data->date);
+        LONGS_EQUAL((i % 2 == 0) ? 2 : 0, ptr_line->data->tags_count);
+        if (i % 2 == 0)
+        {
+            STRCMP_EQUAL("tag1", ptr_line->data->tags_array[0]);
+            STRCMP_EQUAL("tag2", ptr_line->data->tags_array[1]);
+        }
+        CHECK(ptr_line->data->str_time);
+        i++;
+    }
+    LONGS_EQUAL(GUI_LINE_BLOCK_LINES + 10, i);
+
+    /* compress again, then uncompress all lines */
+    LONGS_EQUAL(1, gui_line_compress_block (buffer));
+    LONGS_EQUAL(10, buffer->own_lines->lines_count);
+    gui_line_uncompress_all (buffer);
+    LONGS_EQUAL(GUI_LINE_BLOCK_LINES + 10, buffer->own_lines->lines_count);
+    STRCMP_EQUAL("message 0", buffer->own_lines->first_line->data->message);
+    LONGS_EQUAL(0, gui_line_uncompress_block (buffer));
+
+    gui_buffer_close (buffer);
+
+    config_file_option_reset (config_history_max_buffer_lines_uncompressed, 1);
+}
@@ -0,0 +1,401 @@
+/*
+ * test-gui-nicklist.cpp - test nicklist functions
+ *
+ * Copyright (C) 2020 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "CppUTest/TestHarness.h"
+
+extern "C"
+{
+#include <string.h>
+#include "src/core/wee-hashtable.h"
+#include "src/core/wee-string.h"
+#include "src/gui/gui-buffer.h"
+#include "src/gui/gui-nicklist.h"
+
+extern unsigned long long gui_nicklist_hash_key_cb (struct t_hashtable *hashtable,
+                                                    const void *key);
+extern int gui_nicklist_keycmp_cb (struct t_hashtable *hashtable,
+                                   const void *key1, const void *key2);
+}
+
+#define TEST_NICKLIST_NUM_NICKS 9
+
+/* nicks in the expected order of nicklist */
+const char *test_nicklist_nicks_sorted[TEST_NICKLIST_NUM_NICKS] =
+{ "[x]", "_y", "Alice", "alice", "Bob", "bob", "bob2", "carol", "{z}" };
+
+/* same nicks, in the order they are added */
+const char *test_nicklist_nicks_added[TEST_NICKLIST_NUM_NICKS] =
+{ "carol", "bob", "{z}", "Alice", "bob2", "_y", "Bob", "[x]", "alice" };
+
+TEST_GROUP(GuiNicklist)
+{
+};
+
+/*
+ * Compares two nicks with IRC casemapping "rfc1459" (chars "[ \ ] ^" are the
+ * uppercase of "{ | } ~"), like IRC buffers do.
+ */
+
+int
+test_nicklist_nickcmp_cb (const void *pointer, void *data,
+                          struct t_gui_buffer *buffer,
+                          const char *nick1, const char *nick2)
+{
+    /* make C++ compiler happy */
+    (void) pointer;
+    (void) data;
+    (void) buffer;
+
+    return string_strcasecmp_range (nick1, nick2, 30);
+}
+
+/*
+ * Checks that nicks of a group are in the expected order.
+ *
+ * Returns:
+ *   1: nicks are in the expected order
+ *   0: nicks are not in the expected order
+ */
+
+int
+test_nicklist_check_order (struct t_gui_nick_group *group,
+                           const char **nicks, int num_nicks)
+{
+    struct t_gui_nick *ptr_nick;
+    int i;
+
+    i = 0;
+    for (ptr_nick = group->nicks; ptr_nick; ptr_nick = ptr_nick->next_nick)
+    {
+        if ((i >= num_nicks) || (strcmp (ptr_nick->name, nicks[i]) != 0))
+            return 0;
+        if ((ptr_nick->prev_nick && (ptr_nick->prev_nick->next_nick != ptr_nick))
+            || (!ptr_nick->next_nick && (group->last_nick != ptr_nick)))
+        {
+            return 0;
+        }
+        i++;
+    }
+
+    return (i == num_nicks) ? 1 : 0;
+}
+
+/*
+ * Tests functions:
+ *   gui_nicklist_hash_key_cb
+ *   gui_nicklist_keycmp_cb
+ */
+
+TEST(GuiNicklist, HashKey)
+{
+    CHECK(gui_nicklist_hash_key_cb (NULL, "nick")
+          == gui_nicklist_hash_key_cb (NULL, "NICK"));
+    CHECK(gui_nicklist_hash_key_cb (NULL, "nick")
+          == gui_nicklist_hash_key_cb (NULL, "Nick"));
+    CHECK(gui_nicklist_hash_key_cb (NULL, "{a}|~")
+          == gui_nicklist_hash_key_cb (NULL, "[A]\\^"));
+    CHECK(gui_nicklist_hash_key_cb (NULL, "nick")
+          != gui_nicklist_hash_key_cb (NULL, "nick2"));
+    CHECK(gui_nicklist_hash_key_cb (NULL, "_")
+          != gui_nicklist_hash_key_cb (NULL, "\x7f"));
+
+    LONGS_EQUAL(0, gui_nicklist_keycmp_cb (NULL, "nick", "nick"));
+    LONGS_EQUAL(0, gui_nicklist_keycmp_cb (NULL, "nick", "NICK"));
+    LONGS_EQUAL(0, gui_nicklist_keycmp_cb (NULL, "{a}|~", "[A]\\^"));
+    CHECK(gui_nicklist_keycmp_cb (NULL, "nick", "nick2") != 0);
+    CHECK(gui_nicklist_keycmp_cb (NULL, "_", "\x7f") != 0);
+}
+
+/*
+ * Tests functions:
+ *   gui_nicklist_add_nick
+ *   gui_nicklist_search_nick
+ *   gui_nicklist_remove_nick
+ *
+ * (buffer without callback "nickcmp": nicks are case sensitive)
+ */
+
+TEST(GuiNicklist, SearchNickCaseSensitive)
+{
+    struct t_gui_buffer *buffer;
+    struct t_gui_nick *nick1, *nick2;
+
+    buffer = gui_buffer_new (NULL, "test-nicklist", NULL, NULL, NULL,
+                             NULL, NULL, NULL);
+    CHECK(buffer);
+
+    nick1 = gui_nicklist_add_nick (buffer, NULL, "nick", NULL, NULL, NULL, 1);
+    CHECK(nick1);
+    LONGS_EQUAL(0, buffer->nicklist_nicks_key_collisions);
+
+    /* same key in hashtable, but another nick for the buffer */
+    nick2 = gui_nicklist_add_nick (buffer, NULL, "Nick", NULL, NULL, NULL, 1);
+    CHECK(nick2);
+    CHECK(nick2 != nick1);
+    LONGS_EQUAL(1, buffer->nicklist_nicks_key_collisions);
+
+    /* same nick: not added */
+    POINTERS_EQUAL(NULL, gui_nicklist_add_nick (buffer, NULL, "Nick",
+                                                NULL, NULL, NULL, 1));
+    LONGS_EQUAL(1, buffer->nicklist_nicks_key_collisions);
+
+    POINTERS_EQUAL(nick1, gui_nicklist_search_nick (buffer, NULL, "nick"));
+    POINTERS_EQUAL(nick2, gui_nicklist_search_nick (buffer, NULL, "Nick"));
+    POINTERS_EQUAL(NULL, gui_nicklist_search_nick (buffer, NULL, "NICK"));
+    POINTERS_EQUAL(NULL, gui_nicklist_search_nick (buffer, NULL, "nick2"));
+
+    /* remove nick in hashtable: the other nick replaces it */
+    gui_nicklist_remove_nick (buffer, nick1);
+    LONGS_EQUAL(0, buffer->nicklist_nicks_key_collisions);
+    POINTERS_EQUAL(nick2, hashtable_get (buffer->nicklist_nicks_hashtable,
+                                         "Nick"));
+    POINTERS_EQUAL(NULL, gui_nicklist_search_nick (buffer, NULL, "nick"));
+    POINTERS_EQUAL(nick2, gui_nicklist_search_nick (buffer, NULL, "Nick"));
+
+    /* add again "nick", then remove the nick which is not in hashtable */
+    nick1 = gui_nicklist_add_nick (buffer, NULL, "nick", NULL, NULL, NULL, 1);
+    CHECK(nick1);
+    LONGS_EQUAL(1, buffer->nicklist_nicks_key_collisions);
+    gui_nicklist_remove_nick (buffer, nick1);
+    LONGS_EQUAL(0, buffer->nicklist_nicks_key_collisions);
+    POINTERS_EQUAL(NULL, gui_nicklist_search_nick (buffer, NULL, "nick"));
+    POINTERS_EQUAL(nick2, gui_nicklist_search_nick (buffer, NULL, "Nick"));
+
+    gui_nicklist_remove_nick (buffer, nick2);
+    LONGS_EQUAL(0, buffer->nicklist_nicks_key_collisions);
+    LONGS_EQUAL(0, buffer->nicklist_nicks_count);
+    POINTERS_EQUAL(NULL, gui_nicklist_search_nick (buffer, NULL, "Nick"));
+
+    gui_buffer_close (buffer);
+}
+
+/*
+ * Tests functions:
+ *   gui_nicklist_add_nick
+ *   gui_nicklist_search_nick
+ *
+ * (buffer with callback "nickcmp" using IRC casemapping)
+ */
+
+TEST(GuiNicklist, SearchNickCasemapping)
+{
+    struct t_gui_buffer *buffer;
+    struct t_gui_nick_group *group;
+    struct t_gui_nick *nick;
+
+    buffer = gui_buffer_new (NULL, "test-nicklist", NULL, NULL, NULL,
+                             NULL, NULL, NULL);
+    CHECK(buffer);
+    gui_buffer_set_pointer (buffer, "nickcmp_callback",
+                            (void *)&test_nicklist_nickcmp_cb);
+
+    group = gui_nicklist_add_group (buffer, NULL, "group", NULL, 1);
+    CHECK(group);
+
+    nick = gui_nicklist_add_nick (buffer, group, "nick[a]", NULL, NULL, NULL,
+                                  1);
+    CHECK(nick);
+
+    POINTERS_EQUAL(nick, gui_nicklist_search_nick (buffer, NULL, "nick[a]"));
+    POINTERS_EQUAL(nick, gui_nicklist_search_nick (buffer, NULL, "NICK[A]"));
+    POINTERS_EQUAL(nick, gui_nicklist_search_nick (buffer, NULL, "nick{a}"));
+    POINTERS_EQUAL(nick, gui_nicklist_search_nick (buffer, NULL, "Nick{A}"));
+    POINTERS_EQUAL(nick, gui_nicklist_search_nick (buffer, group, "nick{a}"));
+    POINTERS_EQUAL(NULL, gui_nicklist_search_nick (buffer, NULL, "nick(a)"));
+    POINTERS_EQUAL(NULL, gui_nicklist_search_nick (buffer, NULL, "nick_a_"));
+
+    /* same nick with IRC casemapping: not added */
+    POINTERS_EQUAL(NULL, gui_nicklist_add_nick (buffer, NULL, "NICK{A}",
+                                                NULL, NULL, NULL, 1));
+    LONGS_EQUAL(0, buffer->nicklist_nicks_key_collisions);
+    LONGS_EQUAL(1, buffer->nicklist_nicks_count);
+
+    /* nick is not in root group itself, but in a child group */
+    POINTERS_EQUAL(nick, gui_nicklist_search_nick (buffer,
+                                                   buffer->nicklist_root,
+                                                   "nick{a}"));
+
+    /* search from another group */
+    group = gui_nicklist_add_group (buffer, NULL, "group2", NULL, 1);
+    CHECK(group);
+    POINTERS_EQUAL(NULL, gui_nicklist_search_nick (buffer, group, "nick[a]"));
+
+    gui_buffer_close (buffer);
+}
+
+/*
+ * Tests functions:
+ *   gui_nicklist_remove_nick
+ *
+ * (nicks with same key in hashtable)
+ */
+
+TEST(GuiNicklist, RemoveNickCollision)
+{
+    struct t_gui_buffer *buffer;
+    struct t_gui_nick_group *group;
+    struct t_gui_nick *nick1, *nick2, *nick3, *ptr_nick;
+
+    buffer = gui_buffer_new (NULL, "test-nicklist", NULL, NULL, NULL,
+                             NULL, NULL, NULL);
+    CHECK(buffer);
+
+    group = gui_nicklist_add_group (buffer, NULL, "group", NULL, 1);
+    CHECK(group);
+
+    /* 3 nicks with same key, in different groups */
+    nick1 = gui_nicklist_add_nick (buffer, NULL, "abc", NULL, NULL, NULL, 1);
+    CHECK(nick1);
+    nick2 = gui_nicklist_add_nick (buffer, group, "ABC", NULL, NULL, NULL, 1);
+    CHECK(nick2);
+    nick3 = gui_nicklist_add_nick (buffer, group, "Abc", NULL, NULL, NULL, 1);
+    CHECK(nick3);
+    LONGS_EQUAL(2, buffer->nicklist_nicks_key_collisions);
+    POINTERS_EQUAL(nick1, hashtable_get (buffer->nicklist_nicks_hashtable,
+                                         "abc"));
+
+    /* remove nick in hashtable: replaced by another nick with same key */
+    gui_nicklist_remove_nick (buffer, nick1);
+    LONGS_EQUAL(1, buffer->nicklist_nicks_key_collisions);
+    ptr_nick = (struct t_gui_nick *)hashtable_get (
+        buffer->nicklist_nicks_hashtable, "abc");
+    CHECK((ptr_nick == nick2) || (ptr_nick == nick3));
+    POINTERS_EQUAL(NULL, gui_nicklist_search_nick (buffer, NULL, "abc"));
+    POINTERS_EQUAL(nick2, gui_nicklist_search_nick (buffer, NULL, "ABC"));
+    POINTERS_EQUAL(nick3, gui_nicklist_search_nick (buffer, NULL, "Abc"));
+    POINTERS_EQUAL(nick3, gui_nicklist_search_nick (buffer, group, "Abc"));
+
+    /* remove nick in hashtable again */
+    gui_nicklist_remove_nick (buffer, ptr_nick);
+    LONGS_EQUAL(0, buffer->nicklist_nicks_key_collisions);
+    ptr_nick = (ptr_nick == nick2) ? nick3 : nick2;
+    POINTERS_EQUAL(ptr_nick, hashtable_get (buffer->nicklist_nicks_hashtable,
+                                            "abc"));
+    POINTERS_EQUAL(ptr_nick,
+                   gui_nicklist_search_nick (buffer, NULL, ptr_nick->name));
+
+    /* add nicks again, then remove the group with nicks */
+    nick1 = gui_nicklist_add_nick (buffer, NULL, "abc", NULL, NULL, NULL, 1);
+    CHECK(nick1);
+    LONGS_EQUAL(1, buffer->nicklist_nicks_key_collisions);
+    gui_nicklist_remove_group (buffer, group);
+    LONGS_EQUAL(0, buffer->nicklist_nicks_key_collisions);
+    POINTERS_EQUAL(nick1, hashtable_get (buffer->nicklist_nicks_hashtable,
+                                         "abc"));
+    POINTERS_EQUAL(nick1, gui_nicklist_search_nick (buffer, NULL, "abc"));
+    POINTERS_EQUAL(NULL, gui_nicklist_search_nick (buffer, NULL, "ABC"));
+
+    gui_nicklist_remove_all (buffer);
+    LONGS_EQUAL(0, buffer->nicklist_nicks_key_collisions);
+    POINTERS_EQUAL(NULL, gui_nicklist_search_nick (buffer, NULL, "abc"));
+
+    gui_buffer_close (buffer);
+}
+
+/*
+ * Tests functions:
+ *   gui_nicklist_add_nick
+ *   gui_nicklist_set_bulk_add
+ *   gui_nicklist_sort_group_nicks
+ */
+
+TEST(GuiNicklist, SortNicks)
+{
+    struct t_gui_buffer *buffer1, *buffer2, *buffer3;
+    struct t_gui_nick *nick;
+    int i;
+
+    buffer1 = gui_buffer_new (NULL, "test-nicklist1", NULL, NULL, NULL,
+                              NULL, NULL, NULL);
+    CHECK(buffer1);
+    buffer2 = gui_buffer_new (NULL, "test-nicklist2", NULL, NULL, NULL,
+                              NULL, NULL, NULL);
+    CHECK(buffer2);
+    buffer3 = gui_buffer_new (NULL, "test-nicklist3", NULL, NULL, NULL,
+                              NULL, NULL, NULL);
+    CHECK(buffer3);
+
+    /* nicks added one at a time */
+    for (i = 0; i < TEST_NICKLIST_NUM_NICKS; i++)
+    {
+        CHECK(gui_nicklist_add_nick (buffer1, NULL,
+                                     test_nicklist_nicks_added[i],
+                                     NULL, NULL, NULL, 1));
+    }
+    LONGS_EQUAL(1, test_nicklist_check_order (buffer1->nicklist_root,
+                                              test_nicklist_nicks_sorted,
+                                              TEST_NICKLIST_NUM_NICKS));
+
+    /* all nicks added in bulk */
+    gui_buffer_set (buffer2, "nicklist_bulk_add", "1");
+    LONGS_EQUAL(1, buffer2->nicklist_bulk_add);
+    for (i = TEST_NICKLIST_NUM_NICKS - 1; i >= 0; i--)
+    {
+        CHECK(gui_nicklist_add_nick (buffer2, NULL,
+                                     test_nicklist_nicks_added[i],
+                                     NULL, NULL, NULL, 1));
+    }
+    LONGS_EQUAL(TEST_NICKLIST_NUM_NICKS,
+                buffer2->nicklist_root->nicks_unsorted);
+    gui_buffer_set (buffer2, "nicklist_bulk_add", "0");
+    LONGS_EQUAL(0, buffer2->nicklist_bulk_add);
+    LONGS_EQUAL(0, buffer2->nicklist_root->nicks_unsorted);
+    LONGS_EQUAL(1, test_nicklist_check_order (buffer2->nicklist_root,
+                                              test_nicklist_nicks_sorted,
+                                              TEST_NICKLIST_NUM_NICKS));
+
+    /* some nicks added one at a time, then other nicks in bulk (merge) */
+    for (i = 0; i < 4; i++)
+    {
+        CHECK(gui_nicklist_add_nick (buffer3, NULL,
+                                     test_nicklist_nicks_added[i],
+                                     NULL, NULL, NULL, 1));
+    }
+    gui_buffer_set (buffer3, "nicklist_bulk_add", "1");
+    for (i = 4; i < TEST_NICKLIST_NUM_NICKS; i++)
+    {
+        CHECK(gui_nicklist_add_nick (buffer3, NULL,
+                                     test_nicklist_nicks_added[i],
+                                     NULL, NULL, NULL, 1));
+    }
+    /* nick removed during bulk add */
+    gui_nicklist_remove_nick (
+        buffer3, gui_nicklist_search_nick (buffer3, NULL, "Bob"));
+    CHECK(gui_nicklist_add_nick (buffer3, NULL, "Bob", NULL, NULL, NULL, 1));
+    gui_buffer_set (buffer3, "nicklist_bulk_add", "0");
+    LONGS_EQUAL(1, test_nicklist_check_order (buffer3->nicklist_root,
+                                              test_nicklist_nicks_sorted,
+                                              TEST_NICKLIST_NUM_NICKS));
+
+    /* nick added after the bulk add is sorted */
+    nick = gui_nicklist_add_nick (buffer3, NULL, "Carol", NULL, NULL, NULL, 1);
+    CHECK(nick);
+    STRCMP_EQUAL("bob2", nick->prev_nick->name);
+    STRCMP_EQUAL("carol", nick->next_nick->name);
+    gui_nicklist_remove_nick (buffer3, nick);
+    LONGS_EQUAL(1, test_nicklist_check_order (buffer3->nicklist_root,
+                                              test_nicklist_nicks_sorted,
+                                              TEST_NICKLIST_NUM_NICKS));
+
+    gui_buffer_close (buffer1);
+    gui_buffer_close (buffer2);
+    gui_buffer_close (buffer3);
+}
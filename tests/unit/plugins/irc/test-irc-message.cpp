@@ -507,6 +507,87 @@ TEST(IrcMessage, Parse)
                     ":irc.example.com 404 nick #channel :Cannot send to channel");
 }
 
+/*
+ * Tests functions:
+ *   irc_message_parse_positions
+ *   irc_message_parsed_dup
+ *   irc_message_parsed_get
+ */
+
+TEST(IrcMessage, ParsePositions)
+{
+    struct t_irc_message_parsed parsed;
+    const char *msg;
+    char buffer[16], *str;
+
+    irc_message_parse_positions (NULL, NULL, &parsed);
+    POINTERS_EQUAL(NULL, parsed.message);
+    LONGS_EQUAL(-1, parsed.pos_tags);
+    LONGS_EQUAL(-1, parsed.pos_message_without_tags);
+    LONGS_EQUAL(-1, parsed.pos_nick);
+    LONGS_EQUAL(-1, parsed.pos_command);
+    POINTERS_EQUAL(NULL, irc_message_parsed_dup (&parsed, parsed.pos_nick,
+                                                 parsed.length_nick));
+
+    msg = "@time=2015-06-27T16:40:35.000Z :nick!user@host PRIVMSG #weechat "
+        ":hello!";
+    irc_message_parse_positions (NULL, msg, &parsed);
+    POINTERS_EQUAL(msg, parsed.message);
+    LONGS_EQUAL(1, parsed.pos_tags);
+    LONGS_EQUAL(29, parsed.length_tags);
+    LONGS_EQUAL(31, parsed.pos_message_without_tags);
+    LONGS_EQUAL(32, parsed.pos_nick);
+    LONGS_EQUAL(4, parsed.length_nick);
+    LONGS_EQUAL(37, parsed.pos_user);
+    LONGS_EQUAL(4, parsed.length_user);
+    LONGS_EQUAL(32, parsed.pos_host);
+    LONGS_EQUAL(14, parsed.length_host);
+    LONGS_EQUAL(47, parsed.pos_command);
+    LONGS_EQUAL(7, parsed.length_command);
+    LONGS_EQUAL(55, parsed.pos_arguments);
+    LONGS_EQUAL(55, parsed.pos_channel);
+    LONGS_EQUAL(8, parsed.length_channel);
+    LONGS_EQUAL(65, parsed.pos_text);
+
+    str = irc_message_parsed_dup (&parsed, parsed.pos_tags,
+                                  parsed.length_tags);
+    STRCMP_EQUAL("time=2015-06-27T16:40:35.000Z", str);
+    free (str);
+
+    /* part fits in buffer */
+    str = irc_message_parsed_get (&parsed,
+                                  parsed.pos_command, parsed.length_command,
+                                  buffer, sizeof (buffer));
+    POINTERS_EQUAL(buffer, str);
+    STRCMP_EQUAL("PRIVMSG", str);
+
+    /* part too long for buffer: allocated string */
+    str = irc_message_parsed_get (&parsed,
+                                  parsed.pos_host, parsed.length_host,
+                                  buffer, 8);
+    CHECK(str != buffer);
+    STRCMP_EQUAL("nick!user@host", str);
+    free (str);
+
+    /* part not found */
+    msg = "PING :server";
+    irc_message_parse_positions (NULL, msg, &parsed);
+    LONGS_EQUAL(-1, parsed.pos_tags);
+    LONGS_EQUAL(0, parsed.pos_message_without_tags);
+    LONGS_EQUAL(-1, parsed.pos_nick);
+    LONGS_EQUAL(-1, parsed.pos_host);
+    LONGS_EQUAL(0, parsed.pos_command);
+    LONGS_EQUAL(4, parsed.length_command);
+    LONGS_EQUAL(5, parsed.pos_arguments);
+    LONGS_EQUAL(-1, parsed.pos_channel);
+    LONGS_EQUAL(6, parsed.pos_text);
+    POINTERS_EQUAL(NULL,
+                   irc_message_parsed_get (&parsed,
+                                           parsed.pos_channel,
+                                           parsed.length_channel,
+                                           buffer, sizeof (buffer)));
+}
+
 /*
  * Tests functions:
  *   irc_message_parse_to_hashtable
@@ -24,9 +24,11 @@
 extern "C"
 {
 #include <stdio.h>
+#include <sys/time.h>
 #include "src/core/wee-config-file.h"
 #include "src/core/wee-hashtable.h"
 #include "src/core/wee-hook.h"
+#include "src/core/wee-util.h"
 #include "src/gui/gui-color.h"
 #include "src/plugins/plugin.h"
 #include "src/plugins/irc/irc-protocol.h"
@@ -43,6 +45,7 @@ extern const char *irc_protocol_nick_address (struct t_irc_server *server,
                                               const char *nickname,
                                               const char *address);
 extern struct t_hashtable *irc_protocol_get_message_tags (const char *tags);
+extern struct t_irc_protocol_msg irc_protocol_messages[];
 }
 
 #include "tests/tests.h"
@@ -219,6 +222,68 @@ TEST(IrcProtocol, ParseTime)
     LONGS_EQUAL(1547386699, irc_protocol_parse_time ("1547386699"));
 }
 
+/*
+ * Tests functions:
+ *   irc_protocol_search_message
+ */
+
+TEST(IrcProtocol, SearchMessage)
+{
+    struct t_irc_protocol_msg *ptr_msg;
+    int i, numeric, prev_numeric;
+
+    /* table must be sorted: commands first, then numeric commands */
+    prev_numeric = 0;
+    for (i = 0; irc_protocol_messages[i].name; i++)
+    {
+        numeric = irc_protocol_is_numeric_command (irc_protocol_messages[i].name);
+        CHECK(numeric >= prev_numeric);
+        if (i > 0 && (numeric == prev_numeric))
+        {
+            CHECK(strcmp (irc_protocol_messages[i - 1].name,
+                          irc_protocol_messages[i].name) < 0);
+        }
+        prev_numeric = numeric;
+    }
+
+    /* all messages of table must be found */
+    for (i = 0; irc_protocol_messages[i].name; i++)
+    {
+        POINTERS_EQUAL(&irc_protocol_messages[i],
+                       irc_protocol_search_message (irc_protocol_messages[i].name));
+    }
+
+    /* message not found */
+    POINTERS_EQUAL(NULL, irc_protocol_search_message (NULL));
+    POINTERS_EQUAL(NULL, irc_protocol_search_message (""));
+    POINTERS_EQUAL(NULL, irc_protocol_search_message ("unknown"));
+    POINTERS_EQUAL(NULL, irc_protocol_search_message ("0"));
+    POINTERS_EQUAL(NULL, irc_protocol_search_message ("00"));
+    POINTERS_EQUAL(NULL, irc_protocol_search_message ("000"));
+    POINTERS_EQUAL(NULL, irc_protocol_search_message ("0001"));
+    POINTERS_EQUAL(NULL, irc_protocol_search_message ("1a1"));
+    POINTERS_EQUAL(NULL, irc_protocol_search_message ("999"));
+
+    /* message found (case insensitive for commands) */
+    ptr_msg = irc_protocol_search_message ("privmsg");
+    CHECK(ptr_msg);
+    STRCMP_EQUAL("privmsg", ptr_msg->name);
+    POINTERS_EQUAL(ptr_msg, irc_protocol_search_message ("PRIVMSG"));
+    POINTERS_EQUAL(ptr_msg, irc_protocol_search_message ("PrivMsg"));
+    ptr_msg = irc_protocol_search_message ("account");
+    CHECK(ptr_msg);
+    STRCMP_EQUAL("account", ptr_msg->name);
+    ptr_msg = irc_protocol_search_message ("WALLOPS");
+    CHECK(ptr_msg);
+    STRCMP_EQUAL("wallops", ptr_msg->name);
+    ptr_msg = irc_protocol_search_message ("001");
+    CHECK(ptr_msg);
+    STRCMP_EQUAL("001", ptr_msg->name);
+    ptr_msg = irc_protocol_search_message ("353");
+    CHECK(ptr_msg);
+    STRCMP_EQUAL("353", ptr_msg->name);
+}
+
 TEST_GROUP(IrcProtocolWithServer)
 {
     void server_recv (const char *command)
@@ -891,7 +956,7 @@ TEST(IrcProtocolWithServer, mode)
 
 TEST(IrcProtocolWithServer, nick)
 {
-    struct t_irc_channel *ptr_channel;
+    struct t_irc_channel *ptr_channel, **ptr_channels;
     struct t_irc_nick *ptr_nick1, *ptr_nick2;
 
     server_recv (":server 001 alice");
@@ -934,6 +999,43 @@ TEST(IrcProtocolWithServer, nick)
     STRCMP_EQUAL("bob2", ptr_nick2->name);
 
     STRCMP_EQUAL("bob2", ptr_server->last_channel->name);
+
+    /* search nicks (index is updated on nick change) */
+    POINTERS_EQUAL(ptr_nick1, irc_nick_search (ptr_server, ptr_channel, "alice2"));
+    POINTERS_EQUAL(ptr_nick1, irc_nick_search (ptr_server, ptr_channel, "ALICE2"));
+    POINTERS_EQUAL(ptr_nick2, irc_nick_search (ptr_server, ptr_channel, "Bob2"));
+    POINTERS_EQUAL(NULL, irc_nick_search (ptr_server, ptr_channel, "alice"));
+    POINTERS_EQUAL(NULL, irc_nick_search (ptr_server, ptr_channel, "bob_away"));
+
+    /* search with casemapping: rfc1459 (default), then ascii */
+    server_recv (":bob2!user@host NICK :bob[2]");
+    POINTERS_EQUAL(ptr_nick2, irc_nick_search (ptr_server, ptr_channel, "BOB{2}"));
+    server_recv (":server 005 alice CASEMAPPING=ascii :are supported");
+    LONGS_EQUAL(IRC_SERVER_CASEMAPPING_ASCII, ptr_server->casemapping);
+    POINTERS_EQUAL(NULL, irc_nick_search (ptr_server, ptr_channel, "BOB{2}"));
+    POINTERS_EQUAL(ptr_nick2, irc_nick_search (ptr_server, ptr_channel, "BOB[2]"));
+
+    /* new nick already used by another (obsolete) nick in channel */
+    server_recv (":carol!user@host JOIN #test");
+    LONGS_EQUAL(3, ptr_channel->nicks_count);
+    server_recv (":bob[2]!user@host NICK :carol");
+    LONGS_EQUAL(2, ptr_channel->nicks_count);
+    STRCMP_EQUAL("carol", ptr_nick2->name);
+    POINTERS_EQUAL(ptr_nick2, ptr_channel->last_nick);
+    POINTERS_EQUAL(ptr_nick2, irc_nick_search (ptr_server, ptr_channel, "carol"));
+    POINTERS_EQUAL(NULL, irc_nick_search (ptr_server, ptr_channel, "bob[2]"));
+    ptr_channels = irc_nick_get_channels (ptr_server, "carol", 0);
+    CHECK(ptr_channels);
+    POINTERS_EQUAL(ptr_channel, ptr_channels[0]);
+    POINTERS_EQUAL(NULL, ptr_channels[1]);
+    free (ptr_channels);
+    server_recv (":carol!user@host PART #test");
+    LONGS_EQUAL(1, ptr_channel->nicks_count);
+    POINTERS_EQUAL(NULL, irc_nick_search (ptr_server, ptr_channel, "carol"));
+    ptr_channels = irc_nick_get_channels (ptr_server, "carol", 0);
+    CHECK(ptr_channels);
+    POINTERS_EQUAL(NULL, ptr_channels[0]);
+    free (ptr_channels);
 }
 
 /*
@@ -1175,7 +1277,7 @@ TEST(IrcProtocolWithServer, privmsg)
 
 TEST(IrcProtocolWithServer, quit)
 {
-    struct t_irc_channel *ptr_channel;
+    struct t_irc_channel *ptr_channel, **ptr_channels;
 
     server_recv (":server 001 alice");
 
@@ -1205,6 +1307,25 @@ TEST(IrcProtocolWithServer, quit)
     LONGS_EQUAL(1, ptr_channel->nicks_count);
     STRCMP_EQUAL("alice", ptr_channel->nicks->name);
     POINTERS_EQUAL(NULL, ptr_channel->nicks->next_nick);
+
+    /* quit of a nick on many channels */
+    server_recv (":alice!user@host JOIN #test2");
+    server_recv (":bob!user@host JOIN #test");
+    server_recv (":bob!user@host JOIN #test2");
+    ptr_channels = irc_nick_get_channels (ptr_server, "BOB", 1);
+    CHECK(ptr_channels);
+    POINTERS_EQUAL(ptr_channel, ptr_channels[0]);
+    POINTERS_EQUAL(irc_channel_search (ptr_server, "#TEST2"), ptr_channels[1]);
+    POINTERS_EQUAL(irc_channel_search (ptr_server, "Bob"), ptr_channels[2]);
+    POINTERS_EQUAL(NULL, ptr_channels[3]);
+    free (ptr_channels);
+    server_recv (":bob!user@host QUIT :quit message");
+    LONGS_EQUAL(1, ptr_channel->nicks_count);
+    LONGS_EQUAL(1, irc_channel_search (ptr_server, "#test2")->nicks_count);
+    ptr_channels = irc_nick_get_channels (ptr_server, "bob", 0);
+    CHECK(ptr_channels);
+    POINTERS_EQUAL(NULL, ptr_channels[0]);
+    free (ptr_channels);
 }
 
 /*
@@ -2731,3 +2852,59 @@ TEST(IrcProtocolWithServer, server_mode_reason)
     server_recv (":server 975 bob mode test");
     server_recv (":server 975 bob mode :test");
 }
+
+/*
+ * Tests functions:
+ *   irc_protocol_recv_command (benchmark)
+ *
+ * Replays a synthetic trace of a busy network (joins, messages, modes,
+ * nick changes, quits and numeric replies) and displays the number of
+ * messages handled per second.
+ */
+
+TEST(IrcProtocolWithServer, Benchmark)
+{
+    const char *trace[] = {
+        ":nick%d!user@host JOIN #test",
+        ":nick%d!user@host PRIVMSG #test :hello world, this is a test",
+        ":server 353 alice = #test :nick%d",
+        ":nick%d!user@host MODE #test +v nick%d",
+        ":nick%d!user@host NOTICE #test :notice message",
+        ":server 366 alice #test :End of /NAMES list.",
+        ":nick%d!user@host NICK nick%d_",
+        ":nick%d_!user@host PRIVMSG #test :message from renamed nick",
+        ":nick%d_!user@host QUIT :quit message",
+        NULL,
+    };
+    char message[1024];
+    struct timeval tv1, tv2;
+    long long diff;
+    int i, j, count;
+
+    server_recv (":server 001 alice");
+    server_recv (":alice!user@host JOIN #test");
+
+    count = 0;
+    gettimeofday (&tv1, NULL);
+    for (i = 0; i < 5000; i++)
+    {
+        for (j = 0; trace[j]; j++)
+        {
+            snprintf (message, sizeof (message) - 2, trace[j], i, i);
+            strcat (message, "\r\n");
+            irc_server_msgq_add_buffer (ptr_server, message);
+            irc_server_msgq_flush ();
+            count++;
+        }
+    }
+    gettimeofday (&tv2, NULL);
+
+    /* all nicks have quit */
+    CHECK(ptr_server->channels);
+    LONGS_EQUAL(1, ptr_server->channels->nicks_count);
+
+    diff = util_timeval_diff (&tv1, &tv2);
+    printf ("\nirc messages received: %d, %.0f msgs/s\n",
+            count,
+            (diff > 0) ? (double)count * 1000000 / diff : 0);
+}